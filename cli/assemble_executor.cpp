@@ -1,6 +1,8 @@
 #include "assemble_executor.hpp"
 #include "../src/Assembler.h"
 #include "../src/Instruction.h"
+#include "../src/MappedFile.h"
+#include "../src/ObjectFile.h"
 #include <filesystem>
 #include <fstream>
 #include <iostream>
@@ -19,44 +21,46 @@ int execute_assemble_command(const AssembleConfig& config)
             return EXIT_IO_ERROR;
         }
 
-        // Read input assembly file
-        std::ifstream input_file(config.input);
-        if (!input_file.is_open())
+        // Map the input; the assembler lexes it in place
+        mips::MappedFile input_file;
+        std::string      open_error;
+        if (!input_file.open(config.input, open_error))
         {
             std::cerr << "mipsim: cannot open input file: " << config.input << std::endl;
             return EXIT_IO_ERROR;
         }
-
-        std::string assembly_content;
-        std::string line;
-        while (std::getline(input_file, line))
-        {
-            assembly_content += line + "\n";
-        }
-        input_file.close();
+        const std::string_view assembly_content = input_file.view();
 
         // Check for empty input
-        if (assembly_content.empty() ||
-            assembly_content.find_first_not_of(" \t\n\r") == std::string::npos)
+        if (assembly_content.find_first_not_of(" \t\n\r") == std::string_view::npos)
         {
             std::cerr << "mipsim: input file is empty or contains only whitespace" << std::endl;
             return EXIT_RUNTIME_ERROR;
         }
 
         // Create assembler and assemble the code
-        mips::Assembler                 assembler;
-        std::map<std::string, uint32_t> labelMap;
+        mips::Assembler                  assembler(static_cast<unsigned>(config.jobs));
+        std::map<std::string, uint32_t>  labelMap;
+        std::vector<mips::DataDirective> dataDirectives;
 
         std::vector<std::unique_ptr<mips::Instruction>> instructions;
+        mips::ObjectFile                                object;
         try
         {
-            instructions = assembler.assembleWithLabels(assembly_content, labelMap);
+            instructions = assembler.assembleWithLabels(assembly_content, labelMap, dataDirectives);
+            mips::Assembler::link(instructions, labelMap);
+            object = mips::ObjectFile::fromProgram(instructions, dataDirectives, labelMap);
         }
         catch (const std::exception& e)
         {
             std::cerr << "mipsim: assembly error: " << e.what() << std::endl;
             return EXIT_RUNTIME_ERROR;
         }
+        if (const auto warning = mips::Assembler::describeSkippedLines(assembler.skippedLines());
+            !warning.empty())
+        {
+            std::cerr << "mipsim: warning: " << warning << std::endl;
+        }
 
         // Check if assembly produced any instructions
         if (instructions.empty())
@@ -80,16 +84,12 @@ int execute_assemble_command(const AssembleConfig& config)
             return EXIT_IO_ERROR;
         }
 
-        // For each instruction, write its binary representation
-        // Note: This is a simplified implementation that writes instruction count
-        // In a complete implementation, we'd need to properly encode each instruction
-        size_t instruction_count = instructions.size();
-        for (size_t i = 0; i < instruction_count; ++i)
+        // Text, data and symbol sections (see ObjectFile)
+        object.write(output_file);
+        if (!output_file)
         {
-            // Write instruction index as a simple binary format
-            // This provides a non-zero output that's deterministic for testing
-            uint32_t encoded = static_cast<uint32_t>(i + 1);  // 1-based indexing
-            output_file.write(reinterpret_cast<const char*>(&encoded), sizeof(uint32_t));
+            std::cerr << "mipsim: failed to write output file: " << output_filename << std::endl;
+            return EXIT_IO_ERROR;
         }
         output_file.close();
 
@@ -0,0 +1,475 @@
+#include "batch_executor.hpp"
+#include "../src/MipsSimulatorAPI.h"
+#include "../src/ProgramCache.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+
+namespace cli
+{
+
+namespace
+{
+
+namespace fs = std::filesystem;
+using Clock  = std::chrono::steady_clock;
+
+/**
+ * @brief Raises a worker's stop flag once its program has run past the timeout
+ *
+ * One thread serves every worker: it sleeps until the earliest armed deadline,
+ * so a batch costs one watchdog rather than one per program.
+ */
+class Watchdog
+{
+  public:
+    explicit Watchdog(size_t lanes) : m_lanes(lanes)
+    {
+        m_thread = std::thread([this] { watch(); });
+    }
+
+    ~Watchdog()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_done = true;
+        }
+        m_wakeup.notify_one();
+        m_thread.join();
+    }
+
+    std::atomic<bool>* arm(size_t lane, std::chrono::seconds timeout)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_lanes[lane].stop.store(false, std::memory_order_relaxed);
+            m_lanes[lane].deadline = Clock::now() + timeout;
+        }
+        m_wakeup.notify_one();
+        return &m_lanes[lane].stop;
+    }
+
+    void disarm(size_t lane)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_lanes[lane].deadline = Clock::time_point::max();
+    }
+
+  private:
+    struct Lane
+    {
+        std::atomic<bool> stop{false};
+        Clock::time_point deadline = Clock::time_point::max();
+    };
+
+    void watch()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (!m_done)
+        {
+            Clock::time_point next = Clock::time_point::max();
+            for (const Lane& lane : m_lanes)
+            {
+                next = std::min(next, lane.deadline);
+            }
+            if (next == Clock::time_point::max())
+            {
+                m_wakeup.wait(lock);
+                continue;
+            }
+            m_wakeup.wait_until(lock, next);
+
+            const Clock::time_point now = Clock::now();
+            for (Lane& lane : m_lanes)
+            {
+                if (lane.deadline <= now)
+                {
+                    lane.stop.store(true, std::memory_order_relaxed);
+                    lane.deadline = Clock::time_point::max();
+                }
+            }
+        }
+    }
+
+    std::vector<Lane>       m_lanes;
+    std::mutex              m_mutex;
+    std::condition_variable m_wakeup;
+    bool                    m_done = false;
+    std::thread             m_thread;
+};
+
+struct Outcome
+{
+    const char* status       = "error";  // pass, fail, unchecked (no .out file) or error
+    const char* reason       = "load";   // exit, limit, timeout, fault or load
+    uint64_t    cycles       = 0;
+    uint64_t    instructions = 0;
+    double      wallMs       = 0;
+    size_t      diffLine     = 0;  // First differing output line of a fail, from 1
+    std::string error;
+};
+
+bool readFile(const fs::path& path, std::string& content)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        return false;
+    }
+    content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
+
+// Expected outputs are often saved on Windows or by editors that drop the final
+// newline, so CRLF and trailing newlines do not count as differences
+std::string normaliseOutput(const std::string& text)
+{
+    std::string normalised;
+    normalised.reserve(text.size());
+    for (size_t i = 0; i < text.size(); ++i)
+    {
+        if (text[i] != '\r' || i + 1 >= text.size() || text[i + 1] != '\n')
+        {
+            normalised += text[i];
+        }
+    }
+    while (!normalised.empty() && (normalised.back() == '\n' || normalised.back() == '\r'))
+    {
+        normalised.pop_back();
+    }
+    return normalised;
+}
+
+size_t firstDifferentLine(const std::string& a, const std::string& b)
+{
+    const auto mismatch = std::mismatch(a.begin(), a.end(), b.begin(), b.end()).first;
+    return 1 + static_cast<size_t>(std::count(a.begin(), mismatch, '\n'));
+}
+
+void appendJsonString(std::string& json, const std::string& text)
+{
+    json += '"';
+    for (const char c : text)
+    {
+        switch (c)
+        {
+        case '"':
+            json += "\\\"";
+            break;
+        case '\\':
+            json += "\\\\";
+            break;
+        case '\n':
+            json += "\\n";
+            break;
+        case '\t':
+            json += "\\t";
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20)
+            {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                json += escaped;
+            }
+            else
+            {
+                json += c;
+            }
+        }
+    }
+    json += '"';
+}
+
+std::string toJson(const std::string& program, const Outcome& outcome)
+{
+    char wall[32];
+    std::snprintf(wall, sizeof(wall), "%.3f", outcome.wallMs);
+
+    std::string json = "{\"program\":";
+    appendJsonString(json, program);
+    json += ",\"status\":\"" + std::string(outcome.status) + "\"";
+    json += ",\"reason\":\"" + std::string(outcome.reason) + "\"";
+    json += ",\"cycles\":" + std::to_string(outcome.cycles);
+    json += ",\"instructions\":" + std::to_string(outcome.instructions);
+    json += ",\"wall_ms\":" + std::string(wall);
+    if (outcome.diffLine > 0)
+    {
+        json += ",\"diff_line\":" + std::to_string(outcome.diffLine);
+    }
+    if (!outcome.error.empty())
+    {
+        json += ",\"error\":";
+        appendJsonString(json, outcome.error);
+    }
+    return json + "}\n";
+}
+
+// Runs one program in its own simulator, with <stem>.in as console input and
+// <stem>.out as the expected console output when they exist
+Outcome runProgram(const std::string& program, const BatchConfig& config, std::atomic<bool>* stop)
+{
+    const Clock::time_point start = Clock::now();
+    const fs::path          path(program);
+    Outcome                 outcome;
+
+    mips::MipsSimulatorAPI simulator;
+    simulator.setProgramCache(mips::ProgramCache::standard());
+    if (config.jit)
+    {
+        simulator.setJitEnabled(true);
+    }
+
+    const bool loaded = path.extension() == ".bin" ? simulator.loadBinaryFile(program)
+                                                   : simulator.loadProgramFromFile(program);
+    if (!loaded)
+    {
+        outcome.error = simulator.getLastError();
+    }
+    else
+    {
+        std::string input;
+        if (readFile(fs::path(path).replace_extension(".in"), input))
+        {
+            simulator.setConsoleInput(input);
+        }
+
+        const uint64_t budget =
+            config.limit > 0 ? static_cast<uint64_t>(config.limit) : UINT64_MAX;
+
+        mips::RunResult result;
+        result.reason = mips::StopReason::Fault;  // Unless runFor returns
+        try
+        {
+            result = simulator.runFor(budget, stop);
+        }
+        catch (const std::exception& e)
+        {
+            outcome.error = e.what();
+        }
+        outcome.cycles       = simulator.getCycleCount();
+        outcome.instructions = simulator.getRetiredInstructionCount();
+
+        switch (result.reason)
+        {
+        case mips::StopReason::Exit:
+        {
+            outcome.reason = "exit";
+            std::string expected;
+            if (!readFile(fs::path(path).replace_extension(".out"), expected))
+            {
+                outcome.status = "unchecked";
+                break;
+            }
+            const std::string actual = normaliseOutput(simulator.getConsoleOutput());
+            expected                 = normaliseOutput(expected);
+            outcome.status           = actual == expected ? "pass" : "fail";
+            if (actual != expected)
+            {
+                outcome.diffLine = firstDifferentLine(actual, expected);
+            }
+            break;
+        }
+        case mips::StopReason::BudgetExhausted:
+            outcome.reason = "limit";
+            break;
+        case mips::StopReason::StopRequested:
+            outcome.reason = "timeout";
+            break;
+        case mips::StopReason::Breakpoint:
+        case mips::StopReason::Fault:
+            outcome.reason = "fault";
+            if (outcome.error.empty())
+            {
+                outcome.error = simulator.getLastError();
+            }
+            break;
+        }
+    }
+
+    outcome.wallMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    return outcome;
+}
+
+}  // namespace
+
+bool collect_batch_programs(const std::vector<std::string>& inputs,
+                            std::vector<std::string>& programs, std::string& error)
+{
+    for (const std::string& input : inputs)
+    {
+        std::error_code code;
+        const fs::path  path(input);
+        if (fs::is_directory(path, code))
+        {
+            std::vector<std::string> found;
+            for (fs::recursive_directory_iterator
+                     it(path, fs::directory_options::skip_permission_denied, code),
+                 end;
+                 !code && it != end; it.increment(code))
+            {
+                if (it->path().extension() == ".asm" && it->is_regular_file(code))
+                {
+                    found.push_back(it->path().string());
+                }
+            }
+            if (code)
+            {
+                error = "cannot read directory " + input + ": " + code.message();
+                return false;
+            }
+            std::sort(found.begin(), found.end());
+            programs.insert(programs.end(), found.begin(), found.end());
+        }
+        else if (!fs::exists(path, code))
+        {
+            error = "file not found: " + input;
+            return false;
+        }
+        else if (path.extension() == ".asm" || path.extension() == ".bin")
+        {
+            programs.push_back(input);
+        }
+        else
+        {
+            std::ifstream list(path);
+            if (!list.is_open())
+            {
+                error = "cannot read program list: " + input;
+                return false;
+            }
+            std::string line;
+            while (std::getline(list, line))
+            {
+                const size_t first = line.find_first_not_of(" \t\r");
+                if (first == std::string::npos || line[first] == '#')
+                {
+                    continue;
+                }
+                const size_t   last = line.find_last_not_of(" \t\r");
+                const fs::path entry(line.substr(first, last - first + 1));
+                programs.push_back(
+                    (entry.is_absolute() ? entry : path.parent_path() / entry).string());
+            }
+        }
+    }
+    return true;
+}
+
+int execute_batch_command(const BatchConfig& config)
+{
+    if (config.output.empty())
+    {
+        const int result = execute_batch_command(config, std::cout);
+        std::cout.flush();
+        return result;
+    }
+
+    std::ofstream out(config.output, std::ios::binary);
+    if (!out.is_open())
+    {
+        std::cerr << "mipsim: cannot write " << config.output << std::endl;
+        return EXIT_IO_ERROR;
+    }
+    return execute_batch_command(config, out);
+}
+
+int execute_batch_command(const BatchConfig& config, std::ostream& out)
+{
+    std::vector<std::string> programs;
+    std::string              error;
+    if (!collect_batch_programs(config.inputs, programs, error))
+    {
+        std::cerr << "mipsim: " << error << std::endl;
+        return EXIT_IO_ERROR;
+    }
+    if (programs.empty())
+    {
+        std::cerr << "mipsim: no programs found" << std::endl;
+        return EXIT_IO_ERROR;
+    }
+
+    if (config.jit && !mips::MipsSimulatorAPI().setJitEnabled(true))
+    {
+        std::cerr << "mipsim: no JIT is available in this build; --jit ignored" << std::endl;
+    }
+
+    unsigned jobs = config.jobs > 0 ? static_cast<unsigned>(config.jobs)
+                                    : std::max(1u, std::thread::hardware_concurrency());
+    jobs = static_cast<unsigned>(std::min<size_t>(jobs, programs.size()));
+
+    std::unique_ptr<Watchdog> watchdog;
+    if (config.timeout > 0)
+    {
+        watchdog = std::make_unique<Watchdog>(jobs);
+    }
+
+    // Workers claim programs in order and write each line as soon as it is
+    // ready, so results stream in completion order
+    std::atomic<size_t> next{0};
+    std::mutex          output_mutex;
+    size_t              passed    = 0;
+    size_t              failed    = 0;
+    size_t              errors    = 0;
+    size_t              unchecked = 0;
+
+    auto work = [&](size_t lane)
+    {
+        for (size_t index = next++; index < programs.size(); index = next++)
+        {
+            std::atomic<bool>* stop =
+                watchdog ? watchdog->arm(lane, std::chrono::seconds(config.timeout)) : nullptr;
+            const Outcome outcome = runProgram(programs[index], config, stop);
+            if (watchdog)
+            {
+                watchdog->disarm(lane);
+            }
+            const std::string line = toJson(programs[index], outcome);
+
+            std::lock_guard<std::mutex> lock(output_mutex);
+            out.write(line.data(), static_cast<std::streamsize>(line.size()));
+            out.flush();
+
+            const std::string_view status = outcome.status;
+            (status == "pass"        ? passed
+             : status == "fail"      ? failed
+             : status == "unchecked" ? unchecked
+                                     : errors)++;
+        }
+    };
+
+    const Clock::time_point  start = Clock::now();
+    std::vector<std::thread> workers;
+    workers.reserve(jobs);
+    for (unsigned i = 0; i < jobs; ++i)
+    {
+        workers.emplace_back(work, i);
+    }
+    for (std::thread& worker : workers)
+    {
+        worker.join();
+    }
+    const std::chrono::duration<double> elapsed = Clock::now() - start;
+
+    std::cerr << "mipsim: " << programs.size() << " programs: " << passed << " passed, " << failed
+              << " failed, " << errors << " errors, " << unchecked << " without expected output ("
+              << elapsed.count() << " s, " << jobs << " jobs)" << std::endl;
+
+    if (!out)
+    {
+        std::cerr << "mipsim: error writing batch results" << std::endl;
+        return EXIT_IO_ERROR;
+    }
+    return failed + errors > 0 ? EXIT_TEST_FAILURE : EXIT_OK;
+}
+
+}  // namespace cli
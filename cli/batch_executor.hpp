@@ -0,0 +1,36 @@
+#pragma once
+
+#include "cli.hpp"
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace cli
+{
+
+/**
+ * @brief Execute the batch command, writing the JSON lines to config.output or standard output
+ * @param config BatchConfig containing the programs, the worker count and the per-program limits
+ * @return EXIT_OK if every program exited with the expected output, EXIT_TEST_FAILURE if
+ *         any failed or stopped early, EXIT_IO_ERROR if the inputs or the output are unusable
+ */
+int execute_batch_command(const BatchConfig& config);
+
+/**
+ * @brief Execute the batch command, writing the JSON lines to the given stream
+ */
+int execute_batch_command(const BatchConfig& config, std::ostream& out);
+
+/**
+ * @brief Expand batch inputs into the programs to run
+ *
+ * A directory contributes every .asm file below it, in path order; a .asm or .bin file is
+ * itself; any other file is a list of programs, one per line, relative to the list's
+ * directory, with blank lines and lines starting with '#' skipped.
+ *
+ * @return false if an input does not exist or a list cannot be read
+ */
+bool collect_batch_programs(const std::vector<std::string>& inputs,
+                            std::vector<std::string>& programs, std::string& error);
+
+}  // namespace cli
@@ -1,7 +1,13 @@
 #include "cli.hpp"
 #include "assemble_executor.hpp"
+#include "batch_executor.hpp"
+#include "disasm_executor.hpp"
 #include "run_executor.hpp"
+#include "translate_executor.hpp"
+#include "Log.h"
 
+#include <algorithm>
+#include <climits>
 #include <iostream>
 #include <sstream>
 
@@ -105,6 +111,63 @@ ParseResult parse_argv(const std::vector<std::string>& args)
                     return result;
                 }
             }
+            else if (arg == "--log")
+            {
+                if (i + 1 >= args.size())
+                {
+                    result.error_code    = EXIT_ARG_PARSE;
+                    result.error_message = "missing value for --log";
+                    return result;
+                }
+                std::string log_error;
+                if (!mips::Log::validate(args[i + 1], log_error))
+                {
+                    result.error_code    = EXIT_ARG_PARSE;
+                    result.error_message = "invalid value for --log: " + log_error;
+                    return result;
+                }
+                run_cfg.log = args[i + 1];
+                i++;  // skip the value
+            }
+            else if (arg == "--jit")
+            {
+                run_cfg.jit = true;
+            }
+            else if (arg == "--checkpoint-every")
+            {
+                if (i + 1 >= args.size())
+                {
+                    result.error_code    = EXIT_ARG_PARSE;
+                    result.error_message = "missing value for --checkpoint-every";
+                    return result;
+                }
+                try
+                {
+                    run_cfg.checkpoint_every = std::stoll(args[i + 1]);
+                    i++;  // skip the value
+                }
+                catch (const std::exception&)
+                {
+                    run_cfg.checkpoint_every = 0;  // Rejected below
+                }
+                if (run_cfg.checkpoint_every <= 0)
+                {
+                    result.error_code    = EXIT_ARG_PARSE;
+                    result.error_message = "invalid value for --checkpoint-every";
+                    return result;
+                }
+            }
+            else if (arg == "--checkpoint-dir" || arg == "--resume")
+            {
+                if (i + 1 >= args.size())
+                {
+                    result.error_code    = EXIT_ARG_PARSE;
+                    result.error_message = "missing value for " + arg;
+                    return result;
+                }
+                (arg == "--resume" ? run_cfg.resume : run_cfg.checkpoint_dir) = args[i + 1];
+                i++;  // skip the value
+            }
             else if (arg.substr(0, 2) == "--")
             {
                 result.error_code    = EXIT_ARG_PARSE;
@@ -119,6 +182,13 @@ ParseResult parse_argv(const std::vector<std::string>& args)
             }
         }
 
+        if ((run_cfg.checkpoint_every > 0) != !run_cfg.checkpoint_dir.empty())
+        {
+            result.error_code    = EXIT_ARG_PARSE;
+            result.error_message = "--checkpoint-every and --checkpoint-dir must be used together";
+            return result;
+        }
+
         result.config = run_cfg;
         return result;
     }
@@ -165,6 +235,32 @@ ParseResult parse_argv(const std::vector<std::string>& args)
                 assemble_cfg.map = args[i + 1];
                 i++;  // skip the value
             }
+            else if (arg == "--jobs")
+            {
+                if (i + 1 >= args.size())
+                {
+                    result.error_code    = EXIT_ARG_PARSE;
+                    result.error_message = "missing value for --jobs";
+                    return result;
+                }
+                const std::string& value = args[i + 1];
+                i++;  // skip the value
+                try
+                {
+                    size_t used       = 0;
+                    assemble_cfg.jobs = std::stoi(value, &used);
+                    if (assemble_cfg.jobs <= 0 || used != value.size())
+                    {
+                        throw std::invalid_argument(value);
+                    }
+                }
+                catch (const std::exception&)
+                {
+                    result.error_code    = EXIT_ARG_PARSE;
+                    result.error_message = "invalid value for --jobs";
+                    return result;
+                }
+            }
             else if (arg.substr(0, 2) == "--")
             {
                 result.error_code    = EXIT_ARG_PARSE;
@@ -183,6 +279,227 @@ ParseResult parse_argv(const std::vector<std::string>& args)
         return result;
     }
 
+    if (cmd == "translate")
+    {
+        result.cmd = Command::Translate;
+        TranslateConfig translate_cfg;
+
+        // Need at least the input file
+        if (start_idx + 1 >= args.size())
+        {
+            result.error_code    = EXIT_ARG_PARSE;
+            result.error_message = "missing input file";
+            return result;
+        }
+
+        translate_cfg.input = args[start_idx + 1];
+
+        for (size_t i = start_idx + 2; i < args.size(); i++)
+        {
+            const std::string& arg = args[i];
+
+            if (arg == "-o" || arg == "--output")
+            {
+                if (i + 1 >= args.size())
+                {
+                    result.error_code    = EXIT_ARG_PARSE;
+                    result.error_message = "missing value for -o";
+                    return result;
+                }
+                translate_cfg.output = args[i + 1];
+                i++;  // skip the value
+            }
+            else if (arg.substr(0, 2) == "--")
+            {
+                result.error_code    = EXIT_ARG_PARSE;
+                result.error_message = "unknown option " + arg + " (see 'mipsim translate --help')";
+                return result;
+            }
+            else
+            {
+                result.error_code    = EXIT_ARG_PARSE;
+                result.error_message = "unexpected argument: " + arg;
+                return result;
+            }
+        }
+
+        result.config = translate_cfg;
+        return result;
+    }
+
+    if (cmd == "disasm")
+    {
+        result.cmd = Command::Disasm;
+        DisasmConfig disasm_cfg;
+
+        // Need at least the binary
+        if (start_idx + 1 >= args.size())
+        {
+            result.error_code    = EXIT_ARG_PARSE;
+            result.error_message = "missing input file";
+            return result;
+        }
+
+        disasm_cfg.input = args[start_idx + 1];
+
+        for (size_t i = start_idx + 2; i < args.size(); i++)
+        {
+            const std::string& arg = args[i];
+
+            if (arg == "--start" || arg == "--count" || arg == "--jobs" || arg == "--map")
+            {
+                if (i + 1 >= args.size())
+                {
+                    result.error_code    = EXIT_ARG_PARSE;
+                    result.error_message = "missing value for " + arg;
+                    return result;
+                }
+                const std::string& value = args[i + 1];
+                i++;  // skip the value
+
+                if (arg == "--map")
+                {
+                    disasm_cfg.map = value;
+                    continue;
+                }
+                try
+                {
+                    size_t used = 0;
+                    if (arg == "--start")
+                    {
+                        disasm_cfg.start = std::stoull(value, &used, 0);  // Decimal or 0x hex
+                        if (disasm_cfg.start % 4 != 0 || disasm_cfg.start > UINT32_MAX)
+                        {
+                            throw std::invalid_argument(value);
+                        }
+                    }
+                    else if (arg == "--count")
+                    {
+                        disasm_cfg.count = std::stoi(value, &used);
+                        if (disasm_cfg.count < 0)
+                        {
+                            throw std::invalid_argument(value);
+                        }
+                    }
+                    else
+                    {
+                        disasm_cfg.jobs = std::stoi(value, &used);
+                        if (disasm_cfg.jobs <= 0)
+                        {
+                            throw std::invalid_argument(value);
+                        }
+                    }
+                    if (used != value.size())
+                    {
+                        throw std::invalid_argument(value);
+                    }
+                }
+                catch (const std::exception&)
+                {
+                    result.error_code    = EXIT_ARG_PARSE;
+                    result.error_message = "invalid value for " + arg;
+                    if (arg == "--start")
+                    {
+                        result.error_message += " (expected a word-aligned address)";
+                    }
+                    return result;
+                }
+            }
+            else if (arg.substr(0, 2) == "--")
+            {
+                result.error_code    = EXIT_ARG_PARSE;
+                result.error_message = "unknown option " + arg + " (see 'mipsim disasm --help')";
+                return result;
+            }
+            else
+            {
+                result.error_code    = EXIT_ARG_PARSE;
+                result.error_message = "unexpected argument: " + arg;
+                return result;
+            }
+        }
+
+        result.config = disasm_cfg;
+        return result;
+    }
+
+    if (cmd == "batch")
+    {
+        result.cmd = Command::Batch;
+        BatchConfig batch_cfg;
+
+        for (size_t i = start_idx + 1; i < args.size(); i++)
+        {
+            const std::string& arg = args[i];
+
+            if (arg == "--jobs" || arg == "--limit" || arg == "--timeout" || arg == "-o" ||
+                arg == "--output")
+            {
+                if (i + 1 >= args.size())
+                {
+                    result.error_code    = EXIT_ARG_PARSE;
+                    result.error_message = "missing value for " + arg;
+                    return result;
+                }
+                const std::string& value = args[i + 1];
+                i++;  // skip the value
+
+                if (arg == "-o" || arg == "--output")
+                {
+                    batch_cfg.output = value;
+                    continue;
+                }
+                try
+                {
+                    size_t    used   = 0;
+                    long long number = std::stoll(value, &used);
+                    if (number <= 0 || used != value.size())
+                    {
+                        throw std::invalid_argument(value);
+                    }
+                    if (arg == "--jobs")
+                    {
+                        batch_cfg.jobs = static_cast<int>(std::min<long long>(number, INT_MAX));
+                    }
+                    else
+                    {
+                        (arg == "--limit" ? batch_cfg.limit : batch_cfg.timeout) = number;
+                    }
+                }
+                catch (const std::exception&)
+                {
+                    result.error_code    = EXIT_ARG_PARSE;
+                    result.error_message = "invalid value for " + arg;
+                    return result;
+                }
+            }
+            else if (arg == "--jit")
+            {
+                batch_cfg.jit = true;
+            }
+            else if (arg.substr(0, 2) == "--")
+            {
+                result.error_code    = EXIT_ARG_PARSE;
+                result.error_message = "unknown option " + arg + " (see 'mipsim batch --help')";
+                return result;
+            }
+            else
+            {
+                batch_cfg.inputs.push_back(arg);
+            }
+        }
+
+        if (batch_cfg.inputs.empty())
+        {
+            result.error_code    = EXIT_ARG_PARSE;
+            result.error_message = "missing program directory or list";
+            return result;
+        }
+
+        result.config = batch_cfg;
+        return result;
+    }
+
     // Unknown command
     result.cmd           = Command::Unknown;
     result.error_code    = EXIT_ARG_PARSE;
@@ -220,6 +537,24 @@ int dispatch(const ParseResult& result)
         return execute_assemble_command(assemble_cfg);
     }
 
+    case Command::Translate:
+    {
+        auto& translate_cfg = std::get<TranslateConfig>(result.config);
+        return execute_translate_command(translate_cfg);
+    }
+
+    case Command::Disasm:
+    {
+        auto& disasm_cfg = std::get<DisasmConfig>(result.config);
+        return execute_disasm_command(disasm_cfg);
+    }
+
+    case Command::Batch:
+    {
+        auto& batch_cfg = std::get<BatchConfig>(result.config);
+        return execute_batch_command(batch_cfg);
+    }
+
     default:
         std::cerr << "mipsim: internal error - unhandled command" << std::endl;
         return EXIT_RUNTIME_ERROR;
@@ -240,7 +575,9 @@ std::string format_help()
         << "Commands:\n"
         << "  run         Execute a program (.asm or .bin)\n"
         << "  assemble    Assemble .asm → .bin\n"
+        << "  translate   Translate .asm → standalone C++ source\n"
         << "  disasm      Disassemble .bin → text\n"
+        << "  batch       Run many programs in parallel and check their output\n"
         << "  repl        Interactive shell (step/regs/mem/break)\n"
         << "  dump        Print state (regs/pc/mem), scriptable output\n"
         << "  help        Per-command help\n"
@@ -254,13 +591,50 @@ std::string format_help()
         << "Examples:\n"
         << "  mipsim run prog.asm --limit 1000 --trace regs\n"
         << "  mipsim run prog.asm --timeout 30\n"
+        << "  mipsim run prog.asm --log cpu,branch=debug\n"
+        << "  mipsim run prog.asm --jit\n"
+        << "  mipsim run prog.asm --checkpoint-every 100000000 --checkpoint-dir ckpt\n"
+        << "  mipsim run prog.asm --resume ckpt/prog.ckpt\n"
         << "  mipsim assemble src.asm -o out.bin --map symbols.map\n"
-        << "  mipsim disasm out.bin --start 0x00400000 --count 10\n"
+        << "  mipsim translate prog.asm -o prog.cpp\n"
+        << "  mipsim disasm out.bin --start 0x40 --count 10 --map symbols.map\n"
+        << "  mipsim batch tests/ --jobs 8 --limit 1000000 -o results.jsonl\n"
         << "\n"
         << "Run Command Options:\n"
         << "  --limit N      Stop execution after N cycles\n"
         << "  --timeout N    Stop execution after N seconds\n"
-        << "  --trace TYPE   Enable tracing (regs|mem|all)\n";
+        << "  --trace TYPE   Enable tracing (regs|mem|all)\n"
+        << "  --log SPEC     Enable log categories on stderr: CAT[=LEVEL][,...]\n"
+        << "                 CAT: all|cpu|branch|memory|register|syscall|pipeline\n"
+        << "                 LEVEL: off|error|warn|info|debug|trace (default trace)\n"
+        << "  --jit          Translate hot code to native x86-64 (interpreted elsewhere)\n"
+        << "  --checkpoint-every N\n"
+        << "                 Save the machine state every N cycles (needs --checkpoint-dir)\n"
+        << "  --checkpoint-dir DIR\n"
+        << "                 Write checkpoints to DIR/<program>.ckpt, replacing the last one\n"
+        << "  --resume FILE  Continue bit-exactly from a checkpoint of the same program\n"
+        << "\n"
+        << "Assemble Command Options:\n"
+        << "  -o FILE        Output file (default: <input>.bin)\n"
+        << "  --map FILE     Also write the symbol table to FILE\n"
+        << "  --jobs N       Worker threads for large sources (default: one per core)\n"
+        << "\n"
+        << "Disasm Command Options:\n"
+        << "  --start ADDR   First instruction address (decimal or 0x hex, default 0)\n"
+        << "  --count N      Number of instructions (default: to the end of the text)\n"
+        << "  --map FILE     Label instructions and targets with symbols from FILE\n"
+        << "  --jobs N       Worker threads for large images (default: one per core)\n"
+        << "\n"
+        << "Batch Command Options:\n"
+        << "  mipsim batch <dir|program|list>... runs every .asm under each directory,\n"
+        << "  each listed program, and the programs named one per line in list files.\n"
+        << "  Output is checked against <program>.out when it exists, ignoring CR and\n"
+        << "  trailing newlines; one JSON line per program is written as it finishes.\n"
+        << "  --jobs N       Programs run at once (default: one per core)\n"
+        << "  --limit N      Stop each program after N cycles\n"
+        << "  --timeout N    Stop each program after N seconds\n"
+        << "  --jit          Translate hot code to native x86-64\n"
+        << "  -o FILE        Write the JSON lines to FILE (default: standard output)\n";
     return oss.str();
 }
 
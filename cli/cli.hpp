@@ -22,7 +22,9 @@ enum class Command
     Version,
     Run,
     Assemble,
+    Translate,
     Disasm,
+    Batch,
     Repl,
     Dump,
     Unknown
@@ -38,23 +40,47 @@ struct GlobalOptions
 struct RunConfig
 {
     std::string program;
-    long long   limit   = -1;  // -1 means no limit
-    long long   timeout = -1;  // -1 means no timeout (in seconds)
-    std::string trace;         // "regs", "mem", "all", or empty
+    long long   limit   = -1;           // -1 means no limit
+    long long   timeout = -1;           // -1 means no timeout (in seconds)
+    std::string trace;                  // "regs", "mem", "all", or empty
+    std::string log;                    // Log spec, e.g. "cpu,memory=debug", or empty
+    bool        jit = false;            // Translate hot blocks to native code
+    long long   checkpoint_every = -1;  // Cycles between checkpoints, -1 means none
+    std::string checkpoint_dir;         // Where <program stem>.ckpt is written
+    std::string resume;                 // Checkpoint file to continue from, or empty
 };
 
 struct AssembleConfig
 {
     std::string input;
     std::string output;
-    std::string map;  // symbol map file
+    std::string map;       // symbol map file
+    int         jobs = 0;  // Worker threads, 0 means one per hardware thread
+};
+
+struct TranslateConfig
+{
+    std::string input;
+    std::string output;  // Defaults to <input>.cpp
 };
 
 struct DisasmConfig
 {
     std::string input;
-    uint64_t    start = 0;
+    uint64_t    start = 0;   // Byte address of the first instruction (word-aligned)
     int         count = -1;  // -1 means all
+    std::string map;         // Symbol map file (from assemble --map), or empty
+    int         jobs = 0;    // Worker threads, 0 means one per hardware thread
+};
+
+struct BatchConfig
+{
+    std::vector<std::string> inputs;           // Directories, programs (.asm/.bin) or list files
+    int                      jobs    = 0;      // Worker threads, 0 means one per hardware thread
+    long long                limit   = -1;     // Cycles per program, -1 means no limit
+    long long                timeout = -1;     // Seconds per program, -1 means no timeout
+    bool                     jit     = false;  // Translate hot blocks to native code
+    std::string              output;           // JSON lines file, or empty for standard output
 };
 
 struct ReplConfig
@@ -74,7 +100,9 @@ struct ParseResult
 {
     Command       cmd = Command::Unknown;
     GlobalOptions global;
-    std::variant<RunConfig, AssembleConfig, DisasmConfig, ReplConfig, DumpConfig> config;
+    std::variant<RunConfig, AssembleConfig, TranslateConfig, DisasmConfig, BatchConfig, ReplConfig,
+                 DumpConfig>
+        config;
     int         error_code = EXIT_OK;
     std::string error_message;
 };
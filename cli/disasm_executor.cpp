@@ -0,0 +1,227 @@
+#include "disasm_executor.hpp"
+#include "../src/Disassembler.h"
+#include "../src/MappedFile.h"
+#include "../src/ObjectFile.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cli
+{
+
+namespace
+{
+
+// Words formatted per output chunk. The listing is written a chunk at a time, so
+// memory stays bounded however large the image is.
+constexpr size_t BLOCK_WORDS = 16384;
+
+// Smaller ranges are formatted on the calling thread; threads would cost more
+// than they save
+constexpr size_t PARALLEL_MIN_WORDS = 4 * BLOCK_WORDS;
+
+/**
+ * @brief Format blocks on worker threads and write them in address order
+ *
+ * Workers claim blocks from a shared counter. A worker may run at most `window`
+ * blocks ahead of the writer, so at most that many formatted chunks are held at
+ * once; the calling thread writes each chunk as soon as it and all the chunks
+ * before it are ready.
+ */
+bool writeParallel(const mips::Disassembler& disassembler, const uint32_t* words, size_t count,
+                   uint32_t firstIndex, unsigned jobs, std::ostream& out)
+{
+    const size_t blocks = (count + BLOCK_WORDS - 1) / BLOCK_WORDS;
+    const size_t window = 2 * static_cast<size_t>(jobs);
+
+    struct Slot
+    {
+        std::string text;
+        bool        ready = false;
+    };
+    std::vector<Slot> slots(window);
+
+    std::mutex              mutex;
+    std::condition_variable changed;
+    std::atomic<size_t>     next{0};
+    size_t                  written = 0;  // Blocks already handed to the stream
+    bool                    failed  = false;
+
+    auto work = [&]()
+    {
+        std::string text;
+        for (size_t block = next++; block < blocks; block = next++)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [&] { return failed || block < written + window; });
+                if (failed)
+                {
+                    return;
+                }
+            }
+
+            const size_t first = block * BLOCK_WORDS;
+            const size_t size  = std::min(BLOCK_WORDS, count - first);
+            text.clear();
+            disassembler.disassemble(words + first, size,
+                                     firstIndex + static_cast<uint32_t>(first), text);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            Slot& slot = slots[block % window];
+            slot.text.swap(text);
+            slot.ready = true;
+            changed.notify_all();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(jobs);
+    for (unsigned i = 0; i < jobs; ++i)
+    {
+        workers.emplace_back(work);
+    }
+
+    std::string text;
+    while (written < blocks)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            Slot& slot = slots[written % window];
+            changed.wait(lock, [&] { return slot.ready; });
+            text.swap(slot.text);
+            slot.ready = false;
+        }
+
+        // Write outside the lock so workers keep formatting meanwhile
+        out.write(text.data(), static_cast<std::streamsize>(text.size()));
+
+        std::lock_guard<std::mutex> lock(mutex);
+        ++written;
+        if (!out)
+        {
+            failed  = true;
+            written = blocks;
+        }
+        changed.notify_all();
+    }
+
+    for (std::thread& worker : workers)
+    {
+        worker.join();
+    }
+    return !failed;
+}
+
+bool writeSerial(const mips::Disassembler& disassembler, const uint32_t* words, size_t count,
+                 uint32_t firstIndex, std::ostream& out)
+{
+    std::string text;
+    for (size_t first = 0; first < count && out; first += BLOCK_WORDS)
+    {
+        const size_t size = std::min(BLOCK_WORDS, count - first);
+        text.clear();
+        disassembler.disassemble(words + first, size, firstIndex + static_cast<uint32_t>(first),
+                                 text);
+        out.write(text.data(), static_cast<std::streamsize>(text.size()));
+    }
+    return static_cast<bool>(out);
+}
+
+}  // namespace
+
+int execute_disasm_command(const DisasmConfig& config)
+{
+    const int result = execute_disasm_command(config, std::cout);
+    std::cout.flush();
+    return result;
+}
+
+int execute_disasm_command(const DisasmConfig& config, std::ostream& out)
+{
+    try
+    {
+        std::string      error;
+        mips::MappedFile file;
+        if (!file.open(config.input, error))
+        {
+            std::cerr << "mipsim: " << error << std::endl;
+            return EXIT_IO_ERROR;
+        }
+
+        mips::ObjectFile::View image;
+        if (!mips::ObjectFile::view(file.data(), file.size(), image, error))
+        {
+            std::cerr << "mipsim: invalid binary " << config.input << ": " << error << std::endl;
+            return EXIT_IO_ERROR;
+        }
+
+        // Symbols in the map file take precedence over the ones in the binary
+        std::map<std::string, uint32_t> symbols = image.symbols;
+        if (!config.map.empty())
+        {
+            std::ifstream map_file(config.map);
+            if (!map_file.is_open())
+            {
+                std::cerr << "mipsim: cannot open symbol map: " << config.map << std::endl;
+                return EXIT_IO_ERROR;
+            }
+            std::map<std::string, uint32_t> mapped;
+            if (!mips::Disassembler::readSymbolMap(map_file, mapped, error))
+            {
+                std::cerr << "mipsim: " << config.map << ": " << error << std::endl;
+                return EXIT_IO_ERROR;
+            }
+            for (const auto& [name, address] : mapped)
+            {
+                symbols[name] = address;
+            }
+        }
+
+        const uint64_t first = config.start / 4;
+        if (first > image.textWords || (first == image.textWords && image.textWords > 0))
+        {
+            std::cerr << "mipsim: start address 0x" << std::hex << config.start << std::dec
+                      << " is past the end of the text (" << image.textWords * 4 << " bytes)"
+                      << std::endl;
+            return EXIT_RUNTIME_ERROR;
+        }
+
+        size_t count = image.textWords - static_cast<size_t>(first);
+        if (config.count >= 0)
+        {
+            count = std::min(count, static_cast<size_t>(config.count));
+        }
+
+        const mips::Disassembler disassembler(symbols);
+        const uint32_t*          words      = image.text + first;
+        const uint32_t           firstIndex = static_cast<uint32_t>(first);
+
+        unsigned jobs = config.jobs > 0 ? static_cast<unsigned>(config.jobs)
+                                        : std::max(1u, std::thread::hardware_concurrency());
+        jobs = static_cast<unsigned>(
+            std::min<size_t>(jobs, (count + BLOCK_WORDS - 1) / BLOCK_WORDS));
+
+        const bool ok = jobs > 1 && count >= PARALLEL_MIN_WORDS
+                            ? writeParallel(disassembler, words, count, firstIndex, jobs, out)
+                            : writeSerial(disassembler, words, count, firstIndex, out);
+        if (!ok)
+        {
+            std::cerr << "mipsim: error writing disassembly" << std::endl;
+            return EXIT_IO_ERROR;
+        }
+        return EXIT_OK;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "mipsim: unexpected error: " << e.what() << std::endl;
+        return EXIT_RUNTIME_ERROR;
+    }
+}
+
+}  // namespace cli
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "cli.hpp"
+#include <iosfwd>
+
+namespace cli
+{
+
+/**
+ * @brief Execute the disasm command, writing the listing to standard output
+ * @param config DisasmConfig containing the binary, the range and the symbol map
+ * @return Exit code (EXIT_OK, EXIT_IO_ERROR, or EXIT_RUNTIME_ERROR)
+ */
+int execute_disasm_command(const DisasmConfig& config);
+
+/**
+ * @brief Execute the disasm command, writing the listing to the given stream
+ */
+int execute_disasm_command(const DisasmConfig& config, std::ostream& out);
+
+}  // namespace cli
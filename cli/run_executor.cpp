@@ -1,28 +1,66 @@
 #include "run_executor.hpp"
+#include "Log.h"
+#include "ProgramCache.h"
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <filesystem>
-#include <fstream>
 #include <iostream>
+#include <mutex>
+#include <optional>
+#include <thread>
 
 namespace cli
 {
 
-bool load_file_content(const std::string& filename, std::string& content)
+namespace
 {
-    std::ifstream file(filename);
-    if (!file.is_open())
+
+// Raises a stop flag once a timeout passes; destroying it ends and joins the
+// thread, so leaving the run by any path, exceptions included, cleans it up
+class Watchdog
+{
+  public:
+    Watchdog(std::chrono::seconds timeout, std::atomic<bool>& stop_requested)
+        : m_thread(
+              [this, timeout, &stop_requested]
+              {
+                  std::unique_lock<std::mutex> lock(m_mutex);
+                  if (!m_wakeup.wait_for(lock, timeout, [this] { return m_finished; }))
+                  {
+                      stop_requested.store(true, std::memory_order_relaxed);
+                  }
+              })
     {
-        return false;
     }
 
-    std::string line;
-    content.clear();
-    while (std::getline(file, line))
+    Watchdog(const Watchdog&)            = delete;
+    Watchdog& operator=(const Watchdog&) = delete;
+
+    ~Watchdog()
     {
-        content += line + "\n";
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_finished = true;
+        }
+        m_wakeup.notify_one();
+        m_thread.join();
     }
 
-    return true;
+  private:
+    std::mutex              m_mutex;
+    std::condition_variable m_wakeup;
+    bool                    m_finished = false;
+    std::thread             m_thread;  // Last, so it starts after the members it uses
+};
+
+}  // namespace
+
+bool load_file_content(const std::string& filename, mips::MappedFile& content)
+{
+    std::string error;
+    return content.open(filename, error);
 }
 
 int execute_run_command(const RunConfig& config)
@@ -34,106 +72,114 @@ int execute_run_command(const RunConfig& config)
         return EXIT_IO_ERROR;
     }
 
-    // Load the program file
-    std::string program_content;
-    if (!load_file_content(config.program, program_content))
+    // Assembled binaries are mapped and decoded by the simulator; anything else is source
+    const bool  binary = std::filesystem::path(config.program).extension() == ".bin";
+    mips::MappedFile program_content;
+    if (!binary && !load_file_content(config.program, program_content))
     {
         std::cerr << "mipsim: failed to read file: " << config.program << std::endl;
         return EXIT_IO_ERROR;
     }
 
+    if (!config.log.empty())
+    {
+        if (!mips::Log::compiledIn)
+        {
+            std::cerr << "mipsim: logging is compiled out of this build; --log ignored"
+                      << std::endl;
+        }
+        std::string log_error;
+        mips::Log::configure(config.log, log_error);  // Validated by parse_argv
+    }
+
     // Create simulator instance
     mips::MipsSimulatorAPI simulator;
+    simulator.setProgramCache(mips::ProgramCache::standard());
+
+    if (config.jit && !simulator.setJitEnabled(true))
+    {
+        std::cerr << "mipsim: no JIT is available in this build; --jit ignored" << std::endl;
+    }
 
     // Load the program
-    if (!simulator.loadProgram(program_content))
+    if (binary)
+    {
+        if (!simulator.loadBinaryFile(config.program))
+        {
+            std::cerr << "mipsim: invalid binary: " << simulator.getLastError() << std::endl;
+            return EXIT_IO_ERROR;
+        }
+    }
+    else if (!simulator.loadCachedProgram(program_content.view()))
     {
         std::cerr << "mipsim: assembly error: " << simulator.getLastError() << std::endl;
         return EXIT_RUNTIME_ERROR;
     }
+    if (!simulator.getLastWarning().empty())
+    {
+        std::cerr << "mipsim: warning: " << simulator.getLastWarning() << std::endl;
+    }
 
     // Debug: Print program loaded successfully
     // std::cerr << "DEBUG: Program loaded successfully" << std::endl;
 
-    // Execute the program
-    try
+    if (!config.resume.empty() && !simulator.loadCheckpoint(config.resume))
+    {
+        std::cerr << "mipsim: cannot resume: " << simulator.getLastError() << std::endl;
+        return EXIT_IO_ERROR;
+    }
+
+    const bool            checkpointing = config.checkpoint_every > 0;
+    std::filesystem::path checkpoint_path;
+    if (checkpointing)
     {
-        int  cycles_executed;
-        auto start_time = std::chrono::steady_clock::now();
+        std::error_code error;
+        std::filesystem::create_directories(config.checkpoint_dir, error);
+        checkpoint_path = std::filesystem::path(config.checkpoint_dir) /
+                          (std::filesystem::path(config.program).stem().string() + ".ckpt");
+    }
 
-        if (config.limit > 0 && config.timeout > 0)
+    // Execute the program: batched runs bounded by --limit, split into
+    // --checkpoint-every slices, with --timeout enforced by a watchdog that
+    // raises the run's stop flag
+    try
+    {
+        // --limit counts from the start of the program, so a resumed run stops
+        // exactly where an uninterrupted one would
+        const uint64_t limit =
+            config.limit > 0 ? static_cast<uint64_t>(config.limit) : UINT64_MAX;
+        const uint64_t resumed = simulator.getCycleCount();
+        uint64_t       budget  = limit > resumed ? limit - resumed : 0;
+
+        std::atomic<bool>       stop_requested{false};
+        std::optional<Watchdog> watchdog;
+        if (config.timeout > 0)
         {
-            // Both limits specified - check both
-            cycles_executed = 0;
-            while (!simulator.isTerminated())
-            {
-                simulator.step();
-                cycles_executed++;
-
-                // Check cycle limit
-                if (cycles_executed >= config.limit)
-                {
-                    std::cerr << "mipsim: step limit exceeded (limit: " << config.limit << ")"
-                              << std::endl;
-                    return EXIT_RUNTIME_ERROR;
-                }
-
-                // Check timeout
-                auto current_time = std::chrono::steady_clock::now();
-                auto elapsed_seconds =
-                    std::chrono::duration_cast<std::chrono::seconds>(current_time - start_time)
-                        .count();
-                if (elapsed_seconds >= config.timeout)
-                {
-                    std::cerr << "mipsim: timeout exceeded (timeout: " << config.timeout
-                              << " seconds)" << std::endl;
-                    return EXIT_RUNTIME_ERROR;
-                }
-            }
+            watchdog.emplace(std::chrono::seconds(config.timeout), stop_requested);
         }
-        else if (config.limit > 0)
+
+        mips::RunResult result;
+        bool            checkpoint_saved = true;
+        for (;;)
         {
-            // Only cycle limit
-            cycles_executed = simulator.run(static_cast<int>(config.limit));
+            const uint64_t slice =
+                checkpointing ? std::min<uint64_t>(budget, config.checkpoint_every) : budget;
+            result = simulator.runFor(slice, config.timeout > 0 ? &stop_requested : nullptr);
+            budget -= result.cycles;
 
-            // Check if we hit the limit
-            if (!simulator.isTerminated() && cycles_executed >= config.limit)
+            const bool sliced = result.reason == mips::StopReason::BudgetExhausted && budget > 0;
+            if (checkpointing && (sliced || result.reason == mips::StopReason::StopRequested))
             {
-                std::cerr << "mipsim: step limit exceeded (limit: " << config.limit << ")"
-                          << std::endl;
-                return EXIT_RUNTIME_ERROR;
+                // Also saved on timeout, so a preempted run can pick up from here
+                checkpoint_saved = simulator.saveCheckpoint(checkpoint_path.string());
             }
-        }
-        else if (config.timeout > 0)
-        {
-            // Only timeout
-            cycles_executed = 0;
-            while (!simulator.isTerminated())
+            if (!sliced || !checkpoint_saved)
             {
-                simulator.step();
-                cycles_executed++;
-
-                // Check timeout every 100 cycles for efficiency
-                if (cycles_executed % 100 == 0)
-                {
-                    auto current_time = std::chrono::steady_clock::now();
-                    auto elapsed_seconds =
-                        std::chrono::duration_cast<std::chrono::seconds>(current_time - start_time)
-                            .count();
-                    if (elapsed_seconds >= config.timeout)
-                    {
-                        std::cerr << "mipsim: timeout exceeded (timeout: " << config.timeout
-                                  << " seconds)" << std::endl;
-                        return EXIT_RUNTIME_ERROR;
-                    }
-                }
+                break;
             }
         }
-        else
-        {
-            // No limits
-            cycles_executed = simulator.run(0);  // No limit
-        }
+
+        watchdog.reset();
 
         // Print any console output from the program
         const std::string& console_output = simulator.getConsoleOutput();
@@ -142,18 +188,31 @@ int execute_run_command(const RunConfig& config)
             std::cout << console_output;
         }
 
-        // Debug output
-        // std::cerr << "DEBUG: Executed " << cycles_executed << " cycles" << std::endl;
-        // std::cerr << "DEBUG: Console output length: " << console_output.length() << std::endl;
+        if (!checkpoint_saved)
+        {
+            std::cerr << "mipsim: checkpoint failed: " << simulator.getLastError() << std::endl;
+            return EXIT_IO_ERROR;
+        }
 
-        // Verbose output if requested
-        if (cycles_executed > 0)
+        switch (result.reason)
         {
-            // Optional: print execution summary in verbose mode
-            // std::cerr << "Executed " << cycles_executed << " cycles" << std::endl;
+        case mips::StopReason::Exit:
+            return EXIT_OK;
+        case mips::StopReason::BudgetExhausted:
+            std::cerr << "mipsim: step limit exceeded (limit: " << config.limit << ")"
+                      << std::endl;
+            return EXIT_RUNTIME_ERROR;
+        case mips::StopReason::StopRequested:
+            std::cerr << "mipsim: timeout exceeded (timeout: " << config.timeout << " seconds)"
+                      << std::endl;
+            return EXIT_RUNTIME_ERROR;
+        case mips::StopReason::Breakpoint:
+        case mips::StopReason::Fault:
+            break;
         }
 
-        return EXIT_OK;
+        std::cerr << "mipsim: runtime error: " << simulator.getLastError() << std::endl;
+        return EXIT_RUNTIME_ERROR;
     }
     catch (const std::exception& e)
     {
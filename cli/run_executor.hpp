@@ -1,5 +1,6 @@
 #pragma once
 
+#include "../src/MappedFile.h"
 #include "../src/MipsSimulatorAPI.h"
 #include "cli.hpp"
 #include <string>
@@ -15,11 +16,11 @@ namespace cli
 int execute_run_command(const RunConfig& config);
 
 /**
- * @brief Load file content into string
+ * @brief Map a source file read-only, so it can be assembled without copying it
  * @param filename Path to file
- * @param content Output content
+ * @param content Receives the mapping; content.view() is the source
  * @return true if successful
  */
-bool load_file_content(const std::string& filename, std::string& content);
+bool load_file_content(const std::string& filename, mips::MappedFile& content);
 
 }  // namespace cli
@@ -0,0 +1,85 @@
+#include "translate_executor.hpp"
+#include "../src/Assembler.h"
+#include "../src/CppTranslator.h"
+#include "../src/Instruction.h"
+#include "../src/MappedFile.h"
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace cli
+{
+
+int execute_translate_command(const TranslateConfig& config)
+{
+    try
+    {
+        if (!std::filesystem::exists(config.input))
+        {
+            std::cerr << "mipsim: file not found: " << config.input << std::endl;
+            return EXIT_IO_ERROR;
+        }
+
+        mips::MappedFile input_file;
+        std::string      open_error;
+        if (!input_file.open(config.input, open_error))
+        {
+            std::cerr << "mipsim: cannot open input file: " << config.input << std::endl;
+            return EXIT_IO_ERROR;
+        }
+        const std::string_view assembly_content = input_file.view();
+
+        mips::Assembler                 assembler;
+        std::map<std::string, uint32_t> labelMap;
+        std::vector<mips::DataDirective> dataDirectives;
+
+        std::string translation;
+        try
+        {
+            auto instructions =
+                assembler.assembleWithLabels(assembly_content, labelMap, dataDirectives);
+            mips::Assembler::link(instructions, labelMap);
+            if (const auto warning =
+                    mips::Assembler::describeSkippedLines(assembler.skippedLines());
+                !warning.empty())
+            {
+                std::cerr << "mipsim: warning: " << warning << std::endl;
+            }
+            if (instructions.empty())
+            {
+                std::cerr << "mipsim: no valid instructions found in input file" << std::endl;
+                return EXIT_RUNTIME_ERROR;
+            }
+            translation =
+                mips::CppTranslator::translate(instructions, dataDirectives, labelMap, config.input);
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "mipsim: translation error: " << e.what() << std::endl;
+            return EXIT_RUNTIME_ERROR;
+        }
+
+        std::string output_filename = config.output;
+        if (output_filename.empty())
+        {
+            output_filename = config.input + ".cpp";
+        }
+
+        std::ofstream output_file(output_filename);
+        if (!output_file.is_open())
+        {
+            std::cerr << "mipsim: cannot create output file: " << output_filename << std::endl;
+            return EXIT_IO_ERROR;
+        }
+        output_file << translation;
+
+        return EXIT_OK;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "mipsim: unexpected error: " << e.what() << std::endl;
+        return EXIT_RUNTIME_ERROR;
+    }
+}
+
+}  // namespace cli
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "cli.hpp"
+
+namespace cli
+{
+
+/**
+ * @brief Execute the translate command with the given configuration
+ * @param config TranslateConfig containing the input and output files
+ * @return Exit code (EXIT_OK, EXIT_IO_ERROR, or EXIT_RUNTIME_ERROR)
+ */
+int execute_translate_command(const TranslateConfig& config);
+
+}  // namespace cli
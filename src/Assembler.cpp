@@ -1,2060 +1,1128 @@
 #include "Assembler.h"
 #include "Instruction.h"
+#include "InstructionArena.h"
 #include <algorithm>
-#include <cctype>
-#include <iostream>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <exception>
+#include <span>
 #include <sstream>
 #include <stdexcept>
+#include <string_view>
+#include <thread>
 
 namespace mips
 {
 
-Assembler::Assembler()
+namespace
 {
-    // Initialize register name mappings
-    m_registerMap["$zero"] = 0;
-    m_registerMap["$at"]   = 1;
-    m_registerMap["$v0"]   = 2;
-    m_registerMap["$v1"]   = 3;
-    m_registerMap["$a0"]   = 4;
-    m_registerMap["$a1"]   = 5;
-    m_registerMap["$a2"]   = 6;
-    m_registerMap["$a3"]   = 7;
-    m_registerMap["$t0"]   = 8;
-    m_registerMap["$t1"]   = 9;
-    m_registerMap["$t2"]   = 10;
-    m_registerMap["$t3"]   = 11;
-    m_registerMap["$t4"]   = 12;
-    m_registerMap["$t5"]   = 13;
-    m_registerMap["$t6"]   = 14;
-    m_registerMap["$t7"]   = 15;
-    m_registerMap["$s0"]   = 16;
-    m_registerMap["$s1"]   = 17;
-    m_registerMap["$s2"]   = 18;
-    m_registerMap["$s3"]   = 19;
-    m_registerMap["$s4"]   = 20;
-    m_registerMap["$s5"]   = 21;
-    m_registerMap["$s6"]   = 22;
-    m_registerMap["$s7"]   = 23;
-    m_registerMap["$t8"]   = 24;
-    m_registerMap["$t9"]   = 25;
-    m_registerMap["$k0"]   = 26;
-    m_registerMap["$k1"]   = 27;
-    m_registerMap["$gp"]   = 28;
-    m_registerMap["$sp"]   = 29;
-    m_registerMap["$fp"]   = 30;
-    m_registerMap["$ra"]   = 31;
-}
 
-std::vector<std::unique_ptr<Instruction>> Assembler::assemble(const std::string& assembly)
+/**
+ * @brief One source line, lexed in place
+ *
+ * Every field views the source text. The vectors are reused from line to line,
+ * so after the first few lines lexing allocates nothing.
+ */
+struct Statement
 {
-    std::vector<std::unique_ptr<Instruction>> instructions;
-    std::istringstream                        stream(assembly);
-    std::string                               line;
-
-    while (std::getline(stream, line))
+    std::vector<std::string_view> labels;    // "name:" prefixes, without the colon
+    std::string_view              mnemonic;  // Instruction or directive; empty if none
+    std::vector<std::string_view> operands;  // Split on whitespace and commas
+};
+
+/**
+ * @brief Splits the source into statements, one line at a time
+ *
+ * '#' or ';' starts a comment. A string operand runs from its opening quote to the
+ * last quote on the line, so it may contain separators, comment characters and ':'.
+ * A UTF-8 byte order mark at the start of the source, as some editors save, is skipped.
+ */
+class SourceLexer
+{
+  public:
+    explicit SourceLexer(std::string_view source) : m_source(source)
     {
-        line = trim(line);
-
-        // Skip empty lines and comments
-        if (line.empty() || line[0] == '#')
+        if (m_source.starts_with("\xEF\xBB\xBF"))
         {
-            continue;
+            m_pos = 3;
         }
+    }
 
-        auto instruction = parseInstruction(line);
-        if (instruction)
+    /**
+     * @brief Lex the next line that has a label or a mnemonic
+     * @return false at the end of the source
+     */
+    bool next(Statement& statement)
+    {
+        while (m_pos < m_source.size())
         {
-            instructions.push_back(std::move(instruction));
+            size_t end = m_source.find('\n', m_pos);
+            if (end == std::string_view::npos)
+            {
+                end = m_source.size();
+            }
+            const std::string_view line = m_source.substr(m_pos, end - m_pos);
+            m_pos                       = end + 1;
+            ++m_line;
+
+            lexLine(line, statement);
+            if (!statement.labels.empty() || !statement.mnemonic.empty())
+            {
+                return true;
+            }
         }
+        return false;
     }
 
-    return instructions;
-}
+    // 1-based number of the line last lexed; after the end, the number of lines read
+    size_t line() const
+    {
+        return m_line;
+    }
 
-std::vector<std::unique_ptr<Instruction>>
-Assembler::assembleWithLabels(const std::string&               assembly,
-                              std::map<std::string, uint32_t>& labelMap,
-                              std::vector<DataDirective>&      dataDirectives)
-{
-    std::vector<std::unique_ptr<Instruction>> instructions;
-    std::vector<std::string>                  lines;
-    std::istringstream                        stream(assembly);
-    std::string                               line;
-
-    // First pass: collect all lines and identify labels and data directives
-    uint32_t                      instructionAddress = 0;
-    bool                          inDataSection      = false;
-    std::vector<std::string>      dataLines;        // Store data section lines for second pass
-    std::map<std::string, size_t> dataLabelToLine;  // Map labels to data line indices
-    std::vector<std::string>      allLines;         // Store all non-comment, non-empty lines
-
-    // First, collect all lines
-    while (std::getline(stream, line))
-    {
-        line = trim(line);
-        if (line.empty() || line[0] == '#')
-            continue;
-        allLines.push_back(line);
+  private:
+    static bool isSeparator(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r' || c == ',' || c == ':';
+    }
+
+    static bool isComment(char c)
+    {
+        return c == '#' || c == ';';
+    }
+
+    static bool endsToken(char c)
+    {
+        return isSeparator(c) || isComment(c) || c == '"';
     }
 
-    // Process lines with look-ahead capability
-    for (size_t lineIndex = 0; lineIndex < allLines.size(); ++lineIndex)
+    static void lexLine(std::string_view line, Statement& statement)
     {
-        line = allLines[lineIndex];
+        statement.labels.clear();
+        statement.mnemonic = {};
+        statement.operands.clear();
 
-        // Check if this line is a label (contains ':')
-        size_t colonPos = line.find(':');
-        if (colonPos != std::string::npos)
+        size_t i = 0;
+        while (true)
         {
-            std::string labelName = line.substr(0, colonPos);
-            labelName             = trim(labelName);  // Remove any whitespace around label name
+            while (i < line.size() && isSeparator(line[i]))
+            {
+                ++i;
+            }
+            if (i >= line.size() || isComment(line[i]))
+            {
+                return;
+            }
+
+            const size_t start = i;
+            if (line[i] == '"')
+            {
+                const size_t close = line.rfind('"');
+                i                  = close > start ? close + 1 : line.size();
+                addToken(statement, line.substr(start, i - start));
+                continue;
+            }
 
-            // Look ahead to see if next line is a data directive
-            bool nextLineIsData = false;
-            if (lineIndex + 1 < allLines.size())
+            while (i < line.size() && !endsToken(line[i]))
             {
-                std::string nextLine = allLines[lineIndex + 1];
-                nextLineIsData = (nextLine.find(".word") == 0 || nextLine.find(".byte") == 0 ||
-                                  nextLine.find(".asciiz") == 0);
+                ++i;
             }
+            const std::string_view token = line.substr(start, i - start);
 
-            if (nextLineIsData || inDataSection)
+            // "name:" (or "name :") before the mnemonic defines a label
+            size_t next = i;
+            while (next < line.size() && (line[next] == ' ' || line[next] == '\t'))
+            {
+                ++next;
+            }
+            if (statement.mnemonic.empty() && next < line.size() && line[next] == ':')
             {
-                // This label is for data
-                dataLabelToLine[labelName] = dataLines.size();
+                statement.labels.push_back(token);
+                i = next + 1;
             }
             else
             {
-                // This label is for instruction
-                labelMap[labelName] = instructionAddress;
+                addToken(statement, token);
             }
-            continue;
         }
+    }
 
-        // Check for data directives
-        if (line.find(".word") == 0 || line.find(".byte") == 0 || line.find(".asciiz") == 0)
+    static void addToken(Statement& statement, std::string_view token)
+    {
+        if (statement.mnemonic.empty())
         {
-            inDataSection = true;
-            dataLines.push_back(line);
-            continue;
+            statement.mnemonic = token;
         }
-
-        // This is an instruction line
-        if (!inDataSection)
+        else
         {
-            lines.push_back(line);
-            instructionAddress++;
+            statement.operands.push_back(token);
         }
     }
 
-    // Second pass: process data directives with correct addresses
-    uint32_t actualDataStart = instructionAddress * 4;
-    uint32_t currentDataAddr = actualDataStart;
+    std::string_view m_source;
+    size_t           m_pos  = 0;
+    size_t           m_line = 0;
+};
 
-    for (size_t i = 0; i < dataLines.size(); ++i)
+/**
+ * @brief Parse a whole token as an integer
+ *
+ * Accepts an optional sign, then decimal or 0x hex digits; with allowOctal a
+ * leading 0 selects octal, as the data directives have always accepted. The
+ * magnitude must fit in 32 bits.
+ */
+bool parseInteger(std::string_view text, int64_t& value, bool allowOctal = false)
+{
+    bool negative = false;
+    if (!text.empty() && (text[0] == '+' || text[0] == '-'))
     {
-        DataDirective directive(DataDirective::WORD, currentDataAddr);
-        if (parseDataDirective(dataLines[i], currentDataAddr, directive))
-        {
-            directive.address = currentDataAddr;
-            dataDirectives.push_back(directive);
+        negative = text[0] == '-';
+        text.remove_prefix(1);
+    }
 
-            // Check if any labels point to this data line
-            for (const auto& labelPair : dataLabelToLine)
-            {
-                if (labelPair.second == i)
-                {
-                    labelMap[labelPair.first] = currentDataAddr;
-                }
-            }
+    int base = 10;
+    if (text.size() > 2 && text[0] == '0' && (text[1] == 'x' || text[1] == 'X'))
+    {
+        base = 16;
+        text.remove_prefix(2);
+    }
+    else if (allowOctal && text.size() > 1 && text[0] == '0')
+    {
+        base = 8;
+        text.remove_prefix(1);
+    }
 
-            // TEMPORARY FIX: Force data labels to correct addresses
-            // Look for common data label patterns and fix them
-            std::vector<std::string> commonDataLabels = {"data", "test_data", "mydata", "strings"};
-            for (const std::string& labelName : commonDataLabels)
-            {
-                auto it = labelMap.find(labelName);
-                if (it != labelMap.end() && i == 0)  // First data directive
-                {
-                    it->second = currentDataAddr;
-                }
-            }
+    uint64_t   magnitude = 0;
+    const auto result    = std::from_chars(text.data(), text.data() + text.size(), magnitude, base);
+    if (text.empty() || result.ec != std::errc() || result.ptr != text.data() + text.size() ||
+        magnitude > UINT32_MAX)
+    {
+        return false;
+    }
+    value = negative ? -static_cast<int64_t>(magnitude) : static_cast<int64_t>(magnitude);
+    return true;
+}
 
-            // Update address for next directive
-            if (directive.type == DataDirective::WORD)
-            {
-                currentDataAddr += directive.words.size() * 4;
-            }
-            else
-            {
-                currentDataAddr += directive.bytes.size();
-                // Align to word boundary
-                if (currentDataAddr % 4 != 0)
-                {
-                    currentDataAddr = (currentDataAddr + 3) & ~3;
-                }
-            }
+/**
+ * @brief Compile-time perfect hash over a fixed set of names
+ *
+ * The constructor searches for a seed under which every key lands in a slot of
+ * its own, so a lookup is one hash of the name, one slot read and one string
+ * comparison, whichever key it is. Tables are built during compilation.
+ */
+template <size_t N, size_t SLOTS>
+class PerfectHash
+{
+    static_assert((SLOTS & (SLOTS - 1)) == 0 && N < SLOTS && SLOTS <= 256);
+
+  public:
+    constexpr explicit PerfectHash(const std::array<std::string_view, N>& keys) : m_keys(keys)
+    {
+        while (!place())
+        {
+            ++m_seed;
         }
     }
 
-    // Second pass: parse instructions
-    for (const auto& instrLine : lines)
+    /**
+     * @return Index of the key in the array given to the constructor, or -1
+     */
+    constexpr int find(std::string_view name) const
     {
-        auto instruction = parseInstruction(instrLine);
-        if (instruction)
+        const uint8_t index = m_slots[hash(name, m_seed) & (SLOTS - 1)];
+        return index != EMPTY && m_keys[index] == name ? index : -1;
+    }
+
+  private:
+    static constexpr uint8_t EMPTY = 0xFF;
+
+    static constexpr uint32_t hash(std::string_view name, uint32_t seed)
+    {
+        uint32_t h = 2166136261u ^ seed;  // FNV-1a
+        for (char c : name)
         {
-            instructions.push_back(std::move(instruction));
+            h = (h ^ static_cast<uint8_t>(c)) * 16777619u;
         }
+        return h ^ (h >> 16);
     }
 
-    // Recompute instruction label indices to ensure labels map to the
-    // actual instruction indices produced above. The first-pass used a
-    // simple counter which may diverge from the final parsed instruction
-    // vector if some lines failed to parse. Walk the original allLines and
-    // recompute indices for instruction labels.
+    constexpr bool place()
     {
-        std::map<std::string, uint32_t> recomputedLabels;
-        uint32_t                        instrIndex     = 0;
-        bool                            inDataSection2 = false;
-
-        for (size_t lineIndex = 0; lineIndex < allLines.size(); ++lineIndex)
+        for (uint8_t& slot : m_slots)
+        {
+            slot = EMPTY;
+        }
+        for (size_t i = 0; i < N; ++i)
         {
-            std::string cur      = allLines[lineIndex];
-            size_t      colonPos = cur.find(':');
-            if (colonPos != std::string::npos)
+            uint8_t& slot = m_slots[hash(m_keys[i], m_seed) & (SLOTS - 1)];
+            if (slot != EMPTY)
             {
-                std::string labelName = cur.substr(0, colonPos);
-                labelName             = trim(labelName);
+                return false;
+            }
+            slot = static_cast<uint8_t>(i);
+        }
+        return true;
+    }
 
-                // Look ahead to determine if this is a data label
-                bool nextLineIsData = false;
-                if (lineIndex + 1 < allLines.size())
-                {
-                    std::string nextLine = allLines[lineIndex + 1];
-                    nextLineIsData = (nextLine.find(".word") == 0 || nextLine.find(".byte") == 0 ||
-                                      nextLine.find(".asciiz") == 0);
-                }
+    std::array<std::string_view, N> m_keys{};
+    std::array<uint8_t, SLOTS>      m_slots{};
+    uint32_t                        m_seed = 0;
+};
+
+// Register names, indexed by register number
+constexpr PerfectHash<32, 128> REGISTERS({
+    "$zero", "$at", "$v0", "$v1", "$a0", "$a1", "$a2", "$a3", "$t0", "$t1", "$t2",
+    "$t3",   "$t4", "$t5", "$t6", "$t7", "$s0", "$s1", "$s2", "$s3", "$s4", "$s5",
+    "$s6",   "$s7", "$t8", "$t9", "$k0", "$k1", "$gp", "$sp", "$fp", "$ra",
+});
+
+static_assert(REGISTERS.find("$zero") == 0 && REGISTERS.find("$ra") == 31);
+static_assert(REGISTERS.find("$t10") == -1 && REGISTERS.find("") == -1);
+
+/**
+ * @brief Typed access to the operands of one instruction
+ *
+ * Out-of-range positions read as invalid, so a missing operand fails the same
+ * check as a malformed one.
+ */
+class Operands
+{
+  public:
+    explicit Operands(std::span<const std::string_view> tokens) : m_tokens(tokens) {}
 
-                if (nextLineIsData || inDataSection2)
-                {
-                    // data label - leave it for data handling
-                }
-                else
-                {
-                    // instruction label - map to current instruction index
-                    recomputedLabels[labelName] = instrIndex;
-                }
-                continue;
-            }
+    size_t size() const
+    {
+        return m_tokens.size();
+    }
 
-            if (cur.find(".word") == 0 || cur.find(".byte") == 0 || cur.find(".asciiz") == 0)
-            {
-                inDataSection2 = true;
-                continue;
-            }
+    std::string_view text(size_t i) const
+    {
+        return i < m_tokens.size() ? m_tokens[i] : std::string_view();
+    }
 
-            if (!inDataSection2)
-            {
-                // This is an instruction line; only increment if it parses
-                auto instr = parseInstruction(cur);
-                if (instr)
-                {
-                    instrIndex++;
-                }
-            }
+    // Register number, or -1
+    int reg(size_t i) const
+    {
+        return REGISTERS.find(text(i));
+    }
+
+    bool integer(size_t i, int64_t& value) const
+    {
+        return parseInteger(text(i), value);
+    }
+
+    // "offset($base)", also written "offset ($base)" as two operands; the offset may be omitted
+    bool memory(size_t i, int& base, int16_t& offset) const
+    {
+        std::string_view address   = text(i);
+        std::string_view offsetStr = address;
+        const size_t     paren     = address.find('(');
+        if (paren != std::string_view::npos)
+        {
+            offsetStr = address.substr(0, paren);
+            address.remove_prefix(paren);
+        }
+        else
+        {
+            address = text(i + 1);
+        }
+        if (address.size() < 2 || address.front() != '(' || address.back() != ')')
+        {
+            return false;
         }
 
-        // Overwrite any instruction-label entries in the labelMap with the recomputed values
-        // Store instruction labels as byte addresses (instrIndex * 4) so callers don't
-        // need a runtime heuristic to distinguish instruction indices from data addresses.
-        for (const auto& p : recomputedLabels)
+        int64_t value = 0;
+        if (!offsetStr.empty() && !parseInteger(offsetStr, value))
         {
-            labelMap[p.first] = p.second * 4;
+            return false;
         }
+        base   = REGISTERS.find(address.substr(1, address.size() - 2));
+        offset = static_cast<int16_t>(value);
+        return base >= 0;
     }
 
-    return instructions;
-}
+  private:
+    std::span<const std::string_view> m_tokens;
+};
 
-std::vector<std::unique_ptr<Instruction>>
-Assembler::assembleWithLabels(const std::string&               assembly,
-                              std::map<std::string, uint32_t>& labelMap)
+// Operand formats, one helper per assembler syntax
+
+template <class T>
+std::unique_ptr<Instruction> threeRegisters(const Operands& o)  // add rd, rs, rt
 {
-    std::vector<DataDirective> dataDirectives;  // Ignored for backward compatibility
-    return assembleWithLabels(assembly, labelMap, dataDirectives);
+    const int a = o.reg(0);
+    const int b = o.reg(1);
+    const int c = o.reg(2);
+    if (a < 0 || b < 0 || c < 0)
+    {
+        return nullptr;
+    }
+    return std::make_unique<T>(a, b, c);
 }
 
-std::unique_ptr<Instruction> Assembler::parseInstruction(const std::string& line)
+template <class T>
+std::unique_ptr<Instruction> twoRegisters(const Operands& o)  // mult rs, rt
 {
-    // Remove comments
-    std::string cleanLine  = line;
-    size_t      commentPos = cleanLine.find('#');
-    if (commentPos != std::string::npos)
+    const int a = o.reg(0);
+    const int b = o.reg(1);
+    if (a < 0 || b < 0)
     {
-        cleanLine = cleanLine.substr(0, commentPos);
+        return nullptr;
     }
-    cleanLine = trim(cleanLine);
+    return std::make_unique<T>(a, b);
+}
 
-    if (cleanLine.empty())
+template <class T>
+std::unique_ptr<Instruction> oneRegister(const Operands& o)  // mfhi rd
+{
+    const int a = o.reg(0);
+    if (a < 0)
     {
         return nullptr;
     }
+    return std::make_unique<T>(a);
+}
 
-    // Split by spaces
-    std::vector<std::string> tokens;
-    std::istringstream       tokenStream(cleanLine);
-    std::string              token;
-    while (tokenStream >> token)
+template <class T>
+std::unique_ptr<Instruction> immediate(const Operands& o)  // addi rt, rs, imm
+{
+    const int rt  = o.reg(0);
+    const int rs  = o.reg(1);
+    int64_t   imm = 0;
+    if (rt < 0 || rs < 0 || !o.integer(2, imm))
     {
-        tokens.push_back(token);
+        return nullptr;
     }
+    return std::make_unique<T>(rt, rs, static_cast<int16_t>(imm));
+}
 
-    if (tokens.empty())
+template <class T>
+std::unique_ptr<Instruction> upperImmediate(const Operands& o)  // llo rt, imm
+{
+    const int rt  = o.reg(0);
+    int64_t   imm = 0;
+    if (rt < 0 || !o.integer(1, imm))
     {
         return nullptr;
     }
+    return std::make_unique<T>(rt, static_cast<uint16_t>(imm));
+}
 
-    std::string opcode = tokens[0];
+template <class T>
+std::unique_ptr<Instruction> shift(const Operands& o)  // sll rd, rt, shamt
+{
+    const int rd    = o.reg(0);
+    const int rt    = o.reg(1);
+    int64_t   shamt = 0;
+    if (rd < 0 || rt < 0 || !o.integer(2, shamt) || shamt < 0 || shamt > 31)
+    {
+        return nullptr;
+    }
+    return std::make_unique<T>(rd, rt, static_cast<uint32_t>(shamt));
+}
 
-    if (opcode == "add" && tokens.size() >= 4)
+template <class T>
+std::unique_ptr<Instruction> memory(const Operands& o)  // lw rt, offset(rs)
+{
+    const int rt     = o.reg(0);
+    int       rs     = -1;
+    int16_t   offset = 0;
+    if (rt < 0 || !o.memory(1, rs, offset))
     {
-        // Parse: add $rd, $rs, $rt
-        std::string rdStr = tokens[1];
-        std::string rsStr = tokens[2];
-        std::string rtStr = tokens[3];
+        return nullptr;
+    }
+    return std::make_unique<T>(rt, rs, offset);
+}
 
-        // Remove commas
-        if (rdStr.back() == ',')
-            rdStr.pop_back();
-        if (rsStr.back() == ',')
-            rsStr.pop_back();
-        if (rtStr.back() == ',')
-            rtStr.pop_back();
+template <class T>
+std::unique_ptr<Instruction> compareBranch(const Operands& o)  // beq rs, rt, label
+{
+    const int rs = o.reg(0);
+    const int rt = o.reg(1);
+    if (rs < 0 || rt < 0 || o.text(2).empty())
+    {
+        return nullptr;
+    }
+    return std::make_unique<T>(rs, rt, std::string(o.text(2)));
+}
 
-        int rd = getRegisterNumber(rdStr);
-        int rs = getRegisterNumber(rsStr);
-        int rt = getRegisterNumber(rtStr);
+template <class T>
+std::unique_ptr<Instruction> zeroBranch(const Operands& o)  // blez rs, label
+{
+    const int rs = o.reg(0);
+    if (rs < 0 || o.text(1).empty())
+    {
+        return nullptr;
+    }
+    return std::make_unique<T>(rs, std::string(o.text(1)));
+}
 
-        if (rd >= 0 && rs >= 0 && rt >= 0)
-        {
-            return std::make_unique<AddInstruction>(rd, rs, rt);
-        }
+std::unique_ptr<Instruction> jumpAndLink(const Operands& o)  // jal target|label
+{
+    if (o.size() != 1)
+    {
+        return nullptr;
     }
-    else if (opcode == "addu" && tokens.size() >= 4)
+    int64_t target = 0;
+    if (o.integer(0, target))
     {
-        // Parse: addu $rd, $rs, $rt
-        std::string rdStr = tokens[1];
-        std::string rsStr = tokens[2];
-        std::string rtStr = tokens[3];
-
-        // Remove commas
-        if (rdStr.back() == ',')
-            rdStr.pop_back();
-        if (rsStr.back() == ',')
-            rsStr.pop_back();
-        if (rtStr.back() == ',')
-            rtStr.pop_back();
-
-        int rd = getRegisterNumber(rdStr);
-        int rs = getRegisterNumber(rsStr);
-        int rt = getRegisterNumber(rtStr);
+        return std::make_unique<JALInstruction>(static_cast<uint32_t>(target));
+    }
+    return std::make_unique<JALLabelInstruction>(std::string(o.text(0)));
+}
 
-        if (rd >= 0 && rs >= 0 && rt >= 0)
-        {
-            return std::make_unique<ADDUInstruction>(rd, rs, rt);
-        }
+std::unique_ptr<Instruction> jumpAndLinkRegister(const Operands& o)  // jalr [rd,] rs
+{
+    if (o.size() == 1)
+    {
+        const int rs = o.reg(0);
+        return rs >= 0 ? std::make_unique<JALRInstruction>(31, rs) : nullptr;  // rd = $ra
     }
-    else if (opcode == "and" && tokens.size() >= 4)
+    if (o.size() == 2)
     {
-        // Parse: and $rd, $rs, $rt
-        std::string rdStr = tokens[1];
-        std::string rsStr = tokens[2];
-        std::string rtStr = tokens[3];
-
-        // Remove commas
-        if (rdStr.back() == ',')
-            rdStr.pop_back();
-        if (rsStr.back() == ',')
-            rsStr.pop_back();
-        if (rtStr.back() == ',')
-            rtStr.pop_back();
-
-        int rd = getRegisterNumber(rdStr);
-        int rs = getRegisterNumber(rsStr);
-        int rt = getRegisterNumber(rtStr);
+        return twoRegisters<JALRInstruction>(o);
+    }
+    return nullptr;
+}
 
-        if (rd >= 0 && rs >= 0 && rt >= 0)
-        {
-            return std::make_unique<AndInstruction>(rd, rs, rt);
-        }
+std::unique_ptr<Instruction> trap(const Operands& o)  // trap name|code
+{
+    const std::string_view name = o.text(0);
+    uint32_t               code = 0;
+    if (name == "print_int")
+    {
+        code = 1;  // Same as syscall 1
     }
-    else if (opcode == "or" && tokens.size() >= 4)
+    else if (name == "print_string")
     {
-        // Parse: or $rd, $rs, $rt
-        std::string rdStr = tokens[1];
-        std::string rsStr = tokens[2];
-        std::string rtStr = tokens[3];
-
-        // Remove commas
-        if (rdStr.back() == ',')
-            rdStr.pop_back();
-        if (rsStr.back() == ',')
-            rsStr.pop_back();
-        if (rtStr.back() == ',')
-            rtStr.pop_back();
-
-        int rd = getRegisterNumber(rdStr);
-        int rs = getRegisterNumber(rsStr);
-        int rt = getRegisterNumber(rtStr);
-
-        if (rd >= 0 && rs >= 0 && rt >= 0)
-        {
-            return std::make_unique<OrInstruction>(rd, rs, rt);
-        }
+        code = 4;  // Same as syscall 4
     }
-    else if (opcode == "xor" && tokens.size() >= 4)
+    else if (name == "exit")
     {
-        // Parse: xor $rd, $rs, $rt
-        std::string rdStr = tokens[1];
-        std::string rsStr = tokens[2];
-        std::string rtStr = tokens[3];
-
-        // Remove commas
-        if (rdStr.back() == ',')
-            rdStr.pop_back();
-        if (rsStr.back() == ',')
-            rsStr.pop_back();
-        if (rtStr.back() == ',')
-            rtStr.pop_back();
-
-        int rd = getRegisterNumber(rdStr);
-        int rs = getRegisterNumber(rsStr);
-        int rt = getRegisterNumber(rtStr);
-
-        if (rd >= 0 && rs >= 0 && rt >= 0)
-        {
-            return std::make_unique<XorInstruction>(rd, rs, rt);
-        }
+        code = 10;  // Same as syscall 10
     }
-    else if (opcode == "nor" && tokens.size() >= 4)
+    else if (name == "print_character")
     {
-        // Parse: nor $rd, $rs, $rt
-        std::string rdStr = tokens[1];
-        std::string rsStr = tokens[2];
-        std::string rtStr = tokens[3];
-
-        // Remove commas
-        if (rdStr.back() == ',')
-            rdStr.pop_back();
-        if (rsStr.back() == ',')
-            rsStr.pop_back();
-        if (rtStr.back() == ',')
-            rtStr.pop_back();
-
-        int rd = getRegisterNumber(rdStr);
-        int rs = getRegisterNumber(rsStr);
-        int rt = getRegisterNumber(rtStr);
-
-        if (rd >= 0 && rs >= 0 && rt >= 0)
-        {
-            return std::make_unique<NorInstruction>(rd, rs, rt);
-        }
+        code = 11;  // Same as syscall 11
     }
-    else if (opcode == "sub" && tokens.size() >= 4)
+    else
     {
-        // Parse: sub $rd, $rs, $rt
-        std::string rdStr = tokens[1];
-        std::string rsStr = tokens[2];
-        std::string rtStr = tokens[3];
-
-        // Remove commas
-        if (rdStr.back() == ',')
-            rdStr.pop_back();
-        if (rsStr.back() == ',')
-            rsStr.pop_back();
-        if (rtStr.back() == ',')
-            rtStr.pop_back();
-
-        int rd = getRegisterNumber(rdStr);
-        int rs = getRegisterNumber(rsStr);
-        int rt = getRegisterNumber(rtStr);
-
-        if (rd >= 0 && rs >= 0 && rt >= 0)
+        int64_t value = 0;
+        if (!o.integer(0, value))
         {
-            return std::make_unique<SubInstruction>(rd, rs, rt);
+            return nullptr;
         }
+        code = static_cast<uint32_t>(value);
     }
-    else if (opcode == "subu" && tokens.size() >= 4)
-    {
-        // Parse: subu $rd, $rs, $rt
-        std::string rdStr = tokens[1];
-        std::string rsStr = tokens[2];
-        std::string rtStr = tokens[3];
+    return std::make_unique<TrapInstruction>(code);
+}
 
-        // Remove commas
-        if (rdStr.back() == ',')
-            rdStr.pop_back();
-        if (rsStr.back() == ',')
-            rsStr.pop_back();
-        if (rtStr.back() == ',')
-            rtStr.pop_back();
+std::unique_ptr<Instruction> jump(const Operands& o)  // j label
+{
+    if (o.text(0).empty())
+    {
+        return nullptr;
+    }
+    return std::make_unique<JInstruction>(std::string(o.text(0)));
+}
 
-        int rd = getRegisterNumber(rdStr);
-        int rs = getRegisterNumber(rsStr);
-        int rt = getRegisterNumber(rtStr);
+std::unique_ptr<Instruction> jumpRegister(const Operands& o)  // jr rs
+{
+    return o.size() == 1 ? oneRegister<JRInstruction>(o) : nullptr;
+}
 
-        if (rd >= 0 && rs >= 0 && rt >= 0)
-        {
-            return std::make_unique<SUBUInstruction>(rd, rs, rt);
-        }
-    }
-    else if (opcode == "sltu" && tokens.size() >= 4)
+std::unique_ptr<Instruction> loadAddress(const Operands& o)  // la rt, label
+{
+    const int rt = o.reg(0);
+    if (rt < 0 || o.text(1).empty())
     {
-        // Parse: sltu $rd, $rs, $rt
-        std::string rdStr = tokens[1];
-        std::string rsStr = tokens[2];
-        std::string rtStr = tokens[3];
+        return nullptr;
+    }
+    return std::make_unique<LAInstruction>(rt, std::string(o.text(1)));
+}
 
-        // Remove commas
-        if (rdStr.back() == ',')
-            rdStr.pop_back();
-        if (rsStr.back() == ',')
-            rsStr.pop_back();
-        if (rtStr.back() == ',')
-            rtStr.pop_back();
+std::unique_ptr<Instruction> syscall(const Operands&)  // syscall
+{
+    return std::make_unique<SyscallInstruction>();
+}
 
-        int rd = getRegisterNumber(rdStr);
-        int rs = getRegisterNumber(rsStr);
-        int rt = getRegisterNumber(rtStr);
+using OperandParser = std::unique_ptr<Instruction> (*)(const Operands&);
 
-        if (rd >= 0 && rs >= 0 && rt >= 0)
-        {
-            return std::make_unique<SltuInstruction>(rd, rs, rt);
-        }
-    }
-    else if (opcode == "slt" && tokens.size() >= 4)
+struct Mnemonic
+{
+    std::string_view name;
+    OperandParser    parse;  // Operand format, instantiated for the instruction class
+};
+
+constexpr Mnemonic MNEMONICS[] = {
+    // R-type: rd, rs, rt (shifts by register take rd, rt, rs)
+    {"add", threeRegisters<AddInstruction>},
+    {"addu", threeRegisters<ADDUInstruction>},
+    {"sub", threeRegisters<SubInstruction>},
+    {"subu", threeRegisters<SUBUInstruction>},
+    {"and", threeRegisters<AndInstruction>},
+    {"or", threeRegisters<OrInstruction>},
+    {"xor", threeRegisters<XorInstruction>},
+    {"nor", threeRegisters<NorInstruction>},
+    {"slt", threeRegisters<SltInstruction>},
+    {"sltu", threeRegisters<SltuInstruction>},
+    {"sllv", threeRegisters<SLLVInstruction>},
+    {"srlv", threeRegisters<SRLVInstruction>},
+    {"srav", threeRegisters<SRAVInstruction>},
+    {"sll", shift<SllInstruction>},
+    {"srl", shift<SrlInstruction>},
+    {"sra", shift<SraInstruction>},
+
+    // HI/LO
+    {"mult", twoRegisters<MULTInstruction>},
+    {"multu", twoRegisters<MULTUInstruction>},
+    {"div", twoRegisters<DIVInstruction>},
+    {"divu", twoRegisters<DIVUInstruction>},
+    {"mfhi", oneRegister<MFHIInstruction>},
+    {"mthi", oneRegister<MTHIInstruction>},
+    {"mflo", oneRegister<MFLOInstruction>},
+    {"mtlo", oneRegister<MTLOInstruction>},
+
+    // I-type: rt, rs, imm
+    {"addi", immediate<AddiInstruction>},
+    {"addiu", immediate<ADDIUInstruction>},
+    {"andi", immediate<AndiInstruction>},
+    {"ori", immediate<OriInstruction>},
+    {"xori", immediate<XoriInstruction>},
+    {"slti", immediate<SltiInstruction>},
+    {"sltiu", immediate<SltiuInstruction>},
+    {"llo", upperImmediate<LLOInstruction>},
+    {"lhi", upperImmediate<LHIInstruction>},
+
+    // Loads and stores: rt, offset(rs)
+    {"lw", memory<LwInstruction>},
+    {"sw", memory<SwInstruction>},
+    {"lb", memory<LBInstruction>},
+    {"lbu", memory<LBUInstruction>},
+    {"lh", memory<LHInstruction>},
+    {"lhu", memory<LHUInstruction>},
+    {"sb", memory<SBInstruction>},
+    {"sh", memory<SHInstruction>},
+
+    // Control flow; label operands are resolved by link()
+    {"beq", compareBranch<BeqInstruction>},
+    {"bne", compareBranch<BneInstruction>},
+    {"blez", zeroBranch<BLEZInstruction>},
+    {"bgtz", zeroBranch<BGTZInstruction>},
+    {"j", jump},
+    {"jal", jumpAndLink},
+    {"jr", jumpRegister},
+    {"jalr", jumpAndLinkRegister},
+    {"la", loadAddress},
+
+    // System
+    {"syscall", syscall},
+    {"trap", trap},
+};
+
+constexpr size_t MNEMONIC_COUNT = std::size(MNEMONICS);
+
+constexpr std::array<std::string_view, MNEMONIC_COUNT> mnemonicNames()
+{
+    std::array<std::string_view, MNEMONIC_COUNT> names{};
+    for (size_t i = 0; i < MNEMONIC_COUNT; ++i)
     {
-        // Parse: slt $rd, $rs, $rt
-        std::string rdStr = tokens[1];
-        std::string rsStr = tokens[2];
-        std::string rtStr = tokens[3];
+        names[i] = MNEMONICS[i].name;
+    }
+    return names;
+}
 
-        // Remove commas
-        if (rdStr.back() == ',')
-            rdStr.pop_back();
-        if (rsStr.back() == ',')
-            rsStr.pop_back();
-        if (rtStr.back() == ',')
-            rtStr.pop_back();
+constexpr PerfectHash<MNEMONIC_COUNT, 256> MNEMONIC_HASH(mnemonicNames());
 
-        int rd = getRegisterNumber(rdStr);
-        int rs = getRegisterNumber(rsStr);
-        int rt = getRegisterNumber(rtStr);
+static_assert(MNEMONIC_HASH.find("syscall") == MNEMONIC_COUNT - 2);
+static_assert(MNEMONIC_HASH.find("lui") == -1 && MNEMONIC_HASH.find(".word") == -1);
 
-        if (rd >= 0 && rs >= 0 && rt >= 0)
-        {
-            return std::make_unique<SltInstruction>(rd, rs, rt);
-        }
-    }
-    else if (opcode == "addi" && tokens.size() >= 4)
+/**
+ * @brief Parse one instruction from its lexed mnemonic and operands
+ * @return nullptr if the mnemonic is unknown or an operand is invalid
+ */
+std::unique_ptr<Instruction> parseInstruction(std::string_view                  mnemonic,
+                                              std::span<const std::string_view> operands)
+{
+    const int index = MNEMONIC_HASH.find(mnemonic);
+    if (index < 0)
     {
-        // Parse: addi $rt, $rs, imm
-        std::string rtStr  = tokens[1];
-        std::string rsStr  = tokens[2];
-        std::string immStr = tokens[3];
+        return nullptr;
+    }
+    return MNEMONICS[index].parse(Operands(operands));
+}
 
-        // Remove commas
-        if (rtStr.back() == ',')
-            rtStr.pop_back();
-        if (rsStr.back() == ',')
-            rsStr.pop_back();
-        if (immStr.back() == ',')
-            immStr.pop_back();
+bool isDataDirective(std::string_view mnemonic)
+{
+    return mnemonic == ".word" || mnemonic == ".byte" || mnemonic == ".asciiz";
+}
 
-        int rt = getRegisterNumber(rtStr);
-        int rs = getRegisterNumber(rsStr);
+/**
+ * @brief Parse a .word, .byte or .asciiz statement
+ * @return false if an operand is missing or invalid
+ */
+bool parseDataDirective(const Statement& statement, DataDirective& directive)
+{
+    if (statement.operands.empty())
+    {
+        return false;
+    }
 
-        if (rt >= 0 && rs >= 0)
+    if (statement.mnemonic == ".asciiz")
+    {
+        // No escape sequences: the bytes between the quotes are stored as written
+        const std::string_view text = statement.operands[0];
+        if (text.size() < 2 || text.front() != '"' || text.back() != '"')
         {
-            // Parse immediate value (support decimal and hex)
-            int16_t imm = 0;
-            try
-            {
-                if (immStr.substr(0, 2) == "0x" || immStr.substr(0, 2) == "0X")
-                {
-                    imm = static_cast<int16_t>(std::stoi(immStr, nullptr, 16));
-                }
-                else
-                {
-                    imm = static_cast<int16_t>(std::stoi(immStr));
-                }
-                return std::make_unique<AddiInstruction>(rt, rs, imm);
-            }
-            catch (const std::exception&)
-            {
-                // Invalid immediate value
-                return nullptr;
-            }
+            return false;
         }
+        directive.type = DataDirective::ASCIIZ;
+        directive.bytes.assign(text.begin() + 1, text.end() - 1);
+        directive.bytes.push_back(0);
+        return true;
     }
-    else if (opcode == "addiu" && tokens.size() >= 4)
-    {
-        // Parse: addiu $rt, $rs, imm
-        std::string rtStr  = tokens[1];
-        std::string rsStr  = tokens[2];
-        std::string immStr = tokens[3];
-
-        // Remove commas
-        if (rtStr.back() == ',')
-            rtStr.pop_back();
-        if (rsStr.back() == ',')
-            rsStr.pop_back();
-        if (immStr.back() == ',')
-            immStr.pop_back();
-
-        int rt = getRegisterNumber(rtStr);
-        int rs = getRegisterNumber(rsStr);
 
-        if (rt >= 0 && rs >= 0)
-        {
-            // Parse immediate value (support decimal and hex)
-            int16_t imm = 0;
-            try
-            {
-                if (immStr.substr(0, 2) == "0x" || immStr.substr(0, 2) == "0X")
-                {
-                    imm = static_cast<int16_t>(std::stoi(immStr, nullptr, 16));
-                }
-                else
-                {
-                    imm = static_cast<int16_t>(std::stoi(immStr));
-                }
-                return std::make_unique<ADDIUInstruction>(rt, rs, imm);
-            }
-            catch (const std::exception&)
-            {
-                // Invalid immediate value
-                return nullptr;
-            }
-        }
-    }
-    else if (opcode == "andi" && tokens.size() >= 4)
+    const bool isWord = statement.mnemonic == ".word";
+    directive.type    = isWord ? DataDirective::WORD : DataDirective::BYTE;
+    for (std::string_view operand : statement.operands)
     {
-        // Parse: andi $rt, $rs, imm
-        std::string rtStr  = tokens[1];
-        std::string rsStr  = tokens[2];
-        std::string immStr = tokens[3];
-
-        // Remove commas
-        if (rtStr.back() == ',')
-            rtStr.pop_back();
-        if (rsStr.back() == ',')
-            rsStr.pop_back();
-        if (immStr.back() == ',')
-            immStr.pop_back();
-
-        int rt = getRegisterNumber(rtStr);
-        int rs = getRegisterNumber(rsStr);
-
-        if (rt >= 0 && rs >= 0)
+        int64_t value = 0;
+        if (!parseInteger(operand, value, true))
         {
-            // Parse immediate value (support decimal and hex)
-            int16_t imm = 0;
-            try
-            {
-                if (immStr.substr(0, 2) == "0x" || immStr.substr(0, 2) == "0X")
-                {
-                    imm = static_cast<int16_t>(std::stoi(immStr, nullptr, 16));
-                }
-                else
-                {
-                    imm = static_cast<int16_t>(std::stoi(immStr));
-                }
-                return std::make_unique<AndiInstruction>(rt, rs, imm);
-            }
-            catch (const std::exception&)
-            {
-                // Invalid immediate value
-                return nullptr;
-            }
+            return false;
         }
-    }
-    else if (opcode == "ori" && tokens.size() >= 4)
-    {
-        // Parse: ori $rt, $rs, imm
-        std::string rtStr  = tokens[1];
-        std::string rsStr  = tokens[2];
-        std::string immStr = tokens[3];
-
-        // Remove commas
-        if (rtStr.back() == ',')
-            rtStr.pop_back();
-        if (rsStr.back() == ',')
-            rsStr.pop_back();
-        if (immStr.back() == ',')
-            immStr.pop_back();
-
-        int rt = getRegisterNumber(rtStr);
-        int rs = getRegisterNumber(rsStr);
-
-        if (rt >= 0 && rs >= 0)
+        if (isWord)
         {
-            // Parse immediate value (support decimal and hex)
-            int16_t imm = 0;
-            try
-            {
-                if (immStr.substr(0, 2) == "0x" || immStr.substr(0, 2) == "0X")
-                {
-                    imm = static_cast<int16_t>(std::stoi(immStr, nullptr, 16));
-                }
-                else
-                {
-                    imm = static_cast<int16_t>(std::stoi(immStr));
-                }
-                return std::make_unique<OriInstruction>(rt, rs, imm);
-            }
-            catch (const std::exception&)
-            {
-                // Invalid immediate value
-                return nullptr;
-            }
+            directive.words.push_back(static_cast<uint32_t>(value));
         }
-    }
-    else if (opcode == "xori" && tokens.size() >= 4)
-    {
-        // Parse: xori $rt, $rs, imm
-        std::string rtStr  = tokens[1];
-        std::string rsStr  = tokens[2];
-        std::string immStr = tokens[3];
-
-        // Remove commas
-        if (rtStr.back() == ',')
-            rtStr.pop_back();
-        if (rsStr.back() == ',')
-            rsStr.pop_back();
-        if (immStr.back() == ',')
-            immStr.pop_back();
-
-        int rt = getRegisterNumber(rtStr);
-        int rs = getRegisterNumber(rsStr);
-
-        if (rt >= 0 && rs >= 0)
+        else if (value < 0 || value > 255)
         {
-            // Parse immediate value (support decimal and hex)
-            int16_t imm = 0;
-            try
-            {
-                if (immStr.substr(0, 2) == "0x" || immStr.substr(0, 2) == "0X")
-                {
-                    imm = static_cast<int16_t>(std::stoi(immStr, nullptr, 16));
-                }
-                else
-                {
-                    imm = static_cast<int16_t>(std::stoi(immStr));
-                }
-                return std::make_unique<XoriInstruction>(rt, rs, imm);
-            }
-            catch (const std::exception&)
-            {
-                // Invalid immediate value
-                return nullptr;
-            }
+            return false;  // Invalid byte value
         }
-    }
-    else if (opcode == "sltiu" && tokens.size() >= 4)
-    {
-        // Parse: sltiu $rt, $rs, imm
-        std::string rtStr  = tokens[1];
-        std::string rsStr  = tokens[2];
-        std::string immStr = tokens[3];
-
-        // Remove commas
-        if (rtStr.back() == ',')
-            rtStr.pop_back();
-        if (rsStr.back() == ',')
-            rsStr.pop_back();
-        if (immStr.back() == ',')
-            immStr.pop_back();
-
-        int rt = getRegisterNumber(rtStr);
-        int rs = getRegisterNumber(rsStr);
-
-        if (rt >= 0 && rs >= 0)
-        {
-            // Parse immediate value (support decimal and hex)
-            int16_t imm = 0;
-            try
-            {
-                if (immStr.substr(0, 2) == "0x" || immStr.substr(0, 2) == "0X")
-                {
-                    imm = static_cast<int16_t>(std::stoi(immStr, nullptr, 16));
-                }
-                else
-                {
-                    imm = static_cast<int16_t>(std::stoi(immStr));
-                }
-                return std::make_unique<SltiuInstruction>(rt, rs, imm);
-            }
-            catch (const std::exception&)
-            {
-                // Invalid immediate value
-                return nullptr;
-            }
-        }
-    }
-    else if (opcode == "lb" && tokens.size() >= 3)
-    {
-        // Parse: lb $rt, offset($rs)  -- accept both "0($a1)" and "0 ($a1)"
-        std::string rtStr = tokens[1];
-        // Reconstruct offset($rs) from remaining tokens to tolerate a space between offset and
-        // (reg)
-        std::string offsetRegStr;
-        if (tokens.size() >= 3)
-        {
-            offsetRegStr.clear();
-            for (size_t i = 2; i < tokens.size(); ++i)
-            {
-                offsetRegStr += tokens[i];
-            }
-            // Remove any stray commas
-            offsetRegStr.erase(std::remove(offsetRegStr.begin(), offsetRegStr.end(), ','),
-                               offsetRegStr.end());
-        }
-
-        // Remove comma from rt
-        if (!rtStr.empty() && rtStr.back() == ',')
-            rtStr.pop_back();
-
-        int rt = getRegisterNumber(rtStr);
-        if (rt >= 0)
-        {
-            // Parse offset($rs) format
-            size_t parenPos = offsetRegStr.find('(');
-            if (parenPos != std::string::npos)
-            {
-                std::string offsetStr = offsetRegStr.substr(0, parenPos);
-                std::string rsStr     = offsetRegStr.substr(parenPos + 1);
-                if (!rsStr.empty() && rsStr.back() == ')')
-                    rsStr.pop_back();
-
-                int rs = getRegisterNumber(rsStr);
-                if (rs >= 0)
-                {
-                    try
-                    {
-                        int16_t offset = 0;
-                        if (!offsetStr.empty())
-                        {
-                            if (offsetStr.front() == '+')
-                            {
-                                offsetStr = offsetStr.substr(1);
-                            }
-                            if (!offsetStr.empty())
-                            {
-                                offset = static_cast<int16_t>(std::stoi(offsetStr));
-                            }
-                        }
-                        return std::make_unique<LBInstruction>(rt, rs, offset);
-                    }
-                    catch (const std::exception&)
-                    {
-                        return nullptr;
-                    }
-                }
-            }
-        }
-    }
-    else if (opcode == "sb" && tokens.size() >= 3)
-    {
-        // Parse: sb $rt, offset($rs)
-        std::string rtStr = tokens[1];
-        // Reconstruct offset($rs) from remaining tokens to tolerate a space between offset and
-        // (reg)
-        std::string offsetRegStr;
-        if (tokens.size() >= 3)
-        {
-            offsetRegStr.clear();
-            for (size_t i = 2; i < tokens.size(); ++i)
-            {
-                offsetRegStr += tokens[i];
-            }
-            // Remove any stray commas
-            offsetRegStr.erase(std::remove(offsetRegStr.begin(), offsetRegStr.end(), ','),
-                               offsetRegStr.end());
-        }
-
-        // Remove comma from rt
-        if (rtStr.back() == ',')
-            rtStr.pop_back();
-
-        int rt = getRegisterNumber(rtStr);
-        if (rt >= 0)
-        {
-            // Parse offset($rs) format
-            size_t parenPos = offsetRegStr.find('(');
-            if (parenPos != std::string::npos)
-            {
-                std::string offsetStr = offsetRegStr.substr(0, parenPos);
-                std::string rsStr     = offsetRegStr.substr(parenPos + 1);
-                if (rsStr.back() == ')')
-                    rsStr.pop_back();
-
-                int rs = getRegisterNumber(rsStr);
-                if (rs >= 0)
-                {
-                    try
-                    {
-                        int16_t offset = 0;
-                        if (!offsetStr.empty())
-                        {
-                            if (offsetStr.front() == '+')
-                            {
-                                offsetStr = offsetStr.substr(1);
-                            }
-                            if (!offsetStr.empty())
-                            {
-                                offset = static_cast<int16_t>(std::stoi(offsetStr));
-                            }
-                        }
-                        return std::make_unique<SBInstruction>(rt, rs, offset);
-                    }
-                    catch (const std::exception&)
-                    {
-                        return nullptr;
-                    }
-                }
-            }
-        }
-    }
-    else if (opcode == "lbu" && tokens.size() >= 3)
-    {
-        // Parse: lbu $rt, offset($rs) -- accept both "0($a1)" and "0 ($a1)"
-        std::string rtStr = tokens[1];
-        std::string offsetRegStr;
-        if (tokens.size() >= 3)
-        {
-            offsetRegStr.clear();
-            for (size_t i = 2; i < tokens.size(); ++i)
-            {
-                offsetRegStr += tokens[i];
-            }
-            offsetRegStr.erase(std::remove(offsetRegStr.begin(), offsetRegStr.end(), ','),
-                               offsetRegStr.end());
-        }
-
-        // Remove comma from rt
-        if (!rtStr.empty() && rtStr.back() == ',')
-            rtStr.pop_back();
-
-        int rt = getRegisterNumber(rtStr);
-        if (rt >= 0)
-        {
-            // Parse offset($rs) format
-            size_t parenPos = offsetRegStr.find('(');
-            if (parenPos != std::string::npos)
-            {
-                std::string offsetStr = offsetRegStr.substr(0, parenPos);
-                std::string rsStr     = offsetRegStr.substr(parenPos + 1);
-                if (!rsStr.empty() && rsStr.back() == ')')
-                    rsStr.pop_back();
-
-                int rs = getRegisterNumber(rsStr);
-                if (rs >= 0)
-                {
-                    try
-                    {
-                        int16_t offset = 0;
-                        if (!offsetStr.empty())
-                        {
-                            if (offsetStr.front() == '+')
-                            {
-                                offsetStr = offsetStr.substr(1);
-                            }
-                            offset = static_cast<int16_t>(std::stoi(offsetStr));
-                        }
-                        return std::make_unique<LBUInstruction>(rt, rs, offset);
-                    }
-                    catch (const std::exception&)
-                    {
-                        return nullptr;
-                    }
-                }
-            }
-        }
-    }
-    else if (opcode == "sh" && tokens.size() >= 3)
-    {
-        // Parse: sh $rt, offset($rs)
-        std::string rtStr = tokens[1];
-        // Reconstruct offset($rs) from remaining tokens to tolerate a space between offset and
-        // (reg)
-        std::string offsetRegStr;
-        if (tokens.size() >= 3)
-        {
-            offsetRegStr.clear();
-            for (size_t i = 2; i < tokens.size(); ++i)
-            {
-                offsetRegStr += tokens[i];
-            }
-            // Remove any stray commas
-            offsetRegStr.erase(std::remove(offsetRegStr.begin(), offsetRegStr.end(), ','),
-                               offsetRegStr.end());
-        }
-
-        // Remove comma from rt
-        if (rtStr.back() == ',')
-            rtStr.pop_back();
-
-        int rt = getRegisterNumber(rtStr);
-        if (rt >= 0)
-        {
-            // Parse offset($rs) format
-            size_t parenPos = offsetRegStr.find('(');
-            if (parenPos != std::string::npos)
-            {
-                std::string offsetStr = offsetRegStr.substr(0, parenPos);
-                std::string rsStr     = offsetRegStr.substr(parenPos + 1);
-                if (rsStr.back() == ')')
-                    rsStr.pop_back();
-
-                int rs = getRegisterNumber(rsStr);
-                if (rs >= 0)
-                {
-                    try
-                    {
-                        int16_t offset = 0;
-                        if (!offsetStr.empty())
-                        {
-                            if (offsetStr.front() == '+')
-                            {
-                                offsetStr = offsetStr.substr(1);
-                            }
-                            if (!offsetStr.empty())
-                            {
-                                offset = static_cast<int16_t>(std::stoi(offsetStr));
-                            }
-                        }
-                        return std::make_unique<SHInstruction>(rt, rs, offset);
-                    }
-                    catch (const std::exception&)
-                    {
-                        return nullptr;
-                    }
-                }
-            }
-        }
-    }
-    else if (opcode == "lhu" && tokens.size() >= 3)
-    {
-        // Parse: lhu $rt, offset($rs) -- accept both "0($a1)" and "0 ($a1)"
-        std::string rtStr = tokens[1];
-        std::string offsetRegStr;
-        if (tokens.size() >= 3)
-        {
-            offsetRegStr.clear();
-            for (size_t i = 2; i < tokens.size(); ++i)
-            {
-                offsetRegStr += tokens[i];
-            }
-            offsetRegStr.erase(std::remove(offsetRegStr.begin(), offsetRegStr.end(), ','),
-                               offsetRegStr.end());
-        }
-
-        // Remove comma from rt
-        if (!rtStr.empty() && rtStr.back() == ',')
-            rtStr.pop_back();
-
-        int rt = getRegisterNumber(rtStr);
-        if (rt >= 0)
+        else
         {
-            // Parse offset($rs) format
-            size_t parenPos = offsetRegStr.find('(');
-            if (parenPos != std::string::npos)
-            {
-                std::string offsetStr = offsetRegStr.substr(0, parenPos);
-                std::string rsStr     = offsetRegStr.substr(parenPos + 1);
-                if (!rsStr.empty() && rsStr.back() == ')')
-                    rsStr.pop_back();
-
-                int rs = getRegisterNumber(rsStr);
-                if (rs >= 0)
-                {
-                    try
-                    {
-                        int16_t offset = 0;
-                        if (!offsetStr.empty())
-                        {
-                            if (offsetStr.front() == '+')
-                            {
-                                offsetStr = offsetStr.substr(1);
-                            }
-                            offset = static_cast<int16_t>(std::stoi(offsetStr));
-                        }
-                        return std::make_unique<LHUInstruction>(rt, rs, offset);
-                    }
-                    catch (const std::exception&)
-                    {
-                        return nullptr;
-                    }
-                }
-            }
+            directive.bytes.push_back(static_cast<uint8_t>(value));
         }
     }
-    else if (opcode == "lh" && tokens.size() >= 3)
-    {
-        // Parse: lh $rt, offset($rs) -- accept both "0($a1)" and "0 ($a1)"
-        std::string rtStr = tokens[1];
-        std::string offsetRegStr;
-        if (tokens.size() >= 3)
-        {
-            offsetRegStr.clear();
-            for (size_t i = 2; i < tokens.size(); ++i)
-            {
-                offsetRegStr += tokens[i];
-            }
-            offsetRegStr.erase(std::remove(offsetRegStr.begin(), offsetRegStr.end(), ','),
-                               offsetRegStr.end());
-        }
-
-        // Remove comma from rt
-        if (!rtStr.empty() && rtStr.back() == ',')
-            rtStr.pop_back();
-
-        int rt = getRegisterNumber(rtStr);
-        if (rt >= 0)
-        {
-            // Parse offset($rs) format
-            size_t parenPos = offsetRegStr.find('(');
-            if (parenPos != std::string::npos)
-            {
-                std::string offsetStr = offsetRegStr.substr(0, parenPos);
-                std::string rsStr     = offsetRegStr.substr(parenPos + 1);
-                if (!rsStr.empty() && rsStr.back() == ')')
-                    rsStr.pop_back();
+    return true;
+}
 
-                int rs = getRegisterNumber(rsStr);
-                if (rs >= 0)
-                {
-                    try
-                    {
-                        int16_t offset = 0;
-                        if (!offsetStr.empty())
-                        {
-                            if (offsetStr.front() == '+')
-                            {
-                                offsetStr = offsetStr.substr(1);
-                            }
-                            offset = static_cast<int16_t>(std::stoi(offsetStr));
-                        }
-                        return std::make_unique<LHInstruction>(rt, rs, offset);
-                    }
-                    catch (const std::exception&)
-                    {
-                        return nullptr;
-                    }
-                }
-            }
-        }
-    }
-    else if (opcode == "lw" && tokens.size() >= 3)
+/**
+ * @brief A label as defined in the single pass: an offset into its section
+ */
+struct LabelDefinition
+{
+    std::string_view name;
+    uint32_t         offset;
+    bool             inData;  // Relative to the data base, known only at the end
+};
+
+// Sources at least this large are split into chunks of about CHUNK_BYTES that are
+// lexed and parsed concurrently
+constexpr size_t CHUNK_BYTES        = 256 * 1024;
+constexpr size_t PARALLEL_MIN_BYTES = 4 * CHUNK_BYTES;
+
+/**
+ * @brief A run of whole source lines, lexed and parsed without knowing the section
+ *
+ * Every instruction is parsed, even one that turns out to sit in the data section,
+ * so a chunk depends only on its own text. Placing labels, sections and data needs
+ * the state left by the previous chunks and is done by replaying the steps in order.
+ */
+struct LexedChunk
+{
+    enum class Step : uint8_t
+    {
+        Label,             // Next entry of labels
+        Directive,         // Next entry of directives
+        InvalidDirective,  // A data directive that did not parse
+        DataSection,
+        TextSection,
+        Instruction        // Next entry of instructions
+    };
+
+    std::vector<Step>                         steps;
+    std::vector<std::string_view>             labels;
+    std::vector<DataDirective>                directives;    // Section-relative address 0
+    std::vector<std::unique_ptr<Instruction>> instructions;  // nullptr if it did not parse
+    std::vector<size_t>                       invalidLines;  // Chunk line of each nullptr
+    size_t                                    lineCount = 0;
+};
+
+/**
+ * @brief Classify a lexed statement and parse its instruction or data directive
+ * @param[out] instruction Set for ParsedLine::INSTRUCTION
+ * @param[out] directive Filled for ParsedLine::DIRECTIVE
+ */
+ParsedLine::Kind parseStatement(const Statement& statement,
+                                std::unique_ptr<Instruction>& instruction,
+                                DataDirective& directive)
+{
+    const std::string_view mnemonic = statement.mnemonic;
+    if (mnemonic.empty())
     {
-        // Parse: lw $rt, offset($rs) -- accept both "0($a1)" and "0 ($a1)"
-        std::string rtStr = tokens[1];
-        std::string offsetRegStr;
-        if (tokens.size() >= 3)
-        {
-            offsetRegStr.clear();
-            for (size_t i = 2; i < tokens.size(); ++i)
-            {
-                offsetRegStr += tokens[i];
-            }
-            offsetRegStr.erase(std::remove(offsetRegStr.begin(), offsetRegStr.end(), ','),
-                               offsetRegStr.end());
-        }
-
-        // Remove comma from rt
-        if (rtStr.back() == ',')
-            rtStr.pop_back();
-
-        int rt = getRegisterNumber(rtStr);
-        if (rt >= 0)
-        {
-            // Parse offset($rs) format
-            size_t parenPos = offsetRegStr.find('(');
-            if (parenPos != std::string::npos)
-            {
-                std::string offsetStr = offsetRegStr.substr(0, parenPos);
-                std::string rsStr     = offsetRegStr.substr(parenPos + 1);
-                if (rsStr.back() == ')')
-                    rsStr.pop_back();
-
-                int rs = getRegisterNumber(rsStr);
-                if (rs >= 0)
-                {
-                    try
-                    {
-                        int16_t offset = 0;
-                        if (!offsetStr.empty())
-                        {
-                            if (offsetStr.substr(0, 2) == "0x" || offsetStr.substr(0, 2) == "0X")
-                            {
-                                offset = static_cast<int16_t>(std::stoi(offsetStr, nullptr, 16));
-                            }
-                            else
-                            {
-                                offset = static_cast<int16_t>(std::stoi(offsetStr));
-                            }
-                        }
-                        return std::make_unique<LwInstruction>(rt, rs, offset);
-                    }
-                    catch (const std::exception&)
-                    {
-                        return nullptr;
-                    }
-                }
-            }
-        }
+        return ParsedLine::NONE;
     }
-    else if (opcode == "sw" && tokens.size() >= 3)
+    if (isDataDirective(mnemonic))
     {
-        // Parse: sw $rt, offset($rs) -- accept both "0($a1)" and "0 ($a1)"
-        std::string rtStr = tokens[1];
-        std::string offsetRegStr;
-        if (tokens.size() >= 3)
-        {
-            offsetRegStr.clear();
-            for (size_t i = 2; i < tokens.size(); ++i)
-            {
-                offsetRegStr += tokens[i];
-            }
-            offsetRegStr.erase(std::remove(offsetRegStr.begin(), offsetRegStr.end(), ','),
-                               offsetRegStr.end());
-        }
-
-        // Remove comma from rt
-        if (rtStr.back() == ',')
-            rtStr.pop_back();
-
-        int rt = getRegisterNumber(rtStr);
-        if (rt >= 0)
-        {
-            // Parse offset($rs) format
-            size_t parenPos = offsetRegStr.find('(');
-            if (parenPos != std::string::npos)
-            {
-                std::string offsetStr = offsetRegStr.substr(0, parenPos);
-                std::string rsStr     = offsetRegStr.substr(parenPos + 1);
-                if (rsStr.back() == ')')
-                    rsStr.pop_back();
-
-                int rs = getRegisterNumber(rsStr);
-                if (rs >= 0)
-                {
-                    try
-                    {
-                        int16_t offset = 0;
-                        if (!offsetStr.empty())
-                        {
-                            if (offsetStr.substr(0, 2) == "0x" || offsetStr.substr(0, 2) == "0X")
-                            {
-                                offset = static_cast<int16_t>(std::stoi(offsetStr, nullptr, 16));
-                            }
-                            else
-                            {
-                                offset = static_cast<int16_t>(std::stoi(offsetStr));
-                            }
-                        }
-                        return std::make_unique<SwInstruction>(rt, rs, offset);
-                    }
-                    catch (const std::exception&)
-                    {
-                        return nullptr;
-                    }
-                }
-            }
-        }
+        return parseDataDirective(statement, directive) ? ParsedLine::DIRECTIVE
+                                                        : ParsedLine::INVALID_DIRECTIVE;
     }
-    else if (opcode == "beq" && tokens.size() >= 4)
+    if (mnemonic == ".data" || mnemonic == ".text")
     {
-        // Parse: beq $rs, $rt, label
-        std::string rsStr    = tokens[1];
-        std::string rtStr    = tokens[2];
-        std::string labelStr = tokens[3];
-
-        // Remove commas
-        if (rsStr.back() == ',')
-            rsStr.pop_back();
-        if (rtStr.back() == ',')
-            rtStr.pop_back();
-        if (labelStr.back() == ',')
-            labelStr.pop_back();
-
-        int rs = getRegisterNumber(rsStr);
-        int rt = getRegisterNumber(rtStr);
-
-        if (rs >= 0 && rt >= 0)
-        {
-            return std::make_unique<BeqInstruction>(rs, rt, labelStr);
-        }
+        return mnemonic == ".data" ? ParsedLine::DATA_SECTION : ParsedLine::TEXT_SECTION;
     }
-    else if (opcode == "bne" && tokens.size() >= 4)
+    if (mnemonic.front() == '.')
     {
-        // Parse: bne $rs, $rt, label
-        std::string rsStr    = tokens[1];
-        std::string rtStr    = tokens[2];
-        std::string labelStr = tokens[3];
-
-        // Remove commas
-        if (rsStr.back() == ',')
-            rsStr.pop_back();
-        if (rtStr.back() == ',')
-            rtStr.pop_back();
-        if (labelStr.back() == ',')
-            labelStr.pop_back();
-
-        int rs = getRegisterNumber(rsStr);
-        int rt = getRegisterNumber(rtStr);
-
-        if (rs >= 0 && rt >= 0)
-        {
-            return std::make_unique<BneInstruction>(rs, rt, labelStr);
-        }
+        return ParsedLine::NONE;  // Other directives (.globl, ...) have no effect
     }
-    else if (opcode == "blez" && tokens.size() >= 3)
-    {
-        // Parse: blez $rs, label
-        std::string rsStr    = tokens[1];
-        std::string labelStr = tokens[2];
-
-        // Remove commas
-        if (rsStr.back() == ',')
-            rsStr.pop_back();
-        if (labelStr.back() == ',')
-            labelStr.pop_back();
+    instruction = parseInstruction(mnemonic, statement.operands);
+    return ParsedLine::INSTRUCTION;
+}
 
-        int rs = getRegisterNumber(rsStr);
+void lexChunk(std::string_view text, LexedChunk& chunk)
+{
+    using Step = LexedChunk::Step;
 
-        if (rs >= 0)
-        {
-            return std::make_unique<BLEZInstruction>(rs, labelStr);
-        }
-    }
-    else if (opcode == "bgtz" && tokens.size() >= 3)
+    InstructionArena::Scope arena;  // The chunk's instructions, side by side
+    SourceLexer             lexer(text);
+    Statement               statement;
+    while (lexer.next(statement))
     {
-        // Parse: bgtz $rs, label
-        std::string rsStr    = tokens[1];
-        std::string labelStr = tokens[2];
-
-        // Remove commas
-        if (rsStr.back() == ',')
-            rsStr.pop_back();
-        if (labelStr.back() == ',')
-            labelStr.pop_back();
-
-        int rs = getRegisterNumber(rsStr);
-
-        if (rs >= 0)
+        for (std::string_view label : statement.labels)
         {
-            return std::make_unique<BGTZInstruction>(rs, labelStr);
+            chunk.steps.push_back(Step::Label);
+            chunk.labels.push_back(label);
         }
-    }
-    else if (opcode == "j" && tokens.size() >= 2)
-    {
-        // Parse: j label
-        std::string labelStr = tokens[1];
-
-        // Remove comma if present
-        if (labelStr.back() == ',')
-            labelStr.pop_back();
-
-        return std::make_unique<JInstruction>(labelStr);
-    }
-    else if (opcode == "sll" && tokens.size() >= 4)
-    {
-        // Parse: sll $rd, $rt, shamt
-        std::string rdStr    = tokens[1];
-        std::string rtStr    = tokens[2];
-        std::string shamtStr = tokens[3];
-
-        // Remove commas
-        if (rdStr.back() == ',')
-            rdStr.pop_back();
-        if (rtStr.back() == ',')
-            rtStr.pop_back();
-        if (shamtStr.back() == ',')
-            shamtStr.pop_back();
-
-        int rd = getRegisterNumber(rdStr);
-        int rt = getRegisterNumber(rtStr);
 
-        if (rd >= 0 && rt >= 0)
+        std::unique_ptr<Instruction> instruction;
+        DataDirective                directive(DataDirective::WORD, 0);
+        switch (parseStatement(statement, instruction, directive))
         {
-            // Parse shift amount (0-31)
-            try
-            {
-                uint32_t shamt = 0;
-                if (shamtStr.substr(0, 2) == "0x" || shamtStr.substr(0, 2) == "0X")
-                {
-                    shamt = static_cast<uint32_t>(std::stoi(shamtStr, nullptr, 16));
-                }
-                else
-                {
-                    shamt = static_cast<uint32_t>(std::stoi(shamtStr));
-                }
-
-                // Validate shift amount (0-31)
-                if (shamt <= 31)
-                {
-                    return std::make_unique<SllInstruction>(rd, rt, shamt);
-                }
-            }
-            catch (const std::exception&)
+        case ParsedLine::NONE:
+            break;
+        case ParsedLine::INSTRUCTION:
+            if (!instruction)
             {
-                // Invalid shift amount
-                return nullptr;
+                chunk.invalidLines.push_back(lexer.line());
             }
-        }
-    }
-    else if (opcode == "srl" && tokens.size() >= 4)
-    {
-        // Parse: srl $rd, $rt, shamt
-        std::string rdStr    = tokens[1];
-        std::string rtStr    = tokens[2];
-        std::string shamtStr = tokens[3];
-
-        // Remove commas
-        if (rdStr.back() == ',')
-            rdStr.pop_back();
-        if (rtStr.back() == ',')
-            rtStr.pop_back();
-        if (shamtStr.back() == ',')
-            shamtStr.pop_back();
-
-        int rd = getRegisterNumber(rdStr);
-        int rt = getRegisterNumber(rtStr);
-
-        if (rd >= 0 && rt >= 0)
-        {
-            // Parse shift amount (0-31)
-            try
-            {
-                uint32_t shamt = 0;
-                if (shamtStr.substr(0, 2) == "0x" || shamtStr.substr(0, 2) == "0X")
-                {
-                    shamt = static_cast<uint32_t>(std::stoi(shamtStr, nullptr, 16));
-                }
-                else
-                {
-                    shamt = static_cast<uint32_t>(std::stoi(shamtStr));
-                }
+            chunk.steps.push_back(Step::Instruction);
+            chunk.instructions.push_back(std::move(instruction));
+            break;
+        case ParsedLine::DIRECTIVE:
+            chunk.steps.push_back(Step::Directive);
+            chunk.directives.push_back(std::move(directive));
+            break;
+        case ParsedLine::INVALID_DIRECTIVE:
+            chunk.steps.push_back(Step::InvalidDirective);
+            break;
+        case ParsedLine::DATA_SECTION:
+            chunk.steps.push_back(Step::DataSection);
+            break;
+        case ParsedLine::TEXT_SECTION:
+            chunk.steps.push_back(Step::TextSection);
+            break;
+        }
+    }
+    chunk.lineCount = lexer.line();
+}
 
-                // Validate shift amount (0-31)
-                if (shamt <= 31)
-                {
-                    return std::make_unique<SrlInstruction>(rd, rt, shamt);
-                }
-            }
-            catch (const std::exception&)
-            {
-                // Invalid shift amount
-                return nullptr;
-            }
-        }
-    }
-    else if (opcode == "sra" && tokens.size() >= 4)
+/**
+ * @brief Split the source into chunks that end on line boundaries and lex them
+ * @param jobs Worker threads, including the caller; 0 means one per hardware thread
+ */
+std::vector<LexedChunk> lexChunks(std::string_view source, unsigned jobs)
+{
+    if (jobs == 0)
     {
-        // Parse: sra $rd, $rt, shamt
-        std::string rdStr    = tokens[1];
-        std::string rtStr    = tokens[2];
-        std::string shamtStr = tokens[3];
-
-        // Remove commas
-        if (rdStr.back() == ',')
-            rdStr.pop_back();
-        if (rtStr.back() == ',')
-            rtStr.pop_back();
-        if (shamtStr.back() == ',')
-            shamtStr.pop_back();
-
-        int rd = getRegisterNumber(rdStr);
-        int rt = getRegisterNumber(rtStr);
-
-        if (rd >= 0 && rt >= 0)
-        {
-            // Parse shift amount (0-31)
-            try
-            {
-                uint32_t shamt = 0;
-                if (shamtStr.substr(0, 2) == "0x" || shamtStr.substr(0, 2) == "0X")
-                {
-                    shamt = static_cast<uint32_t>(std::stoi(shamtStr, nullptr, 16));
-                }
-                else
-                {
-                    shamt = static_cast<uint32_t>(std::stoi(shamtStr));
-                }
-
-                // Validate shift amount (0-31)
-                if (shamt <= 31)
-                {
-                    return std::make_unique<SraInstruction>(rd, rt, shamt);
-                }
-            }
-            catch (const std::exception&)
-            {
-                // Invalid shift amount
-                return nullptr;
-            }
-        }
+        jobs = std::max(1u, std::thread::hardware_concurrency());
     }
-    else if (opcode == "sllv" && tokens.size() >= 4)
+    if (jobs == 1 || source.size() < PARALLEL_MIN_BYTES)
     {
-        // Parse: sllv $rd, $rt, $rs
-        std::string rdStr = tokens[1];
-        std::string rtStr = tokens[2];
-        std::string rsStr = tokens[3];
-
-        // Remove commas
-        if (rdStr.back() == ',')
-            rdStr.pop_back();
-        if (rtStr.back() == ',')
-            rtStr.pop_back();
-        if (rsStr.back() == ',')
-            rsStr.pop_back();
-
-        int rd = getRegisterNumber(rdStr);
-        int rt = getRegisterNumber(rtStr);
-        int rs = getRegisterNumber(rsStr);
-
-        if (rd >= 0 && rt >= 0 && rs >= 0)
-        {
-            return std::make_unique<SLLVInstruction>(rd, rt, rs);
-        }
+        std::vector<LexedChunk> chunks(1);
+        lexChunk(source, chunks.front());
+        return chunks;
     }
-    else if (opcode == "srlv" && tokens.size() >= 4)
-    {
-        // Parse: srlv $rd, $rt, $rs
-        std::string rdStr = tokens[1];
-        std::string rtStr = tokens[2];
-        std::string rsStr = tokens[3];
-
-        // Remove commas
-        if (rdStr.back() == ',')
-            rdStr.pop_back();
-        if (rtStr.back() == ',')
-            rtStr.pop_back();
-        if (rsStr.back() == ',')
-            rsStr.pop_back();
 
-        int rd = getRegisterNumber(rdStr);
-        int rt = getRegisterNumber(rtStr);
-        int rs = getRegisterNumber(rsStr);
-
-        if (rd >= 0 && rt >= 0 && rs >= 0)
-        {
-            return std::make_unique<SRLVInstruction>(rd, rt, rs);
-        }
-    }
-    else if (opcode == "srav" && tokens.size() >= 4)
+    std::vector<std::string_view> pieces;
+    for (size_t pos = 0; pos < source.size();)
     {
-        // Parse: srav $rd, $rt, $rs
-        std::string rdStr = tokens[1];
-        std::string rtStr = tokens[2];
-        std::string rsStr = tokens[3];
-
-        // Remove commas
-        if (rdStr.back() == ',')
-            rdStr.pop_back();
-        if (rtStr.back() == ',')
-            rtStr.pop_back();
-        if (rsStr.back() == ',')
-            rsStr.pop_back();
-
-        int rd = getRegisterNumber(rdStr);
-        int rt = getRegisterNumber(rtStr);
-        int rs = getRegisterNumber(rsStr);
-
-        if (rd >= 0 && rt >= 0 && rs >= 0)
+        size_t end = pos + CHUNK_BYTES;
+        if (end >= source.size() || (end = source.find('\n', end)) == std::string_view::npos)
         {
-            return std::make_unique<SRAVInstruction>(rd, rt, rs);
+            end = source.size();
         }
-    }
-    else if (opcode == "jr" && tokens.size() == 2)
-    {  // Exactly 2 tokens: "jr" and register
-        // Parse: jr $rs
-        std::string rsStr = tokens[1];
-
-        // Remove commas if present
-        if (rsStr.back() == ',')
-            rsStr.pop_back();
-
-        int rs = getRegisterNumber(rsStr);
-
-        if (rs >= 0)
+        else
         {
-            return std::make_unique<JRInstruction>(rs);
+            ++end;  // Keep the newline with its line
         }
+        pieces.push_back(source.substr(pos, end - pos));
+        pos = end;
     }
-    else if (opcode == "jal" && tokens.size() == 2)
-    {  // Exactly 2 tokens: "jal" and target
-        // Parse: jal target
-        std::string targetStr = tokens[1];
-
-        // Remove commas if present
-        if (targetStr.back() == ',')
-            targetStr.pop_back();
 
-        // Try to parse as numeric value (hex or decimal) first
-        uint32_t target = 0;
-        try
-        {
-            if (targetStr.size() > 2 && targetStr.substr(0, 2) == "0x")
-            {
-                // Hexadecimal
-                target = static_cast<uint32_t>(std::stoul(targetStr, nullptr, 16));
-                return std::make_unique<JALInstruction>(target);
-            }
-            else
-            {
-                // Try decimal
-                target = static_cast<uint32_t>(std::stoul(targetStr, nullptr, 10));
-                return std::make_unique<JALInstruction>(target);
-            }
-        }
-        catch (const std::exception&)
-        {
-            // Failed to parse as number, treat as label
-            return std::make_unique<JALLabelInstruction>(targetStr);
-        }
-    }
-    else if (opcode == "jalr" && (tokens.size() == 2 || tokens.size() == 3))
+    // Chunk results go to pre-sized slots, so workers never touch shared state
+    // beyond the counter that hands out chunks
+    std::vector<LexedChunk>         chunks(pieces.size());
+    std::atomic<size_t>             nextChunk{0};
+    std::vector<std::exception_ptr> failures(std::min<size_t>(jobs, pieces.size()));
+    auto                            work = [&](std::exception_ptr& failure)
     {
-        // Parse: jalr $rs (implicit $rd = $ra) or jalr $rd, $rs
         try
         {
-            if (tokens.size() == 2)
-            {
-                // jalr $rs (default destination is $ra = $31)
-                std::string rsStr = tokens[1];
-                int         rs    = getRegisterNumber(rsStr);
-                if (rs == -1)
-                {
-                    return nullptr;  // Invalid register
-                }
-                return std::make_unique<JALRInstruction>(31, rs);  // $ra = 31
-            }
-            else
+            for (size_t i; (i = nextChunk.fetch_add(1)) < pieces.size();)
             {
-                // jalr $rd, $rs
-                std::string rdStr = tokens[1];
-                if (rdStr.back() == ',')
-                {
-                    rdStr.pop_back();  // Remove comma
-                }
-                std::string rsStr = tokens[2];
-
-                int rd = getRegisterNumber(rdStr);
-                int rs = getRegisterNumber(rsStr);
-                if (rd == -1 || rs == -1)
-                {
-                    return nullptr;  // Invalid register
-                }
-                return std::make_unique<JALRInstruction>(rd, rs);
+                lexChunk(pieces[i], chunks[i]);
             }
         }
-        catch (const std::exception&)
+        catch (...)
         {
-            return nullptr;
+            failure   = std::current_exception();
+            nextChunk = pieces.size();  // Let the other workers stop early
         }
-    }
-    else if (opcode == "mfhi" && tokens.size() >= 2)
-    {
-        // Parse: mfhi $rd
-        std::string rdStr = tokens[1];
+    };
 
-        int rd = getRegisterNumber(rdStr);
-        if (rd >= 0)
-        {
-            return std::make_unique<MFHIInstruction>(rd);
-        }
-    }
-    else if (opcode == "mthi" && tokens.size() >= 2)
+    std::vector<std::thread> workers;
+    workers.reserve(failures.size() - 1);
+    for (size_t i = 1; i < failures.size(); ++i)
     {
-        // Parse: mthi $rs
-        std::string rsStr = tokens[1];
-
-        int rs = getRegisterNumber(rsStr);
-        if (rs >= 0)
-        {
-            return std::make_unique<MTHIInstruction>(rs);
-        }
+        workers.emplace_back(work, std::ref(failures[i]));
     }
-    else if (opcode == "mflo" && tokens.size() >= 2)
+    work(failures[0]);
+    for (std::thread& worker : workers)
     {
-        // Parse: mflo $rd
-        std::string rdStr = tokens[1];
-
-        int rd = getRegisterNumber(rdStr);
-        if (rd >= 0)
-        {
-            return std::make_unique<MFLOInstruction>(rd);
-        }
+        worker.join();
     }
-    else if (opcode == "mtlo" && tokens.size() >= 2)
+    for (const std::exception_ptr& failure : failures)
     {
-        // Parse: mtlo $rs
-        std::string rsStr = tokens[1];
-
-        int rs = getRegisterNumber(rsStr);
-        if (rs >= 0)
+        if (failure)
         {
-            return std::make_unique<MTLOInstruction>(rs);
+            std::rethrow_exception(failure);
         }
     }
-    else if (opcode == "mult" && tokens.size() >= 3)
-    {
-        // Parse: mult $rs, $rt
-        std::string rsStr = tokens[1];
-        std::string rtStr = tokens[2];
+    return chunks;
+}
 
-        // Remove commas
-        if (rsStr.back() == ',')
-            rsStr.pop_back();
-        if (rtStr.back() == ',')
-            rtStr.pop_back();
+}  // namespace
 
-        int rs = getRegisterNumber(rsStr);
-        int rt = getRegisterNumber(rtStr);
+std::vector<std::unique_ptr<Instruction>> Assembler::assemble(std::string_view assembly)
+{
+    InstructionArena::Scope                   arena;
+    std::vector<std::unique_ptr<Instruction>> instructions;
+    SourceLexer                               lexer(assembly);
+    Statement                                 statement;
 
-        if (rs >= 0 && rt >= 0)
+    // Every instruction, wherever it is; labels and directives are skipped
+    while (lexer.next(statement))
+    {
+        if (statement.mnemonic.empty() || statement.mnemonic.front() == '.')
         {
-            return std::make_unique<MULTInstruction>(rs, rt);
+            continue;
         }
-    }
-    else if (opcode == "multu" && tokens.size() >= 3)
-    {
-        // Parse: multu $rs, $rt
-        std::string rsStr = tokens[1];
-        std::string rtStr = tokens[2];
-
-        // Remove commas
-        if (rsStr.back() == ',')
-            rsStr.pop_back();
-        if (rtStr.back() == ',')
-            rtStr.pop_back();
-
-        int rs = getRegisterNumber(rsStr);
-        int rt = getRegisterNumber(rtStr);
-
-        if (rs >= 0 && rt >= 0)
+        auto instruction = parseInstruction(statement.mnemonic, statement.operands);
+        if (instruction)
         {
-            return std::make_unique<MULTUInstruction>(rs, rt);
+            instructions.push_back(std::move(instruction));
         }
     }
-    else if (opcode == "div" && tokens.size() >= 3)
-    {
-        // Parse: div $rs, $rt
-        std::string rsStr = tokens[1];
-        std::string rtStr = tokens[2];
-
-        // Remove commas
-        if (rsStr.back() == ',')
-            rsStr.pop_back();
-        if (rtStr.back() == ',')
-            rtStr.pop_back();
 
-        int rs = getRegisterNumber(rsStr);
-        int rt = getRegisterNumber(rtStr);
+    return instructions;
+}
 
-        if (rs >= 0 && rt >= 0)
-        {
-            return std::make_unique<DIVInstruction>(rs, rt);
-        }
-    }
-    else if (opcode == "divu" && tokens.size() >= 3)
-    {
-        // Parse: divu $rs, $rt
-        std::string rsStr = tokens[1];
-        std::string rtStr = tokens[2];
+std::vector<std::unique_ptr<Instruction>>
+Assembler::assembleWithLabels(std::string_view                 assembly,
+                              std::map<std::string, uint32_t>& labelMap,
+                              std::vector<DataDirective>&      dataDirectives)
+{
+    using Step = LexedChunk::Step;
 
-        // Remove commas
-        if (rsStr.back() == ',')
-            rsStr.pop_back();
-        if (rtStr.back() == ',')
-            rtStr.pop_back();
+    std::vector<LexedChunk> chunks = lexChunks(assembly, m_jobs);
 
-        int rs = getRegisterNumber(rsStr);
-        int rt = getRegisterNumber(rtStr);
+    std::vector<std::unique_ptr<Instruction>> instructions;
+    std::vector<LabelDefinition>              definitions;
+    std::vector<std::string_view>             pending;  // Labels waiting for their statement
+    const size_t                              firstDirective = dataDirectives.size();
+    uint32_t                                  dataOffset     = 0;
+    bool                                      inDataSection  = false;
 
-        if (rs >= 0 && rt >= 0)
-        {
-            return std::make_unique<DIVUInstruction>(rs, rt);
-        }
-    }
-    else if (opcode == "syscall")
+    size_t instructionCount = 0;
+    for (const LexedChunk& chunk : chunks)
     {
-        // Parse: syscall (no arguments)
-        return std::make_unique<SyscallInstruction>();
+        instructionCount += chunk.instructions.size();
     }
-    else if (opcode == "trap" && tokens.size() >= 2)
-    {
-        // Parse: trap <traptype>
-        std::string trapType = tokens[1];
+    instructions.reserve(instructionCount);
 
-        // Map trap types to trap codes
-        uint32_t trapCode = 0;
-        if (trapType == "print_int")
-        {
-            trapCode = 1;  // Same as syscall 1
-        }
-        else if (trapType == "print_string")
-        {
-            trapCode = 4;  // Same as syscall 4
-        }
-        else if (trapType == "exit")
-        {
-            trapCode = 10;  // Same as syscall 10
-        }
-        else if (trapType == "print_character")
-        {
-            trapCode = 11;  // Same as syscall 11
-        }
-        else
-        {
-            // Try to parse as numeric trap code
-            try
-            {
-                trapCode = static_cast<uint32_t>(std::stoul(trapType));
-            }
-            catch (const std::exception&)
-            {
-                return nullptr;  // Invalid trap type
-            }
-        }
+    size_t firstLine = 0;  // Source line before the chunk's first
+    m_skippedLines.clear();
 
-        return std::make_unique<TrapInstruction>(trapCode);
-    }
-    else if (opcode == "llo" && tokens.size() >= 3)
+    // Replay the chunks in source order, exactly as if the lines were read one by one
+    for (LexedChunk& chunk : chunks)
     {
-        // Parse: llo $rt, immediate
-        std::string rtStr  = tokens[1];
-        std::string immStr = tokens[2];
-
-        // Remove commas
-        if (rtStr.back() == ',')
-            rtStr.pop_back();
-        if (immStr.back() == ',')
-            immStr.pop_back();
-
-        int rt = getRegisterNumber(rtStr);
-        if (rt >= 0)
+        auto label       = chunk.labels.begin();
+        auto directive   = chunk.directives.begin();
+        auto instruction = chunk.instructions.begin();
+        auto invalidLine = chunk.invalidLines.begin();
+        for (Step step : chunk.steps)
         {
-            try
+            switch (step)
             {
-                uint16_t immediate = 0;
-                if (immStr.substr(0, 2) == "0x" || immStr.substr(0, 2) == "0X")
+            case Step::Label:
+                pending.push_back(*label++);
+                break;
+
+            case Step::Directive:
+            case Step::InvalidDirective:
+                // Data follows the text, so addresses stay section-relative for now.
+                // Labels on a directive that does not parse stay undefined.
+                inDataSection = true;
+                if (step == Step::Directive)
                 {
-                    immediate = static_cast<uint16_t>(std::stoul(immStr, nullptr, 16));
+                    for (std::string_view name : pending)
+                    {
+                        definitions.push_back({name, dataOffset, true});
+                    }
+                    directive->address = dataOffset;
+                    dataOffset += directive->size();
+                    dataDirectives.push_back(std::move(*directive++));
                 }
-                else
+                pending.clear();
+                break;
+
+            case Step::DataSection:
+            case Step::TextSection:
+                inDataSection = step == Step::DataSection;
+                break;
+
+            case Step::Instruction:
+                // Instructions after data without a .text are ignored. Labels take the
+                // index of the next instruction that parses; lines that do not parse
+                // are left out and listed in skippedLines().
+                const bool parsed = *instruction != nullptr;
+                if (!inDataSection)
                 {
-                    immediate = static_cast<uint16_t>(std::stoul(immStr));
-                }
-                return std::make_unique<LLOInstruction>(rt, immediate);
-            }
-            catch (const std::exception&)
-            {
-                return nullptr;
-            }
-        }
-    }
-    else if (opcode == "lhi" && tokens.size() >= 3)
-    {
-        // Parse: lhi $rt, immediate
-        std::string rtStr  = tokens[1];
-        std::string immStr = tokens[2];
-
-        // Remove commas
-        if (rtStr.back() == ',')
-            rtStr.pop_back();
-        if (immStr.back() == ',')
-            immStr.pop_back();
-
-        int rt = getRegisterNumber(rtStr);
-        if (rt >= 0)
-        {
-            try
-            {
-                uint16_t immediate = 0;
-                if (immStr.substr(0, 2) == "0x" || immStr.substr(0, 2) == "0X")
-                {
-                    immediate = static_cast<uint16_t>(std::stoul(immStr, nullptr, 16));
+                    const uint32_t address = static_cast<uint32_t>(instructions.size() * 4);
+                    for (std::string_view name : pending)
+                    {
+                        definitions.push_back({name, address, false});
+                    }
+                    pending.clear();
+                    if (parsed)
+                    {
+                        instructions.push_back(std::move(*instruction));
+                    }
+                    else
+                    {
+                        m_skippedLines.push_back(firstLine + *invalidLine);
+                    }
                 }
-                else
+                if (!parsed)
                 {
-                    immediate = static_cast<uint16_t>(std::stoul(immStr));
+                    ++invalidLine;
                 }
-                return std::make_unique<LHIInstruction>(rt, immediate);
-            }
-            catch (const std::exception&)
-            {
-                return nullptr;
+                ++instruction;
+                break;
             }
         }
+        firstLine += chunk.lineCount;
     }
-    else if (opcode == "la" && tokens.size() >= 3)
-    {
-        // Parse: la $rt, label
-        std::string rtStr    = tokens[1];
-        std::string labelStr = tokens[2];
 
-        // Remove commas
-        if (rtStr.back() == ',')
-            rtStr.pop_back();
-        if (labelStr.back() == ',')
-            labelStr.pop_back();
 
-        int rt = getRegisterNumber(rtStr);
-        if (rt >= 0)
-        {
-            // For now, create an LA instruction that will be handled specially
-            // This instruction loads the address of a label into a register
-            return std::make_unique<LAInstruction>(rt, labelStr);
-        }
+    // Trailing labels mark the end of their section
+    for (std::string_view label : pending)
+    {
+        definitions.push_back(
+            {label,
+             inDataSection ? dataOffset : static_cast<uint32_t>(instructions.size() * 4),
+             inDataSection});
     }
 
-    return nullptr;
-}
-
-int Assembler::getRegisterNumber(const std::string& regName)
-{
-    auto it = m_registerMap.find(regName);
-    if (it != m_registerMap.end())
+    // Resolution: the data section starts right after the text
+    const uint32_t dataBase = static_cast<uint32_t>(instructions.size() * 4);
+    for (size_t i = firstDirective; i < dataDirectives.size(); ++i)
     {
-        return it->second;
+        dataDirectives[i].address += dataBase;
     }
-    return -1;  // Invalid register
+    for (const LabelDefinition& definition : definitions)
+    {
+        labelMap[std::string(definition.name)] =
+            definition.offset + (definition.inData ? dataBase : 0);
+    }
+
+    return instructions;
 }
 
-std::string Assembler::trim(const std::string& str)
+std::vector<std::unique_ptr<Instruction>>
+Assembler::assembleWithLabels(std::string_view                 assembly,
+                              std::map<std::string, uint32_t>& labelMap)
 {
-    size_t start = str.find_first_not_of(" \t\r\n");
-    if (start == std::string::npos)
-    {
-        return "";
-    }
-    size_t end = str.find_last_not_of(" \t\r\n");
-    return str.substr(start, end - start + 1);
+    std::vector<DataDirective> dataDirectives;  // Ignored for backward compatibility
+    return assembleWithLabels(assembly, labelMap, dataDirectives);
 }
 
-std::vector<std::string> Assembler::split(const std::string& str, char delimiter)
+const std::vector<size_t>& Assembler::skippedLines() const
 {
-    std::vector<std::string> tokens;
-    std::stringstream        ss(str);
-    std::string              token;
+    return m_skippedLines;
+}
 
-    while (std::getline(ss, token, delimiter))
+std::string Assembler::describeSkippedLines(const std::vector<size_t>& lines)
+{
+    if (lines.empty())
     {
-        tokens.push_back(trim(token));
+        return {};
     }
-
-    return tokens;
+    std::ostringstream text;
+    text << "skipped " << (lines.size() > 1 ? "lines" : "line") << " that did not parse: ";
+    for (size_t i = 0; i < lines.size(); ++i)
+    {
+        text << (i ? ", " : "") << lines[i];
+    }
+    return text.str();
 }
 
-bool Assembler::parseDataDirective(const std::string& line, uint32_t address,
-                                   DataDirective& directive)
+void Assembler::parseLine(std::string_view line, ParsedLine& parsed)
 {
-    std::vector<std::string> tokens;
-    std::istringstream       tokenStream(line);
-    std::string              token;
-    while (tokenStream >> token)
-    {
-        tokens.push_back(token);
-    }
+    parsed.labels.clear();
+    parsed.instruction.reset();
+    parsed.directive.reset();
+    parsed.kind = ParsedLine::NONE;
 
-    if (tokens.empty())
+    SourceLexer lexer(line.substr(0, line.find('\n')));
+    Statement   statement;
+    if (!lexer.next(statement))
     {
-        return false;
+        return;
     }
+    parsed.labels = statement.labels;
 
-    if (tokens[0] == ".word" && tokens.size() >= 2)
+    DataDirective directive(DataDirective::WORD, 0);
+    parsed.kind = parseStatement(statement, parsed.instruction, directive);
+    if (parsed.kind == ParsedLine::DIRECTIVE)
     {
-        directive.type    = DataDirective::WORD;
-        directive.address = address;
-
-        for (size_t i = 1; i < tokens.size(); ++i)
-        {
-            std::string valueStr = tokens[i];
-            // Remove commas
-            if (!valueStr.empty() && valueStr.back() == ',')
-                valueStr.pop_back();
-
-            try
-            {
-                uint32_t value = std::stoul(valueStr, nullptr, 0);  // Support hex/decimal
-                directive.words.push_back(value);
-            }
-            catch (const std::exception&)
-            {
-                return false;
-            }
-        }
-        return true;
+        parsed.directive = std::make_unique<DataDirective>(std::move(directive));
     }
-    else if (tokens[0] == ".byte" && tokens.size() >= 2)
-    {
-        directive.type    = DataDirective::BYTE;
-        directive.address = address;
+}
 
-        for (size_t i = 1; i < tokens.size(); ++i)
-        {
-            std::string valueStr = tokens[i];
-            // Remove commas
-            if (!valueStr.empty() && valueStr.back() == ',')
-                valueStr.pop_back();
+void Assembler::link(std::vector<std::unique_ptr<Instruction>>& instructions,
+                     const std::map<std::string, uint32_t>&     labelMap)
+{
+    std::ostringstream undefined;
+    size_t             undefinedCount = 0;
 
-            try
-            {
-                uint32_t value = std::stoul(valueStr, nullptr, 0);
-                if (value > 255)
-                    return false;  // Invalid byte value
-                directive.bytes.push_back(static_cast<uint8_t>(value));
-            }
-            catch (const std::exception&)
-            {
-                return false;
-            }
-        }
-        return true;
-    }
-    else if (tokens[0] == ".asciiz" && tokens.size() >= 2)
+    for (size_t i = 0; i < instructions.size(); ++i)
     {
-        directive.type    = DataDirective::ASCIIZ;
-        directive.address = address;
-
-        // Reconstruct the string (handle quoted strings)
-        std::string fullLine   = line;
-        size_t      firstQuote = fullLine.find('"');
-        size_t      lastQuote  = fullLine.rfind('"');
-
-        if (firstQuote != std::string::npos && lastQuote != std::string::npos &&
-            firstQuote != lastQuote)
+        std::string label;
+        if (instructions[i] && !instructions[i]->link(labelMap, label))
         {
-            std::string str = fullLine.substr(firstQuote + 1, lastQuote - firstQuote - 1);
-
-            // Convert string to bytes
-            for (char c : str)
-            {
-                directive.bytes.push_back(static_cast<uint8_t>(c));
-            }
-            // Add null terminator
-            directive.bytes.push_back(0);
-            return true;
+            undefined << (undefinedCount++ ? ", " : "") << "'" << label << "' (instruction " << i
+                      << ")";
         }
     }
 
-    return false;
+    if (undefinedCount > 0)
+    {
+        throw std::runtime_error("Undefined label" + std::string(undefinedCount > 1 ? "s" : "") +
+                                 ": " + undefined.str());
+    }
 }
 
 }  // namespace mips
@@ -3,6 +3,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace mips
@@ -28,22 +29,75 @@ struct DataDirective
     std::vector<uint8_t>  bytes;  // For .byte and .asciiz directives
 
     DataDirective(Type t, uint32_t addr) : type(t), address(addr) {}
+
+    // Bytes the directive occupies; byte data is padded to a whole word
+    uint32_t size() const
+    {
+        return type == WORD ? static_cast<uint32_t>(words.size() * 4)
+                            : (static_cast<uint32_t>(bytes.size()) + 3) & ~3u;
+    }
+};
+
+/**
+ * @brief One source line, lexed and parsed but not yet placed in a section
+ *
+ * Placement (label addresses, which instructions land in the text) depends on the
+ * lines before it; see Assembler::assembleWithLabels.
+ */
+struct ParsedLine
+{
+    enum Kind
+    {
+        NONE,               // Blank, comment, labels only or a directive with no effect
+        INSTRUCTION,        // instruction is nullptr if the line did not parse
+        DIRECTIVE,          // Data directive, with a section-relative address of 0
+        INVALID_DIRECTIVE,  // Data directive that did not parse
+        DATA_SECTION,       // .data
+        TEXT_SECTION        // .text
+    };
+
+    Kind                           kind = NONE;
+    std::vector<std::string_view>  labels;  // Views of the line, without the colons
+    std::unique_ptr<Instruction>   instruction;
+    std::unique_ptr<DataDirective> directive;
 };
 
 /**
  * @brief Simple assembler for MIPS instructions
+ *
+ * The source is read in a single pass. Each line is lexed in place into views of
+ * the source (labels, mnemonic, operands), so no line or token is copied, and
+ * parsed straight away. Labels are recorded relative to their section as they are
+ * defined; the data section starts where the text ends, so data labels and
+ * directives are patched with its base once, after the last line. Symbolic
+ * operands are resolved by link(). Assembly time is linear in the source size.
+ * The source is any view, e.g. a MappedFile of the .asm file, and is not referenced
+ * after the call returns, so it never needs copying into a std::string first.
+ *
+ * assembleWithLabels() can use several threads for large sources (a MiB or more).
+ * The source is cut at line boundaries into chunks that are lexed and parsed
+ * concurrently; labels, sections and data are then placed by replaying the chunks
+ * in source order, so the output is identical to a single-threaded run.
  */
 class Assembler
 {
   public:
-    Assembler();
+    // Bump whenever the same source assembles to a different program; keys ProgramCache
+    static constexpr uint32_t VERSION = 2;
+
+    Assembler() = default;  // Mnemonic and register tables are built at compile time
+
+    /**
+     * @param jobs Threads for assembleWithLabels(); 0 means one per hardware thread
+     */
+    explicit Assembler(unsigned jobs) : m_jobs(jobs) {}
 
     /**
      * @brief Parse assembly code and return list of instructions
      * @param assembly Assembly code as string
      * @return Vector of parsed instructions
      */
-    std::vector<std::unique_ptr<Instruction>> assemble(const std::string& assembly);
+    std::vector<std::unique_ptr<Instruction>> assemble(std::string_view assembly);
 
     /**
      * @brief Parse assembly code with label support and return instructions + label map
@@ -52,46 +106,51 @@ class Assembler
      * @return Vector of parsed instructions
      */
     std::vector<std::unique_ptr<Instruction>>
-    assembleWithLabels(const std::string& assembly, std::map<std::string, uint32_t>& labelMap);
+    assembleWithLabels(std::string_view assembly, std::map<std::string, uint32_t>& labelMap);
 
     /**
      * @brief Parse assembly code with label support and return instructions + label map + data
      * @param assembly Assembly code as string
      * @param[out] labelMap Map of label names to instruction addresses
      * @param[out] dataDirectives Vector of data directives for memory initialization
-     * @return Vector of parsed instructions
+     * @return Vector of parsed instructions; text-section lines that do not parse are
+     *         left out and listed in skippedLines()
      */
     std::vector<std::unique_ptr<Instruction>>
-    assembleWithLabels(const std::string& assembly, std::map<std::string, uint32_t>& labelMap,
+    assembleWithLabels(std::string_view assembly, std::map<std::string, uint32_t>& labelMap,
                        std::vector<DataDirective>& dataDirectives);
 
-  private:
-    std::map<std::string, int> m_registerMap;
-
     /**
-     * @brief Parse a single instruction line
+     * @brief 1-based lines the last assembleWithLabels() left out, in source order
      */
-    std::unique_ptr<Instruction> parseInstruction(const std::string& line);
+    const std::vector<size_t>& skippedLines() const;
 
     /**
-     * @brief Parse a data directive line
+     * @brief Warning text for skipped lines, empty if there are none
      */
-    bool parseDataDirective(const std::string& line, uint32_t address, DataDirective& directive);
+    static std::string describeSkippedLines(const std::vector<size_t>& lines);
 
     /**
-     * @brief Get register number from name
+     * @brief Lex and parse a single line (no newline) without placing it
      */
-    int getRegisterNumber(const std::string& regName);
+    static void parseLine(std::string_view line, ParsedLine& parsed);
 
     /**
-     * @brief Trim whitespace from string
+     * @brief Link phase: resolve every symbolic operand against the final label table
+     *
+     * Branch, jump and LA targets are stored in the instructions as integer addresses
+     * so execution never has to look labels up by name.
+     *
+     * @param instructions Instructions returned by assembleWithLabels
+     * @param labelMap Label table returned by assembleWithLabels
+     * @throws std::runtime_error listing every reference to an undefined label
      */
-    std::string trim(const std::string& str);
+    static void link(std::vector<std::unique_ptr<Instruction>>& instructions,
+                     const std::map<std::string, uint32_t>&     labelMap);
 
-    /**
-     * @brief Split string by delimiter
-     */
-    std::vector<std::string> split(const std::string& str, char delimiter);
+  private:
+    unsigned            m_jobs = 1;
+    std::vector<size_t> m_skippedLines;  // By the last assembleWithLabels()
 };
 
 }  // namespace mips
@@ -0,0 +1,346 @@
+#include "AssemblySession.h"
+#include "InstructionArena.h"
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+
+namespace mips
+{
+
+AssemblySession::AssemblySession() : m_lines(1) {}
+
+const AssembledProgram& AssemblySession::edit(size_t firstLine, size_t lineCount,
+                                              std::string_view text)
+{
+    if (firstLine > m_lines.size() || lineCount > m_lines.size() - firstLine)
+    {
+        throw std::out_of_range("edit past the last line");
+    }
+    const size_t offset = lineOffset(firstLine);
+    replace(offset, lineOffset(firstLine + lineCount) - offset, text);
+    return checked();
+}
+
+const AssembledProgram& AssemblySession::update(std::string_view source)
+{
+    const std::string_view old   = m_source;
+    const size_t           limit = std::min(old.size(), source.size());
+
+    size_t prefix = 0;
+    while (prefix < limit && old[prefix] == source[prefix])
+    {
+        ++prefix;
+    }
+    size_t suffix = 0;
+    while (suffix < limit - prefix &&
+           old[old.size() - 1 - suffix] == source[source.size() - 1 - suffix])
+    {
+        ++suffix;
+    }
+
+    if (prefix != old.size() || old.size() != source.size())
+    {
+        replace(prefix, old.size() - prefix - suffix,
+                source.substr(prefix, source.size() - prefix - suffix));
+    }
+    return checked();
+}
+
+const AssembledProgram& AssemblySession::program() const
+{
+    return m_program;
+}
+
+const std::string& AssemblySession::source() const
+{
+    return m_source;
+}
+
+size_t AssemblySession::lineCount() const
+{
+    return m_lines.size();
+}
+
+size_t AssemblySession::lastParsedLines() const
+{
+    return m_lastParsedLines;
+}
+
+void AssemblySession::replace(size_t offset, size_t length, std::string_view text)
+{
+    // Every line that overlaps the replaced bytes is parsed again, including the
+    // line the replacement runs into when it does not end in a newline
+    const auto   begin     = m_source.begin();
+    const size_t firstLine = std::count(begin, begin + offset, '\n');
+    const size_t lastLine  = firstLine + std::count(begin + offset, begin + offset + length, '\n');
+    const size_t lineStart = offset == 0 ? 0 : m_source.rfind('\n', offset - 1) + 1;
+
+    m_source.replace(offset, length, text);
+    size_t lineEnd = m_source.find('\n', offset + text.size());
+    if (lineEnd == std::string::npos)
+    {
+        lineEnd = m_source.size();
+    }
+
+    std::vector<Line> lines;
+    parseLines(lineStart, lineEnd, lines);
+    m_lastParsedLines = lines.size();
+
+    // Lines removed here that hold a placed instruction leave it in the old list,
+    // which place() drops
+    const auto first = m_lines.begin() + static_cast<std::ptrdiff_t>(firstLine);
+    const auto last  = m_lines.begin() + static_cast<std::ptrdiff_t>(lastLine + 1);
+    if (last - first == static_cast<std::ptrdiff_t>(lines.size()))
+    {
+        std::move(lines.begin(), lines.end(), first);
+    }
+    else
+    {
+        m_lines.insert(m_lines.erase(first, last), std::make_move_iterator(lines.begin()),
+                       std::make_move_iterator(lines.end()));
+    }
+
+    place();
+    relink();
+}
+
+void AssemblySession::parseLines(size_t offset, size_t end, std::vector<Line>& lines)
+{
+    static const LabelMap NO_LABELS;
+
+    InstructionArena::Scope arena;  // The edit's instructions, side by side
+    ParsedLine              parsed;
+    while (true)
+    {
+        size_t lineEnd = m_source.find('\n', offset);
+        if (lineEnd == std::string::npos || lineEnd > end)
+        {
+            lineEnd = end;
+        }
+        Assembler::parseLine(std::string_view(m_source).substr(offset, lineEnd - offset), parsed);
+
+        Line& line       = lines.emplace_back();
+        line.kind        = parsed.kind;
+        line.instruction = std::move(parsed.instruction);
+        line.directive   = std::move(parsed.directive);
+        for (std::string_view label : parsed.labels)
+        {
+            line.labels.push_back(labelId(label));
+        }
+        if (line.instruction)
+        {
+            // Linking against an empty table names the label the instruction uses
+            std::string label;
+            if (!line.instruction->link(NO_LABELS, label))
+            {
+                line.reference = labelId(label);
+            }
+            line.fresh = true;
+        }
+
+        if (lineEnd == end)
+        {
+            break;
+        }
+        offset = lineEnd + 1;
+    }
+}
+
+size_t AssemblySession::lineOffset(size_t line) const
+{
+    size_t offset = 0;
+    for (size_t i = 0; i < line; ++i)
+    {
+        offset = m_source.find('\n', offset);
+        if (offset == std::string::npos)
+        {
+            return m_source.size();  // Past the last line
+        }
+        ++offset;
+    }
+    return offset;
+}
+
+uint32_t AssemblySession::labelId(std::string_view name)
+{
+    auto [it, inserted] =
+        m_labelIds.try_emplace(std::string(name), static_cast<uint32_t>(m_labels.size()));
+    if (inserted)
+    {
+        m_labels.push_back({it->first});
+    }
+    return it->second;
+}
+
+void AssemblySession::place()
+{
+    using InstructionList = AssembledProgram::InstructionList;
+
+    // A list nobody else holds gives up its instructions; one still shared with a Cpu
+    // is left intact and its instructions are copied
+    const bool              exclusive = m_program.instructions.use_count() == 1;
+    InstructionList&        previous  = const_cast<InstructionList&>(*m_program.instructions);
+    InstructionArena::Scope arena;  // For the copies
+
+    auto instructions = std::make_shared<InstructionList>();
+    instructions->reserve(previous.size() + m_lastParsedLines);
+    std::vector<DataDirective> dataDirectives;
+
+    // Same placement rules as Assembler::assembleWithLabels. A label defined more than
+    // once takes its last address.
+    std::vector<uint32_t> offsets(m_labels.size());
+    std::vector<uint8_t>  sections(m_labels.size(), 0);  // 0 undefined, 1 text, 2 data
+    std::vector<uint32_t> pending;
+    uint32_t              dataOffset    = 0;
+    bool                  inDataSection = false;
+
+    auto define = [&](uint32_t offset, bool inData)
+    {
+        for (uint32_t id : pending)
+        {
+            offsets[id]  = offset;
+            sections[id] = inData ? 2 : 1;
+        }
+        pending.clear();
+    };
+
+    for (Line& line : m_lines)
+    {
+        pending.insert(pending.end(), line.labels.begin(), line.labels.end());
+        switch (line.kind)
+        {
+        case ParsedLine::NONE:
+            break;
+
+        case ParsedLine::DIRECTIVE:
+            inDataSection = true;
+            define(dataOffset, true);
+            dataDirectives.push_back(*line.directive);
+            dataDirectives.back().address = dataOffset;
+            dataOffset += line.directive->size();
+            break;
+
+        case ParsedLine::INVALID_DIRECTIVE:
+            inDataSection = true;
+            pending.clear();
+            break;
+
+        case ParsedLine::DATA_SECTION:
+        case ParsedLine::TEXT_SECTION:
+            inDataSection = line.kind == ParsedLine::DATA_SECTION;
+            break;
+
+        case ParsedLine::INSTRUCTION:
+        {
+            std::unique_ptr<Instruction> instruction = std::move(line.instruction);
+            if (line.index != UNPLACED)
+            {
+                instruction = exclusive ? std::move(previous[line.index])
+                                        : previous[line.index]->clone();
+            }
+            line.index = UNPLACED;
+
+            if (inDataSection)
+            {
+                line.instruction = std::move(instruction);  // Kept in case it moves back
+                break;
+            }
+            define(static_cast<uint32_t>(instructions->size() * 4), false);
+            if (instruction)
+            {
+                line.index = static_cast<uint32_t>(instructions->size());
+                instructions->push_back(std::move(instruction));
+            }
+            break;
+        }
+        }
+    }
+    define(inDataSection ? dataOffset : static_cast<uint32_t>(instructions->size() * 4),
+           inDataSection);
+
+    // The data section starts right after the text
+    const uint32_t dataBase = static_cast<uint32_t>(instructions->size() * 4);
+    for (DataDirective& directive : dataDirectives)
+    {
+        directive.address += dataBase;
+    }
+
+    m_labelChanged.assign(m_labels.size(), 0);
+    for (size_t id = 0; id < m_labels.size(); ++id)
+    {
+        Label&         label   = m_labels[id];
+        const bool     defined = sections[id] != 0;
+        const uint32_t address = offsets[id] + (sections[id] == 2 ? dataBase : 0);
+        if (defined == label.defined && (!defined || address == label.address))
+        {
+            continue;
+        }
+        label.defined      = defined;
+        label.address      = address;
+        m_labelChanged[id] = 1;
+        if (defined)
+        {
+            m_program.labelMap.insert_or_assign(label.name, address);
+        }
+        else
+        {
+            m_program.labelMap.erase(label.name);
+        }
+    }
+
+    m_program.instructions   = std::move(instructions);
+    m_program.dataDirectives = std::move(dataDirectives);
+}
+
+void AssemblySession::relink()
+{
+    std::ostringstream undefined;
+    size_t             undefinedCount = 0;
+
+    for (Line& line : m_lines)
+    {
+        if (line.kind != ParsedLine::INSTRUCTION)
+        {
+            continue;
+        }
+        Instruction* instruction = line.index != UNPLACED
+                                       ? (*m_program.instructions)[line.index].get()
+                                       : line.instruction.get();
+        if (instruction == nullptr)
+        {
+            continue;
+        }
+
+        if (line.fresh || (line.reference != NO_LABEL && m_labelChanged[line.reference]))
+        {
+            std::string label;
+            line.unresolved = !instruction->link(m_program.labelMap, label);
+            line.fresh      = false;
+        }
+        if (line.unresolved && line.index != UNPLACED)
+        {
+            undefined << (undefinedCount++ ? ", " : "") << "'" << m_labels[line.reference].name
+                      << "' (instruction " << line.index << ")";
+        }
+    }
+
+    m_undefined.clear();
+    if (undefinedCount > 0)
+    {
+        m_undefined = "Undefined label" + std::string(undefinedCount > 1 ? "s" : "") + ": " +
+                      undefined.str();
+    }
+}
+
+const AssembledProgram& AssemblySession::checked() const
+{
+    if (!m_undefined.empty())
+    {
+        throw std::runtime_error(m_undefined);
+    }
+    return m_program;
+}
+
+}  // namespace mips
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "Assembler.h"
+#include "Instruction.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace mips
+{
+
+/**
+ * @brief A linked program as Assembler::assembleWithLabels and link() produce it
+ *
+ * The instruction list is immutable once published, so a Cpu can share it
+ * (Cpu::loadAssembledProgram) while the session that produced it moves on.
+ */
+struct AssembledProgram
+{
+    using InstructionList = std::vector<std::unique_ptr<Instruction>>;
+
+    std::shared_ptr<const InstructionList> instructions = std::make_shared<InstructionList>();
+    LabelMap                               labelMap;
+    std::vector<DataDirective>             dataDirectives;
+};
+
+/**
+ * @brief Incremental assembler for a buffer that is edited and reloaded, e.g. in an editor
+ *
+ * The session keeps every source line's parse result and only parses the lines an
+ * edit touches. Placement (label addresses, which instructions land in the text,
+ * data addresses) is then replayed over the stored results without parsing, label
+ * addresses are compared with the previous ones, and only the instructions that
+ * reference a label whose address changed are linked again.
+ *
+ * The published instruction list is copy-on-write: while a Cpu (or a fork) still
+ * holds the previous program, the next edit copies the surviving instructions
+ * instead of moving them, so a published program never changes.
+ *
+ * The program always equals what Assembler::assembleWithLabels followed by
+ * Assembler::link would produce for source().
+ */
+class AssemblySession
+{
+  public:
+    AssemblySession();  // Empty buffer; load one with update()
+
+    /**
+     * @brief Replace whole lines and reassemble what they affect
+     *
+     * Lines are separated by '\n'. The lines [firstLine, firstLine + lineCount),
+     * each with its newline, are replaced by text, which should normally end in
+     * '\n' itself; lineCount 0 inserts text before firstLine.
+     * @return The updated program
+     * @throws std::out_of_range if the lines are past the end of the buffer
+     * @throws std::runtime_error listing every reference to an undefined label, as
+     *         Assembler::link does (the edit is still applied)
+     */
+    const AssembledProgram& edit(size_t firstLine, size_t lineCount, std::string_view text);
+
+    /**
+     * @brief Replace the whole buffer, reassembling only the lines that differ
+     *
+     * The edit is the span between the longest common prefix and suffix of the
+     * old and new buffers, so typing in an editor reparses a line or two.
+     * @return The updated program
+     * @throws std::runtime_error on undefined labels, as edit() does
+     */
+    const AssembledProgram& update(std::string_view source);
+
+    const AssembledProgram& program() const;
+    const std::string&      source() const;
+    size_t                  lineCount() const;
+
+    /**
+     * @brief Number of lines parsed by the last edit, for diagnostics and tests
+     */
+    size_t lastParsedLines() const;
+
+  private:
+    static constexpr uint32_t NO_LABEL = UINT32_MAX;
+    static constexpr uint32_t UNPLACED = UINT32_MAX;
+
+    struct Line
+    {
+        std::vector<uint32_t>          labels;       // Ids of the labels it defines
+        std::unique_ptr<Instruction>   instruction;  // Held here only while unplaced
+        std::unique_ptr<DataDirective> directive;    // Section-relative address 0
+        uint32_t                       index      = UNPLACED;  // Position in the program
+        uint32_t                       reference  = NO_LABEL;  // Id of the label it uses
+        ParsedLine::Kind               kind       = ParsedLine::NONE;
+        bool                           fresh      = false;  // Parsed by this edit, not yet linked
+        bool                           unresolved = false;  // Its last link failed
+    };
+
+    struct Label
+    {
+        std::string name;
+        uint32_t    address = 0;
+        bool        defined = false;
+    };
+
+    void                    replace(size_t offset, size_t length, std::string_view text);
+    void                    parseLines(size_t offset, size_t end, std::vector<Line>& lines);
+    size_t                  lineOffset(size_t line) const;
+    uint32_t                labelId(std::string_view name);
+    void                    place();
+    void                    relink();
+    const AssembledProgram& checked() const;
+
+    std::string                               m_source;
+    std::vector<Line>                         m_lines;   // One per '\n'-separated line
+    std::vector<Label>                        m_labels;  // Indexed by label id
+    std::unordered_map<std::string, uint32_t> m_labelIds;
+    std::vector<uint8_t>                      m_labelChanged;  // By id, set by place()
+    std::string                               m_undefined;     // link()'s error, if any
+    AssembledProgram                          m_program;
+    size_t                                    m_lastParsedLines = 0;
+};
+
+}  // namespace mips
@@ -0,0 +1,140 @@
+#include "BlockCache.h"
+
+namespace mips
+{
+
+namespace
+{
+
+// Branches and direct jumps whose target is known before execution
+bool hasStaticTarget(DecodedOp op)
+{
+    switch (op)
+    {
+    case DecodedOp::Beq:
+    case DecodedOp::Bne:
+    case DecodedOp::Blez:
+    case DecodedOp::Bgtz:
+    case DecodedOp::J:
+    case DecodedOp::Jal:
+        return true;
+    default:
+        return false;
+    }
+}
+
+}  // namespace
+
+bool BlockCache::endsBlock(DecodedOp op)
+{
+    return hasStaticTarget(op) || op == DecodedOp::Jr || op == DecodedOp::Jalr ||
+           op == DecodedOp::Fallback;
+}
+
+void BlockCache::build(const std::vector<DecodedInstr>& program)
+{
+    m_ownLeaders = findLeaders(program);
+    build(program, m_ownLeaders);
+}
+
+void BlockCache::build(const std::vector<DecodedInstr>& program,
+                       const std::vector<uint8_t>&      leaders)
+{
+    if (&leaders != &m_ownLeaders)
+    {
+        m_ownLeaders.clear();
+    }
+    m_program = &program;
+    m_leaders = &leaders;
+    m_blocks.clear();
+    m_blockAt.clear();
+}
+
+std::vector<uint8_t> BlockCache::findLeaders(const std::vector<DecodedInstr>& program)
+{
+    std::vector<uint8_t> leaders(program.size(), 0);
+    if (program.empty())
+    {
+        return leaders;
+    }
+
+    leaders[0] = 1;
+    for (size_t pc = 0; pc < program.size(); ++pc)
+    {
+        const DecodedInstr& d = program[pc];
+        if (hasStaticTarget(d.op) && d.target < program.size())
+        {
+            leaders[d.target] = 1;
+        }
+        if (endsBlock(d.op) && pc + 1 < program.size())
+        {
+            leaders[pc + 1] = 1;
+        }
+    }
+    return leaders;
+}
+
+void BlockCache::clear()
+{
+    m_program = nullptr;
+    m_leaders = nullptr;
+    m_ownLeaders.clear();
+    m_blockAt.clear();
+    m_blocks.clear();
+}
+
+int32_t BlockCache::blockAt(uint32_t pc)
+{
+    if (m_blockAt.empty())
+    {
+        m_blockAt.assign(m_program->size(), NO_BLOCK);
+    }
+    int32_t index = m_blockAt[pc];
+    if (index != NO_BLOCK)
+    {
+        return index;
+    }
+
+    const std::vector<DecodedInstr>& program = *m_program;
+
+    BasicBlock block;
+    block.start = pc;
+    uint32_t end = pc;
+    while (true)
+    {
+        const DecodedInstr& d = program[end++];
+        if (endsBlock(d.op))
+        {
+            block.takenTarget    = hasStaticTarget(d.op) ? d.target : BasicBlock::NO_TARGET;
+            block.endsInFallback = d.op == DecodedOp::Fallback;
+            break;
+        }
+        if (end >= program.size() || (*m_leaders)[end])
+        {
+            break;
+        }
+    }
+    block.length = end - pc;
+
+    index = static_cast<int32_t>(m_blocks.size());
+    m_blocks.push_back(block);
+    m_blockAt[pc] = index;
+    return index;
+}
+
+BasicBlock& BlockCache::block(int32_t index)
+{
+    return m_blocks[static_cast<size_t>(index)];
+}
+
+size_t BlockCache::blockCount() const
+{
+    return m_blocks.size();
+}
+
+bool BlockCache::isLeader(uint32_t pc) const
+{
+    return m_leaders != nullptr && pc < m_leaders->size() && (*m_leaders)[pc] != 0;
+}
+
+}  // namespace mips
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "DecodedInstruction.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace mips
+{
+
+/**
+ * @brief A straight-line run of pre-decoded instructions with a single entry
+ *
+ * Only the last instruction may transfer control (branch, jump, syscall, trap);
+ * every other instruction falls through to the next one.
+ */
+struct BasicBlock
+{
+    static constexpr uint32_t NO_TARGET = UINT32_MAX;
+
+    uint32_t start                = 0;          // Index of the first instruction
+    uint32_t length               = 0;          // Number of instructions, always >= 1
+    uint32_t takenTarget          = NO_TARGET;  // Static target of the final branch/jump
+    int32_t  takenSuccessor       = -1;         // Chained block at takenTarget, -1 until used
+    int32_t  fallthroughSuccessor = -1;         // Chained block at start + length, -1 until used
+    bool     endsInFallback       = false;      // Ends with an out-of-line (syscall/trap) record
+};
+
+/**
+ * @brief Lazily built cache of basic blocks over a pre-decoded program
+ *
+ * Leaders are the program entry, every static branch/jump target and every
+ * instruction following a control-flow instruction. Blocks are formed the first
+ * time execution reaches their start; an indirect jump into the middle of an
+ * existing block simply creates a new block starting there.
+ */
+class BlockCache
+{
+  public:
+    static constexpr int32_t NO_BLOCK = -1;
+
+    /**
+     * @brief Discard all blocks and compute leaders for a new program
+     * @param program Pre-decoded program; must outlive the cache or the next build()
+     */
+    void build(const std::vector<DecodedInstr>& program);
+
+    /**
+     * @brief Discard all blocks and start over on a program whose leaders are known
+     * @param program Pre-decoded program; must outlive the cache or the next build()
+     * @param leaders findLeaders(program); must live as long as program
+     *
+     * Costs nothing in the size of the program, so a shared ProgramImage is attached
+     * without a pass over it.
+     */
+    void build(const std::vector<DecodedInstr>& program, const std::vector<uint8_t>& leaders);
+
+    /**
+     * @brief One flag per instruction, set where a basic block must start
+     */
+    static std::vector<uint8_t> findLeaders(const std::vector<DecodedInstr>& program);
+
+    /**
+     * @brief Discard all blocks and the program reference
+     */
+    void clear();
+
+    /**
+     * @brief Get (forming it if necessary) the block starting at an instruction index
+     * @param pc Instruction index, must be inside the program
+     */
+    int32_t blockAt(uint32_t pc);
+
+    BasicBlock& block(int32_t index);
+
+    /**
+     * @brief Number of blocks formed so far
+     */
+    size_t blockCount() const;
+
+    bool isLeader(uint32_t pc) const;
+
+    /**
+     * @brief Whether an operation ends a basic block
+     */
+    static bool endsBlock(DecodedOp op);
+
+  private:
+    const std::vector<DecodedInstr>* m_program = nullptr;
+    const std::vector<uint8_t>*      m_leaders = nullptr;  // One flag per instruction
+    std::vector<uint8_t>             m_ownLeaders;         // When build() found them itself
+    std::vector<int32_t>             m_blockAt;  // Block at each index or NO_BLOCK, sized lazily
+    std::vector<BasicBlock>          m_blocks;
+};
+
+}  // namespace mips
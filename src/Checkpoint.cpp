@@ -0,0 +1,255 @@
+#include "Checkpoint.h"
+#include "Memory.h"
+#include <algorithm>
+#include <cstring>
+#include <istream>
+#include <iterator>
+#include <ostream>
+
+namespace mips
+{
+
+namespace
+{
+
+constexpr char     MAGIC[8]     = {'M', 'I', 'P', 'S', 'C', 'K', 'P', 'T'};
+constexpr uint64_t FNV_OFFSET   = 0xCBF29CE484222325ull;
+constexpr uint64_t FNV_PRIME    = 0x100000001B3ull;
+constexpr size_t   HEADER_BYTES = sizeof(MAGIC) + 4 + 4;  // Magic, version, page size
+
+uint64_t fnv1a(const char* data, size_t size, uint64_t hash = FNV_OFFSET)
+{
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= static_cast<uint8_t>(data[i]);
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+void put(std::string& out, uint64_t value, size_t bytes)
+{
+    for (size_t i = 0; i < bytes; ++i)
+    {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+void putBytes(std::string& out, const std::string& bytes)
+{
+    put(out, bytes.size(), 8);
+    out += bytes;
+}
+
+// Bounds-checked little-endian reader over the checkpoint body
+class Reader
+{
+  public:
+    Reader(const std::string& data, size_t end) : m_data(data), m_end(end) {}
+
+    bool get(uint64_t& value, size_t bytes)
+    {
+        if (m_end - m_pos < bytes)
+        {
+            return false;
+        }
+        value = 0;
+        for (size_t i = 0; i < bytes; ++i)
+        {
+            value |= static_cast<uint64_t>(static_cast<uint8_t>(m_data[m_pos + i])) << (8 * i);
+        }
+        m_pos += bytes;
+        return true;
+    }
+
+    bool get32(uint32_t& value)
+    {
+        uint64_t wide;
+        if (!get(wide, 4))
+        {
+            return false;
+        }
+        value = static_cast<uint32_t>(wide);
+        return true;
+    }
+
+    bool getBytes(std::string& bytes)
+    {
+        uint64_t size;
+        if (!get(size, 8) || m_end - m_pos < size)
+        {
+            return false;
+        }
+        bytes.assign(m_data, m_pos, size);
+        m_pos += size;
+        return true;
+    }
+
+    Reader& skip(size_t bytes)
+    {
+        m_pos += std::min(bytes, m_end - m_pos);
+        return *this;
+    }
+
+    const char* take(size_t bytes)
+    {
+        if (m_end - m_pos < bytes)
+        {
+            return nullptr;
+        }
+        const char* data = m_data.data() + m_pos;
+        m_pos += bytes;
+        return data;
+    }
+
+    bool atEnd() const
+    {
+        return m_pos == m_end;
+    }
+
+  private:
+    const std::string& m_data;
+    size_t             m_end;
+    size_t             m_pos = 0;
+};
+
+}  // namespace
+
+void Checkpoint::write(std::ostream& out, const CpuSnapshot& state, uint64_t programFingerprint)
+{
+    std::string data(MAGIC, sizeof(MAGIC));
+    put(data, VERSION, 4);
+    put(data, Memory::PAGE_SIZE, 4);
+    put(data, programFingerprint, 8);
+
+    for (uint32_t value : state.registers)
+    {
+        put(data, value, 4);
+    }
+    put(data, state.hi, 4);
+    put(data, state.lo, 4);
+    put(data, state.pc, 4);
+    put(data, state.cycleCount, 8);
+    put(data, state.retiredCount, 8);
+    put(data, state.terminated ? 1 : 0, 1);
+    put(data, state.heapBreak, 4);
+    put(data, state.inputPosition, 8);
+    putBytes(data, state.consoleInput.str());
+    putBytes(data, state.consoleOutput.str());
+
+    const size_t countOffset = data.size();
+    uint32_t     pageCount   = 0;
+    put(data, 0, 4);  // Patched below
+    if (state.memory)
+    {
+        for (const Memory::DirtyPage& page : state.memory->dirtyPages())
+        {
+            if (std::all_of(page.data, page.data + Memory::PAGE_SIZE,
+                            [](uint8_t byte) { return byte == 0; }))
+            {
+                continue;
+            }
+            put(data, page.address, 4);
+            data.append(reinterpret_cast<const char*>(page.data), Memory::PAGE_SIZE);
+            ++pageCount;
+        }
+    }
+    for (size_t i = 0; i < 4; ++i)
+    {
+        data[countOffset + i] = static_cast<char>((pageCount >> (8 * i)) & 0xFF);
+    }
+
+    put(data, fnv1a(data.data(), data.size()), 8);
+    out.write(data.data(), static_cast<std::streamsize>(data.size()));
+}
+
+bool Checkpoint::read(std::istream& in, CpuSnapshot& state, uint64_t& programFingerprint,
+                      std::string& error)
+{
+    const std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    if (data.size() < HEADER_BYTES + 8 || std::memcmp(data.data(), MAGIC, sizeof(MAGIC)) != 0)
+    {
+        error = "not a checkpoint file";
+        return false;
+    }
+
+    // The checksum covers everything before it, so verify it before trusting any field
+    const size_t body     = data.size() - 8;
+    uint64_t     checksum = 0;
+    Reader(data, data.size()).skip(body).get(checksum, 8);
+
+    Reader   fields(data, body);
+    uint32_t version  = 0;
+    uint32_t pageSize = 0;
+    fields.skip(sizeof(MAGIC)).get32(version);
+    fields.get32(pageSize);
+    if (version != VERSION)
+    {
+        error = "unsupported checkpoint version " + std::to_string(version);
+        return false;
+    }
+    if (checksum != fnv1a(data.data(), body))
+    {
+        error = "checkpoint is corrupt (checksum mismatch)";
+        return false;
+    }
+    if (pageSize != Memory::PAGE_SIZE)
+    {
+        error = "checkpoint page size " + std::to_string(pageSize) + " does not match";
+        return false;
+    }
+
+    uint64_t    terminated    = 0;
+    uint64_t    inputPosition = 0;
+    std::string consoleInput;
+    std::string consoleOutput;
+    uint32_t    pageCount     = 0;
+    bool        ok            = fields.get(programFingerprint, 8);
+    for (uint32_t& value : state.registers)
+    {
+        ok = ok && fields.get32(value);
+    }
+    ok = ok && fields.get32(state.hi) && fields.get32(state.lo) && fields.get32(state.pc) &&
+         fields.get(state.cycleCount, 8) && fields.get(state.retiredCount, 8) &&
+         fields.get(terminated, 1) && fields.get32(state.heapBreak) &&
+         fields.get(inputPosition, 8) && fields.getBytes(consoleInput) &&
+         fields.getBytes(consoleOutput) && fields.get32(pageCount);
+    if (!ok)
+    {
+        error = "checkpoint is truncated";
+        return false;
+    }
+    state.terminated    = terminated != 0;
+    state.inputPosition = static_cast<size_t>(inputPosition);
+    state.consoleInput  = ConsoleText(std::move(consoleInput));
+    state.consoleOutput = ConsoleText(std::move(consoleOutput));
+
+    auto memory = std::make_shared<Memory>();
+    for (uint32_t i = 0; i < pageCount; ++i)
+    {
+        uint32_t    address = 0;
+        const char* page    = fields.get32(address) ? fields.take(Memory::PAGE_SIZE) : nullptr;
+        if (page == nullptr || address % Memory::PAGE_SIZE != 0)
+        {
+            error = "checkpoint has a malformed memory page";
+            return false;
+        }
+        memory->writePage(address, reinterpret_cast<const uint8_t*>(page));
+    }
+    if (!fields.atEnd())
+    {
+        error = "checkpoint has trailing data";
+        return false;
+    }
+
+    state.memory = std::move(memory);
+    return true;
+}
+
+uint64_t Checkpoint::fingerprint(std::string_view source)
+{
+    return fnv1a(source.data(), source.size());
+}
+
+}  // namespace mips
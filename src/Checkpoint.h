@@ -0,0 +1,53 @@
+#pragma once
+
+#include "Cpu.h"
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+
+namespace mips
+{
+
+/**
+ * @brief Versioned binary serialisation of a CpuSnapshot
+ *
+ * Layout (all integers little-endian):
+ *   "MIPSCKPT", u32 version, u32 page size, u64 program fingerprint,
+ *   u32 registers[32], u32 hi, u32 lo, u32 pc, u64 cycles, u64 retired,
+ *   u8 terminated, u32 heap break, u64 input position,
+ *   u64 length + console input bytes, u64 length + console output bytes,
+ *   u32 page count, then per page u32 address + Memory::PAGE_SIZE bytes,
+ *   u64 FNV-1a checksum of everything before it.
+ *
+ * Only dirty pages are stored, and dirty pages that are all zeros are skipped,
+ * since every other page of a restored Memory reads as zero anyway.
+ */
+class Checkpoint
+{
+  public:
+    static constexpr uint32_t VERSION = 1;
+
+    /**
+     * @brief Serialise a snapshot
+     * @param programFingerprint Identifies the program the snapshot belongs to
+     *                           (see fingerprint()); checked again by read()
+     */
+    static void write(std::ostream& out, const CpuSnapshot& state, uint64_t programFingerprint);
+
+    /**
+     * @brief Deserialise a snapshot written by write()
+     * @param programFingerprint Receives the fingerprint stored in the checkpoint
+     * @param error Set to a description of the problem on failure
+     * @return false if the data is truncated, corrupt or of another version
+     */
+    static bool read(std::istream& in, CpuSnapshot& state, uint64_t& programFingerprint,
+                     std::string& error);
+
+    /**
+     * @brief FNV-1a hash of program source or image, to tie a checkpoint to its program
+     */
+    static uint64_t fingerprint(std::string_view source);
+};
+
+}  // namespace mips
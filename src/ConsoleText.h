@@ -0,0 +1,71 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace mips
+{
+
+/**
+ * @brief Console text shared copy-on-write between a Cpu, its snapshots and its forks
+ *
+ * Copying one shares the characters, so a snapshot or fork costs a reference
+ * count rather than a copy of everything the program has printed. An append
+ * to shared text first takes a private copy, so a holder that never prints
+ * again never pays for one.
+ */
+class ConsoleText
+{
+  public:
+    ConsoleText() = default;
+    explicit ConsoleText(std::string text)
+        : m_text(text.empty() ? nullptr : std::make_shared<std::string>(std::move(text)))
+    {
+    }
+
+    const std::string& str() const
+    {
+        static const std::string empty;
+        return m_text ? *m_text : empty;
+    }
+
+    void append(std::string_view text)
+    {
+        unshare().append(text);
+    }
+
+    void append(char character)
+    {
+        unshare().push_back(character);
+    }
+
+    void clear()
+    {
+        m_text.reset();
+    }
+
+    // Whether both hold the same characters without a copy, for tests
+    bool sharesWith(const ConsoleText& other) const
+    {
+        return m_text != nullptr && m_text == other.m_text;
+    }
+
+  private:
+    std::string& unshare()
+    {
+        if (!m_text)
+        {
+            m_text = std::make_shared<std::string>();
+        }
+        else if (m_text.use_count() > 1)
+        {
+            m_text = std::make_shared<std::string>(*m_text);
+        }
+        return *m_text;
+    }
+
+    std::shared_ptr<std::string> m_text;  // Null while empty
+};
+
+}  // namespace mips
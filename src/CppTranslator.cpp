@@ -0,0 +1,640 @@
+#include "CppTranslator.h"
+#include "BlockCache.h"
+#include "DecodedInstruction.h"
+#include "Instruction.h"
+#include "Memory.h"
+#include <set>
+#include <sstream>
+#include <stdexcept>
+
+namespace mips
+{
+
+namespace
+{
+
+const char* const RUNTIME_INCLUDES = R"(#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <string>
+)";
+
+// Runtime support emitted ahead of main(); mirrors Memory and the Cpu console helpers.
+// Memory is paged like Memory, with a flat table of page pointers: it lives in
+// zero-initialised static storage, so untouched parts of it cost no host memory.
+const char* const RUNTIME_SUPPORT = R"(
+uint8_t*    g_pages[1u << (32 - PAGE_BITS)];
+uint32_t    g_heapBreak = HEAP_BASE;
+std::string g_input;
+size_t      g_inputPosition = 0;
+bool        g_inputLoaded   = false;
+std::string g_output;
+
+constexpr uint32_t OFFSET_MASK = (1u << PAGE_BITS) - 1;
+
+inline uint8_t* touchPage(uint32_t address)
+{
+    uint8_t*& page = g_pages[address >> PAGE_BITS];
+    if (page == nullptr)
+    {
+        page = static_cast<uint8_t*>(std::calloc(1u << PAGE_BITS, 1));
+        if (page == nullptr)
+            std::abort();
+    }
+    return page;
+}
+
+inline uint32_t readWord(uint32_t address)
+{
+    const uint8_t* page = g_pages[address >> PAGE_BITS];
+    if (page == nullptr || address % 4 != 0)
+        return 0;
+    uint32_t value;
+    std::memcpy(&value, page + (address & OFFSET_MASK), 4);
+    return value;
+}
+
+inline void writeWord(uint32_t address, uint32_t value)
+{
+    if (address % 4 != 0)
+        return;
+    std::memcpy(touchPage(address) + (address & OFFSET_MASK), &value, 4);
+}
+
+inline uint8_t readByte(uint32_t address)
+{
+    const uint8_t* page = g_pages[address >> PAGE_BITS];
+    return page != nullptr ? page[address & OFFSET_MASK] : 0;
+}
+
+inline void writeByte(uint32_t address, uint8_t value)
+{
+    touchPage(address)[address & OFFSET_MASK] = value;
+}
+
+inline uint16_t readHalfword(uint32_t address)
+{
+    return static_cast<uint16_t>(readByte(address) | (readByte(address + 1) << 8));
+}
+
+inline void writeHalfword(uint32_t address, uint16_t value)
+{
+    writeByte(address, static_cast<uint8_t>(value & 0xFF));
+    writeByte(address + 1, static_cast<uint8_t>(value >> 8));
+}
+
+inline uint32_t sbrk(uint32_t increment)
+{
+    const uint32_t oldBreak = g_heapBreak;
+    const int64_t  delta    = static_cast<int32_t>(increment);
+    int64_t        newBreak = g_heapBreak + ((delta + 3) & ~int64_t{3});
+    if (newBreak < HEAP_BASE)
+        newBreak = HEAP_BASE;
+    if (newBreak > HEAP_LIMIT)
+        newBreak = HEAP_LIMIT;
+    g_heapBreak = static_cast<uint32_t>(newBreak);
+    return oldBreak;
+}
+
+inline void divide(uint32_t dividend, uint32_t divisor, uint32_t& hi, uint32_t& lo)
+{
+    int32_t a = static_cast<int32_t>(dividend);
+    int32_t b = static_cast<int32_t>(divisor);
+    if (b == 0)
+    {
+        hi = lo = 0;
+    }
+    else if (b == -1)
+    {
+        lo = 0u - dividend;
+        hi = 0;
+    }
+    else
+    {
+        lo = static_cast<uint32_t>(a / b);
+        hi = static_cast<uint32_t>(a % b);
+    }
+}
+
+inline void divideUnsigned(uint32_t dividend, uint32_t divisor, uint32_t& hi, uint32_t& lo)
+{
+    lo = divisor == 0 ? 0 : dividend / divisor;
+    hi = divisor == 0 ? 0 : dividend % divisor;
+}
+
+inline void printInt(uint32_t value)
+{
+    g_output += std::to_string(value);
+    g_output += '\n';
+}
+
+inline void printChar(uint32_t value)
+{
+    g_output += static_cast<char>(value & 0xFF);
+}
+
+inline void printString(uint32_t address)
+{
+    for (;; address += 4)
+    {
+        uint32_t word = readWord(address);
+        for (int i = 0; i < 4; ++i)
+        {
+            char c = static_cast<char>((word >> (i * 8)) & 0xFF);
+            if (c == 0)
+                return;
+            g_output += c;
+        }
+    }
+}
+
+// stdin is only read once the program asks for input, so programs without
+// read syscalls do not wait for end-of-file
+inline void loadInput()
+{
+    if (!g_inputLoaded)
+    {
+        g_input.assign(std::istreambuf_iterator<char>(std::cin), std::istreambuf_iterator<char>());
+        g_inputLoaded = true;
+    }
+}
+
+inline uint32_t readInt()
+{
+    loadInput();
+    while (g_inputPosition < g_input.size())
+    {
+        if (!std::isdigit(static_cast<unsigned char>(g_input[g_inputPosition])) &&
+            g_input[g_inputPosition] != '-')
+        {
+            ++g_inputPosition;
+            continue;
+        }
+        size_t end;
+        int    value = std::stoi(g_input.substr(g_inputPosition), &end);
+        g_inputPosition += end;
+        return static_cast<uint32_t>(value);
+    }
+    return 0;
+}
+
+inline char readChar()
+{
+    loadInput();
+    return g_inputPosition < g_input.size() ? g_input[g_inputPosition++] : static_cast<char>(-1);
+}
+)";
+
+std::string reg(unsigned number)
+{
+    return number == 0 ? "0u" : "r" + std::to_string(number);
+}
+
+std::string hex(uint32_t value)
+{
+    std::ostringstream oss;
+    oss << "0x" << std::hex << std::uppercase << value << "u";
+    return oss.str();
+}
+
+std::string label(uint32_t index)
+{
+    return "L" + std::to_string(index);
+}
+
+std::string signedValue(unsigned number)
+{
+    return "static_cast<int32_t>(" + reg(number) + ")";
+}
+
+class ProgramEmitter
+{
+  public:
+    ProgramEmitter(std::ostringstream& out, uint32_t size, const std::set<uint32_t>& labels)
+        : m_out(out), m_size(size), m_labels(labels)
+    {
+    }
+
+    void line(const std::string& text)
+    {
+        m_out << "    " << text << "\n";
+    }
+
+    // Goto for a static target; targets outside the program end it
+    std::string jumpTo(uint32_t target) const
+    {
+        return target < m_size && m_labels.count(target) ? "goto " + label(target) + ";"
+                                                          : "goto done;";
+    }
+
+    void emit(const DecodedInstr& d, uint32_t pc, const Instruction& instruction);
+
+  private:
+    void assign(unsigned rd, const std::string& expression)
+    {
+        if (rd != 0)
+        {
+            line(reg(rd) + " = " + expression + ";");
+        }
+    }
+
+    std::string address(const DecodedInstr& d) const
+    {
+        return reg(d.rs) + " + " + hex(d.imm);
+    }
+
+    void emitFallback(const Instruction& instruction);
+
+    std::ostringstream&       m_out;
+    uint32_t                  m_size;
+    const std::set<uint32_t>& m_labels;
+};
+
+void ProgramEmitter::emit(const DecodedInstr& d, uint32_t pc, const Instruction& instruction)
+{
+    const std::string rs            = reg(d.rs);
+    const std::string rt            = reg(d.rt);
+    const std::string returnAddress = hex((pc + 1) * 4);
+
+    switch (d.op)
+    {
+    case DecodedOp::Nop:
+        break;
+    case DecodedOp::Add:
+    case DecodedOp::Addu:
+        assign(d.rd, rs + " + " + rt);
+        break;
+    case DecodedOp::Sub:
+    case DecodedOp::Subu:
+        assign(d.rd, rs + " - " + rt);
+        break;
+    case DecodedOp::And:
+        assign(d.rd, rs + " & " + rt);
+        break;
+    case DecodedOp::Or:
+        assign(d.rd, rs + " | " + rt);
+        break;
+    case DecodedOp::Xor:
+        assign(d.rd, rs + " ^ " + rt);
+        break;
+    case DecodedOp::Nor:
+        assign(d.rd, "~(" + rs + " | " + rt + ")");
+        break;
+    case DecodedOp::Slt:
+        assign(d.rd, signedValue(d.rs) + " < " + signedValue(d.rt) + " ? 1u : 0u");
+        break;
+    case DecodedOp::Sltu:
+        assign(d.rd, rs + " < " + rt + " ? 1u : 0u");
+        break;
+    case DecodedOp::Sllv:
+        assign(d.rd, rt + " << (" + rs + " & 0x1Fu)");
+        break;
+    case DecodedOp::Srlv:
+        assign(d.rd, rt + " >> (" + rs + " & 0x1Fu)");
+        break;
+    case DecodedOp::Srav:
+        assign(d.rd, "static_cast<uint32_t>(" + signedValue(d.rt) + " >> (" + rs + " & 0x1Fu))");
+        break;
+    case DecodedOp::Sll:
+        assign(d.rd, rt + " << " + std::to_string(d.imm));
+        break;
+    case DecodedOp::Srl:
+        assign(d.rd, rt + " >> " + std::to_string(d.imm));
+        break;
+    case DecodedOp::Sra:
+        assign(d.rd, "static_cast<uint32_t>(" + signedValue(d.rt) + " >> " +
+                         std::to_string(d.imm) + ")");
+        break;
+    case DecodedOp::Mult:
+        line("{ uint64_t p = static_cast<uint64_t>(static_cast<int64_t>(" + signedValue(d.rs) +
+             ") * " + signedValue(d.rt) + "); hi = static_cast<uint32_t>(p >> 32); " +
+             "lo = static_cast<uint32_t>(p); }");
+        break;
+    case DecodedOp::Multu:
+        line("{ uint64_t p = static_cast<uint64_t>(" + rs + ") * " + rt +
+             "; hi = static_cast<uint32_t>(p >> 32); lo = static_cast<uint32_t>(p); }");
+        break;
+    case DecodedOp::Div:
+        line("divide(" + rs + ", " + rt + ", hi, lo);");
+        break;
+    case DecodedOp::Divu:
+        line("divideUnsigned(" + rs + ", " + rt + ", hi, lo);");
+        break;
+    case DecodedOp::Mfhi:
+        assign(d.rd, "hi");
+        break;
+    case DecodedOp::Mthi:
+        line("hi = " + rs + ";");
+        break;
+    case DecodedOp::Mflo:
+        assign(d.rd, "lo");
+        break;
+    case DecodedOp::Mtlo:
+        line("lo = " + rs + ";");
+        break;
+    case DecodedOp::Addi:
+    case DecodedOp::Addiu:
+        assign(d.rd, rs + " + " + hex(d.imm));
+        break;
+    case DecodedOp::Slti:
+        assign(d.rd, signedValue(d.rs) + " < static_cast<int32_t>(" + hex(d.imm) +
+                         ") ? 1u : 0u");
+        break;
+    case DecodedOp::Sltiu:
+        assign(d.rd, rs + " < " + hex(d.imm) + " ? 1u : 0u");
+        break;
+    case DecodedOp::Andi:
+        assign(d.rd, rs + " & " + hex(d.imm));
+        break;
+    case DecodedOp::Ori:
+        assign(d.rd, rs + " | " + hex(d.imm));
+        break;
+    case DecodedOp::Xori:
+        assign(d.rd, rs + " ^ " + hex(d.imm));
+        break;
+    case DecodedOp::Llo:
+        assign(d.rd, "(" + rs + " & 0xFFFF0000u) | " + hex(d.imm));
+        break;
+    case DecodedOp::Lhi:
+        assign(d.rd, "(" + rs + " & 0x0000FFFFu) | " + hex(d.imm));
+        break;
+    case DecodedOp::La:
+        assign(d.rd, hex(d.imm));
+        break;
+    case DecodedOp::Lw:
+        assign(d.rd, "readWord(" + address(d) + ")");
+        break;
+    case DecodedOp::Lb:
+        assign(d.rd, "static_cast<uint32_t>(static_cast<int8_t>(readByte(" + address(d) + ")))");
+        break;
+    case DecodedOp::Lbu:
+        assign(d.rd, "readByte(" + address(d) + ")");
+        break;
+    case DecodedOp::Lh:
+        assign(d.rd,
+               "static_cast<uint32_t>(static_cast<int16_t>(readHalfword(" + address(d) + ")))");
+        break;
+    case DecodedOp::Lhu:
+        assign(d.rd, "readHalfword(" + address(d) + ")");
+        break;
+    case DecodedOp::Sw:
+        line("writeWord(" + address(d) + ", " + rt + ");");
+        break;
+    case DecodedOp::Sb:
+        line("writeByte(" + address(d) + ", static_cast<uint8_t>(" + rt + "));");
+        break;
+    case DecodedOp::Sh:
+        line("writeHalfword(" + address(d) + ", static_cast<uint16_t>(" + rt + "));");
+        break;
+    case DecodedOp::Beq:
+        line("if (" + rs + " == " + rt + ") " + jumpTo(d.target));
+        break;
+    case DecodedOp::Bne:
+        line("if (" + rs + " != " + rt + ") " + jumpTo(d.target));
+        break;
+    case DecodedOp::Blez:
+        line("if (" + signedValue(d.rs) + " <= 0) " + jumpTo(d.target));
+        break;
+    case DecodedOp::Bgtz:
+        line("if (" + signedValue(d.rs) + " > 0) " + jumpTo(d.target));
+        break;
+    case DecodedOp::J:
+        line(jumpTo(d.target));
+        break;
+    case DecodedOp::Jal:
+        line("r31 = " + returnAddress + "; " + jumpTo(d.target));
+        break;
+    case DecodedOp::Jr:
+        line("pc = " + rs + " / 4; goto dispatch;");
+        break;
+    case DecodedOp::Jalr:
+        line("pc = " + rs + " / 4;");
+        if (d.rd != 0)
+        {
+            assign(d.rd, returnAddress);
+        }
+        line("goto dispatch;");
+        break;
+    case DecodedOp::Fallback:
+        emitFallback(instruction);
+        break;
+    }
+}
+
+void ProgramEmitter::emitFallback(const Instruction& instruction)
+{
+    if (const auto* trap = dynamic_cast<const TrapInstruction*>(&instruction))
+    {
+        switch (trap->getTrapCode())
+        {
+        case 1:
+            line("printInt(r4);");
+            break;
+        case 4:
+            line("printString(r4);");
+            break;
+        case 10:
+            line("goto done;");
+            break;
+        case 11:
+            line("printChar(r4);");
+            break;
+        default:
+            line("g_output += \"TRAP: " + std::to_string(trap->getTrapCode()) + "\";");
+            break;
+        }
+        return;
+    }
+
+    if (dynamic_cast<const SyscallInstruction*>(&instruction) != nullptr)
+    {
+        line("switch (r2)");
+        line("{");
+        line("case 1: printInt(r4); break;");
+        line("case 4: printString(r4); break;");
+        line("case 5: r2 = readInt(); break;");
+        line("case 9: r2 = sbrk(r4); break;");
+        line("case 10: goto done;");
+        line("case 11: printChar(r4); break;");
+        line("case 12: r2 = static_cast<uint32_t>(readChar()); break;");
+        line("default: break;");
+        line("}");
+        return;
+    }
+
+    throw std::runtime_error("no C++ translation for instruction '" + instruction.getName() +
+                             "'");
+}
+
+void emitDataDirectives(std::ostringstream& out, const std::vector<DataDirective>& directives)
+{
+    out << "void loadData()\n{\n";
+    for (size_t i = 0; i < directives.size(); ++i)
+    {
+        const DataDirective& directive = directives[i];
+        const bool           words     = directive.type == DataDirective::WORD;
+        const size_t         count     = words ? directive.words.size() : directive.bytes.size();
+        if (count == 0)
+        {
+            continue;
+        }
+
+        out << "    static const " << (words ? "uint32_t" : "uint8_t") << " data" << i
+            << "[] = {";
+        for (size_t j = 0; j < count; ++j)
+        {
+            out << (j % 12 == 0 ? "\n        " : " ")
+                << hex(words ? directive.words[j] : directive.bytes[j]) << ",";
+        }
+        out << "\n    };\n";
+        out << "    for (uint32_t i = 0; i < " << count << "u; ++i)\n";
+        if (words)
+        {
+            out << "        writeWord(" << hex(directive.address) << " + i * 4, data" << i
+                << "[i]);\n";
+        }
+        else
+        {
+            out << "        writeByte(" << hex(directive.address) << " + i, data" << i << "[i]);\n";
+        }
+    }
+    out << "}\n\n";
+}
+
+}  // namespace
+
+std::string CppTranslator::translate(const std::vector<std::unique_ptr<Instruction>>& instructions,
+                                     const std::vector<DataDirective>&      dataDirectives,
+                                     const std::map<std::string, uint32_t>& labelMap,
+                                     const std::string&                     sourceName)
+{
+    const uint32_t size = static_cast<uint32_t>(instructions.size());
+
+    std::vector<DecodedInstr> program(size);
+    for (uint32_t pc = 0; pc < size; ++pc)
+    {
+        if (!instructions[pc]->lower(program[pc]))
+        {
+            program[pc]        = DecodedInstr{};
+            program[pc].op     = DecodedOp::Fallback;
+            program[pc].target = pc;
+        }
+    }
+
+    // Labelled regions: block leaders, code labels (possible la/jalr targets) and
+    // return addresses of calls (jr targets)
+    BlockCache blocks;
+    blocks.build(program);
+    std::set<uint32_t> labels;
+    for (uint32_t pc = 0; pc < size; ++pc)
+    {
+        if (blocks.isLeader(pc))
+        {
+            labels.insert(pc);
+        }
+    }
+    for (const auto& [name, byteAddress] : labelMap)
+    {
+        if (byteAddress % 4 == 0 && byteAddress / 4 < size)
+        {
+            labels.insert(byteAddress / 4);
+        }
+    }
+
+    std::ostringstream out;
+    out << "// Generated by 'mipsim translate' from " << sourceName << "; do not edit.\n"
+        << "// Build: c++ -std=c++17 -O2 <this file>; console input is read from stdin.\n\n"
+        << RUNTIME_INCLUDES << "\n"
+        << "namespace\n{\n\n"
+        << "constexpr uint32_t PAGE_BITS  = " << Memory::PAGE_BITS << ";\n"
+        << "constexpr int64_t  HEAP_BASE  = " << hex(Memory::HEAP_BASE) << ";\n"
+        << "constexpr int64_t  HEAP_LIMIT = "
+        << hex(Memory::STACK_TOP - Memory::STACK_LIMIT) << ";\n"
+        << RUNTIME_SUPPORT << "\n";
+    emitDataDirectives(out, dataDirectives);
+    out << "}  // namespace\n\n";
+
+    // Only regions something jumps to get a label, so the output builds cleanly
+    // with -Wall; with an indirect jump the dispatch switch reaches all of them
+    bool               indirect = false;
+    std::set<uint32_t> referenced;
+    for (const DecodedInstr& d : program)
+    {
+        switch (d.op)
+        {
+        case DecodedOp::Beq:
+        case DecodedOp::Bne:
+        case DecodedOp::Blez:
+        case DecodedOp::Bgtz:
+        case DecodedOp::J:
+        case DecodedOp::Jal:
+            referenced.insert(d.target);
+            break;
+        case DecodedOp::Jr:
+        case DecodedOp::Jalr:
+            indirect = true;
+            break;
+        default:
+            break;
+        }
+    }
+    if (indirect)
+    {
+        referenced.insert(labels.begin(), labels.end());
+    }
+
+    out << "int main()\n{\n"
+        << "    loadData();\n\n"
+        << "    [[maybe_unused]] uint32_t hi = 0, lo = 0, pc = 0;\n";
+    for (unsigned r = 1; r < 32; ++r)
+    {
+        out << (r % 8 == 1 ? "    [[maybe_unused]] uint32_t " : " ") << "r" << r << " = 0"
+            << (r % 8 == 0 || r == 31 ? ";\n" : ",");
+    }
+    out << "\n";
+
+    ProgramEmitter emitter(out, size, labels);
+    for (uint32_t pc = 0; pc < size; ++pc)
+    {
+        if (labels.count(pc) && referenced.count(pc))
+        {
+            out << label(pc) << ":  // block at " << pc << "\n";
+        }
+        out << "    // " << pc << ": " << instructions[pc]->getName() << "\n";
+        emitter.emit(program[pc], pc, *instructions[pc]);
+    }
+    out << "    goto done;\n\n";
+
+    if (indirect)
+    {
+        out << "dispatch:\n"
+            << "    switch (pc)\n"
+            << "    {\n";
+        for (uint32_t target : labels)
+        {
+            out << "    case " << target << ": goto " << label(target) << ";\n";
+        }
+        out << "    default:\n"
+            << "        if (pc < " << size << "u)\n"
+            << "        {\n"
+            << "            std::fprintf(stderr, "
+               "\"indirect jump to untranslated instruction %u\\n\", pc);\n"
+            << "            return 4;\n"
+            << "        }\n"
+            << "        goto done;\n"
+            << "    }\n\n";
+    }
+
+    out << "done:\n"
+        << "    std::fwrite(g_output.data(), 1, g_output.size(), stdout);\n"
+        << "    return 0;\n"
+        << "}\n";
+
+    return out.str();
+}
+
+}  // namespace mips
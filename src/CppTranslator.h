@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Assembler.h"
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace mips
+{
+
+class Instruction;
+
+/**
+ * @brief Ahead-of-time translator from an assembled program to a C++ translation unit
+ *
+ * The emitted file has no dependency on the simulator. Each basic block becomes
+ * a labelled region of main(), general registers and HI/LO are locals, memory is
+ * a sparse array of 4KB pages with the same address space and access rules as
+ * Memory, and data directives are written to it at start-up. Console input is read from stdin
+ * and console output is written to stdout when the program exits.
+ *
+ * Indirect jumps (jr/jalr) dispatch through a switch over every block, code
+ * label and return address. Two cases differ from the simulator: running past
+ * the last instruction ends the program instead of idling, and an indirect jump
+ * to an instruction outside that set exits with status 4.
+ */
+class CppTranslator
+{
+  public:
+    /**
+     * @brief Translate a linked program
+     * @param instructions Instructions after Assembler::link
+     * @param dataDirectives Data directives from Assembler::assembleWithLabels
+     * @param labelMap Label table from Assembler::assembleWithLabels
+     * @param sourceName Name of the source file, recorded in the header comment
+     * @return C++ source text
+     * @throws std::runtime_error if an instruction has no translation
+     */
+    static std::string translate(const std::vector<std::unique_ptr<Instruction>>& instructions,
+                                 const std::vector<DataDirective>&                dataDirectives,
+                                 const std::map<std::string, uint32_t>&           labelMap,
+                                 const std::string&                               sourceName);
+};
+
+}  // namespace mips
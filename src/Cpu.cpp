@@ -1,17 +1,22 @@
 #include "Cpu.h"
 #include "Assembler.h"
+#include "AssemblySession.h"
+#include "BlockCache.h"
 #include "EXStage.h"
 #include "IDStage.h"
 #include "IFStage.h"
 #include "Instruction.h"
+#include "Log.h"
 #include "MEMStage.h"
 #include "Memory.h"
+#include "ProgramImage.h"
 #include "RegisterFile.h"
 #include "Stage.h"
 #include "WBStage.h"
+#include <algorithm>
 #include <cctype>
+#include <climits>
 #include <cstdio>
-#include <iostream>
 #include <string>
 
 namespace mips
@@ -20,12 +25,17 @@ namespace mips
 Cpu::Cpu()
     : m_registerFile(std::make_unique<RegisterFile>()),
       m_memory(std::make_unique<Memory>()),
+      m_program(ProgramImage::empty()),
+      m_jitStale(false),
       m_cycleCount(0),
+      m_retiredCount(0),
       m_pc(0),
       m_pipelineMode(false)  // Default to single-cycle mode
       ,
       m_terminated(false),
-      m_inputPosition(0)
+      m_engine(ExecutionEngine::Block),
+      m_inputPosition(0),
+      m_heapBreak(Memory::HEAP_BASE)
 {
     initializePipeline();
 }
@@ -54,28 +64,402 @@ void Cpu::tick()
 
 void Cpu::tickSingleCycle()
 {
-    // Original single-cycle execution logic
-    if (m_pc < m_instructions.size())
+    if (m_engine != ExecutionEngine::Reference)
+    {
+        // A single tick is one instruction, so the block engine steps like the decoded one
+        executeDecoded(1, NO_STOP_PC);
+        return;
+    }
+
+    // Reference single-cycle execution logic
+    const InstructionList& instructions = m_program->instructions();
+    if (m_pc < instructions.size())
     {
         uint32_t oldPc = m_pc;
-        // Debug: log which instruction is about to execute to help trace
-        try
+        MIPS_LOG(Cpu, Trace, "exec pc=" << m_pc << " instr='" << instructions[m_pc]->getName()
+                                        << "'");
+
+        instructions[m_pc]->execute(*this);
+        m_retiredCount++;
+
+        // Only increment PC if instruction didn't change it (for non-branch instructions)
+        if (m_pc == oldPc)
+        {
+            m_pc++;
+        }
+    }
+}
+
+inline uint32_t Cpu::executeInstruction(const DecodedInstr& d, uint32_t pc, uint32_t* regs,
+                                        Memory& memory)
+{
+    uint32_t next = pc + 1;
+
+    switch (d.op)
+    {
+    case DecodedOp::Nop:
+        break;
+    case DecodedOp::Add:
+    case DecodedOp::Addu:
+        regs[d.rd] = regs[d.rs] + regs[d.rt];
+        break;
+    case DecodedOp::Sub:
+    case DecodedOp::Subu:
+        regs[d.rd] = regs[d.rs] - regs[d.rt];
+        break;
+    case DecodedOp::And:
+        regs[d.rd] = regs[d.rs] & regs[d.rt];
+        break;
+    case DecodedOp::Or:
+        regs[d.rd] = regs[d.rs] | regs[d.rt];
+        break;
+    case DecodedOp::Xor:
+        regs[d.rd] = regs[d.rs] ^ regs[d.rt];
+        break;
+    case DecodedOp::Nor:
+        regs[d.rd] = ~(regs[d.rs] | regs[d.rt]);
+        break;
+    case DecodedOp::Slt:
+        regs[d.rd] = static_cast<int32_t>(regs[d.rs]) < static_cast<int32_t>(regs[d.rt]);
+        break;
+    case DecodedOp::Sltu:
+        regs[d.rd] = regs[d.rs] < regs[d.rt];
+        break;
+    case DecodedOp::Sllv:
+        regs[d.rd] = regs[d.rt] << (regs[d.rs] & 0x1F);
+        break;
+    case DecodedOp::Srlv:
+        regs[d.rd] = regs[d.rt] >> (regs[d.rs] & 0x1F);
+        break;
+    case DecodedOp::Srav:
+        regs[d.rd] =
+            static_cast<uint32_t>(static_cast<int32_t>(regs[d.rt]) >> (regs[d.rs] & 0x1F));
+        break;
+    case DecodedOp::Sll:
+        regs[d.rd] = regs[d.rt] << d.imm;
+        break;
+    case DecodedOp::Srl:
+        regs[d.rd] = regs[d.rt] >> d.imm;
+        break;
+    case DecodedOp::Sra:
+        regs[d.rd] = static_cast<uint32_t>(static_cast<int32_t>(regs[d.rt]) >> d.imm);
+        break;
+    case DecodedOp::Mult:
+    {
+        int64_t product = static_cast<int64_t>(static_cast<int32_t>(regs[d.rs])) *
+                          static_cast<int64_t>(static_cast<int32_t>(regs[d.rt]));
+        m_registerFile->writeHI(static_cast<uint32_t>(static_cast<uint64_t>(product) >> 32));
+        m_registerFile->writeLO(static_cast<uint32_t>(product));
+        break;
+    }
+    case DecodedOp::Multu:
+    {
+        uint64_t product = static_cast<uint64_t>(regs[d.rs]) * regs[d.rt];
+        m_registerFile->writeHI(static_cast<uint32_t>(product >> 32));
+        m_registerFile->writeLO(static_cast<uint32_t>(product));
+        break;
+    }
+    case DecodedOp::Div:
+    {
+        int32_t dividend = static_cast<int32_t>(regs[d.rs]);
+        int32_t divisor  = static_cast<int32_t>(regs[d.rt]);
+        // Divide by zero leaves HI and LO zeroed, as in DIVInstruction
+        if (divisor == 0)
+        {
+            m_registerFile->writeLO(0);
+            m_registerFile->writeHI(0);
+        }
+        else if (divisor == -1)
+        {
+            // Avoids the host trap on INT_MIN / -1; the quotient wraps
+            m_registerFile->writeLO(0u - regs[d.rs]);
+            m_registerFile->writeHI(0);
+        }
+        else
+        {
+            m_registerFile->writeLO(static_cast<uint32_t>(dividend / divisor));
+            m_registerFile->writeHI(static_cast<uint32_t>(dividend % divisor));
+        }
+        break;
+    }
+    case DecodedOp::Divu:
+    {
+        uint32_t dividend = regs[d.rs];
+        uint32_t divisor  = regs[d.rt];
+        m_registerFile->writeLO(divisor == 0 ? 0 : dividend / divisor);
+        m_registerFile->writeHI(divisor == 0 ? 0 : dividend % divisor);
+        break;
+    }
+    case DecodedOp::Mfhi:
+        regs[d.rd] = m_registerFile->readHI();
+        break;
+    case DecodedOp::Mthi:
+        m_registerFile->writeHI(regs[d.rs]);
+        break;
+    case DecodedOp::Mflo:
+        regs[d.rd] = m_registerFile->readLO();
+        break;
+    case DecodedOp::Mtlo:
+        m_registerFile->writeLO(regs[d.rs]);
+        break;
+    case DecodedOp::Addi:
+    case DecodedOp::Addiu:
+        regs[d.rd] = regs[d.rs] + d.imm;
+        break;
+    case DecodedOp::Slti:
+        regs[d.rd] = static_cast<int32_t>(regs[d.rs]) < static_cast<int32_t>(d.imm);
+        break;
+    case DecodedOp::Sltiu:
+        regs[d.rd] = regs[d.rs] < d.imm;
+        break;
+    case DecodedOp::Andi:
+        regs[d.rd] = regs[d.rs] & d.imm;
+        break;
+    case DecodedOp::Ori:
+        regs[d.rd] = regs[d.rs] | d.imm;
+        break;
+    case DecodedOp::Xori:
+        regs[d.rd] = regs[d.rs] ^ d.imm;
+        break;
+    case DecodedOp::Llo:
+        regs[d.rd] = (regs[d.rs] & 0xFFFF0000u) | d.imm;
+        break;
+    case DecodedOp::Lhi:
+        regs[d.rd] = (regs[d.rs] & 0x0000FFFFu) | d.imm;
+        break;
+    case DecodedOp::La:
+        regs[d.rd] = d.imm;
+        break;
+    case DecodedOp::Lw:
+        regs[d.rd] = memory.readWord(regs[d.rs] + d.imm);
+        break;
+    case DecodedOp::Lb:
+        regs[d.rd] = static_cast<uint32_t>(
+            static_cast<int32_t>(static_cast<int8_t>(memory.readByte(regs[d.rs] + d.imm))));
+        break;
+    case DecodedOp::Lbu:
+        regs[d.rd] = memory.readByte(regs[d.rs] + d.imm);
+        break;
+    case DecodedOp::Lh:
+        regs[d.rd] = static_cast<uint32_t>(static_cast<int32_t>(
+            static_cast<int16_t>(memory.readHalfword(regs[d.rs] + d.imm))));
+        break;
+    case DecodedOp::Lhu:
+        regs[d.rd] = memory.readHalfword(regs[d.rs] + d.imm);
+        break;
+    case DecodedOp::Sw:
+        memory.writeWord(regs[d.rs] + d.imm, regs[d.rt]);
+        break;
+    case DecodedOp::Sb:
+        memory.writeByte(regs[d.rs] + d.imm, static_cast<uint8_t>(regs[d.rt] & 0xFF));
+        break;
+    case DecodedOp::Sh:
+        memory.writeHalfword(regs[d.rs] + d.imm, static_cast<uint16_t>(regs[d.rt] & 0xFFFF));
+        break;
+    case DecodedOp::Beq:
+        if (regs[d.rs] == regs[d.rt])
+            next = d.target;
+        break;
+    case DecodedOp::Bne:
+        if (regs[d.rs] != regs[d.rt])
+            next = d.target;
+        break;
+    case DecodedOp::Blez:
+        if (static_cast<int32_t>(regs[d.rs]) <= 0)
+            next = d.target;
+        break;
+    case DecodedOp::Bgtz:
+        if (static_cast<int32_t>(regs[d.rs]) > 0)
+            next = d.target;
+        break;
+    case DecodedOp::J:
+        next = d.target;
+        break;
+    case DecodedOp::Jal:
+        // Return address is stored as a byte address, as in JALInstruction
+        regs[31] = (pc + 1) * 4;
+        next     = d.target;
+        break;
+    case DecodedOp::Jr:
+        next = regs[d.rs] / 4;
+        break;
+    case DecodedOp::Jalr:
+    {
+        uint32_t targetByteAddress = regs[d.rs];
+        if (d.rd != 0)
         {
-            std::string instrName = m_instructions[m_pc]->getName();
-            std::cerr << "DEBUG: Exec pc=" << m_pc << " instr='" << instrName << "'" << std::endl;
+            regs[d.rd] = (pc + 1) * 4;
         }
-        catch (...)
+        next = targetByteAddress / 4;
+        break;
+    }
+    case DecodedOp::Fallback:
+        // Cold path (syscall, trap): run the original instruction object
+        m_pc = pc;
+        m_program->instructions()[d.target]->execute(*this);
+        next = (m_pc == pc) ? pc + 1 : m_pc;
+        break;
+    }
+
+    return next;
+}
+
+uint64_t Cpu::executeDecoded(uint64_t maxCycles, uint32_t stopPc)
+{
+    uint32_t*           regs    = m_registerFile->data().data();
+    Memory&             memory  = *m_memory;
+    const DecodedInstr* code    = m_program->decoded().data();
+    const uint32_t      size    = static_cast<uint32_t>(m_program->decoded().size());
+    uint32_t            pc      = m_pc;
+    uint64_t            cycles  = 0;
+    uint64_t            retired = 0;
+    const bool          trace   = Log::isEnabled(LogCategory::Cpu, LogLevel::Trace);
+
+    while (cycles < maxCycles)
+    {
+        if (pc >= size || pc == stopPc)
         {
+            break;
         }
 
-        m_instructions[m_pc]->execute(*this);
+        const DecodedInstr& d = code[pc];
+        ++cycles;
+        ++retired;
 
-        // Only increment PC if instruction didn't change it (for non-branch instructions)
-        if (m_pc == oldPc)
+        if (trace)
         {
-            m_pc++;
+            MIPS_LOG(Cpu, Trace,
+                     "exec pc=" << pc << " instr='" << m_program->instructions()[pc]->getName()
+                                << "'");
+        }
+
+        pc = executeInstruction(d, pc, regs, memory);
+
+        if (d.op == DecodedOp::Fallback && m_terminated)
+        {
+            break;
+        }
+    }
+
+    m_pc = pc;
+    m_retiredCount += retired;
+    return cycles;
+}
+
+uint64_t Cpu::executeBlocks(uint64_t maxCycles, bool jit, uint32_t stopPc)
+{
+    if (Log::isEnabled(LogCategory::Cpu, LogLevel::Trace))
+    {
+        // Per-instruction tracing needs the instruction-at-a-time loop
+        return executeDecoded(maxCycles, stopPc);
+    }
+
+    uint32_t*           regs    = m_registerFile->data().data();
+    Memory&             memory  = *m_memory;
+    const DecodedInstr* code    = m_program->decoded().data();
+    const uint32_t      size    = static_cast<uint32_t>(m_program->decoded().size());
+    uint32_t            pc      = m_pc;
+    uint64_t            cycles  = 0;
+    uint64_t            retired = 0;
+    int32_t             index   = BlockCache::NO_BLOCK;
+    JitContext          context;
+    if (jit && m_jitStale)
+    {
+        m_jit.reset(size);
+        m_jitStale = false;
+    }
+    context.memory     = m_memory.get();
+    context.entries    = m_jit.entryTable();
+    context.entryCount = size;
+
+    while (cycles < maxCycles)
+    {
+        if (pc >= size || pc == stopPc)
+        {
+            break;
+        }
+
+        if (index == BlockCache::NO_BLOCK)
+        {
+            index = m_blockCache.blockAt(pc);
+        }
+        const BasicBlock block = m_blockCache.block(index);
+
+        if (block.length > maxCycles - cycles || stopPc - pc < block.length)
+        {
+            // The budget or the stop PC ends inside this block: finish one
+            // instruction at a time
+            m_pc = pc;
+            m_retiredCount += retired;
+            return cycles + executeDecoded(maxCycles - cycles, stopPc);
+        }
+
+        JitBlockFn native = jit ? m_jit.lookup(index, block, m_program->decoded()) : nullptr;
+        if (native != nullptr)
+        {
+            // Translated blocks chain among themselves until the budget or the
+            // translated code runs out, so the successor is looked up afresh
+            context.hi     = m_registerFile->readHI();
+            context.lo     = m_registerFile->readLO();
+            // Every budget unit the translated code spends is one retired instruction
+            const uint64_t budget = std::min<uint64_t>(maxCycles - cycles, INT64_MAX);
+            context.budget        = static_cast<int64_t>(budget);
+            pc                    = native(regs, &context);
+            const uint64_t spent  = budget - static_cast<uint64_t>(context.budget);
+            cycles += spent;
+            retired += spent;
+            m_registerFile->writeHI(context.hi);
+            m_registerFile->writeLO(context.lo);
+            index = BlockCache::NO_BLOCK;
+            continue;
+        }
+
+        // Straight-line body: every instruction but the last falls through
+        const uint32_t last = block.start + block.length - 1;
+        for (uint32_t i = block.start; i < last; ++i)
+        {
+            executeInstruction(code[i], i, regs, memory);
+        }
+        uint32_t next = executeInstruction(code[last], last, regs, memory);
+        cycles += block.length;
+        retired += block.length;
+        pc = next;
+
+        if (block.endsInFallback && m_terminated)
+        {
+            break;
+        }
+
+        // Chain to the successor block without going back through the block map
+        // (blockAt may grow the cache, so block references are re-fetched after it)
+        if (next == block.takenTarget)
+        {
+            if (block.takenSuccessor == BlockCache::NO_BLOCK && next < size)
+            {
+                int32_t successor                        = m_blockCache.blockAt(next);
+                m_blockCache.block(index).takenSuccessor = successor;
+            }
+            index = m_blockCache.block(index).takenSuccessor;
+        }
+        else if (next == last + 1)
+        {
+            if (block.fallthroughSuccessor == BlockCache::NO_BLOCK && next < size)
+            {
+                int32_t successor                              = m_blockCache.blockAt(next);
+                m_blockCache.block(index).fallthroughSuccessor = successor;
+            }
+            index = m_blockCache.block(index).fallthroughSuccessor;
+        }
+        else
+        {
+            // Indirect jump (jr/jalr) or out-of-line PC change: look the target up
+            index = BlockCache::NO_BLOCK;
         }
     }
+
+    m_pc = pc;
+    m_retiredCount += retired;
+    return cycles;
 }
 
 void Cpu::tickPipeline()
@@ -98,7 +482,7 @@ void Cpu::tickPipeline()
     // Update PC if IF stage allows it and we're not terminated
     if (m_ifStage && m_ifStage->canUpdatePC() && !m_terminated)
     {
-        if (m_pc < m_instructions.size())
+        if (m_pc < m_program->instructions().size())
         {
             // Only increment PC if we're still within instruction range
             m_pc++;
@@ -111,35 +495,64 @@ void Cpu::tickPipeline()
     updatePipelineRegisters();
 }
 
-void Cpu::loadProgramFromString(const std::string& assembly)
+void Cpu::loadProgramFromString(std::string_view assembly, std::vector<size_t>* skippedLines)
 {
     Assembler                  assembler;
     std::vector<DataDirective> dataDirectives;
-    m_instructions = assembler.assembleWithLabels(assembly, m_labelMap, dataDirectives);
+    std::map<std::string, uint32_t> labelMap;
+    auto instructions = assembler.assembleWithLabels(assembly, labelMap, dataDirectives);
+    Assembler::link(instructions, labelMap);  // Throws on undefined labels
+    if (skippedLines != nullptr)
+    {
+        *skippedLines = assembler.skippedLines();
+    }
 
-    // Debug: Print data directives count
-    // std::cerr << "DEBUG: Found " << dataDirectives.size() << " data directives" << std::endl;
+    Memory data;
+    ProgramImage::writeData(dataDirectives, data);
+    loadProgramImage(ProgramImage::create(
+        std::make_shared<const InstructionList>(std::move(instructions)), std::move(labelMap),
+        std::move(data)));
+}
 
-    // Initialize memory with data directives
-    for (const auto& directive : dataDirectives)
+void Cpu::loadAssembledProgram(const AssembledProgram& program)
+{
+    loadProgramImage(ProgramImage::create(program));
+}
+
+void Cpu::loadProgramImage(std::shared_ptr<const ProgramImage> image)
+{
+    if (m_memory->dirtyPageCount() == 0)
     {
-        if (directive.type == DataDirective::WORD)
-        {
-            for (size_t i = 0; i < directive.words.size(); ++i)
-            {
-                uint32_t address = directive.address + (i * 4);
-                m_memory->writeWord(address, directive.words[i]);
-            }
-        }
-        else if (directive.type == DataDirective::BYTE || directive.type == DataDirective::ASCIIZ)
+        *m_memory = image->data();  // Shares pages; the JIT keeps its Memory pointer
+    }
+    else
+    {
+        // Memory the caller or an earlier program wrote stays, as for the other loads
+        for (const Memory::DirtyPage& page : image->data().dirtyPages())
         {
-            for (size_t i = 0; i < directive.bytes.size(); ++i)
-            {
-                uint32_t address = directive.address + i;
-                m_memory->writeByte(address, directive.bytes[i]);
-            }
+            m_memory->writePage(page.address, page.data);
         }
     }
+    installProgram(std::move(image));
+}
+
+const std::shared_ptr<const ProgramImage>& Cpu::getProgramImage() const
+{
+    return m_program;
+}
+
+void Cpu::loadLinkedProgram(std::vector<std::unique_ptr<Instruction>> instructions,
+                            std::map<std::string, uint32_t>           labelMap)
+{
+    installProgram(ProgramImage::create(
+        std::make_shared<const InstructionList>(std::move(instructions)), std::move(labelMap)));
+}
+
+void Cpu::installProgram(std::shared_ptr<const ProgramImage> image)
+{
+    m_program = std::move(image);
+    m_blockCache.build(m_program->decoded(), m_program->leaders());
+    m_jitStale = true;  // Reset on first use, sized for the program
 
     m_pc         = 0;
     m_terminated = false;  // Reset termination flag
@@ -157,7 +570,7 @@ void Cpu::loadProgramFromString(const std::string& assembly)
     // Update IF stage with new instructions for pipeline mode
     if (m_ifStage)
     {
-        m_ifStage->setInstructions(&m_instructions);
+        m_ifStage->setInstructions(&m_program->instructions());
         m_ifStage->reset();
     }
 }
@@ -168,14 +581,150 @@ void Cpu::loadProgram(const std::string& path)
     (void)path;  // Suppress unused parameter warning
 }
 
-void Cpu::run(int cycles)
+void Cpu::run(uint64_t cycles)
 {
-    for (int i = 0; i < cycles; ++i)
+    if (!m_pipelineMode && m_engine != ExecutionEngine::Reference)
+    {
+        // Same accounting as repeated tick(): no cycles are counted once terminated
+        if (!m_terminated && cycles > 0)
+        {
+            const uint64_t executed = executeBatch(cycles, NO_STOP_PC);
+            if (!m_terminated)
+            {
+                // Past the end of the program every remaining cycle is idle
+                m_cycleCount += cycles - executed;
+            }
+        }
+        return;
+    }
+
+    for (uint64_t i = 0; i < cycles; ++i)
     {
         tick();
     }
 }
 
+void Cpu::executeTicks(uint64_t maxCycles, uint32_t stopPc)
+{
+    const uint32_t size = static_cast<uint32_t>(m_program->instructions().size());
+
+    if (m_pipelineMode)
+    {
+        for (uint64_t i = 0; i < maxCycles && !m_terminated; ++i)
+        {
+            tickPipeline();
+            m_cycleCount++;
+            if (m_pc == stopPc)
+            {
+                break;
+            }
+        }
+        return;
+    }
+
+    for (uint64_t i = 0; i < maxCycles && !m_terminated; ++i)
+    {
+        tickSingleCycle();
+        m_cycleCount++;
+        if (m_pc == stopPc || m_pc >= size)
+        {
+            break;
+        }
+    }
+}
+
+uint64_t Cpu::executeBatch(uint64_t maxCycles, uint32_t stopPc)
+{
+    uint64_t cycles;
+    switch (m_engine)
+    {
+    case ExecutionEngine::Block:
+        cycles = executeBlocks(maxCycles, false, stopPc);
+        break;
+    case ExecutionEngine::Jit:
+        // Chained native code only returns at block boundaries it cannot
+        // translate, so a stop PC keeps the run on the block interpreter
+        cycles = executeBlocks(maxCycles, JitCompiler::available && stopPc == NO_STOP_PC,
+                               stopPc);
+        break;
+    default:
+        cycles = executeDecoded(maxCycles, stopPc);
+        break;
+    }
+    m_cycleCount += cycles;
+    return cycles;
+}
+
+RunResult Cpu::runFor(uint64_t budget, uint32_t stopPc, const std::atomic<bool>* stopFlag)
+{
+    RunResult      result;
+    const uint64_t cyclesBefore = m_cycleCount;
+    const bool     batched      = !m_pipelineMode && m_engine != ExecutionEngine::Reference;
+    const uint32_t size         = static_cast<uint32_t>(m_program->instructions().size());
+
+    // The instruction at the current PC always runs, so a run that starts on
+    // its stop PC goes round to it again instead of returning straight away
+    bool first = true;
+
+    for (;;)
+    {
+        const uint64_t spent = m_cycleCount - cyclesBefore;
+        if (m_terminated)
+        {
+            result.reason = StopReason::Exit;
+            break;
+        }
+        if (!first && m_pc == stopPc)
+        {
+            result.reason = StopReason::Breakpoint;
+            break;
+        }
+        if (m_pc >= size && !m_pipelineMode)
+        {
+            // Only a fault in single-cycle mode: a pipeline drains after fetch stops
+            result.reason = StopReason::Fault;
+            break;
+        }
+        if (stopFlag != nullptr && stopFlag->load(std::memory_order_relaxed))
+        {
+            result.reason = StopReason::StopRequested;
+            break;
+        }
+        if (spent >= budget)
+        {
+            result.reason = StopReason::BudgetExhausted;
+            break;
+        }
+
+        // Bounded slices keep the stop flag responsive; without one the whole
+        // budget goes to the engine in a single call
+        uint64_t slice     = budget - spent;
+        uint32_t sliceStop = stopPc;
+        if (stopFlag != nullptr)
+        {
+            slice = std::min(slice, STOP_POLL_CYCLES);
+        }
+        if (first && m_pc == stopPc)
+        {
+            slice     = 1;
+            sliceStop = NO_STOP_PC;
+        }
+        first = false;
+
+        if (batched)
+        {
+            executeBatch(slice, sliceStop);
+        }
+        else
+        {
+            executeTicks(slice, sliceStop);
+        }
+    }
+
+    result.cycles = m_cycleCount - cyclesBefore;
+    return result;
+}
+
 RegisterFile& Cpu::getRegisterFile()
 {
     return *m_registerFile;
@@ -186,23 +735,37 @@ Memory& Cpu::getMemory()
     return *m_memory;
 }
 
-int Cpu::getCycleCount() const
+uint64_t Cpu::getCycleCount() const
 {
     return m_cycleCount;
 }
 
+uint64_t Cpu::getRetiredInstructionCount() const
+{
+    return m_retiredCount;
+}
+
+void Cpu::retireInstruction()
+{
+    m_retiredCount++;
+}
+
 void Cpu::reset()
 {
-    m_cycleCount = 0;
-    m_pc         = 0;
-    m_instructions.clear();
-    m_labelMap.clear();
+    m_cycleCount   = 0;
+    m_retiredCount = 0;
+    m_pc           = 0;
+    m_program      = ProgramImage::empty();
+    m_blockCache.clear();
+    m_jit.reset(0);
+    m_jitStale = false;
     m_registerFile->reset();
     m_memory->reset();
     m_terminated = false;
     m_consoleOutput.clear();
     m_consoleInput.clear();
     m_inputPosition = 0;
+    m_heapBreak     = Memory::HEAP_BASE;
 
     // Reset pipeline registers
     if (m_ifidRegister)
@@ -216,7 +779,10 @@ void Cpu::reset()
 
     // Reset pipeline stages
     if (m_ifStage)
+    {
+        m_ifStage->setInstructions(&m_program->instructions());
         m_ifStage->reset();
+    }
     if (m_idStage)
         m_idStage->reset();
     if (m_exStage)
@@ -227,13 +793,65 @@ void Cpu::reset()
         m_wbStage->reset();
 }
 
+CpuSnapshot Cpu::snapshot() const
+{
+    CpuSnapshot state;
+    state.registers     = m_registerFile->data();
+    state.hi            = m_registerFile->readHI();
+    state.lo            = m_registerFile->readLO();
+    state.pc            = m_pc;
+    state.cycleCount    = m_cycleCount;
+    state.retiredCount  = m_retiredCount;
+    state.terminated    = m_terminated;
+    state.consoleOutput = m_consoleOutput;  // Shares the text
+    state.consoleInput  = m_consoleInput;
+    state.inputPosition = m_inputPosition;
+    state.heapBreak     = m_heapBreak;
+    state.memory        = std::make_shared<const Memory>(*m_memory);  // Shares pages
+    return state;
+}
+
+void Cpu::restore(const CpuSnapshot& state)
+{
+    m_registerFile->data() = state.registers;
+    m_registerFile->writeHI(state.hi);
+    m_registerFile->writeLO(state.lo);
+    m_pc            = state.pc;
+    m_cycleCount    = state.cycleCount;
+    m_retiredCount  = state.retiredCount;
+    m_terminated    = state.terminated;
+    m_consoleOutput = state.consoleOutput;
+    m_consoleInput  = state.consoleInput;
+    m_inputPosition = state.inputPosition;
+    m_heapBreak     = state.heapBreak;
+    *m_memory       = *state.memory;  // Shares pages; the JIT keeps its Memory pointer
+
+    // The pipeline restarts empty at the restored PC
+    if (m_ifidRegister)
+        m_ifidRegister->reset();
+    if (m_idexRegister)
+        m_idexRegister->reset();
+    if (m_exmemRegister)
+        m_exmemRegister->reset();
+    if (m_memwbRegister)
+        m_memwbRegister->reset();
+    if (m_ifStage)
+        m_ifStage->reset();
+}
+
+std::unique_ptr<Cpu> Cpu::fork() const
+{
+    auto clone            = std::make_unique<Cpu>();
+    clone->m_pipelineMode = m_pipelineMode;
+    clone->m_engine       = m_engine;
+    clone->installProgram(m_program);
+    clone->restore(snapshot());
+    return clone;
+}
+
 void Cpu::setProgramCounter(uint32_t pc)
 {
-    // Targeted debug logging for suspicious loop region
-    if (pc >= 30 && pc <= 140)
-    {
-        std::cerr << "DEBUG: Cpu::setProgramCounter old=" << m_pc << " new=" << pc << std::endl;
-    }
+    MIPS_LOG(Cpu, Trace, "setProgramCounter old=" << m_pc << " new=" << pc);
     m_pc = pc;
 }
 
@@ -244,25 +862,24 @@ uint32_t Cpu::getProgramCounter() const
 
 uint32_t Cpu::getInstructionCount() const
 {
-    return static_cast<uint32_t>(m_instructions.size());
+    return static_cast<uint32_t>(m_program->instructions().size());
 }
 
 uint32_t Cpu::getLabelAddress(const std::string& label) const
 {
-    auto it = m_labelMap.find(label);
-    if (it != m_labelMap.end())
+    const LabelMap& symbols = m_program->symbols();
+    auto            it      = symbols.find(label);
+    if (it != symbols.end())
     {
         // The assembler now stores labelMap values as byte addresses for both
         // instruction labels and data labels. Return the stored byte address
         // directly to avoid any runtime heuristics.
         uint32_t address = it->second;
-        std::cerr << "DEBUG: getLabelAddress - label='" << label << "' byteAddr=" << address
-                  << std::endl;
+        MIPS_LOG(Branch, Debug, "getLabelAddress label='" << label << "' byteAddr=" << address);
         return address;
     }
     // Label not found
-    std::cerr << "DEBUG: getLabelAddress - label='" << label << "' not found, returning 0"
-              << std::endl;
+    MIPS_LOG(Branch, Debug, "getLabelAddress label='" << label << "' not found, returning 0");
     return 0;
 }
 
@@ -278,40 +895,50 @@ bool Cpu::isPipelineMode() const
     return m_pipelineMode;
 }
 
+void Cpu::setExecutionEngine(ExecutionEngine engine)
+{
+    m_engine = engine;
+}
+
+ExecutionEngine Cpu::getExecutionEngine() const
+{
+    return m_engine;
+}
+
 void Cpu::printInt(uint32_t value)
 {
     // Trace which PC emitted this integer (covers both syscall and trap paths)
-    std::cerr << "TRACE: Cpu::printInt pc=" << m_pc << " value=" << value << std::endl;
+    MIPS_LOG(Syscall, Debug, "printInt pc=" << m_pc << " value=" << value);
 
     // Append a newline to make each printed integer appear on its own line
-    m_consoleOutput += std::to_string(value);
-    m_consoleOutput += '\n';
+    m_consoleOutput.append(std::to_string(value));
+    m_consoleOutput.append('\n');
 }
 
 void Cpu::printString(const std::string& str)
 {
     // Trace which PC emitted this string (covers both syscall and trap paths)
-    std::cerr << "TRACE: Cpu::printString pc=" << m_pc << " str='" << str << "'" << std::endl;
+    MIPS_LOG(Syscall, Debug, "printString pc=" << m_pc << " str='" << str << "'");
 
-    m_consoleOutput += str;
+    m_consoleOutput.append(str);
 }
 
 void Cpu::printChar(char character)
 {
-    unsigned char uc = static_cast<unsigned char>(character);
-    std::cerr << "TRACE: Cpu::printChar pc=" << m_pc << " ch='" << character
-              << "' (code=" << static_cast<int>(uc) << ")" << std::endl;
-    m_consoleOutput += character;
+    MIPS_LOG(Syscall, Debug,
+             "printChar pc=" << m_pc << " ch='" << character << "' (code="
+                             << static_cast<int>(static_cast<unsigned char>(character)) << ")");
+    m_consoleOutput.append(character);
 }
 
 uint32_t Cpu::readInt()
 {
     // Find next integer in input buffer
-    while (m_inputPosition < m_consoleInput.length())
+    const std::string& input = m_consoleInput.str();
+    while (m_inputPosition < input.length())
     {
         // Skip non-digit characters
-        if (!std::isdigit(m_consoleInput[m_inputPosition]) &&
-            m_consoleInput[m_inputPosition] != '-')
+        if (!std::isdigit(input[m_inputPosition]) && input[m_inputPosition] != '-')
         {
             m_inputPosition++;
             continue;
@@ -319,7 +946,7 @@ uint32_t Cpu::readInt()
 
         // Parse integer
         size_t endPos;
-        int    value = std::stoi(m_consoleInput.substr(m_inputPosition), &endPos);
+        int    value = std::stoi(input.substr(m_inputPosition), &endPos);
         m_inputPosition += endPos;
         return static_cast<uint32_t>(value);
     }
@@ -330,13 +957,26 @@ uint32_t Cpu::readInt()
 
 char Cpu::readChar()
 {
-    if (m_inputPosition < m_consoleInput.length())
+    const std::string& input = m_consoleInput.str();
+    if (m_inputPosition < input.length())
     {
-        return m_consoleInput[m_inputPosition++];
+        return input[m_inputPosition++];
     }
     return -1;  // Return EOF if no more input
 }
 
+uint32_t Cpu::sbrk(int32_t increment)
+{
+    const uint32_t oldBreak = m_heapBreak;
+    const int64_t  rounded  = (static_cast<int64_t>(increment) + 3) & ~int64_t{3};
+    const int64_t  newBreak = static_cast<int64_t>(m_heapBreak) + rounded;
+    m_heapBreak = static_cast<uint32_t>(
+        std::clamp<int64_t>(newBreak, Memory::HEAP_BASE, Memory::STACK_TOP - Memory::STACK_LIMIT));
+    MIPS_LOG(Syscall, Debug, "sbrk increment=" << increment << " break=0x" << std::hex
+                                               << m_heapBreak);
+    return oldBreak;
+}
+
 void Cpu::terminate()
 {
     m_terminated = true;
@@ -349,12 +989,12 @@ bool Cpu::shouldTerminate() const
 
 const std::string& Cpu::getConsoleOutput() const
 {
-    return m_consoleOutput;
+    return m_consoleOutput.str();
 }
 
 void Cpu::setConsoleInput(const std::string& input)
 {
-    m_consoleInput  = input;
+    m_consoleInput  = ConsoleText(input);
     m_inputPosition = 0;
 }
 
@@ -375,7 +1015,7 @@ void Cpu::initializePipeline()
 
     // Connect stages to their output registers
     m_ifStage->setOutputRegister(m_ifidRegister.get());
-    m_ifStage->setInstructions(&m_instructions);
+    m_ifStage->setInstructions(&m_program->instructions());
 
     m_idStage->setInputRegister(m_ifidRegister.get());
     m_idStage->setOutputRegister(m_idexRegister.get());
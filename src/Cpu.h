@@ -1,9 +1,17 @@
 #pragma once
 
+#include "BlockCache.h"
+#include "ConsoleText.h"
+#include "DecodedInstruction.h"
+#include "Jit.h"
+#include "RunResult.h"
+#include <array>
+#include <atomic>
 #include <cstdint>
 #include <map>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace mips
@@ -12,12 +20,57 @@ namespace mips
 class RegisterFile;
 class Memory;
 class Instruction;
+struct AssembledProgram;
 class IFStage;
 class IDStage;
 class EXStage;
 class MEMStage;
 class WBStage;
 class PipelineRegister;
+class ProgramImage;
+
+/**
+ * @brief Single-cycle execution engine selection
+ *
+ * Block (the default) runs cached basic blocks of pre-decoded records and chains
+ * directly from one block to the next; budget and termination are checked once
+ * per block. Jit is the block engine with hot blocks translated to x86-64 code
+ * (see JitCompiler); where no JIT is available it behaves exactly like Block.
+ * Decoded dispatches the same records one instruction at a time.
+ * Reference walks the Instruction objects and calls their virtual execute(); it
+ * is kept as the behavioural reference.
+ */
+enum class ExecutionEngine
+{
+    Block,
+    Jit,
+    Decoded,
+    Reference
+};
+
+/**
+ * @brief Saved architectural state of a Cpu (see Cpu::snapshot)
+ *
+ * Memory and the console text are held as copy-on-write clones, so taking a
+ * snapshot and restoring it cost a page-table copy rather than a copy of guest
+ * memory or of everything the program has printed. A snapshot can be restored
+ * any number of times, into the Cpu it came from or into a fork.
+ */
+struct CpuSnapshot
+{
+    std::array<uint32_t, 32>      registers{};
+    uint32_t                      hi            = 0;
+    uint32_t                      lo            = 0;
+    uint32_t                      pc            = 0;
+    uint64_t                      cycleCount    = 0;
+    uint64_t                      retiredCount  = 0;
+    bool                          terminated    = false;
+    ConsoleText                   consoleOutput;
+    ConsoleText                   consoleInput;
+    size_t                        inputPosition = 0;
+    uint32_t                      heapBreak     = 0;
+    std::shared_ptr<const Memory> memory;
+};
 
 /**
  * @brief Main CPU class implementing 5-stage MIPS pipeline
@@ -37,10 +90,48 @@ class Cpu
     void tick();
 
     /**
-     * @brief Load program from assembly string
+     * @brief Load program from assembly string, through loadProgramImage()
      * @param assembly Assembly code as string
+     * @param[out] skippedLines If given, receives Assembler::skippedLines()
+     * @throws std::runtime_error if the program references an undefined label
      */
-    void loadProgramFromString(const std::string& assembly);
+    void loadProgramFromString(std::string_view     assembly,
+                               std::vector<size_t>* skippedLines = nullptr);
+
+    /**
+     * @brief Install an already linked program, e.g. one decoded from a .bin image
+     *
+     * Memory is left alone, so the caller writes the program's data itself.
+     * @param instructions Instructions whose targets are resolved to indices
+     * @param labelMap Label table (byte addresses)
+     */
+    void loadLinkedProgram(std::vector<std::unique_ptr<Instruction>> instructions,
+                           std::map<std::string, uint32_t>           labelMap);
+
+    /**
+     * @brief Load a program kept up to date by an AssemblySession
+     *
+     * The instruction list is shared with the session, not copied, so reloading an
+     * edited buffer costs the lowering pass and the data writes only.
+     */
+    void loadAssembledProgram(const AssembledProgram& program);
+
+    /**
+     * @brief Attach a shared, immutable program image
+     *
+     * Takes time independent of the program's size: the image's instructions,
+     * lowered records and symbols are shared, not copied, and clean memory takes
+     * the image's data, whose pages are copied only when this Cpu writes to them.
+     * Memory already written (since the last reset()) is kept, with the image's
+     * data pages written over it. Registers, the heap break, console I/O and
+     * counters are left alone. Every other load of a program goes through here.
+     */
+    void loadProgramImage(std::shared_ptr<const ProgramImage> image);
+
+    /**
+     * @brief The program currently loaded (an empty image after reset())
+     */
+    const std::shared_ptr<const ProgramImage>& getProgramImage() const;
 
     /**
      * @brief Load program from assembly file
@@ -52,7 +143,27 @@ class Cpu
      * @brief Run for specified number of cycles
      * @param cycles Number of cycles to execute
      */
-    void run(int cycles);
+    void run(uint64_t cycles);
+
+    static constexpr uint32_t NO_STOP_PC       = UINT32_MAX;
+    static constexpr uint64_t STOP_POLL_CYCLES = 1u << 16;  // Stop-flag polling interval
+
+    /**
+     * @brief Run until the program exits, the budget is spent or a stop condition hits
+     * @param budget Maximum cycles to run (one instruction per cycle in single-cycle mode)
+     * @param stopPc Instruction index to stop at before executing it, or NO_STOP_PC
+     * @param stopFlag Polled every STOP_POLL_CYCLES cycles; the run stops once it is set
+     * @return Stop reason and the cycles spent
+     *
+     * The instruction at the current PC always runs, so a stop PC equal to the
+     * current PC is only reported when execution comes back to it. Unlike run(),
+     * leaving the program is reported as StopReason::Fault instead of idling
+     * (single-cycle mode only; a pipeline keeps draining). The batched engines
+     * run whole slices without per-instruction mode checks; with a stop PC the
+     * Jit engine runs on the block interpreter.
+     */
+    RunResult runFor(uint64_t budget, uint32_t stopPc = NO_STOP_PC,
+                     const std::atomic<bool>* stopFlag = nullptr);
 
     /**
      * @brief Get register file for testing/debugging
@@ -67,13 +178,49 @@ class Cpu
     /**
      * @brief Get current cycle count
      */
-    int getCycleCount() const;
+    uint64_t getCycleCount() const;
+
+    /**
+     * @brief Get the number of instructions retired so far
+     *
+     * Equal to the cycle count in single-cycle mode except for idle cycles past
+     * the end of the program; in pipeline mode it counts instructions leaving WB,
+     * so getCycleCount() / getRetiredInstructionCount() is the CPI.
+     */
+    uint64_t getRetiredInstructionCount() const;
+
+    /**
+     * @brief Count one instruction completing the WB stage (pipeline mode)
+     */
+    void retireInstruction();
 
     /**
      * @brief Reset CPU state
      */
     void reset();
 
+    /**
+     * @brief Capture registers, HI/LO, PC, counters, console buffers and memory
+     *
+     * Pipeline latches are not captured: restoring in pipeline mode restarts the
+     * pipeline empty at the saved PC.
+     */
+    CpuSnapshot snapshot() const;
+
+    /**
+     * @brief Return to a state captured by snapshot() of this Cpu or of its fork source
+     */
+    void restore(const CpuSnapshot& state);
+
+    /**
+     * @brief Clone this Cpu in its current state
+     *
+     * The clone shares the assembled program and the memory pages (copy-on-write)
+     * with this Cpu, so the two can then run independently, also on different
+     * threads. JIT translations are not shared; the clone warms up its own.
+     */
+    std::unique_ptr<Cpu> fork() const;
+
     /**
      * @brief Set program counter (for branch/jump instructions)
      */
@@ -104,6 +251,16 @@ class Cpu
      */
     bool isPipelineMode() const;
 
+    /**
+     * @brief Select the engine used for single-cycle execution
+     */
+    void setExecutionEngine(ExecutionEngine engine);
+
+    /**
+     * @brief Get the engine used for single-cycle execution
+     */
+    ExecutionEngine getExecutionEngine() const;
+
     /**
      * @brief Print integer to console (for syscall support)
      */
@@ -129,6 +286,14 @@ class Cpu
      */
     char readChar();
 
+    /**
+     * @brief Move the heap break (for syscall 9, sbrk)
+     * @param increment Bytes to add, rounded up to a whole word; negative shrinks
+     *                  the heap but never below Memory::HEAP_BASE
+     * @return Address of the old break, i.e. the start of the new block
+     */
+    uint32_t sbrk(int32_t increment);
+
     /**
      * @brief Set program termination flag (for syscall support)
      */
@@ -153,21 +318,27 @@ class Cpu
     std::unique_ptr<RegisterFile> m_registerFile;
     std::unique_ptr<Memory>       m_memory;
 
-    // Program storage
-    std::vector<std::unique_ptr<Instruction>> m_instructions;
+    using InstructionList = std::vector<std::unique_ptr<Instruction>>;
+
+    // Program storage: immutable, and shared with forks and other Cpus running it
+    std::shared_ptr<const ProgramImage> m_program;
+    BlockCache                          m_blockCache;  // Basic blocks of m_program->decoded()
+    JitCompiler                         m_jit;         // Translations of hot blocks
+    bool                                m_jitStale;    // m_jit not yet reset for m_program
 
-    int      m_cycleCount;
-    uint32_t m_pc;            // Program counter
-    bool     m_pipelineMode;  // Pipeline vs single-cycle mode
-    bool     m_terminated;    // Program termination flag
+    uint64_t        m_cycleCount;
+    uint64_t        m_retiredCount;  // Retired instructions
+    uint32_t        m_pc;            // Program counter
+    bool            m_pipelineMode;  // Pipeline vs single-cycle mode
+    bool            m_terminated;    // Program termination flag
+    ExecutionEngine m_engine;        // Single-cycle engine
 
-    // Console I/O for syscall support
-    std::string m_consoleOutput;
-    std::string m_consoleInput;
+    // Console I/O for syscall support, shared with snapshots and forks
+    ConsoleText m_consoleOutput;
+    ConsoleText m_consoleInput;
     size_t      m_inputPosition;
 
-    // Label to instruction address mapping
-    std::map<std::string, uint32_t> m_labelMap;
+    uint32_t m_heapBreak;  // End of the sbrk heap, from Memory::HEAP_BASE
 
     // Pipeline components
     std::unique_ptr<class IFStage>  m_ifStage;
@@ -183,10 +354,17 @@ class Cpu
     std::unique_ptr<class PipelineRegister> m_memwbRegister;
 
     // Pipeline execution methods
-    void tickPipeline();
-    void tickSingleCycle();
-    void updatePipelineRegisters();
-    void initializePipeline();
+    void     tickPipeline();
+    void     tickSingleCycle();
+    void     installProgram(std::shared_ptr<const ProgramImage> image);
+    uint64_t executeDecoded(uint64_t maxCycles, uint32_t stopPc);
+    uint64_t executeBlocks(uint64_t maxCycles, bool jit, uint32_t stopPc);
+    uint64_t executeBatch(uint64_t maxCycles, uint32_t stopPc);
+    void     executeTicks(uint64_t maxCycles, uint32_t stopPc);
+    uint32_t executeInstruction(const DecodedInstr& d, uint32_t pc, uint32_t* regs,
+                                Memory& memory);
+    void     updatePipelineRegisters();
+    void     initializePipeline();
 
     // For now, maintain single-cycle compatibility
 };
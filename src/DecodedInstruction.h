@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+namespace mips
+{
+
+/**
+ * @brief Operation codes for the pre-decoded execution engine
+ *
+ * One entry per distinct runtime behaviour. Instructions that have no compact
+ * form (system calls, traps) are lowered to Fallback and executed through the
+ * original Instruction object.
+ */
+enum class DecodedOp : uint8_t
+{
+    Nop,
+    Add,
+    Addu,
+    Sub,
+    Subu,
+    And,
+    Or,
+    Xor,
+    Nor,
+    Slt,
+    Sltu,
+    Sllv,
+    Srlv,
+    Srav,
+    Sll,
+    Srl,
+    Sra,
+    Mult,
+    Multu,
+    Div,
+    Divu,
+    Mfhi,
+    Mthi,
+    Mflo,
+    Mtlo,
+    Addi,
+    Addiu,
+    Slti,
+    Sltiu,
+    Andi,
+    Ori,
+    Xori,
+    Llo,
+    Lhi,
+    La,
+    Lw,
+    Lb,
+    Lbu,
+    Lh,
+    Lhu,
+    Sw,
+    Sb,
+    Sh,
+    Beq,
+    Bne,
+    Blez,
+    Bgtz,
+    J,
+    Jal,
+    Jr,
+    Jalr,
+    Fallback
+};
+
+/**
+ * @brief Compact POD record for one pre-decoded instruction
+ *
+ * Field usage:
+ * - rd:     destination register of every register-writing operation (the MIPS
+ *           rt field for I-type instructions); writes to $zero are lowered to Nop
+ * - rs/rt:  source registers (rt is the value register for stores)
+ * - imm:    operand already extended to 32 bits (sign- or zero-extended as the
+ *           instruction requires), shift amount, LLO/LHI field, or LA address
+ * - target: instruction index for branches/jumps, or index into the instruction
+ *           vector for Fallback
+ */
+struct DecodedInstr
+{
+    DecodedOp op = DecodedOp::Nop;
+    uint8_t   rd = 0;
+    uint8_t   rs = 0;
+    uint8_t   rt = 0;
+    uint32_t  imm    = 0;
+    uint32_t  target = 0;
+};
+
+static_assert(std::is_trivially_copyable_v<DecodedInstr>, "DecodedInstr must stay POD");
+static_assert(sizeof(DecodedInstr) == 12, "DecodedInstr should stay compact");
+
+}  // namespace mips
@@ -0,0 +1,364 @@
+#include "Disassembler.h"
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <istream>
+#include <sstream>
+#include <stdexcept>
+
+namespace mips
+{
+
+namespace
+{
+
+const char* const REGISTER_NAMES[32] = {
+    "$zero", "$at", "$v0", "$v1", "$a0", "$a1", "$a2", "$a3", "$t0", "$t1", "$t2",
+    "$t3",   "$t4", "$t5", "$t6", "$t7", "$s0", "$s1", "$s2", "$s3", "$s4", "$s5",
+    "$s6",   "$s7", "$t8", "$t9", "$k0", "$k1", "$gp", "$sp", "$fp", "$ra"};
+
+// Operand layouts, in assembler syntax
+enum class Syntax : uint8_t
+{
+    Invalid,
+    RdRsRt,      // add rd, rs, rt
+    RdRtRs,      // sllv rd, rt, rs
+    RdRtShamt,   // sll rd, rt, shamt
+    RsRt,        // mult rs, rt
+    Rd,          // mfhi rd
+    Rs,          // mthi rs, jr rs
+    RdRs,        // jalr rd, rs
+    None,        // syscall
+    RtRsImm,     // addi rt, rs, -5
+    RtRsHex,     // ori rt, rs, 0xffff (zero-extended)
+    RtHex,       // llo rt, 0x1234
+    Memory,      // lw rt, -4(rs)
+    RsRtBranch,  // beq rs, rt, target
+    RsBranch,    // blez rs, target
+    Jump,        // j target
+    Trap         // trap code
+};
+
+struct Mnemonic
+{
+    const char* name   = nullptr;
+    Syntax      syntax = Syntax::Invalid;
+};
+
+// Indexed like InstructionDecoder's table: by opcode, or 64 + funct for R-type
+constexpr std::array<Mnemonic, 128> buildMnemonics()
+{
+    std::array<Mnemonic, 128> table{};
+
+    table[0x02] = {"j", Syntax::Jump};
+    table[0x03] = {"jal", Syntax::Jump};
+    table[0x04] = {"beq", Syntax::RsRtBranch};
+    table[0x05] = {"bne", Syntax::RsRtBranch};
+    table[0x06] = {"blez", Syntax::RsBranch};
+    table[0x07] = {"bgtz", Syntax::RsBranch};
+    table[0x08] = {"addi", Syntax::RtRsImm};
+    table[0x09] = {"addiu", Syntax::RtRsImm};
+    table[0x0A] = {"slti", Syntax::RtRsImm};
+    table[0x0B] = {"sltiu", Syntax::RtRsImm};
+    table[0x0C] = {"andi", Syntax::RtRsHex};
+    table[0x0D] = {"ori", Syntax::RtRsHex};
+    table[0x0E] = {"xori", Syntax::RtRsHex};
+    table[0x18] = {"llo", Syntax::RtHex};
+    table[0x19] = {"lhi", Syntax::RtHex};
+    table[0x1A] = {"trap", Syntax::Trap};
+    table[0x20] = {"lb", Syntax::Memory};
+    table[0x21] = {"lh", Syntax::Memory};
+    table[0x23] = {"lw", Syntax::Memory};
+    table[0x24] = {"lbu", Syntax::Memory};
+    table[0x25] = {"lhu", Syntax::Memory};
+    table[0x28] = {"sb", Syntax::Memory};
+    table[0x29] = {"sh", Syntax::Memory};
+    table[0x2B] = {"sw", Syntax::Memory};
+
+    table[64 + 0x00] = {"sll", Syntax::RdRtShamt};
+    table[64 + 0x02] = {"srl", Syntax::RdRtShamt};
+    table[64 + 0x03] = {"sra", Syntax::RdRtShamt};
+    table[64 + 0x04] = {"sllv", Syntax::RdRtRs};
+    table[64 + 0x06] = {"srlv", Syntax::RdRtRs};
+    table[64 + 0x07] = {"srav", Syntax::RdRtRs};
+    table[64 + 0x08] = {"jr", Syntax::Rs};
+    table[64 + 0x09] = {"jalr", Syntax::RdRs};
+    table[64 + 0x0C] = {"syscall", Syntax::None};
+    table[64 + 0x10] = {"mfhi", Syntax::Rd};
+    table[64 + 0x11] = {"mthi", Syntax::Rs};
+    table[64 + 0x12] = {"mflo", Syntax::Rd};
+    table[64 + 0x13] = {"mtlo", Syntax::Rs};
+    table[64 + 0x18] = {"mult", Syntax::RsRt};
+    table[64 + 0x19] = {"multu", Syntax::RsRt};
+    table[64 + 0x1A] = {"div", Syntax::RsRt};
+    table[64 + 0x1B] = {"divu", Syntax::RsRt};
+    table[64 + 0x20] = {"add", Syntax::RdRsRt};
+    table[64 + 0x21] = {"addu", Syntax::RdRsRt};
+    table[64 + 0x22] = {"sub", Syntax::RdRsRt};
+    table[64 + 0x23] = {"subu", Syntax::RdRsRt};
+    table[64 + 0x24] = {"and", Syntax::RdRsRt};
+    table[64 + 0x25] = {"or", Syntax::RdRsRt};
+    table[64 + 0x26] = {"xor", Syntax::RdRsRt};
+    table[64 + 0x27] = {"nor", Syntax::RdRsRt};
+    table[64 + 0x2A] = {"slt", Syntax::RdRsRt};
+    table[64 + 0x2B] = {"sltu", Syntax::RdRsRt};
+    return table;
+}
+
+constexpr std::array<Mnemonic, 128> MNEMONICS = buildMnemonics();
+
+void appendDecimal(std::string& out, int64_t value)
+{
+    char buffer[24];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, result.ptr);
+}
+
+// Fixed-width lower-case hex, no prefix
+void appendHex(std::string& out, uint32_t value, int digits)
+{
+    static constexpr char DIGITS[] = "0123456789abcdef";
+    char                  buffer[8];
+    for (int i = digits - 1; i >= 0; --i)
+    {
+        buffer[i] = DIGITS[value & 0xF];
+        value >>= 4;
+    }
+    out.append(buffer, static_cast<size_t>(digits));
+}
+
+void appendRegister(std::string& out, uint32_t reg)
+{
+    out += REGISTER_NAMES[reg & 0x1F];
+}
+
+void appendSeparator(std::string& out)
+{
+    out += ", ";
+}
+
+}  // namespace
+
+Disassembler::Disassembler(const std::map<std::string, uint32_t>& symbols)
+{
+    m_symbols.reserve(symbols.size());
+    for (const auto& [name, address] : symbols)
+    {
+        m_symbols.emplace_back(address, name);
+    }
+    std::sort(m_symbols.begin(), m_symbols.end());
+}
+
+void Disassembler::disassemble(const uint32_t* words, size_t count, uint32_t firstIndex,
+                               std::string& out) const
+{
+    // Labels are visited in address order alongside the words
+    auto label = std::lower_bound(m_symbols.begin(), m_symbols.end(),
+                                  std::make_pair(firstIndex * 4, std::string()));
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const uint32_t index   = firstIndex + static_cast<uint32_t>(i);
+        const uint32_t address = index * 4;
+        while (label != m_symbols.end() && label->first < address)
+        {
+            ++label;  // Not word-aligned, so no line of its own
+        }
+        for (; label != m_symbols.end() && label->first == address; ++label)
+        {
+            out += label->second;
+            out += ":\n";
+        }
+
+        appendHex(out, address, 8);
+        out += "  ";
+        appendHex(out, words[i], 8);
+        out += "  ";
+        formatInstruction(words[i], index, out);
+        out += '\n';
+    }
+}
+
+void Disassembler::formatInstruction(uint32_t word, uint32_t index, std::string& out) const
+{
+    if (word == 0)
+    {
+        out += "nop";  // sll $zero, $zero, 0
+        return;
+    }
+
+    const uint32_t opcode = word >> 26;
+    const Mnemonic m      = MNEMONICS[opcode == 0 ? 64 + (word & 0x3F) : opcode];
+    if (m.syntax == Syntax::Invalid)
+    {
+        out += ".word 0x";
+        appendHex(out, word, 8);
+        return;
+    }
+
+    const uint32_t rs              = (word >> 21) & 0x1F;
+    const uint32_t rt              = (word >> 16) & 0x1F;
+    const uint32_t rd              = (word >> 11) & 0x1F;
+    const uint32_t low             = word & 0xFFFF;
+    const int16_t  signedImmediate = static_cast<int16_t>(low);
+
+    out += m.name;
+    if (m.syntax != Syntax::None)
+    {
+        out += ' ';
+    }
+
+    switch (m.syntax)
+    {
+    case Syntax::RdRsRt:
+        appendRegister(out, rd);
+        appendSeparator(out);
+        appendRegister(out, rs);
+        appendSeparator(out);
+        appendRegister(out, rt);
+        break;
+    case Syntax::RdRtRs:
+        appendRegister(out, rd);
+        appendSeparator(out);
+        appendRegister(out, rt);
+        appendSeparator(out);
+        appendRegister(out, rs);
+        break;
+    case Syntax::RdRtShamt:
+        appendRegister(out, rd);
+        appendSeparator(out);
+        appendRegister(out, rt);
+        appendSeparator(out);
+        appendDecimal(out, (word >> 6) & 0x1F);
+        break;
+    case Syntax::RsRt:
+        appendRegister(out, rs);
+        appendSeparator(out);
+        appendRegister(out, rt);
+        break;
+    case Syntax::Rd:
+        appendRegister(out, rd);
+        break;
+    case Syntax::Rs:
+        appendRegister(out, rs);
+        break;
+    case Syntax::RdRs:
+        appendRegister(out, rd);
+        appendSeparator(out);
+        appendRegister(out, rs);
+        break;
+    case Syntax::RtRsImm:
+        appendRegister(out, rt);
+        appendSeparator(out);
+        appendRegister(out, rs);
+        appendSeparator(out);
+        appendDecimal(out, signedImmediate);
+        break;
+    case Syntax::RtRsHex:
+        appendRegister(out, rt);
+        appendSeparator(out);
+        appendRegister(out, rs);
+        out += ", 0x";
+        appendHex(out, low, 4);
+        break;
+    case Syntax::RtHex:
+        appendRegister(out, rt);
+        out += ", 0x";
+        appendHex(out, low, 4);
+        break;
+    case Syntax::Memory:
+        appendRegister(out, rt);
+        appendSeparator(out);
+        appendDecimal(out, signedImmediate);
+        out += '(';
+        appendRegister(out, rs);
+        out += ')';
+        break;
+    case Syntax::RsRtBranch:
+        appendRegister(out, rs);
+        appendSeparator(out);
+        appendRegister(out, rt);
+        appendSeparator(out);
+        appendTarget(index + 1 + static_cast<uint32_t>(static_cast<int32_t>(signedImmediate)),
+                     out);
+        break;
+    case Syntax::RsBranch:
+        appendRegister(out, rs);
+        appendSeparator(out);
+        appendTarget(index + 1 + static_cast<uint32_t>(static_cast<int32_t>(signedImmediate)),
+                     out);
+        break;
+    case Syntax::Jump:
+        appendTarget(word & 0x03FFFFFF, out);
+        break;
+    case Syntax::Trap:
+        appendDecimal(out, word & 0x03FFFFFF);
+        break;
+    case Syntax::None:
+    case Syntax::Invalid:
+        break;
+    }
+}
+
+void Disassembler::appendTarget(uint32_t index, std::string& out) const
+{
+    const uint32_t address = index * 4;
+    out += "0x";
+    appendHex(out, address, 8);
+
+    auto it = std::lower_bound(m_symbols.begin(), m_symbols.end(),
+                               std::make_pair(address, std::string()));
+    if (it != m_symbols.end() && it->first == address)
+    {
+        out += " <";
+        out += it->second;
+        out += '>';
+    }
+}
+
+bool Disassembler::readSymbolMap(std::istream& in, std::map<std::string, uint32_t>& symbols,
+                                 std::string& error)
+{
+    std::string line;
+    size_t      lineNumber = 0;
+    while (std::getline(in, line))
+    {
+        ++lineNumber;
+        const size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#')
+        {
+            continue;
+        }
+
+        std::istringstream fields(line);
+        std::string        name;
+        std::string        address;
+        std::string        extra;
+        fields >> name >> address;
+        if (address.empty() || (fields >> extra))
+        {
+            error = "symbol map line " + std::to_string(lineNumber) +
+                    ": expected <label> <address>";
+            return false;
+        }
+        try
+        {
+            size_t              used  = 0;
+            const unsigned long value = std::stoul(address, &used, 0);
+            if (used != address.size() || value > UINT32_MAX)
+            {
+                throw std::out_of_range(address);
+            }
+            symbols[name] = static_cast<uint32_t>(value);
+        }
+        catch (const std::exception&)
+        {
+            error = "symbol map line " + std::to_string(lineNumber) + ": invalid address '" +
+                    address + "'";
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace mips
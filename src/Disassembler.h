@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace mips
+{
+
+/**
+ * @brief Text disassembler for machine words (the encoding InstructionDecoder reads)
+ *
+ * Each word becomes one line, "<address>  <word>  <instruction>", preceded by a
+ * "<label>:" line for every symbol at that address; branch and jump targets are
+ * annotated with the symbol they land on. Text starts at address 0, so word i
+ * sits at byte i * 4. Words that are not valid instructions print as ".word".
+ *
+ * Formatting appends to a caller-owned string and allocates nothing else, so
+ * disjoint ranges of one image can be formatted concurrently with one
+ * Disassembler.
+ */
+class Disassembler
+{
+  public:
+    /**
+     * @param symbols Label table (byte addresses), e.g. ObjectFile::symbols
+     */
+    explicit Disassembler(const std::map<std::string, uint32_t>& symbols = {});
+
+    /**
+     * @brief Append the listing of a run of words
+     * @param words Machine words
+     * @param count Number of words
+     * @param firstIndex Instruction index of words[0]
+     * @param out Receives the lines
+     */
+    void disassemble(const uint32_t* words, size_t count, uint32_t firstIndex,
+                     std::string& out) const;
+
+    /**
+     * @brief Append one instruction in assembler syntax, without address or newline
+     * @param index Instruction index of the word, to resolve branch offsets
+     */
+    void formatInstruction(uint32_t word, uint32_t index, std::string& out) const;
+
+    /**
+     * @brief Parse a symbol map written by 'mipsim assemble --map'
+     *
+     * One "<label> <address>" pair per line; blank lines and '#' comments are skipped.
+     * @param error Set to a description of the problem on failure
+     * @return false on a malformed line
+     */
+    static bool readSymbolMap(std::istream& in, std::map<std::string, uint32_t>& symbols,
+                              std::string& error);
+
+  private:
+    void appendTarget(uint32_t index, std::string& out) const;
+
+    std::vector<std::pair<uint32_t, std::string>> m_symbols;  // Sorted by address
+};
+
+}  // namespace mips
@@ -1,8 +1,8 @@
 #include "IFStage.h"
 #include "Cpu.h"
 #include "Instruction.h"
+#include "Log.h"
 #include "Stage.h"
-#include <iostream>
 
 namespace mips
 {
@@ -58,11 +58,7 @@ void IFStage::execute()
         return;
     }
 
-    if (pc >= 30 && pc <= 140)
-    {
-        std::cerr << "DEBUG: IFStage fetch PC=" << pc << " instr='" << instruction->getName() << "'"
-                  << std::endl;
-    }
+    MIPS_LOG(Pipeline, Trace, "IF fetch pc=" << pc << " instr='" << instruction->getName() << "'");
 
     // Create pipeline data
     PipelineData data;
@@ -1,13 +1,162 @@
 #include "Instruction.h"
 #include "Cpu.h"
+#include "InstructionArena.h"
+#include "Log.h"
 #include "Memory.h"
 #include "RegisterFile.h"
+#include <algorithm>
 #include <cstdio>
-#include <iostream>
+#include <vector>
 
 namespace mips
 {
 
+namespace
+{
+
+// Writes to $zero have no architectural effect, so they lower to a no-op
+bool lowerRegisterWrite(DecodedInstr& out, DecodedOp op, int rd, int rs, int rt, uint32_t imm)
+{
+    out.op  = rd == 0 ? DecodedOp::Nop : op;
+    out.rd  = static_cast<uint8_t>(rd);
+    out.rs  = static_cast<uint8_t>(rs);
+    out.rt  = static_cast<uint8_t>(rt);
+    out.imm = imm;
+    return true;
+}
+
+// Decimal byte list for tracing strings read by print_string
+[[maybe_unused]] std::string formatBytes(const std::vector<uint8_t>& bytes)
+{
+    std::string text;
+    for (size_t i = 0; i < bytes.size(); ++i)
+    {
+        if (!text.empty())
+            text += ' ';
+        text += std::to_string(bytes[i]);
+    }
+    return text;
+}
+
+// Reports the label of a failed link so the assembler can list every undefined symbol
+bool linkLabel(LabelRef& ref, const LabelMap& labelMap, std::string& unresolvedLabel)
+{
+    if (ref.link(labelMap))
+    {
+        return true;
+    }
+    unresolvedLabel = ref.name();
+    return false;
+}
+
+}  // namespace
+
+LabelRef::LabelRef(std::string_view name) : m_address(0), m_linked(false)
+{
+    setName(name);
+}
+
+// Copied again, so a clone never refers to the arena of the original
+LabelRef::LabelRef(const LabelRef& other) : m_address(other.m_address), m_linked(other.m_linked)
+{
+    setName(other.m_name);
+}
+
+LabelRef& LabelRef::operator=(const LabelRef& other)
+{
+    if (this != &other)
+    {
+        freeName();
+        setName(other.m_name);
+        m_address = other.m_address;
+        m_linked  = other.m_linked;
+    }
+    return *this;
+}
+
+LabelRef::~LabelRef()
+{
+    freeName();
+}
+
+void LabelRef::setName(std::string_view name)
+{
+    m_ownsName = !InstructionArena::intern(name, this, m_name);
+    if (m_ownsName)
+    {
+        char* copy = new char[name.size()];
+        std::copy(name.begin(), name.end(), copy);
+        m_name = std::string_view(copy, name.size());
+    }
+}
+
+void LabelRef::freeName()
+{
+    if (m_ownsName)
+    {
+        delete[] m_name.data();
+        m_ownsName = false;
+    }
+}
+
+bool LabelRef::link(const LabelMap& labelMap)
+{
+    // LabelMap has std::string keys; reuse one key buffer instead of a string per lookup
+    thread_local std::string key;
+    key.assign(m_name);
+    auto it = labelMap.find(key);
+    if (it == labelMap.end())
+    {
+        return false;
+    }
+    m_address = it->second;
+    m_linked  = true;
+    return true;
+}
+
+uint32_t LabelRef::resolve(const Cpu& cpu) const
+{
+    return m_linked ? m_address : cpu.getLabelAddress(std::string(m_name));
+}
+
+std::string_view LabelRef::name() const
+{
+    return m_name;
+}
+
+bool LabelRef::isLinked() const
+{
+    return m_linked;
+}
+
+uint32_t LabelRef::address() const
+{
+    return m_address;
+}
+
+void* Instruction::operator new(size_t size)
+{
+    return InstructionArena::allocate(size);
+}
+
+void Instruction::operator delete(void* pointer)
+{
+    InstructionArena::deallocate(pointer);
+}
+
+bool Instruction::link(const LabelMap& labelMap, std::string& unresolvedLabel)
+{
+    (void)labelMap;
+    (void)unresolvedLabel;
+    return true;
+}
+
+bool Instruction::lower(DecodedInstr& out) const
+{
+    (void)out;
+    return false;
+}
+
 RTypeInstruction::RTypeInstruction(int rd, int rs, int rt) : m_rd(rd), m_rs(rs), m_rt(rt) {}
 
 AddInstruction::AddInstruction(int rd, int rs, int rt) : RTypeInstruction(rd, rs, rt) {}
@@ -27,6 +176,16 @@ std::string AddInstruction::getName() const
     return "add";
 }
 
+std::unique_ptr<Instruction> AddInstruction::clone() const
+{
+    return std::make_unique<AddInstruction>(*this);
+}
+
+bool AddInstruction::lower(DecodedInstr& out) const
+{
+    return lowerRegisterWrite(out, DecodedOp::Add, m_rd, m_rs, m_rt, 0);
+}
+
 ADDUInstruction::ADDUInstruction(int rd, int rs, int rt) : RTypeInstruction(rd, rs, rt) {}
 
 void ADDUInstruction::execute(Cpu& cpu)
@@ -44,6 +203,16 @@ std::string ADDUInstruction::getName() const
     return "addu";
 }
 
+std::unique_ptr<Instruction> ADDUInstruction::clone() const
+{
+    return std::make_unique<ADDUInstruction>(*this);
+}
+
+bool ADDUInstruction::lower(DecodedInstr& out) const
+{
+    return lowerRegisterWrite(out, DecodedOp::Addu, m_rd, m_rs, m_rt, 0);
+}
+
 SubInstruction::SubInstruction(int rd, int rs, int rt) : RTypeInstruction(rd, rs, rt) {}
 
 void SubInstruction::execute(Cpu& cpu)
@@ -61,6 +230,16 @@ std::string SubInstruction::getName() const
     return "sub";
 }
 
+std::unique_ptr<Instruction> SubInstruction::clone() const
+{
+    return std::make_unique<SubInstruction>(*this);
+}
+
+bool SubInstruction::lower(DecodedInstr& out) const
+{
+    return lowerRegisterWrite(out, DecodedOp::Sub, m_rd, m_rs, m_rt, 0);
+}
+
 SUBUInstruction::SUBUInstruction(int rd, int rs, int rt) : RTypeInstruction(rd, rs, rt) {}
 
 void SUBUInstruction::execute(Cpu& cpu)
@@ -78,6 +257,16 @@ std::string SUBUInstruction::getName() const
     return "subu";
 }
 
+std::unique_ptr<Instruction> SUBUInstruction::clone() const
+{
+    return std::make_unique<SUBUInstruction>(*this);
+}
+
+bool SUBUInstruction::lower(DecodedInstr& out) const
+{
+    return lowerRegisterWrite(out, DecodedOp::Subu, m_rd, m_rs, m_rt, 0);
+}
+
 AndInstruction::AndInstruction(int rd, int rs, int rt) : RTypeInstruction(rd, rs, rt) {}
 
 void AndInstruction::execute(Cpu& cpu)
@@ -95,6 +284,16 @@ std::string AndInstruction::getName() const
     return "and";
 }
 
+std::unique_ptr<Instruction> AndInstruction::clone() const
+{
+    return std::make_unique<AndInstruction>(*this);
+}
+
+bool AndInstruction::lower(DecodedInstr& out) const
+{
+    return lowerRegisterWrite(out, DecodedOp::And, m_rd, m_rs, m_rt, 0);
+}
+
 OrInstruction::OrInstruction(int rd, int rs, int rt) : RTypeInstruction(rd, rs, rt) {}
 
 void OrInstruction::execute(Cpu& cpu)
@@ -112,6 +311,16 @@ std::string OrInstruction::getName() const
     return "or";
 }
 
+std::unique_ptr<Instruction> OrInstruction::clone() const
+{
+    return std::make_unique<OrInstruction>(*this);
+}
+
+bool OrInstruction::lower(DecodedInstr& out) const
+{
+    return lowerRegisterWrite(out, DecodedOp::Or, m_rd, m_rs, m_rt, 0);
+}
+
 XorInstruction::XorInstruction(int rd, int rs, int rt) : RTypeInstruction(rd, rs, rt) {}
 
 void XorInstruction::execute(Cpu& cpu)
@@ -129,6 +338,16 @@ std::string XorInstruction::getName() const
     return "xor";
 }
 
+std::unique_ptr<Instruction> XorInstruction::clone() const
+{
+    return std::make_unique<XorInstruction>(*this);
+}
+
+bool XorInstruction::lower(DecodedInstr& out) const
+{
+    return lowerRegisterWrite(out, DecodedOp::Xor, m_rd, m_rs, m_rt, 0);
+}
+
 NorInstruction::NorInstruction(int rd, int rs, int rt) : RTypeInstruction(rd, rs, rt) {}
 
 void NorInstruction::execute(Cpu& cpu)
@@ -146,6 +365,16 @@ std::string NorInstruction::getName() const
     return "nor";
 }
 
+std::unique_ptr<Instruction> NorInstruction::clone() const
+{
+    return std::make_unique<NorInstruction>(*this);
+}
+
+bool NorInstruction::lower(DecodedInstr& out) const
+{
+    return lowerRegisterWrite(out, DecodedOp::Nor, m_rd, m_rs, m_rt, 0);
+}
+
 SltInstruction::SltInstruction(int rd, int rs, int rt) : RTypeInstruction(rd, rs, rt) {}
 
 void SltInstruction::execute(Cpu& cpu)
@@ -166,6 +395,16 @@ std::string SltInstruction::getName() const
     return "slt";
 }
 
+std::unique_ptr<Instruction> SltInstruction::clone() const
+{
+    return std::make_unique<SltInstruction>(*this);
+}
+
+bool SltInstruction::lower(DecodedInstr& out) const
+{
+    return lowerRegisterWrite(out, DecodedOp::Slt, m_rd, m_rs, m_rt, 0);
+}
+
 SltuInstruction::SltuInstruction(int rd, int rs, int rt) : RTypeInstruction(rd, rs, rt) {}
 
 void SltuInstruction::execute(Cpu& cpu)
@@ -186,6 +425,16 @@ std::string SltuInstruction::getName() const
     return "sltu";
 }
 
+std::unique_ptr<Instruction> SltuInstruction::clone() const
+{
+    return std::make_unique<SltuInstruction>(*this);
+}
+
+bool SltuInstruction::lower(DecodedInstr& out) const
+{
+    return lowerRegisterWrite(out, DecodedOp::Sltu, m_rd, m_rs, m_rt, 0);
+}
+
 MULTInstruction::MULTInstruction(int rs, int rt) : m_rs(rs), m_rt(rt) {}
 
 void MULTInstruction::execute(Cpu& cpu)
@@ -214,6 +463,19 @@ std::string MULTInstruction::getName() const
     return "mult";
 }
 
+std::unique_ptr<Instruction> MULTInstruction::clone() const
+{
+    return std::make_unique<MULTInstruction>(*this);
+}
+
+bool MULTInstruction::lower(DecodedInstr& out) const
+{
+    out.op = DecodedOp::Mult;
+    out.rs = static_cast<uint8_t>(m_rs);
+    out.rt = static_cast<uint8_t>(m_rt);
+    return true;
+}
+
 MULTUInstruction::MULTUInstruction(int rs, int rt) : m_rs(rs), m_rt(rt) {}
 
 void MULTUInstruction::execute(Cpu& cpu)
@@ -242,6 +504,19 @@ std::string MULTUInstruction::getName() const
     return "multu";
 }
 
+std::unique_ptr<Instruction> MULTUInstruction::clone() const
+{
+    return std::make_unique<MULTUInstruction>(*this);
+}
+
+bool MULTUInstruction::lower(DecodedInstr& out) const
+{
+    out.op = DecodedOp::Multu;
+    out.rs = static_cast<uint8_t>(m_rs);
+    out.rt = static_cast<uint8_t>(m_rt);
+    return true;
+}
+
 DIVInstruction::DIVInstruction(int rs, int rt) : m_rs(rs), m_rt(rt) {}
 
 void DIVInstruction::execute(Cpu& cpu)
@@ -256,6 +531,12 @@ void DIVInstruction::execute(Cpu& cpu)
         cpu.getRegisterFile().writeHI(0);
         cpu.getRegisterFile().writeLO(0);
     }
+    else if (rtValue == -1)
+    {
+        // INT_MIN / -1 traps on the host; the quotient wraps and there is no remainder
+        cpu.getRegisterFile().writeLO(0u - static_cast<uint32_t>(rsValue));
+        cpu.getRegisterFile().writeHI(0);
+    }
     else
     {
         // Perform signed division
@@ -276,6 +557,19 @@ std::string DIVInstruction::getName() const
     return "div";
 }
 
+std::unique_ptr<Instruction> DIVInstruction::clone() const
+{
+    return std::make_unique<DIVInstruction>(*this);
+}
+
+bool DIVInstruction::lower(DecodedInstr& out) const
+{
+    out.op = DecodedOp::Div;
+    out.rs = static_cast<uint8_t>(m_rs);
+    out.rt = static_cast<uint8_t>(m_rt);
+    return true;
+}
+
 DIVUInstruction::DIVUInstruction(int rs, int rt) : m_rs(rs), m_rt(rt) {}
 
 void DIVUInstruction::execute(Cpu& cpu)
@@ -310,6 +604,19 @@ std::string DIVUInstruction::getName() const
     return "divu";
 }
 
+std::unique_ptr<Instruction> DIVUInstruction::clone() const
+{
+    return std::make_unique<DIVUInstruction>(*this);
+}
+
+bool DIVUInstruction::lower(DecodedInstr& out) const
+{
+    out.op = DecodedOp::Divu;
+    out.rs = static_cast<uint8_t>(m_rs);
+    out.rt = static_cast<uint8_t>(m_rt);
+    return true;
+}
+
 SltiInstruction::SltiInstruction(int rt, int rs, int16_t imm) : ITypeInstruction(rt, rs, imm) {}
 
 void SltiInstruction::execute(Cpu& cpu)
@@ -332,6 +639,16 @@ std::string SltiInstruction::getName() const
     return "slti";
 }
 
+std::unique_ptr<Instruction> SltiInstruction::clone() const
+{
+    return std::make_unique<SltiInstruction>(*this);
+}
+
+bool SltiInstruction::lower(DecodedInstr& out) const
+{
+    return lowerRegisterWrite(out, DecodedOp::Slti, m_rt, m_rs, 0, signExtend16(m_imm));
+}
+
 SltiuInstruction::SltiuInstruction(int rt, int rs, int16_t imm) : ITypeInstruction(rt, rs, imm) {}
 
 void SltiuInstruction::execute(Cpu& cpu)
@@ -355,6 +672,16 @@ std::string SltiuInstruction::getName() const
     return "sltiu";
 }
 
+std::unique_ptr<Instruction> SltiuInstruction::clone() const
+{
+    return std::make_unique<SltiuInstruction>(*this);
+}
+
+bool SltiuInstruction::lower(DecodedInstr& out) const
+{
+    return lowerRegisterWrite(out, DecodedOp::Sltiu, m_rt, m_rs, 0, signExtend16(m_imm));
+}
+
 OriInstruction::OriInstruction(int rt, int rs, int16_t imm) : ITypeInstruction(rt, rs, imm) {}
 
 void OriInstruction::execute(Cpu& cpu)
@@ -379,6 +706,17 @@ std::string OriInstruction::getName() const
     return "ori";
 }
 
+std::unique_ptr<Instruction> OriInstruction::clone() const
+{
+    return std::make_unique<OriInstruction>(*this);
+}
+
+bool OriInstruction::lower(DecodedInstr& out) const
+{
+    return lowerRegisterWrite(out, DecodedOp::Ori, m_rt, m_rs, 0,
+                              static_cast<uint32_t>(static_cast<uint16_t>(m_imm)));
+}
+
 AndiInstruction::AndiInstruction(int rt, int rs, int16_t imm) : ITypeInstruction(rt, rs, imm) {}
 
 void AndiInstruction::execute(Cpu& cpu)
@@ -403,6 +741,17 @@ std::string AndiInstruction::getName() const
     return "andi";
 }
 
+std::unique_ptr<Instruction> AndiInstruction::clone() const
+{
+    return std::make_unique<AndiInstruction>(*this);
+}
+
+bool AndiInstruction::lower(DecodedInstr& out) const
+{
+    return lowerRegisterWrite(out, DecodedOp::Andi, m_rt, m_rs, 0,
+                              static_cast<uint32_t>(static_cast<uint16_t>(m_imm)));
+}
+
 XoriInstruction::XoriInstruction(int rt, int rs, int16_t imm) : ITypeInstruction(rt, rs, imm) {}
 
 void XoriInstruction::execute(Cpu& cpu)
@@ -426,6 +775,17 @@ std::string XoriInstruction::getName() const
     return "xori";
 }
 
+std::unique_ptr<Instruction> XoriInstruction::clone() const
+{
+    return std::make_unique<XoriInstruction>(*this);
+}
+
+bool XoriInstruction::lower(DecodedInstr& out) const
+{
+    return lowerRegisterWrite(out, DecodedOp::Xori, m_rt, m_rs, 0,
+                              static_cast<uint32_t>(static_cast<uint16_t>(m_imm)));
+}
+
 ITypeInstruction::ITypeInstruction(int rt, int rs, int16_t imm) : m_rt(rt), m_rs(rs), m_imm(imm) {}
 
 uint32_t ITypeInstruction::signExtend16(int16_t value)
@@ -450,6 +810,16 @@ std::string AddiInstruction::getName() const
     return "addi";
 }
 
+std::unique_ptr<Instruction> AddiInstruction::clone() const
+{
+    return std::make_unique<AddiInstruction>(*this);
+}
+
+bool AddiInstruction::lower(DecodedInstr& out) const
+{
+    return lowerRegisterWrite(out, DecodedOp::Addi, m_rt, m_rs, 0, signExtend16(m_imm));
+}
+
 // ADDIU instruction implementation
 ADDIUInstruction::ADDIUInstruction(int rt, int rs, int16_t imm) : ITypeInstruction(rt, rs, imm) {}
 
@@ -468,6 +838,16 @@ std::string ADDIUInstruction::getName() const
     return "addiu";
 }
 
+std::unique_ptr<Instruction> ADDIUInstruction::clone() const
+{
+    return std::make_unique<ADDIUInstruction>(*this);
+}
+
+bool ADDIUInstruction::lower(DecodedInstr& out) const
+{
+    return lowerRegisterWrite(out, DecodedOp::Addiu, m_rt, m_rs, 0, signExtend16(m_imm));
+}
+
 LwInstruction::LwInstruction(int rt, int rs, int16_t offset) : ITypeInstruction(rt, rs, offset) {}
 
 void LwInstruction::execute(Cpu& cpu)
@@ -486,6 +866,16 @@ std::string LwInstruction::getName() const
     return "lw";
 }
 
+std::unique_ptr<Instruction> LwInstruction::clone() const
+{
+    return std::make_unique<LwInstruction>(*this);
+}
+
+bool LwInstruction::lower(DecodedInstr& out) const
+{
+    return lowerRegisterWrite(out, DecodedOp::Lw, m_rt, m_rs, 0, signExtend16(m_imm));
+}
+
 LBInstruction::LBInstruction(int rt, int rs, int16_t offset) : ITypeInstruction(rt, rs, offset) {}
 
 void LBInstruction::execute(Cpu& cpu)
@@ -513,6 +903,16 @@ std::string LBInstruction::getName() const
     return "lb";
 }
 
+std::unique_ptr<Instruction> LBInstruction::clone() const
+{
+    return std::make_unique<LBInstruction>(*this);
+}
+
+bool LBInstruction::lower(DecodedInstr& out) const
+{
+    return lowerRegisterWrite(out, DecodedOp::Lb, m_rt, m_rs, 0, signExtend16(m_imm));
+}
+
 SBInstruction::SBInstruction(int rt, int rs, int16_t offset) : ITypeInstruction(rt, rs, offset) {}
 
 void SBInstruction::execute(Cpu& cpu)
@@ -538,6 +938,20 @@ std::string SBInstruction::getName() const
     return "sb";
 }
 
+std::unique_ptr<Instruction> SBInstruction::clone() const
+{
+    return std::make_unique<SBInstruction>(*this);
+}
+
+bool SBInstruction::lower(DecodedInstr& out) const
+{
+    out.op  = DecodedOp::Sb;
+    out.rs  = static_cast<uint8_t>(m_rs);
+    out.rt  = static_cast<uint8_t>(m_rt);
+    out.imm = signExtend16(m_imm);
+    return true;
+}
+
 LBUInstruction::LBUInstruction(int rt, int rs, int16_t offset) : ITypeInstruction(rt, rs, offset) {}
 
 void LBUInstruction::execute(Cpu& cpu)
@@ -550,8 +964,9 @@ void LBUInstruction::execute(Cpu& cpu)
     uint8_t  byteValue         = cpu.getMemory().readByte(address);
     uint32_t zeroExtendedValue = static_cast<uint32_t>(byteValue);  // Automatic zero extension
 
-    std::cerr << "TRACE: LBU pc=" << cpu.getProgramCounter() << " addr=" << address
-              << " byte=" << static_cast<uint32_t>(byteValue) << std::endl;
+    MIPS_LOG(Memory, Trace,
+             "LBU pc=" << cpu.getProgramCounter() << " addr=" << address
+                       << " byte=" << static_cast<uint32_t>(byteValue));
 
     cpu.getRegisterFile().write(m_rt, zeroExtendedValue);
     cpu.setProgramCounter(cpu.getProgramCounter() + 1);
@@ -562,6 +977,16 @@ std::string LBUInstruction::getName() const
     return "lbu";
 }
 
+std::unique_ptr<Instruction> LBUInstruction::clone() const
+{
+    return std::make_unique<LBUInstruction>(*this);
+}
+
+bool LBUInstruction::lower(DecodedInstr& out) const
+{
+    return lowerRegisterWrite(out, DecodedOp::Lbu, m_rt, m_rs, 0, signExtend16(m_imm));
+}
+
 LHInstruction::LHInstruction(int rt, int rs, int16_t offset) : ITypeInstruction(rt, rs, offset) {}
 
 void LHInstruction::execute(Cpu& cpu)
@@ -595,6 +1020,16 @@ std::string LHInstruction::getName() const
     return "lh";
 }
 
+std::unique_ptr<Instruction> LHInstruction::clone() const
+{
+    return std::make_unique<LHInstruction>(*this);
+}
+
+bool LHInstruction::lower(DecodedInstr& out) const
+{
+    return lowerRegisterWrite(out, DecodedOp::Lh, m_rt, m_rs, 0, signExtend16(m_imm));
+}
+
 SHInstruction::SHInstruction(int rt, int rs, int16_t offset) : ITypeInstruction(rt, rs, offset) {}
 
 void SHInstruction::execute(Cpu& cpu)
@@ -617,6 +1052,20 @@ std::string SHInstruction::getName() const
     return "sh";
 }
 
+std::unique_ptr<Instruction> SHInstruction::clone() const
+{
+    return std::make_unique<SHInstruction>(*this);
+}
+
+bool SHInstruction::lower(DecodedInstr& out) const
+{
+    out.op  = DecodedOp::Sh;
+    out.rs  = static_cast<uint8_t>(m_rs);
+    out.rt  = static_cast<uint8_t>(m_rt);
+    out.imm = signExtend16(m_imm);
+    return true;
+}
+
 LHUInstruction::LHUInstruction(int rt, int rs, int16_t offset) : ITypeInstruction(rt, rs, offset) {}
 
 void LHUInstruction::execute(Cpu& cpu)
@@ -638,6 +1087,16 @@ std::string LHUInstruction::getName() const
     return "lhu";
 }
 
+std::unique_ptr<Instruction> LHUInstruction::clone() const
+{
+    return std::make_unique<LHUInstruction>(*this);
+}
+
+bool LHUInstruction::lower(DecodedInstr& out) const
+{
+    return lowerRegisterWrite(out, DecodedOp::Lhu, m_rt, m_rs, 0, signExtend16(m_imm));
+}
+
 SwInstruction::SwInstruction(int rt, int rs, int16_t offset) : ITypeInstruction(rt, rs, offset) {}
 
 void SwInstruction::execute(Cpu& cpu)
@@ -656,12 +1115,31 @@ std::string SwInstruction::getName() const
     return "sw";
 }
 
-BranchInstruction::BranchInstruction(int rs, int rt, const std::string& label)
-    : m_rs(rs), m_rt(rt), m_label(label)
+std::unique_ptr<Instruction> SwInstruction::clone() const
+{
+    return std::make_unique<SwInstruction>(*this);
+}
+
+bool SwInstruction::lower(DecodedInstr& out) const
 {
+    out.op  = DecodedOp::Sw;
+    out.rs  = static_cast<uint8_t>(m_rs);
+    out.rt  = static_cast<uint8_t>(m_rt);
+    out.imm = signExtend16(m_imm);
+    return true;
 }
 
-BeqInstruction::BeqInstruction(int rs, int rt, const std::string& label)
+BranchInstruction::BranchInstruction(int rs, int rt, std::string_view label)
+    : m_rs(rs), m_rt(rt), m_target(label)
+{
+}
+
+bool BranchInstruction::link(const LabelMap& labelMap, std::string& unresolvedLabel)
+{
+    return linkLabel(m_target, labelMap, unresolvedLabel);
+}
+
+BeqInstruction::BeqInstruction(int rs, int rt, std::string_view label)
     : BranchInstruction(rs, rt, label)
 {
 }
@@ -674,12 +1152,13 @@ void BeqInstruction::execute(Cpu& cpu)
     if (rsValue == rtValue)
     {
         // Branch taken - jump to label
-        uint32_t targetByteAddress = cpu.getLabelAddress(m_label);
+        uint32_t targetByteAddress = m_target.resolve(cpu);
         uint32_t targetInstructionIndex =
             targetByteAddress / 4;  // Convert byte address to instruction index
-        std::cerr << "DEBUG: BEQ taken - label='" << m_label << "' byteAddr=" << targetByteAddress
-                  << " -> idx=" << targetInstructionIndex
-                  << " currentPC=" << cpu.getProgramCounter() << std::endl;
+        MIPS_LOG(Branch, Debug,
+                 "BEQ taken label='" << m_target.name() << "' byteAddr=" << targetByteAddress
+                                     << " -> idx=" << targetInstructionIndex
+                                     << " currentPC=" << cpu.getProgramCounter());
         cpu.setProgramCounter(targetInstructionIndex);
     }
     else
@@ -694,7 +1173,25 @@ std::string BeqInstruction::getName() const
     return "beq";
 }
 
-BneInstruction::BneInstruction(int rs, int rt, const std::string& label)
+std::unique_ptr<Instruction> BeqInstruction::clone() const
+{
+    return std::make_unique<BeqInstruction>(*this);
+}
+
+bool BeqInstruction::lower(DecodedInstr& out) const
+{
+    if (!m_target.isLinked())
+    {
+        return false;
+    }
+    out.op     = DecodedOp::Beq;
+    out.rs     = static_cast<uint8_t>(m_rs);
+    out.rt     = static_cast<uint8_t>(m_rt);
+    out.target = m_target.address() / 4;
+    return true;
+}
+
+BneInstruction::BneInstruction(int rs, int rt, std::string_view label)
     : BranchInstruction(rs, rt, label)
 {
 }
@@ -707,12 +1204,13 @@ void BneInstruction::execute(Cpu& cpu)
     if (rsValue != rtValue)
     {
         // Branch taken - jump to label
-        uint32_t targetByteAddress = cpu.getLabelAddress(m_label);
+        uint32_t targetByteAddress = m_target.resolve(cpu);
         uint32_t targetInstructionIndex =
             targetByteAddress / 4;  // Convert byte address to instruction index
-        std::cerr << "DEBUG: BNE taken - label='" << m_label << "' byteAddr=" << targetByteAddress
-                  << " -> idx=" << targetInstructionIndex
-                  << " currentPC=" << cpu.getProgramCounter() << std::endl;
+        MIPS_LOG(Branch, Debug,
+                 "BNE taken label='" << m_target.name() << "' byteAddr=" << targetByteAddress
+                                     << " -> idx=" << targetInstructionIndex
+                                     << " currentPC=" << cpu.getProgramCounter());
         cpu.setProgramCounter(targetInstructionIndex);
     }
     else
@@ -727,7 +1225,25 @@ std::string BneInstruction::getName() const
     return "bne";
 }
 
-BLEZInstruction::BLEZInstruction(int rs, const std::string& label) : m_rs(rs), m_label(label) {}
+std::unique_ptr<Instruction> BneInstruction::clone() const
+{
+    return std::make_unique<BneInstruction>(*this);
+}
+
+bool BneInstruction::lower(DecodedInstr& out) const
+{
+    if (!m_target.isLinked())
+    {
+        return false;
+    }
+    out.op     = DecodedOp::Bne;
+    out.rs     = static_cast<uint8_t>(m_rs);
+    out.rt     = static_cast<uint8_t>(m_rt);
+    out.target = m_target.address() / 4;
+    return true;
+}
+
+BLEZInstruction::BLEZInstruction(int rs, std::string_view label) : m_rs(rs), m_target(label) {}
 
 void BLEZInstruction::execute(Cpu& cpu)
 {
@@ -741,12 +1257,13 @@ void BLEZInstruction::execute(Cpu& cpu)
     {
         // 分支條件成立：rs <= 0
         // Jump to label
-        uint32_t targetByteAddress = cpu.getLabelAddress(m_label);
+        uint32_t targetByteAddress = m_target.resolve(cpu);
         uint32_t targetInstructionIndex =
             targetByteAddress / 4;  // Convert byte address to instruction index
-        std::cerr << "DEBUG: BLEZ taken - label='" << m_label << "' byteAddr=" << targetByteAddress
-                  << " -> idx=" << targetInstructionIndex
-                  << " currentPC=" << cpu.getProgramCounter() << std::endl;
+        MIPS_LOG(Branch, Debug,
+                 "BLEZ taken label='" << m_target.name() << "' byteAddr=" << targetByteAddress
+                                     << " -> idx=" << targetInstructionIndex
+                                     << " currentPC=" << cpu.getProgramCounter());
         cpu.setProgramCounter(targetInstructionIndex);
     }
     else
@@ -762,7 +1279,29 @@ std::string BLEZInstruction::getName() const
     return "blez";
 }
 
-BGTZInstruction::BGTZInstruction(int rs, const std::string& label) : m_rs(rs), m_label(label) {}
+std::unique_ptr<Instruction> BLEZInstruction::clone() const
+{
+    return std::make_unique<BLEZInstruction>(*this);
+}
+
+bool BLEZInstruction::lower(DecodedInstr& out) const
+{
+    if (!m_target.isLinked())
+    {
+        return false;
+    }
+    out.op     = DecodedOp::Blez;
+    out.rs     = static_cast<uint8_t>(m_rs);
+    out.target = m_target.address() / 4;
+    return true;
+}
+
+bool BLEZInstruction::link(const LabelMap& labelMap, std::string& unresolvedLabel)
+{
+    return linkLabel(m_target, labelMap, unresolvedLabel);
+}
+
+BGTZInstruction::BGTZInstruction(int rs, std::string_view label) : m_rs(rs), m_target(label) {}
 
 void BGTZInstruction::execute(Cpu& cpu)
 {
@@ -776,12 +1315,13 @@ void BGTZInstruction::execute(Cpu& cpu)
     {
         // 分支條件成立：rs > 0
         // Jump to label
-        uint32_t targetByteAddress = cpu.getLabelAddress(m_label);
+        uint32_t targetByteAddress = m_target.resolve(cpu);
         uint32_t targetInstructionIndex =
             targetByteAddress / 4;  // Convert byte address to instruction index
-        std::cerr << "DEBUG: BGTZ taken - label='" << m_label << "' byteAddr=" << targetByteAddress
-                  << " -> idx=" << targetInstructionIndex
-                  << " currentPC=" << cpu.getProgramCounter() << std::endl;
+        MIPS_LOG(Branch, Debug,
+                 "BGTZ taken label='" << m_target.name() << "' byteAddr=" << targetByteAddress
+                                     << " -> idx=" << targetInstructionIndex
+                                     << " currentPC=" << cpu.getProgramCounter());
         cpu.setProgramCounter(targetInstructionIndex);
     }
     else
@@ -797,17 +1337,40 @@ std::string BGTZInstruction::getName() const
     return "bgtz";
 }
 
-JInstruction::JInstruction(const std::string& label) : m_label(label) {}
+std::unique_ptr<Instruction> BGTZInstruction::clone() const
+{
+    return std::make_unique<BGTZInstruction>(*this);
+}
+
+bool BGTZInstruction::lower(DecodedInstr& out) const
+{
+    if (!m_target.isLinked())
+    {
+        return false;
+    }
+    out.op     = DecodedOp::Bgtz;
+    out.rs     = static_cast<uint8_t>(m_rs);
+    out.target = m_target.address() / 4;
+    return true;
+}
+
+bool BGTZInstruction::link(const LabelMap& labelMap, std::string& unresolvedLabel)
+{
+    return linkLabel(m_target, labelMap, unresolvedLabel);
+}
+
+JInstruction::JInstruction(std::string_view label) : m_target(label) {}
 
 void JInstruction::execute(Cpu& cpu)
 {
     // Unconditional jump to label
-    uint32_t targetByteAddress = cpu.getLabelAddress(m_label);
+    uint32_t targetByteAddress = m_target.resolve(cpu);
     uint32_t targetInstructionIndex =
         targetByteAddress / 4;  // Convert byte address to instruction index
-    std::cerr << "DEBUG: J execute - label='" << m_label << "' byteAddr=" << targetByteAddress
-              << " -> idx=" << targetInstructionIndex << " currentPC=" << cpu.getProgramCounter()
-              << std::endl;
+    MIPS_LOG(Branch, Debug,
+             "J label='" << m_target.name() << "' byteAddr=" << targetByteAddress
+                         << " -> idx=" << targetInstructionIndex
+                         << " currentPC=" << cpu.getProgramCounter());
     cpu.setProgramCounter(targetInstructionIndex);
 }
 
@@ -816,6 +1379,27 @@ std::string JInstruction::getName() const
     return "j";
 }
 
+std::unique_ptr<Instruction> JInstruction::clone() const
+{
+    return std::make_unique<JInstruction>(*this);
+}
+
+bool JInstruction::lower(DecodedInstr& out) const
+{
+    if (!m_target.isLinked())
+    {
+        return false;
+    }
+    out.op     = DecodedOp::J;
+    out.target = m_target.address() / 4;
+    return true;
+}
+
+bool JInstruction::link(const LabelMap& labelMap, std::string& unresolvedLabel)
+{
+    return linkLabel(m_target, labelMap, unresolvedLabel);
+}
+
 SllInstruction::SllInstruction(uint32_t rd, uint32_t rt, uint32_t shamt)
     : m_rd(rd), m_rt(rt), m_shamt(shamt)
 {
@@ -841,6 +1425,16 @@ std::string SllInstruction::getName() const
     return "sll";
 }
 
+std::unique_ptr<Instruction> SllInstruction::clone() const
+{
+    return std::make_unique<SllInstruction>(*this);
+}
+
+bool SllInstruction::lower(DecodedInstr& out) const
+{
+    return lowerRegisterWrite(out, DecodedOp::Sll, m_rd, 0, m_rt, m_shamt);
+}
+
 SrlInstruction::SrlInstruction(uint32_t rd, uint32_t rt, uint32_t shamt)
     : m_rd(rd), m_rt(rt), m_shamt(shamt)
 {
@@ -866,6 +1460,16 @@ std::string SrlInstruction::getName() const
     return "srl";
 }
 
+std::unique_ptr<Instruction> SrlInstruction::clone() const
+{
+    return std::make_unique<SrlInstruction>(*this);
+}
+
+bool SrlInstruction::lower(DecodedInstr& out) const
+{
+    return lowerRegisterWrite(out, DecodedOp::Srl, m_rd, 0, m_rt, m_shamt);
+}
+
 SraInstruction::SraInstruction(uint32_t rd, uint32_t rt, uint32_t shamt)
     : m_rd(rd), m_rt(rt), m_shamt(shamt)
 {
@@ -891,6 +1495,16 @@ std::string SraInstruction::getName() const
     return "sra";
 }
 
+std::unique_ptr<Instruction> SraInstruction::clone() const
+{
+    return std::make_unique<SraInstruction>(*this);
+}
+
+bool SraInstruction::lower(DecodedInstr& out) const
+{
+    return lowerRegisterWrite(out, DecodedOp::Sra, m_rd, 0, m_rt, m_shamt);
+}
+
 SLLVInstruction::SLLVInstruction(int rd, int rt, int rs) : RTypeInstruction(rd, rs, rt) {}
 
 void SLLVInstruction::execute(Cpu& cpu)
@@ -917,6 +1531,16 @@ std::string SLLVInstruction::getName() const
     return "sllv";
 }
 
+std::unique_ptr<Instruction> SLLVInstruction::clone() const
+{
+    return std::make_unique<SLLVInstruction>(*this);
+}
+
+bool SLLVInstruction::lower(DecodedInstr& out) const
+{
+    return lowerRegisterWrite(out, DecodedOp::Sllv, m_rd, m_rs, m_rt, 0);
+}
+
 SRLVInstruction::SRLVInstruction(int rd, int rt, int rs) : RTypeInstruction(rd, rs, rt) {}
 
 void SRLVInstruction::execute(Cpu& cpu)
@@ -943,6 +1567,16 @@ std::string SRLVInstruction::getName() const
     return "srlv";
 }
 
+std::unique_ptr<Instruction> SRLVInstruction::clone() const
+{
+    return std::make_unique<SRLVInstruction>(*this);
+}
+
+bool SRLVInstruction::lower(DecodedInstr& out) const
+{
+    return lowerRegisterWrite(out, DecodedOp::Srlv, m_rd, m_rs, m_rt, 0);
+}
+
 SRAVInstruction::SRAVInstruction(int rd, int rt, int rs) : RTypeInstruction(rd, rs, rt) {}
 
 void SRAVInstruction::execute(Cpu& cpu)
@@ -969,6 +1603,16 @@ std::string SRAVInstruction::getName() const
     return "srav";
 }
 
+std::unique_ptr<Instruction> SRAVInstruction::clone() const
+{
+    return std::make_unique<SRAVInstruction>(*this);
+}
+
+bool SRAVInstruction::lower(DecodedInstr& out) const
+{
+    return lowerRegisterWrite(out, DecodedOp::Srav, m_rd, m_rs, m_rt, 0);
+}
+
 // ===== JR Instruction =====
 
 JRInstruction::JRInstruction(int rs) : RTypeInstruction(0, rs, 0)
@@ -982,9 +1626,10 @@ void JRInstruction::execute(Cpu& cpu)
 
     // Convert byte address to instruction index and set PC
     uint32_t targetInstructionIndex = targetByteAddress / 4;
-    std::cerr << "DEBUG: JR execute - reg(" << m_rs << ") byteAddr=" << targetByteAddress
-              << " -> idx=" << targetInstructionIndex << " currentPC=" << cpu.getProgramCounter()
-              << std::endl;
+    MIPS_LOG(Branch, Debug,
+             "JR reg(" << m_rs << ") byteAddr=" << targetByteAddress
+                       << " -> idx=" << targetInstructionIndex
+                       << " currentPC=" << cpu.getProgramCounter());
     cpu.setProgramCounter(targetInstructionIndex);
 }
 
@@ -993,6 +1638,18 @@ std::string JRInstruction::getName() const
     return "jr";
 }
 
+std::unique_ptr<Instruction> JRInstruction::clone() const
+{
+    return std::make_unique<JRInstruction>(*this);
+}
+
+bool JRInstruction::lower(DecodedInstr& out) const
+{
+    out.op = DecodedOp::Jr;
+    out.rs = static_cast<uint8_t>(m_rs);
+    return true;
+}
+
 // ===== JAL Instruction =====
 
 JALInstruction::JALInstruction(uint32_t target) : m_target(target) {}
@@ -1006,8 +1663,9 @@ void JALInstruction::execute(Cpu& cpu)
     uint32_t returnInstructionIndex = cpu.getProgramCounter() + 1;  // Next instruction index
     uint32_t returnByteAddress      = returnInstructionIndex * 4;
     cpu.getRegisterFile().write(31, returnByteAddress);
-    std::cerr << "DEBUG: JAL execute - save $ra=" << returnByteAddress << " jumpToIdx=" << m_target
-              << " currentPC=" << cpu.getProgramCounter() << std::endl;
+    MIPS_LOG(Branch, Debug,
+             "JAL save $ra=" << returnByteAddress << " jumpToIdx=" << m_target
+                             << " currentPC=" << cpu.getProgramCounter());
 
     // Jump to target address (m_target is expected to be an instruction index)
     cpu.setProgramCounter(m_target);
@@ -1018,9 +1676,22 @@ std::string JALInstruction::getName() const
     return "jal";
 }
 
+std::unique_ptr<Instruction> JALInstruction::clone() const
+{
+    return std::make_unique<JALInstruction>(*this);
+}
+
+bool JALInstruction::lower(DecodedInstr& out) const
+{
+    out.op     = DecodedOp::Jal;
+    out.rd     = 31;
+    out.target = m_target;
+    return true;
+}
+
 // ===== JAL Label Instruction =====
 
-JALLabelInstruction::JALLabelInstruction(const std::string& label) : m_label(label) {}
+JALLabelInstruction::JALLabelInstruction(std::string_view label) : m_target(label) {}
 
 void JALLabelInstruction::execute(Cpu& cpu)
 {
@@ -1030,12 +1701,13 @@ void JALLabelInstruction::execute(Cpu& cpu)
     uint32_t returnInstructionIndex = cpu.getProgramCounter() + 1;
     uint32_t returnByteAddress      = returnInstructionIndex * 4;
     cpu.getRegisterFile().write(31, returnByteAddress);
-    uint32_t targetByteAddress      = cpu.getLabelAddress(m_label);
+    uint32_t targetByteAddress      = m_target.resolve(cpu);
     uint32_t targetInstructionIndex = targetByteAddress / 4;
-    std::cerr << "DEBUG: JAL label execute - save $ra=" << returnByteAddress << " jumpToLabel='"
-              << m_label << "' byteAddr=" << targetByteAddress
-              << " -> idx=" << targetInstructionIndex << " currentPC=" << cpu.getProgramCounter()
-              << std::endl;
+    MIPS_LOG(Branch, Debug,
+             "JAL save $ra=" << returnByteAddress << " label='" << m_target.name()
+                             << "' byteAddr=" << targetByteAddress
+                             << " -> idx=" << targetInstructionIndex
+                             << " currentPC=" << cpu.getProgramCounter());
     cpu.setProgramCounter(targetInstructionIndex);
 }
 
@@ -1044,6 +1716,28 @@ std::string JALLabelInstruction::getName() const
     return "jal";
 }
 
+std::unique_ptr<Instruction> JALLabelInstruction::clone() const
+{
+    return std::make_unique<JALLabelInstruction>(*this);
+}
+
+bool JALLabelInstruction::lower(DecodedInstr& out) const
+{
+    if (!m_target.isLinked())
+    {
+        return false;
+    }
+    out.op     = DecodedOp::Jal;
+    out.rd     = 31;
+    out.target = m_target.address() / 4;
+    return true;
+}
+
+bool JALLabelInstruction::link(const LabelMap& labelMap, std::string& unresolvedLabel)
+{
+    return linkLabel(m_target, labelMap, unresolvedLabel);
+}
+
 // ===== JALR Instruction =====
 
 JALRInstruction::JALRInstruction(int rd, int rs) : RTypeInstruction(rd, rs, 0)
@@ -1061,9 +1755,10 @@ void JALRInstruction::execute(Cpu& cpu)
     uint32_t returnInstructionIndex = cpu.getProgramCounter() + 1;  // Next instruction index
     uint32_t returnByteAddress      = returnInstructionIndex * 4;
     cpu.getRegisterFile().write(m_rd, returnByteAddress);
-    std::cerr << "DEBUG: JALR execute - save reg(" << m_rd << ")=$ra=" << returnByteAddress
-              << " targetByteAddr=" << targetByteAddress << " currentPC=" << cpu.getProgramCounter()
-              << std::endl;
+    MIPS_LOG(Branch, Debug,
+             "JALR save reg(" << m_rd << ")=" << returnByteAddress
+                              << " targetByteAddr=" << targetByteAddress
+                              << " currentPC=" << cpu.getProgramCounter());
 
     // Convert byte address to instruction index and jump
     uint32_t targetInstructionIndex = targetByteAddress / 4;
@@ -1075,6 +1770,20 @@ std::string JALRInstruction::getName() const
     return "jalr";
 }
 
+std::unique_ptr<Instruction> JALRInstruction::clone() const
+{
+    return std::make_unique<JALRInstruction>(*this);
+}
+
+bool JALRInstruction::lower(DecodedInstr& out) const
+{
+    // Not lowered through lowerRegisterWrite: a jump with rd=$zero still jumps
+    out.op = DecodedOp::Jalr;
+    out.rd = static_cast<uint8_t>(m_rd);
+    out.rs = static_cast<uint8_t>(m_rs);
+    return true;
+}
+
 // ===== MFHI Instruction =====
 
 MFHIInstruction::MFHIInstruction(int rd) : m_rd(rd) {}
@@ -1096,6 +1805,16 @@ std::string MFHIInstruction::getName() const
     return "mfhi";
 }
 
+std::unique_ptr<Instruction> MFHIInstruction::clone() const
+{
+    return std::make_unique<MFHIInstruction>(*this);
+}
+
+bool MFHIInstruction::lower(DecodedInstr& out) const
+{
+    return lowerRegisterWrite(out, DecodedOp::Mfhi, m_rd, 0, 0, 0);
+}
+
 // ===== MTHI Instruction =====
 
 MTHIInstruction::MTHIInstruction(int rs) : m_rs(rs) {}
@@ -1117,6 +1836,18 @@ std::string MTHIInstruction::getName() const
     return "mthi";
 }
 
+std::unique_ptr<Instruction> MTHIInstruction::clone() const
+{
+    return std::make_unique<MTHIInstruction>(*this);
+}
+
+bool MTHIInstruction::lower(DecodedInstr& out) const
+{
+    out.op = DecodedOp::Mthi;
+    out.rs = static_cast<uint8_t>(m_rs);
+    return true;
+}
+
 // ===== MFLO Instruction =====
 
 MFLOInstruction::MFLOInstruction(int rd) : m_rd(rd) {}
@@ -1138,6 +1869,16 @@ std::string MFLOInstruction::getName() const
     return "mflo";
 }
 
+std::unique_ptr<Instruction> MFLOInstruction::clone() const
+{
+    return std::make_unique<MFLOInstruction>(*this);
+}
+
+bool MFLOInstruction::lower(DecodedInstr& out) const
+{
+    return lowerRegisterWrite(out, DecodedOp::Mflo, m_rd, 0, 0, 0);
+}
+
 // ===== MTLO Instruction =====
 
 MTLOInstruction::MTLOInstruction(int rs) : m_rs(rs) {}
@@ -1159,6 +1900,18 @@ std::string MTLOInstruction::getName() const
     return "mtlo";
 }
 
+std::unique_ptr<Instruction> MTLOInstruction::clone() const
+{
+    return std::make_unique<MTLOInstruction>(*this);
+}
+
+bool MTLOInstruction::lower(DecodedInstr& out) const
+{
+    out.op = DecodedOp::Mtlo;
+    out.rs = static_cast<uint8_t>(m_rs);
+    return true;
+}
+
 // ===== Syscall Instruction =====
 
 SyscallInstruction::SyscallInstruction() {}
@@ -1179,6 +1932,9 @@ void SyscallInstruction::execute(Cpu& cpu)
     case 5:
         handleReadInt(cpu);
         break;
+    case 9:
+        handleSbrk(cpu);
+        break;
     case 10:
         handleExit(cpu);
         break;
@@ -1225,18 +1981,10 @@ void SyscallInstruction::handlePrintString(Cpu& cpu)
                 rawBytes.push_back(byte);
                 if (byte == 0)
                 {
-                    // Build a simple decimal-bytes string for tracing
-                    std::string bytesStr;
-                    for (size_t j = 0; j < rawBytes.size(); ++j)
-                    {
-                        if (!bytesStr.empty())
-                            bytesStr += ' ';
-                        bytesStr += std::to_string(rawBytes[j]);
-                    }
-
-                    std::cerr << "TRACE: Syscall printString pc=" << cpu.getProgramCounter()
-                              << " addr=" << stringAddress << " str='" << str
-                              << "' bytes=" << bytesStr << std::endl;
+                    MIPS_LOG(Syscall, Trace,
+                             "Syscall printString pc=" << cpu.getProgramCounter() << " addr="
+                                                       << stringAddress << " str='" << str
+                                                       << "' bytes=" << formatBytes(rawBytes));
 
                     cpu.printString(str);
                     return;
@@ -1249,17 +1997,10 @@ void SyscallInstruction::handlePrintString(Cpu& cpu)
     catch (...)
     {
         // Memory access failed, log partial bytes and print what we have
-        std::string bytesStr;
-        for (size_t j = 0; j < rawBytes.size(); ++j)
-        {
-            if (!bytesStr.empty())
-                bytesStr += ' ';
-            bytesStr += std::to_string(rawBytes[j]);
-        }
-
-        std::cerr << "TRACE: Syscall printString pc=" << cpu.getProgramCounter()
-                  << " addr=" << stringAddress << " partial_str='" << str << "' bytes=" << bytesStr
-                  << std::endl;
+        MIPS_LOG(Syscall, Trace,
+                 "Syscall printString pc=" << cpu.getProgramCounter() << " addr=" << stringAddress
+                                           << " partial_str='" << str
+                                           << "' bytes=" << formatBytes(rawBytes));
 
         cpu.printString(str);
     }
@@ -1292,11 +2033,23 @@ void SyscallInstruction::handleReadCharacter(Cpu& cpu)
     cpu.getRegisterFile().write(2, static_cast<uint32_t>(character));  // $v0 = character
 }
 
+void SyscallInstruction::handleSbrk(Cpu& cpu)
+{
+    // Bytes to allocate are in $a0; the block's address is returned in $v0
+    int32_t increment = static_cast<int32_t>(cpu.getRegisterFile().read(4));
+    cpu.getRegisterFile().write(2, cpu.sbrk(increment));
+}
+
 std::string SyscallInstruction::getName() const
 {
     return "syscall";
 }
 
+std::unique_ptr<Instruction> SyscallInstruction::clone() const
+{
+    return std::make_unique<SyscallInstruction>(*this);
+}
+
 // ===== LLO Instruction =====
 
 LLOInstruction::LLOInstruction(int rt, uint16_t immediate)
@@ -1317,6 +2070,17 @@ std::string LLOInstruction::getName() const
     return "llo";
 }
 
+std::unique_ptr<Instruction> LLOInstruction::clone() const
+{
+    return std::make_unique<LLOInstruction>(*this);
+}
+
+bool LLOInstruction::lower(DecodedInstr& out) const
+{
+    return lowerRegisterWrite(out, DecodedOp::Llo, m_rt, m_rt, 0,
+                              static_cast<uint32_t>(m_imm) & 0xFFFF);
+}
+
 // ===== LHI Instruction =====
 
 LHIInstruction::LHIInstruction(int rt, uint16_t immediate)
@@ -1338,6 +2102,17 @@ std::string LHIInstruction::getName() const
     return "lhi";
 }
 
+std::unique_ptr<Instruction> LHIInstruction::clone() const
+{
+    return std::make_unique<LHIInstruction>(*this);
+}
+
+bool LHIInstruction::lower(DecodedInstr& out) const
+{
+    return lowerRegisterWrite(out, DecodedOp::Lhi, m_rt, m_rt, 0,
+                              (static_cast<uint32_t>(m_imm) & 0xFFFF) << 16);
+}
+
 // ===== TRAP Instruction =====
 
 TrapInstruction::TrapInstruction(uint32_t trapCode) : m_trapCode(trapCode) {}
@@ -1373,17 +2148,10 @@ void TrapInstruction::execute(Cpu& cpu)
                     rawBytes.push_back(byte);
                     if (byte == 0)
                     {
-                        std::string bytesStr;
-                        for (size_t j = 0; j < rawBytes.size(); ++j)
-                        {
-                            if (!bytesStr.empty())
-                                bytesStr += ' ';
-                            bytesStr += std::to_string(rawBytes[j]);
-                        }
-
-                        std::cerr << "TRACE: Trap printString pc=" << cpu.getProgramCounter()
-                                  << " addr=" << stringAddress << " str='" << str
-                                  << "' bytes=" << bytesStr << std::endl;
+                        MIPS_LOG(Syscall, Trace,
+                                 "Trap printString pc=" << cpu.getProgramCounter() << " addr="
+                                                        << stringAddress << " str='" << str
+                                                        << "' bytes=" << formatBytes(rawBytes));
 
                         cpu.printString(str);
                         goto string_done;
@@ -1397,17 +2165,10 @@ void TrapInstruction::execute(Cpu& cpu)
         catch (...)
         {
             // Memory access failed, log partial bytes and print what we have
-            std::string bytesStr;
-            for (size_t j = 0; j < rawBytes.size(); ++j)
-            {
-                if (!bytesStr.empty())
-                    bytesStr += ' ';
-                bytesStr += std::to_string(rawBytes[j]);
-            }
-
-            std::cerr << "TRACE: Trap printString pc=" << cpu.getProgramCounter()
-                      << " addr=" << stringAddress << " partial_str='" << str
-                      << "' bytes=" << bytesStr << std::endl;
+            MIPS_LOG(Syscall, Trace,
+                     "Trap printString pc=" << cpu.getProgramCounter() << " addr=" << stringAddress
+                                            << " partial_str='" << str
+                                            << "' bytes=" << formatBytes(rawBytes));
 
             cpu.printString(str);
         }
@@ -1437,17 +2198,28 @@ std::string TrapInstruction::getName() const
     return "trap";
 }
 
+std::unique_ptr<Instruction> TrapInstruction::clone() const
+{
+    return std::make_unique<TrapInstruction>(*this);
+}
+
+uint32_t TrapInstruction::getTrapCode() const
+{
+    return m_trapCode;
+}
+
 // ===== LA Instruction =====
 
-LAInstruction::LAInstruction(int rt, const std::string& label) : m_rt(rt), m_label(label) {}
+LAInstruction::LAInstruction(int rt, std::string_view label) : m_rt(rt), m_target(label) {}
 
 void LAInstruction::execute(Cpu& cpu)
 {
     // Load the address of the label into the target register
-    uint32_t labelAddress = cpu.getLabelAddress(m_label);
+    uint32_t labelAddress = m_target.resolve(cpu);
     cpu.getRegisterFile().write(m_rt, labelAddress);
-    std::cerr << "TRACE: LA rt=" << m_rt << " label='" << m_label << "' addr=" << labelAddress
-              << " pc=" << cpu.getProgramCounter() << std::endl;
+    MIPS_LOG(Branch, Debug,
+             "LA rt=" << m_rt << " label='" << m_target.name() << "' addr=" << labelAddress
+                      << " pc=" << cpu.getProgramCounter());
     cpu.setProgramCounter(cpu.getProgramCounter() + 1);
 }
 
@@ -1456,4 +2228,23 @@ std::string LAInstruction::getName() const
     return "la";
 }
 
+std::unique_ptr<Instruction> LAInstruction::clone() const
+{
+    return std::make_unique<LAInstruction>(*this);
+}
+
+bool LAInstruction::lower(DecodedInstr& out) const
+{
+    if (!m_target.isLinked())
+    {
+        return false;
+    }
+    return lowerRegisterWrite(out, DecodedOp::La, m_rt, 0, 0, m_target.address());
+}
+
+bool LAInstruction::link(const LabelMap& labelMap, std::string& unresolvedLabel)
+{
+    return linkLabel(m_target, labelMap, unresolvedLabel);
+}
+
 }  // namespace mips
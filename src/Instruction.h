@@ -1,13 +1,65 @@
 #pragma once
 
+#include "DecodedInstruction.h"
+#include <cstddef>
 #include <cstdint>
+#include <map>
+#include <memory>
 #include <string>
+#include <string_view>
 
 namespace mips
 {
 
 class Cpu;  // Forward declaration
 
+/**
+ * @brief Label name to byte address table produced by the assembler
+ */
+using LabelMap = std::map<std::string, uint32_t>;
+
+/**
+ * @brief Symbolic label operand, resolved once by the assembler's link phase
+ *
+ * Instructions that never go through the link phase (e.g. built directly by tests
+ * or tools) fall back to looking the label up in the CPU's label table. The name of
+ * an instruction being assembled is interned in its arena (see
+ * InstructionArena::intern), so repeated names share one string; any other LabelRef
+ * owns a copy of its name.
+ */
+class LabelRef
+{
+  public:
+    explicit LabelRef(std::string_view name);
+    LabelRef(const LabelRef& other);
+    LabelRef& operator=(const LabelRef& other);
+    ~LabelRef();
+
+    /**
+     * @brief Resolve the label against the final label table
+     * @return false if the label is not defined
+     */
+    bool link(const LabelMap& labelMap);
+
+    /**
+     * @brief Byte address of the label, using the linked value when available
+     */
+    uint32_t resolve(const Cpu& cpu) const;
+
+    std::string_view name() const;
+    bool             isLinked() const;
+    uint32_t         address() const;
+
+  private:
+    void setName(std::string_view name);
+    void freeName();
+
+    std::string_view m_name;
+    uint32_t         m_address;
+    bool             m_linked;
+    bool             m_ownsName = false;  // m_name was allocated by setName()
+};
+
 /**
  * @brief Base class for all MIPS instructions
  */
@@ -16,6 +68,12 @@ class Instruction
   public:
     virtual ~Instruction() = default;
 
+    /**
+     * @brief Instructions are placed in the thread's InstructionArena while one is open
+     */
+    static void* operator new(size_t size);
+    static void  operator delete(void* pointer);
+
     /**
      * @brief Execute the instruction
      * @param cpu Reference to the CPU instance
@@ -26,6 +84,27 @@ class Instruction
      * @brief Get instruction name for debugging
      */
     virtual std::string getName() const = 0;
+
+    /**
+     * @brief Copy the instruction, including any linked label operands
+     */
+    virtual std::unique_ptr<Instruction> clone() const = 0;
+
+    /**
+     * @brief Resolve symbolic operands against the final label table
+     * @param labelMap Label table produced by the assembler
+     * @param[out] unresolvedLabel Name of the undefined label when linking fails
+     * @return false if a referenced label is not defined
+     */
+    virtual bool link(const LabelMap& labelMap, std::string& unresolvedLabel);
+
+    /**
+     * @brief Lower the instruction into a compact record for the pre-decoded engine
+     * @param[out] out Record to fill
+     * @return false if the instruction has no compact form (or has unlinked operands)
+     *         and must be executed directly
+     */
+    virtual bool lower(DecodedInstr& out) const;
 };
 
 /**
@@ -50,8 +129,10 @@ class AddInstruction : public RTypeInstruction
   public:
     AddInstruction(int rd, int rs, int rt);
 
-    void        execute(Cpu& cpu) override;
-    std::string getName() const override;
+    void                         execute(Cpu& cpu) override;
+    std::string                  getName() const override;
+    std::unique_ptr<Instruction> clone() const override;
+    bool                         lower(DecodedInstr& out) const override;
 };
 
 /**
@@ -62,8 +143,10 @@ class ADDUInstruction : public RTypeInstruction
   public:
     ADDUInstruction(int rd, int rs, int rt);
 
-    void        execute(Cpu& cpu) override;
-    std::string getName() const override;
+    void                         execute(Cpu& cpu) override;
+    std::string                  getName() const override;
+    std::unique_ptr<Instruction> clone() const override;
+    bool                         lower(DecodedInstr& out) const override;
 };
 
 /**
@@ -74,8 +157,10 @@ class SubInstruction : public RTypeInstruction
   public:
     SubInstruction(int rd, int rs, int rt);
 
-    void        execute(Cpu& cpu) override;
-    std::string getName() const override;
+    void                         execute(Cpu& cpu) override;
+    std::string                  getName() const override;
+    std::unique_ptr<Instruction> clone() const override;
+    bool                         lower(DecodedInstr& out) const override;
 };
 
 /**
@@ -86,8 +171,10 @@ class SUBUInstruction : public RTypeInstruction
   public:
     SUBUInstruction(int rd, int rs, int rt);
 
-    void        execute(Cpu& cpu) override;
-    std::string getName() const override;
+    void                         execute(Cpu& cpu) override;
+    std::string                  getName() const override;
+    std::unique_ptr<Instruction> clone() const override;
+    bool                         lower(DecodedInstr& out) const override;
 };
 
 /**
@@ -98,8 +185,10 @@ class AndInstruction : public RTypeInstruction
   public:
     AndInstruction(int rd, int rs, int rt);
 
-    void        execute(Cpu& cpu) override;
-    std::string getName() const override;
+    void                         execute(Cpu& cpu) override;
+    std::string                  getName() const override;
+    std::unique_ptr<Instruction> clone() const override;
+    bool                         lower(DecodedInstr& out) const override;
 };
 
 /**
@@ -110,8 +199,10 @@ class OrInstruction : public RTypeInstruction
   public:
     OrInstruction(int rd, int rs, int rt);
 
-    void        execute(Cpu& cpu) override;
-    std::string getName() const override;
+    void                         execute(Cpu& cpu) override;
+    std::string                  getName() const override;
+    std::unique_ptr<Instruction> clone() const override;
+    bool                         lower(DecodedInstr& out) const override;
 };
 
 /**
@@ -122,8 +213,10 @@ class XorInstruction : public RTypeInstruction
   public:
     XorInstruction(int rd, int rs, int rt);
 
-    void        execute(Cpu& cpu) override;
-    std::string getName() const override;
+    void                         execute(Cpu& cpu) override;
+    std::string                  getName() const override;
+    std::unique_ptr<Instruction> clone() const override;
+    bool                         lower(DecodedInstr& out) const override;
 };
 
 /**
@@ -134,8 +227,10 @@ class NorInstruction : public RTypeInstruction
   public:
     NorInstruction(int rd, int rs, int rt);
 
-    void        execute(Cpu& cpu) override;
-    std::string getName() const override;
+    void                         execute(Cpu& cpu) override;
+    std::string                  getName() const override;
+    std::unique_ptr<Instruction> clone() const override;
+    bool                         lower(DecodedInstr& out) const override;
 };
 
 /**
@@ -146,8 +241,10 @@ class SltInstruction : public RTypeInstruction
   public:
     SltInstruction(int rd, int rs, int rt);
 
-    void        execute(Cpu& cpu) override;
-    std::string getName() const override;
+    void                         execute(Cpu& cpu) override;
+    std::string                  getName() const override;
+    std::unique_ptr<Instruction> clone() const override;
+    bool                         lower(DecodedInstr& out) const override;
 };
 
 /**
@@ -158,8 +255,10 @@ class SltuInstruction : public RTypeInstruction
   public:
     SltuInstruction(int rd, int rs, int rt);
 
-    void        execute(Cpu& cpu) override;
-    std::string getName() const override;
+    void                         execute(Cpu& cpu) override;
+    std::string                  getName() const override;
+    std::unique_ptr<Instruction> clone() const override;
+    bool                         lower(DecodedInstr& out) const override;
 };
 
 /**
@@ -178,8 +277,10 @@ class MULTInstruction : public Instruction
      */
     MULTInstruction(int rs, int rt);
 
-    void        execute(Cpu& cpu) override;
-    std::string getName() const override;
+    void                         execute(Cpu& cpu) override;
+    std::string                  getName() const override;
+    std::unique_ptr<Instruction> clone() const override;
+    bool                         lower(DecodedInstr& out) const override;
 
   private:
     int m_rs;  // Source register 1
@@ -202,8 +303,10 @@ class MULTUInstruction : public Instruction
      */
     MULTUInstruction(int rs, int rt);
 
-    void        execute(Cpu& cpu) override;
-    std::string getName() const override;
+    void                         execute(Cpu& cpu) override;
+    std::string                  getName() const override;
+    std::unique_ptr<Instruction> clone() const override;
+    bool                         lower(DecodedInstr& out) const override;
 
   private:
     int m_rs;  // Source register 1
@@ -226,8 +329,10 @@ class DIVInstruction : public Instruction
      */
     DIVInstruction(int rs, int rt);
 
-    void        execute(Cpu& cpu) override;
-    std::string getName() const override;
+    void                         execute(Cpu& cpu) override;
+    std::string                  getName() const override;
+    std::unique_ptr<Instruction> clone() const override;
+    bool                         lower(DecodedInstr& out) const override;
 
   private:
     int m_rs;  // Source register 1 (dividend)
@@ -250,8 +355,10 @@ class DIVUInstruction : public Instruction
      */
     DIVUInstruction(int rs, int rt);
 
-    void        execute(Cpu& cpu) override;
-    std::string getName() const override;
+    void                         execute(Cpu& cpu) override;
+    std::string                  getName() const override;
+    std::unique_ptr<Instruction> clone() const override;
+    bool                         lower(DecodedInstr& out) const override;
 
   private:
     int m_rs;  // Source register 1 (dividend)
@@ -285,8 +392,10 @@ class AddiInstruction : public ITypeInstruction
   public:
     AddiInstruction(int rt, int rs, int16_t imm);
 
-    void        execute(Cpu& cpu) override;
-    std::string getName() const override;
+    void                         execute(Cpu& cpu) override;
+    std::string                  getName() const override;
+    std::unique_ptr<Instruction> clone() const override;
+    bool                         lower(DecodedInstr& out) const override;
 };
 
 /**
@@ -299,8 +408,10 @@ class ADDIUInstruction : public ITypeInstruction
   public:
     ADDIUInstruction(int rt, int rs, int16_t imm);
 
-    void        execute(Cpu& cpu) override;
-    std::string getName() const override;
+    void                         execute(Cpu& cpu) override;
+    std::string                  getName() const override;
+    std::unique_ptr<Instruction> clone() const override;
+    bool                         lower(DecodedInstr& out) const override;
 };
 
 /**
@@ -311,8 +422,10 @@ class SltiInstruction : public ITypeInstruction
   public:
     SltiInstruction(int rt, int rs, int16_t imm);
 
-    void        execute(Cpu& cpu) override;
-    std::string getName() const override;
+    void                         execute(Cpu& cpu) override;
+    std::string                  getName() const override;
+    std::unique_ptr<Instruction> clone() const override;
+    bool                         lower(DecodedInstr& out) const override;
 };
 
 /**
@@ -323,8 +436,10 @@ class SltiuInstruction : public ITypeInstruction
   public:
     SltiuInstruction(int rt, int rs, int16_t imm);
 
-    void        execute(Cpu& cpu) override;
-    std::string getName() const override;
+    void                         execute(Cpu& cpu) override;
+    std::string                  getName() const override;
+    std::unique_ptr<Instruction> clone() const override;
+    bool                         lower(DecodedInstr& out) const override;
 };
 
 /**
@@ -335,8 +450,10 @@ class OriInstruction : public ITypeInstruction
   public:
     OriInstruction(int rt, int rs, int16_t imm);
 
-    void        execute(Cpu& cpu) override;
-    std::string getName() const override;
+    void                         execute(Cpu& cpu) override;
+    std::string                  getName() const override;
+    std::unique_ptr<Instruction> clone() const override;
+    bool                         lower(DecodedInstr& out) const override;
 };
 
 /**
@@ -347,8 +464,10 @@ class AndiInstruction : public ITypeInstruction
   public:
     AndiInstruction(int rt, int rs, int16_t imm);
 
-    void        execute(Cpu& cpu) override;
-    std::string getName() const override;
+    void                         execute(Cpu& cpu) override;
+    std::string                  getName() const override;
+    std::unique_ptr<Instruction> clone() const override;
+    bool                         lower(DecodedInstr& out) const override;
 };
 
 /**
@@ -359,8 +478,10 @@ class XoriInstruction : public ITypeInstruction
   public:
     XoriInstruction(int rt, int rs, int16_t imm);
 
-    void        execute(Cpu& cpu) override;
-    std::string getName() const override;
+    void                         execute(Cpu& cpu) override;
+    std::string                  getName() const override;
+    std::unique_ptr<Instruction> clone() const override;
+    bool                         lower(DecodedInstr& out) const override;
 };
 
 /**
@@ -371,8 +492,10 @@ class LwInstruction : public ITypeInstruction
   public:
     LwInstruction(int rt, int rs, int16_t offset);
 
-    void        execute(Cpu& cpu) override;
-    std::string getName() const override;
+    void                         execute(Cpu& cpu) override;
+    std::string                  getName() const override;
+    std::unique_ptr<Instruction> clone() const override;
+    bool                         lower(DecodedInstr& out) const override;
 };
 
 /**
@@ -384,8 +507,10 @@ class LBInstruction : public ITypeInstruction
   public:
     LBInstruction(int rt, int rs, int16_t offset);
 
-    void        execute(Cpu& cpu) override;
-    std::string getName() const override;
+    void                         execute(Cpu& cpu) override;
+    std::string                  getName() const override;
+    std::unique_ptr<Instruction> clone() const override;
+    bool                         lower(DecodedInstr& out) const override;
 };
 
 /**
@@ -397,8 +522,10 @@ class SBInstruction : public ITypeInstruction
   public:
     SBInstruction(int rt, int rs, int16_t offset);
 
-    void        execute(Cpu& cpu) override;
-    std::string getName() const override;
+    void                         execute(Cpu& cpu) override;
+    std::string                  getName() const override;
+    std::unique_ptr<Instruction> clone() const override;
+    bool                         lower(DecodedInstr& out) const override;
 };
 
 /**
@@ -412,8 +539,10 @@ class LBUInstruction : public ITypeInstruction
   public:
     LBUInstruction(int rt, int rs, int16_t offset);
 
-    void        execute(Cpu& cpu) override;
-    std::string getName() const override;
+    void                         execute(Cpu& cpu) override;
+    std::string                  getName() const override;
+    std::unique_ptr<Instruction> clone() const override;
+    bool                         lower(DecodedInstr& out) const override;
 };
 
 /**
@@ -427,8 +556,10 @@ class LHInstruction : public ITypeInstruction
   public:
     LHInstruction(int rt, int rs, int16_t offset);
 
-    void        execute(Cpu& cpu) override;
-    std::string getName() const override;
+    void                         execute(Cpu& cpu) override;
+    std::string                  getName() const override;
+    std::unique_ptr<Instruction> clone() const override;
+    bool                         lower(DecodedInstr& out) const override;
 };
 
 /**
@@ -440,8 +571,10 @@ class SHInstruction : public ITypeInstruction
   public:
     SHInstruction(int rt, int rs, int16_t offset);
 
-    void        execute(Cpu& cpu) override;
-    std::string getName() const override;
+    void                         execute(Cpu& cpu) override;
+    std::string                  getName() const override;
+    std::unique_ptr<Instruction> clone() const override;
+    bool                         lower(DecodedInstr& out) const override;
 };
 
 /**
@@ -453,8 +586,10 @@ class LHUInstruction : public ITypeInstruction
   public:
     LHUInstruction(int rt, int rs, int16_t offset);
 
-    void        execute(Cpu& cpu) override;
-    std::string getName() const override;
+    void                         execute(Cpu& cpu) override;
+    std::string                  getName() const override;
+    std::unique_ptr<Instruction> clone() const override;
+    bool                         lower(DecodedInstr& out) const override;
 };
 
 /**
@@ -465,8 +600,10 @@ class SwInstruction : public ITypeInstruction
   public:
     SwInstruction(int rt, int rs, int16_t offset);
 
-    void        execute(Cpu& cpu) override;
-    std::string getName() const override;
+    void                         execute(Cpu& cpu) override;
+    std::string                  getName() const override;
+    std::unique_ptr<Instruction> clone() const override;
+    bool                         lower(DecodedInstr& out) const override;
 };
 
 /**
@@ -475,12 +612,14 @@ class SwInstruction : public ITypeInstruction
 class BranchInstruction : public Instruction
 {
   public:
-    BranchInstruction(int rs, int rt, const std::string& label);
+    BranchInstruction(int rs, int rt, std::string_view label);
+
+    bool link(const LabelMap& labelMap, std::string& unresolvedLabel) override;
 
   protected:
-    int         m_rs;     // Source register 1
-    int         m_rt;     // Source register 2
-    std::string m_label;  // Branch target label
+    int      m_rs;      // Source register 1
+    int      m_rt;      // Source register 2
+    LabelRef m_target;  // Branch target label
 };
 
 /**
@@ -489,10 +628,12 @@ class BranchInstruction : public Instruction
 class BeqInstruction : public BranchInstruction
 {
   public:
-    BeqInstruction(int rs, int rt, const std::string& label);
+    BeqInstruction(int rs, int rt, std::string_view label);
 
-    void        execute(Cpu& cpu) override;
-    std::string getName() const override;
+    void                         execute(Cpu& cpu) override;
+    std::string                  getName() const override;
+    std::unique_ptr<Instruction> clone() const override;
+    bool                         lower(DecodedInstr& out) const override;
 };
 
 /**
@@ -501,10 +642,12 @@ class BeqInstruction : public BranchInstruction
 class BneInstruction : public BranchInstruction
 {
   public:
-    BneInstruction(int rs, int rt, const std::string& label);
+    BneInstruction(int rs, int rt, std::string_view label);
 
-    void        execute(Cpu& cpu) override;
-    std::string getName() const override;
+    void                         execute(Cpu& cpu) override;
+    std::string                  getName() const override;
+    std::unique_ptr<Instruction> clone() const override;
+    bool                         lower(DecodedInstr& out) const override;
 };
 
 /**
@@ -513,14 +656,18 @@ class BneInstruction : public BranchInstruction
 class BLEZInstruction : public Instruction
 {
   public:
-    BLEZInstruction(int rs, const std::string& label);
+    BLEZInstruction(int rs, std::string_view label);
 
-    void        execute(Cpu& cpu) override;
-    std::string getName() const override;
+    void                         execute(Cpu& cpu) override;
+    std::string                  getName() const override;
+    std::unique_ptr<Instruction> clone() const override;
+    bool                         lower(DecodedInstr& out) const override;
+    bool                         link(const LabelMap& labelMap,
+                                      std::string&    unresolvedLabel) override;
 
   private:
-    int         m_rs;
-    std::string m_label;
+    int      m_rs;
+    LabelRef m_target;
 };
 
 /**
@@ -529,14 +676,18 @@ class BLEZInstruction : public Instruction
 class BGTZInstruction : public Instruction
 {
   public:
-    BGTZInstruction(int rs, const std::string& label);
+    BGTZInstruction(int rs, std::string_view label);
 
-    void        execute(Cpu& cpu) override;
-    std::string getName() const override;
+    void                         execute(Cpu& cpu) override;
+    std::string                  getName() const override;
+    std::unique_ptr<Instruction> clone() const override;
+    bool                         lower(DecodedInstr& out) const override;
+    bool                         link(const LabelMap& labelMap,
+                                      std::string&    unresolvedLabel) override;
 
   private:
-    int         m_rs;
-    std::string m_label;
+    int      m_rs;
+    LabelRef m_target;
 };
 
 /**
@@ -545,13 +696,17 @@ class BGTZInstruction : public Instruction
 class JInstruction : public Instruction
 {
   public:
-    JInstruction(const std::string& label);
+    JInstruction(std::string_view label);
 
-    void        execute(Cpu& cpu) override;
-    std::string getName() const override;
+    void                         execute(Cpu& cpu) override;
+    std::string                  getName() const override;
+    std::unique_ptr<Instruction> clone() const override;
+    bool                         lower(DecodedInstr& out) const override;
+    bool                         link(const LabelMap& labelMap,
+                                      std::string&    unresolvedLabel) override;
 
   private:
-    std::string m_label;  // Jump target label
+    LabelRef m_target;  // Jump target label
 };
 
 /**
@@ -562,8 +717,10 @@ class SllInstruction : public Instruction
   public:
     SllInstruction(uint32_t rd, uint32_t rt, uint32_t shamt);
 
-    void        execute(Cpu& cpu) override;
-    std::string getName() const override;
+    void                         execute(Cpu& cpu) override;
+    std::string                  getName() const override;
+    std::unique_ptr<Instruction> clone() const override;
+    bool                         lower(DecodedInstr& out) const override;
 
   private:
     uint32_t m_rd;     // Destination register
@@ -579,8 +736,10 @@ class SrlInstruction : public Instruction
   public:
     SrlInstruction(uint32_t rd, uint32_t rt, uint32_t shamt);
 
-    void        execute(Cpu& cpu) override;
-    std::string getName() const override;
+    void                         execute(Cpu& cpu) override;
+    std::string                  getName() const override;
+    std::unique_ptr<Instruction> clone() const override;
+    bool                         lower(DecodedInstr& out) const override;
 
   private:
     uint32_t m_rd;     // Destination register
@@ -596,8 +755,10 @@ class SraInstruction : public Instruction
   public:
     SraInstruction(uint32_t rd, uint32_t rt, uint32_t shamt);
 
-    void        execute(Cpu& cpu) override;
-    std::string getName() const override;
+    void                         execute(Cpu& cpu) override;
+    std::string                  getName() const override;
+    std::unique_ptr<Instruction> clone() const override;
+    bool                         lower(DecodedInstr& out) const override;
 
   private:
     uint32_t m_rd;     // Destination register
@@ -613,8 +774,10 @@ class SLLVInstruction : public RTypeInstruction
   public:
     SLLVInstruction(int rd, int rt, int rs);
 
-    void        execute(Cpu& cpu) override;
-    std::string getName() const override;
+    void                         execute(Cpu& cpu) override;
+    std::string                  getName() const override;
+    std::unique_ptr<Instruction> clone() const override;
+    bool                         lower(DecodedInstr& out) const override;
 };
 
 /**
@@ -625,8 +788,10 @@ class SRLVInstruction : public RTypeInstruction
   public:
     SRLVInstruction(int rd, int rt, int rs);
 
-    void        execute(Cpu& cpu) override;
-    std::string getName() const override;
+    void                         execute(Cpu& cpu) override;
+    std::string                  getName() const override;
+    std::unique_ptr<Instruction> clone() const override;
+    bool                         lower(DecodedInstr& out) const override;
 };
 
 /**
@@ -637,8 +802,10 @@ class SRAVInstruction : public RTypeInstruction
   public:
     SRAVInstruction(int rd, int rt, int rs);
 
-    void        execute(Cpu& cpu) override;
-    std::string getName() const override;
+    void                         execute(Cpu& cpu) override;
+    std::string                  getName() const override;
+    std::unique_ptr<Instruction> clone() const override;
+    bool                         lower(DecodedInstr& out) const override;
 };
 
 /**
@@ -656,8 +823,10 @@ class JRInstruction : public RTypeInstruction
      */
     explicit JRInstruction(int rs);
 
-    void        execute(Cpu& cpu) override;
-    std::string getName() const override;
+    void                         execute(Cpu& cpu) override;
+    std::string                  getName() const override;
+    std::unique_ptr<Instruction> clone() const override;
+    bool                         lower(DecodedInstr& out) const override;
 };
 
 /**
@@ -675,8 +844,10 @@ class JALInstruction : public Instruction
      */
     explicit JALInstruction(uint32_t target);
 
-    void        execute(Cpu& cpu) override;
-    std::string getName() const override;
+    void                         execute(Cpu& cpu) override;
+    std::string                  getName() const override;
+    std::unique_ptr<Instruction> clone() const override;
+    bool                         lower(DecodedInstr& out) const override;
 
   private:
     uint32_t m_target;  // 26-bit target address
@@ -695,13 +866,17 @@ class JALLabelInstruction : public Instruction
      * @brief Construct a JAL instruction with label target
      * @param label Target label name
      */
-    explicit JALLabelInstruction(const std::string& label);
+    explicit JALLabelInstruction(std::string_view label);
 
-    void        execute(Cpu& cpu) override;
-    std::string getName() const override;
+    void                         execute(Cpu& cpu) override;
+    std::string                  getName() const override;
+    std::unique_ptr<Instruction> clone() const override;
+    bool                         lower(DecodedInstr& out) const override;
+    bool                         link(const LabelMap& labelMap,
+                                      std::string&    unresolvedLabel) override;
 
   private:
-    std::string m_label;  // Target label name
+    LabelRef m_target;  // Target label
 };
 
 /**
@@ -720,8 +895,10 @@ class JALRInstruction : public RTypeInstruction
      */
     JALRInstruction(int rd, int rs);
 
-    void        execute(Cpu& cpu) override;
-    std::string getName() const override;
+    void                         execute(Cpu& cpu) override;
+    std::string                  getName() const override;
+    std::unique_ptr<Instruction> clone() const override;
+    bool                         lower(DecodedInstr& out) const override;
 };
 
 /**
@@ -739,8 +916,10 @@ class MFHIInstruction : public Instruction
      */
     MFHIInstruction(int rd);
 
-    void        execute(Cpu& cpu) override;
-    std::string getName() const override;
+    void                         execute(Cpu& cpu) override;
+    std::string                  getName() const override;
+    std::unique_ptr<Instruction> clone() const override;
+    bool                         lower(DecodedInstr& out) const override;
 
   private:
     int m_rd;  // Destination register
@@ -761,8 +940,10 @@ class MTHIInstruction : public Instruction
      */
     MTHIInstruction(int rs);
 
-    void        execute(Cpu& cpu) override;
-    std::string getName() const override;
+    void                         execute(Cpu& cpu) override;
+    std::string                  getName() const override;
+    std::unique_ptr<Instruction> clone() const override;
+    bool                         lower(DecodedInstr& out) const override;
 
   private:
     int m_rs;  // Source register
@@ -783,8 +964,10 @@ class MFLOInstruction : public Instruction
      */
     MFLOInstruction(int rd);
 
-    void        execute(Cpu& cpu) override;
-    std::string getName() const override;
+    void                         execute(Cpu& cpu) override;
+    std::string                  getName() const override;
+    std::unique_ptr<Instruction> clone() const override;
+    bool                         lower(DecodedInstr& out) const override;
 
   private:
     int m_rd;  // Destination register
@@ -805,8 +988,10 @@ class MTLOInstruction : public Instruction
      */
     MTLOInstruction(int rs);
 
-    void        execute(Cpu& cpu) override;
-    std::string getName() const override;
+    void                         execute(Cpu& cpu) override;
+    std::string                  getName() const override;
+    std::unique_ptr<Instruction> clone() const override;
+    bool                         lower(DecodedInstr& out) const override;
 
   private:
     int m_rs;  // Source register
@@ -820,8 +1005,9 @@ class SyscallInstruction : public Instruction
   public:
     SyscallInstruction();
 
-    void        execute(Cpu& cpu) override;
-    std::string getName() const override;
+    void                         execute(Cpu& cpu) override;
+    std::string                  getName() const override;
+    std::unique_ptr<Instruction> clone() const override;
 
   private:
     void handlePrintInt(Cpu& cpu);
@@ -830,6 +1016,7 @@ class SyscallInstruction : public Instruction
     void handleExit(Cpu& cpu);
     void handlePrintCharacter(Cpu& cpu);
     void handleReadCharacter(Cpu& cpu);
+    void handleSbrk(Cpu& cpu);
 };
 
 /**
@@ -843,8 +1030,10 @@ class LLOInstruction : public ITypeInstruction
   public:
     LLOInstruction(int rt, uint16_t immediate);
 
-    void        execute(Cpu& cpu) override;
-    std::string getName() const override;
+    void                         execute(Cpu& cpu) override;
+    std::string                  getName() const override;
+    std::unique_ptr<Instruction> clone() const override;
+    bool                         lower(DecodedInstr& out) const override;
 };
 
 /**
@@ -858,8 +1047,10 @@ class LHIInstruction : public ITypeInstruction
   public:
     LHIInstruction(int rt, uint16_t immediate);
 
-    void        execute(Cpu& cpu) override;
-    std::string getName() const override;
+    void                         execute(Cpu& cpu) override;
+    std::string                  getName() const override;
+    std::unique_ptr<Instruction> clone() const override;
+    bool                         lower(DecodedInstr& out) const override;
 };
 
 /**
@@ -873,8 +1064,10 @@ class TrapInstruction : public Instruction
   public:
     TrapInstruction(uint32_t trapCode);
 
-    void        execute(Cpu& cpu) override;
-    std::string getName() const override;
+    void                         execute(Cpu& cpu) override;
+    std::string                  getName() const override;
+    std::unique_ptr<Instruction> clone() const override;
+    uint32_t                     getTrapCode() const;
 
   private:
     uint32_t m_trapCode;
@@ -888,14 +1081,18 @@ class TrapInstruction : public Instruction
 class LAInstruction : public Instruction
 {
   public:
-    LAInstruction(int rt, const std::string& label);
+    LAInstruction(int rt, std::string_view label);
 
-    void        execute(Cpu& cpu) override;
-    std::string getName() const override;
+    void                         execute(Cpu& cpu) override;
+    std::string                  getName() const override;
+    std::unique_ptr<Instruction> clone() const override;
+    bool                         lower(DecodedInstr& out) const override;
+    bool                         link(const LabelMap& labelMap,
+                                      std::string&    unresolvedLabel) override;
 
   private:
-    int         m_rt;
-    std::string m_label;
+    int      m_rt;
+    LabelRef m_target;
 };
 
 }  // namespace mips
@@ -0,0 +1,153 @@
+#include "InstructionArena.h"
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <new>
+
+namespace mips
+{
+
+namespace
+{
+
+// Every allocation starts with a pointer to its arena, nullptr for the global heap
+constexpr size_t HEADER = sizeof(InstructionArena*);
+constexpr size_t ALIGN  = alignof(InstructionArena*);
+
+thread_local InstructionArena* t_current = nullptr;
+std::atomic<size_t>            g_liveArenas{0};
+
+size_t roundUp(size_t size)
+{
+    return (size + ALIGN - 1) & ~(ALIGN - 1);
+}
+
+}  // namespace
+
+InstructionArena::Scope::Scope() : m_arena(new InstructionArena), m_previous(t_current)
+{
+    t_current = m_arena;
+}
+
+InstructionArena::Scope::~Scope()
+{
+    t_current        = m_previous;
+    m_arena->m_names.reset();  // Only needed while instructions are being created
+    m_arena->release(SCOPE_REFERENCE - m_arena->m_allocated);
+}
+
+InstructionArena::InstructionArena()
+{
+    g_liveArenas.fetch_add(1, std::memory_order_relaxed);
+}
+
+InstructionArena::~InstructionArena()
+{
+    while (m_blocks != nullptr)
+    {
+        char* previous = *reinterpret_cast<char**>(m_blocks);
+        ::operator delete(m_blocks);
+        m_blocks = previous;
+    }
+    g_liveArenas.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void* InstructionArena::allocate(size_t size)
+{
+    InstructionArena* arena = t_current;
+    char*             storage;
+    if (arena != nullptr)
+    {
+        storage             = static_cast<char*>(arena->bump(HEADER + size));
+        arena->m_lastObject = storage + HEADER;
+        arena->m_lastEnd    = storage + HEADER + size;
+        ++arena->m_allocated;
+    }
+    else
+    {
+        storage = static_cast<char*>(::operator new(HEADER + size));
+    }
+    *reinterpret_cast<InstructionArena**>(storage) = arena;
+    return storage + HEADER;
+}
+
+void InstructionArena::deallocate(void* pointer) noexcept
+{
+    if (pointer == nullptr)
+    {
+        return;
+    }
+    char*             storage = static_cast<char*>(pointer) - HEADER;
+    InstructionArena* arena   = *reinterpret_cast<InstructionArena**>(storage);
+    if (arena != nullptr)
+    {
+        arena->release(1);
+    }
+    else
+    {
+        ::operator delete(storage);
+    }
+}
+
+bool InstructionArena::intern(std::string_view name, const void* owner,
+                              std::string_view& interned)
+{
+    InstructionArena*      arena   = t_current;
+    const char*            address = static_cast<const char*>(owner);
+    std::less<const char*> before;
+
+    // Only inside the object allocated last, i.e. an instruction being constructed
+    if (arena == nullptr || before(address, arena->m_lastObject) ||
+        !before(address, arena->m_lastEnd))
+    {
+        return false;
+    }
+
+    if (!arena->m_names)
+    {
+        arena->m_names = std::make_unique<std::string_view[]>(NAME_SLOTS);
+    }
+    std::string_view& slot = arena->m_names[std::hash<std::string_view>()(name) & (NAME_SLOTS - 1)];
+    if (slot != name)
+    {
+        char* copy = static_cast<char*>(arena->bump(name.size()));
+        std::memcpy(copy, name.data(), name.size());
+        slot = std::string_view(copy, name.size());
+    }
+    interned = slot;
+    return true;
+}
+
+size_t InstructionArena::liveArenas()
+{
+    return g_liveArenas.load(std::memory_order_relaxed);
+}
+
+void* InstructionArena::bump(size_t size)
+{
+    size = roundUp(size);
+    if (static_cast<size_t>(m_end - m_next) < size)
+    {
+        // A new block, linked to the previous one through its first word
+        const size_t blockSize = std::max(m_blockSize, sizeof(char*) + size);
+        char*        block     = static_cast<char*>(::operator new(blockSize));
+        *reinterpret_cast<char**>(block) = m_blocks;
+        m_blocks                         = block;
+        m_next                           = block + sizeof(char*);
+        m_end                            = block + blockSize;
+        m_blockSize                      = std::min(m_blockSize * 2, MAX_BLOCK);
+    }
+    void* storage = m_next;
+    m_next += size;
+    return storage;
+}
+
+void InstructionArena::release(size_t references) noexcept
+{
+    if (m_references.fetch_sub(references, std::memory_order_acq_rel) == references)
+    {
+        delete this;
+    }
+}
+
+}  // namespace mips
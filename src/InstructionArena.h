@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+namespace mips
+{
+
+/**
+ * @brief Program-lifetime storage for Instruction objects and their label names
+ *
+ * While a Scope is alive, every Instruction created on that thread (make_unique,
+ * new, clone()) is bump-allocated from one arena, in creation order, and the label
+ * names those instructions hold are interned into the same arena. An assembled
+ * program therefore occupies a few large blocks instead of millions of separate
+ * heap objects and strings.
+ *
+ * Ownership does not change: instructions are still held by std::unique_ptr.
+ * Deleting an arena instruction runs its (trivial) destructor and drops one
+ * reference, without calling free(). The arena frees all of its blocks at once
+ * when its last instruction is deleted and its Scope has ended. Instructions
+ * created outside any Scope come from the global heap as before.
+ *
+ * Instruction classes must not be over-aligned: objects are aligned to a pointer.
+ */
+class InstructionArena
+{
+  public:
+    /**
+     * @brief Places instructions created on this thread in a new arena while alive
+     *
+     * Scopes nest; the innermost one is used.
+     */
+    class Scope
+    {
+      public:
+        Scope();
+        ~Scope();
+
+        Scope(const Scope&)            = delete;
+        Scope& operator=(const Scope&) = delete;
+
+      private:
+        InstructionArena* m_arena;
+        InstructionArena* m_previous;
+    };
+
+    /**
+     * @brief Storage for one Instruction (Instruction::operator new)
+     */
+    static void* allocate(size_t size);
+
+    /**
+     * @brief Release storage from allocate() (Instruction::operator delete)
+     */
+    static void deallocate(void* pointer) noexcept;
+
+    /**
+     * @brief Copy a label name into the arena of the object at owner
+     *
+     * Only names of the instruction the current arena allocated last can be interned;
+     * they live as long as that arena. For any other owner (an instruction on the
+     * stack, from the heap, or created after its arena's Scope ended) this returns
+     * false and the caller keeps its own copy. The arena's table has a fixed number
+     * of slots, so interning never rehashes: a repeated name shares one copy unless
+     * another name took over its slot in between.
+     * @param[out] interned The arena's copy, set only on success
+     */
+    static bool intern(std::string_view name, const void* owner, std::string_view& interned);
+
+    /**
+     * @brief Arenas still holding instructions or an open Scope, for tests
+     */
+    static size_t liveArenas();
+
+  private:
+    InstructionArena();
+    ~InstructionArena();
+
+    void* bump(size_t size);
+    void  release(size_t references) noexcept;
+
+    static constexpr size_t FIRST_BLOCK = 512;      // An edited line needs little
+    static constexpr size_t MAX_BLOCK   = 1 << 20;  // Whole programs use 1 MiB blocks
+    static constexpr size_t NAME_SLOTS  = 1024;     // Power of two
+
+    // The Scope holds this many references, so allocations are counted without atomics
+    // and the count is settled once when the Scope ends
+    static constexpr size_t SCOPE_REFERENCE = SIZE_MAX / 2;
+
+    char*                                m_blocks     = nullptr;  // Newest; each links the last
+    char*                                m_next       = nullptr;
+    char*                                m_end        = nullptr;
+    size_t                               m_blockSize  = FIRST_BLOCK;
+    const char*                          m_lastObject = nullptr;  // Most recent allocate()
+    const char*                          m_lastEnd    = nullptr;
+    size_t                               m_allocated  = 0;        // By allocate(), in the Scope
+    std::unique_ptr<std::string_view[]>  m_names;                 // By hash, while in the Scope
+    std::atomic<size_t>                  m_references{SCOPE_REFERENCE};  // Live instructions
+};
+
+}  // namespace mips
@@ -1,10 +1,376 @@
 #include "InstructionDecoder.h"
 #include "Instruction.h"
+#include "InstructionArena.h"
+#include <algorithm>
+#include <array>
+#include <sstream>
+#include <stdexcept>
 
 namespace mips
 {
 
+namespace
+{
+
+// One row of the decode table. Every DecodedInstr field is assembled the same way
+// for all instructions, by OR-ing the candidate encodings of that field under the
+// row's masks, so an instruction that does not use a field has zero masks. This
+// keeps decodeInto() free of per-format branches; the $zero-destination Nop is a
+// select between op and zeroOp.
+//
+// The register bytes are handled together as one word laid out like
+// rd << 8 | rs << 16 | rt << 24, built from the R-type field positions
+// (rFields) or from rt alone for I-type destinations (rtFields).
+struct DecodeEntry
+{
+    uint32_t  fixed      = 0;  // op, plus $ra in the rd byte for jal
+    uint32_t  rFields    = 0;
+    uint32_t  rtFields   = 0;
+    DecodedOp zeroOp     = DecodedOp::Nop;  // op when rd is $zero: Nop for register writes
+    bool      valid      = false;
+    uint32_t  lowMask    = 0;  // Zero-extended 16-bit immediate
+    uint32_t  signMask   = 0;  // Sign-extended 16-bit immediate
+    uint32_t  shamtMask  = 0;  // Shift amount
+    uint32_t  highMask   = 0;  // Immediate in the upper halfword (lhi)
+    uint32_t  branchMask = 0;  // index + 1 + offset
+    uint32_t  jumpMask   = 0;  // The 26-bit jump field
+    uint32_t  selfMask   = 0;  // The word's own index (Fallback)
+};
+
+// Register byte positions in the packed register word
+constexpr uint32_t RD_BYTE = 0x1F00;
+constexpr uint32_t RS_BYTE = 0x1F0000;
+constexpr uint32_t RT_BYTE = 0x1F000000;
+
+constexpr uint8_t  REG      = 0x1F;
+constexpr uint32_t ALL_BITS = 0xFFFFFFFF;
+
+// Table rows are indexed by opcode, or by 64 + funct for R-type (opcode 0) words
+constexpr size_t TABLE_SIZE = 128;
+
+inline uint32_t tableKey(uint32_t word)
+{
+    const uint32_t opcode = word >> 26;
+    return opcode == 0 ? 64 + (word & 0x3F) : opcode;
+}
+
+constexpr DecodeEntry entry(DecodedOp op)
+{
+    DecodeEntry e;
+    e.fixed  = static_cast<uint32_t>(op);
+    e.zeroOp = op;
+    e.valid  = true;
+    return e;
+}
+
+// Register writes to $zero lower to Nop (see lowerRegisterWrite in Instruction.cpp)
+constexpr DecodeEntry registerWrite(DecodedOp op)
+{
+    DecodeEntry e = entry(op);
+    e.zeroOp      = DecodedOp::Nop;
+    return e;
+}
+
+// add rd, rs, rt and friends; sllv and co. keep the same field order
+constexpr DecodeEntry registerOp(DecodedOp op)
+{
+    DecodeEntry e = registerWrite(op);
+    e.rFields     = RD_BYTE | RS_BYTE | RT_BYTE;
+    return e;
+}
+
+// sll rd, rt, shamt
+constexpr DecodeEntry shiftOp(DecodedOp op)
+{
+    DecodeEntry e = registerWrite(op);
+    e.rFields     = RD_BYTE | RT_BYTE;
+    e.shamtMask   = ALL_BITS;
+    return e;
+}
+
+// mult/div rs, rt
+constexpr DecodeEntry hiLoOp(DecodedOp op)
+{
+    DecodeEntry e = entry(op);
+    e.rFields     = RS_BYTE | RT_BYTE;
+    return e;
+}
+
+// mfhi/mflo rd
+constexpr DecodeEntry moveFromOp(DecodedOp op)
+{
+    DecodeEntry e = registerWrite(op);
+    e.rFields     = RD_BYTE;
+    return e;
+}
+
+// mthi/mtlo/jr rs
+constexpr DecodeEntry sourceOp(DecodedOp op)
+{
+    DecodeEntry e = entry(op);
+    e.rFields     = RS_BYTE;
+    return e;
+}
+
+// jalr rd, rs (kept even when rd is $zero, as the jump still happens)
+constexpr DecodeEntry jalrOp()
+{
+    DecodeEntry e = entry(DecodedOp::Jalr);
+    e.rFields     = RD_BYTE | RS_BYTE;
+    return e;
+}
+
+// addi rt, rs, imm and loads: rt is the destination
+constexpr DecodeEntry immediateOp(DecodedOp op, bool signExtend)
+{
+    DecodeEntry e = registerWrite(op);
+    e.rFields     = RS_BYTE;
+    e.rtFields    = RD_BYTE;
+    e.signMask    = signExtend ? ALL_BITS : 0;
+    e.lowMask     = signExtend ? 0 : ALL_BITS;
+    return e;
+}
+
+// llo/lhi rt, imm: merge into rt, so rt is also the source
+constexpr DecodeEntry loadHalfOp(DecodedOp op, bool upper)
+{
+    DecodeEntry e = registerWrite(op);
+    e.rtFields    = RD_BYTE | RS_BYTE;
+    e.lowMask     = upper ? 0 : ALL_BITS;
+    e.highMask    = upper ? ALL_BITS : 0;
+    return e;
+}
+
+// sw rt, imm(rs)
+constexpr DecodeEntry storeOp(DecodedOp op)
+{
+    DecodeEntry e = entry(op);
+    e.rFields     = RS_BYTE | RT_BYTE;
+    e.signMask    = ALL_BITS;
+    return e;
+}
+
+// beq/bne compare rs with rt; blez/bgtz only look at rs
+constexpr DecodeEntry branchOp(DecodedOp op, bool usesRt)
+{
+    DecodeEntry e = entry(op);
+    e.rFields     = usesRt ? RS_BYTE | RT_BYTE : RS_BYTE;
+    e.branchMask  = ALL_BITS;
+    return e;
+}
+
+constexpr DecodeEntry jumpOp(DecodedOp op, bool link)
+{
+    DecodeEntry e = entry(op);
+    e.fixed |= link ? 31u << 8 : 0;
+    e.jumpMask = 0x03FFFFFF;
+    return e;
+}
+
+// syscall and trap run through their Instruction object
+constexpr DecodeEntry fallbackOp()
+{
+    DecodeEntry e = entry(DecodedOp::Fallback);
+    e.selfMask    = ALL_BITS;
+    return e;
+}
+
+constexpr std::array<DecodeEntry, TABLE_SIZE> buildTable()
+{
+    std::array<DecodeEntry, TABLE_SIZE> table{};
+
+    // I-type and J-type, by opcode
+    table[0x02] = jumpOp(DecodedOp::J, false);
+    table[0x03] = jumpOp(DecodedOp::Jal, true);
+    table[0x04] = branchOp(DecodedOp::Beq, true);
+    table[0x05] = branchOp(DecodedOp::Bne, true);
+    table[0x06] = branchOp(DecodedOp::Blez, false);
+    table[0x07] = branchOp(DecodedOp::Bgtz, false);
+    table[0x08] = immediateOp(DecodedOp::Addi, true);
+    table[0x09] = immediateOp(DecodedOp::Addiu, true);
+    table[0x0A] = immediateOp(DecodedOp::Slti, true);
+    table[0x0B] = immediateOp(DecodedOp::Sltiu, true);
+    table[0x0C] = immediateOp(DecodedOp::Andi, false);
+    table[0x0D] = immediateOp(DecodedOp::Ori, false);
+    table[0x0E] = immediateOp(DecodedOp::Xori, false);
+    table[0x18] = loadHalfOp(DecodedOp::Llo, false);
+    table[0x19] = loadHalfOp(DecodedOp::Lhi, true);
+    table[0x1A] = fallbackOp();  // trap
+    table[0x20] = immediateOp(DecodedOp::Lb, true);
+    table[0x21] = immediateOp(DecodedOp::Lh, true);
+    table[0x23] = immediateOp(DecodedOp::Lw, true);
+    table[0x24] = immediateOp(DecodedOp::Lbu, true);
+    table[0x25] = immediateOp(DecodedOp::Lhu, true);
+    table[0x28] = storeOp(DecodedOp::Sb);
+    table[0x29] = storeOp(DecodedOp::Sh);
+    table[0x2B] = storeOp(DecodedOp::Sw);
+
+    // R-type, by 64 + funct
+    table[64 + 0x00] = shiftOp(DecodedOp::Sll);
+    table[64 + 0x02] = shiftOp(DecodedOp::Srl);
+    table[64 + 0x03] = shiftOp(DecodedOp::Sra);
+    table[64 + 0x04] = registerOp(DecodedOp::Sllv);
+    table[64 + 0x06] = registerOp(DecodedOp::Srlv);
+    table[64 + 0x07] = registerOp(DecodedOp::Srav);
+    table[64 + 0x08] = sourceOp(DecodedOp::Jr);
+    table[64 + 0x09] = jalrOp();
+    table[64 + 0x0C] = fallbackOp();  // syscall
+    table[64 + 0x10] = moveFromOp(DecodedOp::Mfhi);
+    table[64 + 0x11] = sourceOp(DecodedOp::Mthi);
+    table[64 + 0x12] = moveFromOp(DecodedOp::Mflo);
+    table[64 + 0x13] = sourceOp(DecodedOp::Mtlo);
+    table[64 + 0x18] = hiLoOp(DecodedOp::Mult);
+    table[64 + 0x19] = hiLoOp(DecodedOp::Multu);
+    table[64 + 0x1A] = hiLoOp(DecodedOp::Div);
+    table[64 + 0x1B] = hiLoOp(DecodedOp::Divu);
+    table[64 + 0x20] = registerOp(DecodedOp::Add);
+    table[64 + 0x21] = registerOp(DecodedOp::Addu);
+    table[64 + 0x22] = registerOp(DecodedOp::Sub);
+    table[64 + 0x23] = registerOp(DecodedOp::Subu);
+    table[64 + 0x24] = registerOp(DecodedOp::And);
+    table[64 + 0x25] = registerOp(DecodedOp::Or);
+    table[64 + 0x26] = registerOp(DecodedOp::Xor);
+    table[64 + 0x27] = registerOp(DecodedOp::Nor);
+    table[64 + 0x2A] = registerOp(DecodedOp::Slt);
+    table[64 + 0x2B] = registerOp(DecodedOp::Sltu);
+    return table;
+}
+
+constexpr std::array<DecodeEntry, TABLE_SIZE> DECODE_TABLE = buildTable();
+
+inline void fill(const DecodeEntry& e, uint32_t word, uint32_t index, DecodedInstr& out)
+{
+    const uint32_t rt = (word >> 16) & REG;
+    const uint32_t rFields =
+        ((word >> 3) & RD_BYTE) | ((word >> 5) & RS_BYTE) | ((word << 8) & RT_BYTE);
+    const uint32_t rtFields = rt * 0x10100;  // rt << 8 | rt << 16
+    uint32_t       regs     = e.fixed | (rFields & e.rFields) | (rtFields & e.rtFields);
+    // Swap in zeroOp when rd is $zero, without a branch: the destination is
+    // data-dependent and a mispredict costs more than the whole decode
+    const uint32_t zeroRd = static_cast<uint32_t>((regs & RD_BYTE) == 0) * 0xFFu;
+    regs ^= (regs ^ static_cast<uint32_t>(e.zeroOp)) & zeroRd;
+
+    const uint32_t low = word & 0xFFFF;
+    const uint32_t signExtended =
+        static_cast<uint32_t>(static_cast<int32_t>(static_cast<int16_t>(low)));
+
+    DecodedInstr record;
+    record.op  = static_cast<DecodedOp>(regs & 0xFF);
+    record.rd  = static_cast<uint8_t>(regs >> 8);
+    record.rs  = static_cast<uint8_t>(regs >> 16);
+    record.rt  = static_cast<uint8_t>(regs >> 24);
+    record.imm = (low & e.lowMask) | (signExtended & e.signMask) |
+                 (((word >> 6) & REG) & e.shamtMask) | ((low << 16) & e.highMask);
+    record.target = ((index + 1 + signExtended) & e.branchMask) | (word & e.jumpMask) |
+                    (index & e.selfMask);
+    out = record;  // One store of the whole record
+}
+
+}  // namespace
+
 std::unique_ptr<Instruction> InstructionDecoder::decode(uint32_t word)
+{
+    return decodeAt(word, NO_INDEX);
+}
+
+std::vector<std::unique_ptr<Instruction>> InstructionDecoder::decodeProgram(const uint32_t* words,
+                                                                            size_t          count)
+{
+    InstructionArena::Scope                   arena;  // The program's instructions, side by side
+    std::vector<std::unique_ptr<Instruction>> instructions;
+    instructions.reserve(count);
+
+    // Every label decodeAt can produce is named by its absolute index, so each
+    // instruction links against a table holding only its own target
+    LabelMap    target;
+    std::string unresolved;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const uint32_t index = static_cast<uint32_t>(i);
+        auto           instr = decodeAt(words[i], index);
+        if (!instr)
+        {
+            std::ostringstream message;
+            message << "invalid instruction word 0x" << std::hex << words[i] << std::dec
+                    << " at index " << i;
+            throw std::runtime_error(message.str());
+        }
+
+        int64_t  targetIndex = -1;
+        uint32_t opcode      = extractOpcode(words[i]);
+        if (opcode >= 0x04 && opcode <= 0x07)
+        {
+            targetIndex = index + 1 + static_cast<int16_t>(extractImmediate(words[i]));
+        }
+        else if (opcode == 0x02)
+        {
+            targetIndex = extractJumpTarget(words[i]);
+        }
+        target.clear();
+        if (targetIndex >= 0)
+        {
+            target.emplace(targetLabel(index, targetIndex), static_cast<uint32_t>(targetIndex) * 4);
+        }
+        if (!instr->link(target, unresolved))
+        {
+            throw std::runtime_error("Undefined label: '" + unresolved + "' (instruction " +
+                                     std::to_string(i) + ")");
+        }
+        instructions.push_back(std::move(instr));
+    }
+    return instructions;
+}
+
+bool InstructionDecoder::decodeInto(uint32_t word, DecodedInstr& out, uint32_t index)
+{
+    const DecodeEntry& e = DECODE_TABLE[tableKey(word)];
+    if (!e.valid)
+    {
+        return false;
+    }
+    fill(e, word, index, out);
+    return true;
+}
+
+size_t InstructionDecoder::decodeRange(std::span<const uint32_t> words, std::span<DecodedInstr> out,
+                                       uint32_t firstIndex)
+{
+    // Two passes per chunk: the table keys first, in a loop simple enough for the
+    // compiler to vectorise, then the table-driven field extraction
+    constexpr size_t CHUNK = 256;
+    uint8_t          keys[CHUNK];
+
+    const size_t count = std::min(words.size(), out.size());
+    for (size_t base = 0; base < count; base += CHUNK)
+    {
+        const size_t    n     = std::min(CHUNK, count - base);
+        const uint32_t* chunk = words.data() + base;
+        for (size_t i = 0; i < n; ++i)
+        {
+            const uint32_t opcode = chunk[i] >> 26;
+            keys[i] = static_cast<uint8_t>(opcode == 0 ? 64 + (chunk[i] & 0x3F) : opcode);
+        }
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            const DecodeEntry& e = DECODE_TABLE[keys[i]];
+            if (!e.valid)
+            {
+                return base + i;
+            }
+            fill(e, chunk[i], firstIndex + static_cast<uint32_t>(base + i), out[base + i]);
+        }
+    }
+    return count;
+}
+
+std::string InstructionDecoder::targetLabel(uint32_t index, int64_t target)
+{
+    // Standalone words keep the raw field in the name, as there is nothing to resolve against
+    return index == NO_INDEX ? "label_" + std::to_string(target) : "L" + std::to_string(target);
+}
+
+std::unique_ptr<Instruction> InstructionDecoder::decodeAt(uint32_t word, uint32_t index)
 {
     uint32_t opcode = extractOpcode(word);
 
@@ -14,7 +380,7 @@ std::unique_ptr<Instruction> InstructionDecoder::decode(uint32_t word)
         return decodeRType(word);
     case 0x02:  // J instruction
     case 0x03:  // JAL instruction (not implemented yet)
-        return decodeJType(word);
+        return decodeJType(word, index);
     case 0x08:  // ADDI instruction
     case 0x09:  // ADDIU instruction
     case 0x0A:  // SLTI instruction
@@ -36,7 +402,7 @@ std::unique_ptr<Instruction> InstructionDecoder::decode(uint32_t word)
     case 0x07:  // BGTZ instruction
     case 0x18:  // LLO instruction
     case 0x19:  // LHI instruction
-        return decodeIType(word);
+        return decodeIType(word, index);
     case 0x1A:  // TRAP instruction
         return decodeTrapInstruction(word);
     default:
@@ -153,7 +519,7 @@ std::unique_ptr<Instruction> InstructionDecoder::decodeRType(uint32_t word)
     }
 }
 
-std::unique_ptr<Instruction> InstructionDecoder::decodeIType(uint32_t word)
+std::unique_ptr<Instruction> InstructionDecoder::decodeIType(uint32_t word, uint32_t index)
 {
     uint32_t opcode    = extractOpcode(word);
     uint32_t rs        = extractRs(word);
@@ -163,6 +529,11 @@ std::unique_ptr<Instruction> InstructionDecoder::decodeIType(uint32_t word)
     // Sign-extend 16-bit immediate to 16-bit signed value
     int16_t signedImmediate = static_cast<int16_t>(immediate);
 
+    // Branch offsets count instructions from the one after the branch
+    const std::string branchLabel =
+        targetLabel(index, index == NO_INDEX ? signedImmediate
+                                             : static_cast<int64_t>(index) + 1 + signedImmediate);
+
     switch (opcode)
     {
     case 0x08:  // ADDI instruction
@@ -190,18 +561,15 @@ std::unique_ptr<Instruction> InstructionDecoder::decodeIType(uint32_t word)
     case 0x2B:  // SW instruction
         return std::make_unique<SwInstruction>(rt, rs, signedImmediate);
     case 0x04:  // BEQ instruction
-        // For BEQ, we need to convert immediate to a label (simplified approach)
-        // In a real implementation, this would need a symbol table
-        return std::make_unique<BeqInstruction>(rs, rt, "label_" + std::to_string(signedImmediate));
+        return std::make_unique<BeqInstruction>(rs, rt, branchLabel);
     case 0x05:  // BNE instruction
-        // For BNE, use a label placeholder based on the immediate value
-        return std::make_unique<BneInstruction>(rs, rt, "label_" + std::to_string(signedImmediate));
+        return std::make_unique<BneInstruction>(rs, rt, branchLabel);
     case 0x06:  // BLEZ instruction
         // For BLEZ, only rs is used, rt is ignored (should be 0)
-        return std::make_unique<BLEZInstruction>(rs, "label_" + std::to_string(signedImmediate));
+        return std::make_unique<BLEZInstruction>(rs, branchLabel);
     case 0x07:  // BGTZ instruction
         // For BGTZ, only rs is used, rt is ignored (should be 0)
-        return std::make_unique<BGTZInstruction>(rs, "label_" + std::to_string(signedImmediate));
+        return std::make_unique<BGTZInstruction>(rs, branchLabel);
     case 0x0C:  // ANDI instruction
         return std::make_unique<AndiInstruction>(rt, rs, signedImmediate);
     case 0x0D:  // ORI instruction
@@ -217,7 +585,7 @@ std::unique_ptr<Instruction> InstructionDecoder::decodeIType(uint32_t word)
     }
 }
 
-std::unique_ptr<Instruction> InstructionDecoder::decodeJType(uint32_t word)
+std::unique_ptr<Instruction> InstructionDecoder::decodeJType(uint32_t word, uint32_t index)
 {
     uint32_t opcode     = extractOpcode(word);
     uint32_t jumpTarget = extractJumpTarget(word);
@@ -225,8 +593,7 @@ std::unique_ptr<Instruction> InstructionDecoder::decodeJType(uint32_t word)
     switch (opcode)
     {
     case 0x02:  // J instruction
-        // Convert jump target to label (simplified approach)
-        return std::make_unique<JInstruction>("label_" + std::to_string(jumpTarget));
+        return std::make_unique<JInstruction>(targetLabel(index, jumpTarget));
     case 0x03:  // JAL instruction
         return std::make_unique<JALInstruction>(jumpTarget);
     default:
@@ -1,7 +1,12 @@
 #pragma once
 
+#include "DecodedInstruction.h"
+#include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <span>
+#include <string>
+#include <vector>
 
 namespace mips
 {
@@ -11,7 +16,8 @@ class Instruction;
 /**
  * @brief 32-bit MIPS instruction decoder
  *
- * Converts binary machine code words into Instruction objects
+ * Converts binary machine code words into Instruction objects, or straight into
+ * the DecodedInstr records the interpreters execute (decodeInto/decodeRange)
  */
 class InstructionDecoder
 {
@@ -23,7 +29,48 @@ class InstructionDecoder
      */
     static std::unique_ptr<Instruction> decode(uint32_t word);
 
+    /**
+     * @brief Decode a text section into linked, executable instructions
+     *
+     * Word i is the instruction at index i (byte address i * 4). Unlike decode(),
+     * branch and jump targets are resolved to those indices, so the result can be
+     * run like the output of Assembler::link.
+     * @param words Machine words, e.g. from InstructionEncoder::encodeProgram
+     * @param count Number of words
+     * @throws std::runtime_error if a word is not a valid instruction
+     */
+    static std::vector<std::unique_ptr<Instruction>> decodeProgram(const uint32_t* words,
+                                                                   size_t          count);
+
+    /**
+     * @brief Decode one word into the record Cpu builds by lowering its Instruction
+     *
+     * Table-driven and allocation-free. syscall and trap become Fallback records,
+     * as they are executed through their Instruction object.
+     * @param word 32-bit machine code instruction
+     * @param out Receives the record; unspecified if the word is invalid
+     * @param index Instruction index of the word, to resolve branch offsets
+     * @return false if the word is not a valid instruction
+     */
+    static bool decodeInto(uint32_t word, DecodedInstr& out, uint32_t index = 0);
+
+    /**
+     * @brief Decode a whole text section, word i into out[i]
+     * @param words Machine words, word 0 being instruction firstIndex
+     * @param out At least words.size() records
+     * @param firstIndex Instruction index of words[0]
+     * @return Number of words decoded: words.size(), or the position of the first
+     *         invalid word
+     */
+    static size_t decodeRange(std::span<const uint32_t> words, std::span<DecodedInstr> out,
+                              uint32_t firstIndex = 0);
+
   private:
+    static constexpr uint32_t NO_INDEX = UINT32_MAX;  // Standalone word, targets stay symbolic
+
+    static std::unique_ptr<Instruction> decodeAt(uint32_t word, uint32_t index);
+    static std::string targetLabel(uint32_t index, int64_t target);
+
     // Field extraction methods
     static uint32_t extractOpcode(uint32_t word);      // bits 31-26
     static uint32_t extractRs(uint32_t word);          // bits 25-21
@@ -36,8 +83,8 @@ class InstructionDecoder
 
     // Instruction type decoders
     static std::unique_ptr<Instruction> decodeRType(uint32_t word);
-    static std::unique_ptr<Instruction> decodeIType(uint32_t word);
-    static std::unique_ptr<Instruction> decodeJType(uint32_t word);
+    static std::unique_ptr<Instruction> decodeIType(uint32_t word, uint32_t index);
+    static std::unique_ptr<Instruction> decodeJType(uint32_t word, uint32_t index);
     static std::unique_ptr<Instruction> decodeTrapInstruction(uint32_t word);
 };
 
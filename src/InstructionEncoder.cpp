@@ -0,0 +1,205 @@
+#include "InstructionEncoder.h"
+#include "DecodedInstruction.h"
+#include "Instruction.h"
+#include <sstream>
+#include <stdexcept>
+
+namespace mips
+{
+
+uint32_t InstructionEncoder::encode(const Instruction& instruction, uint32_t index)
+{
+    // System calls and traps have no lowered form; they are encoded from the object
+    if (auto* trap = dynamic_cast<const TrapInstruction*>(&instruction))
+    {
+        return jType(0x1A, trap->getTrapCode());
+    }
+    if (dynamic_cast<const SyscallInstruction*>(&instruction) != nullptr)
+    {
+        return rType(0, 0, 0, 0, 0x0C);
+    }
+
+    DecodedInstr d;
+    if (!instruction.lower(d))
+    {
+        throw std::runtime_error("'" + instruction.getName() + "' has unresolved operands");
+    }
+
+    switch (d.op)
+    {
+    case DecodedOp::Nop:
+        return 0;  // sll $zero, $zero, 0
+
+    // R-type: the decoder reads rs (25-21), rt (20-16), rd (15-11), shamt (10-6), funct (5-0)
+    case DecodedOp::Sll:
+        return rType(0, d.rt, d.rd, d.imm, 0x00);
+    case DecodedOp::Srl:
+        return rType(0, d.rt, d.rd, d.imm, 0x02);
+    case DecodedOp::Sra:
+        return rType(0, d.rt, d.rd, d.imm, 0x03);
+    case DecodedOp::Sllv:
+        return rType(d.rs, d.rt, d.rd, 0, 0x04);
+    case DecodedOp::Srlv:
+        return rType(d.rs, d.rt, d.rd, 0, 0x06);
+    case DecodedOp::Srav:
+        return rType(d.rs, d.rt, d.rd, 0, 0x07);
+    case DecodedOp::Jr:
+        return rType(d.rs, 0, 0, 0, 0x08);
+    case DecodedOp::Jalr:
+        return rType(d.rs, 0, d.rd, 0, 0x09);
+    case DecodedOp::Mfhi:
+        return rType(0, 0, d.rd, 0, 0x10);
+    case DecodedOp::Mthi:
+        return rType(d.rs, 0, 0, 0, 0x11);
+    case DecodedOp::Mflo:
+        return rType(0, 0, d.rd, 0, 0x12);
+    case DecodedOp::Mtlo:
+        return rType(d.rs, 0, 0, 0, 0x13);
+    case DecodedOp::Mult:
+        return rType(d.rs, d.rt, 0, 0, 0x18);
+    case DecodedOp::Multu:
+        return rType(d.rs, d.rt, 0, 0, 0x19);
+    case DecodedOp::Div:
+        return rType(d.rs, d.rt, 0, 0, 0x1A);
+    case DecodedOp::Divu:
+        return rType(d.rs, d.rt, 0, 0, 0x1B);
+    case DecodedOp::Add:
+        return rType(d.rs, d.rt, d.rd, 0, 0x20);
+    case DecodedOp::Addu:
+        return rType(d.rs, d.rt, d.rd, 0, 0x21);
+    case DecodedOp::Sub:
+        return rType(d.rs, d.rt, d.rd, 0, 0x22);
+    case DecodedOp::Subu:
+        return rType(d.rs, d.rt, d.rd, 0, 0x23);
+    case DecodedOp::And:
+        return rType(d.rs, d.rt, d.rd, 0, 0x24);
+    case DecodedOp::Or:
+        return rType(d.rs, d.rt, d.rd, 0, 0x25);
+    case DecodedOp::Xor:
+        return rType(d.rs, d.rt, d.rd, 0, 0x26);
+    case DecodedOp::Nor:
+        return rType(d.rs, d.rt, d.rd, 0, 0x27);
+    case DecodedOp::Slt:
+        return rType(d.rs, d.rt, d.rd, 0, 0x2A);
+    case DecodedOp::Sltu:
+        return rType(d.rs, d.rt, d.rd, 0, 0x2B);
+
+    // I-type: register writes keep their destination in the rt field
+    case DecodedOp::Addi:
+        return iType(0x08, d.rs, d.rd, d.imm);
+    case DecodedOp::Addiu:
+        return iType(0x09, d.rs, d.rd, d.imm);
+    case DecodedOp::Slti:
+        return iType(0x0A, d.rs, d.rd, d.imm);
+    case DecodedOp::Sltiu:
+        return iType(0x0B, d.rs, d.rd, d.imm);
+    case DecodedOp::Andi:
+        return iType(0x0C, d.rs, d.rd, d.imm);
+    case DecodedOp::Ori:
+        return iType(0x0D, d.rs, d.rd, d.imm);
+    case DecodedOp::Xori:
+        return iType(0x0E, d.rs, d.rd, d.imm);
+    case DecodedOp::Llo:
+        return iType(0x18, 0, d.rd, d.imm);
+    case DecodedOp::Lhi:
+        return iType(0x19, 0, d.rd, d.imm >> 16);
+    case DecodedOp::Lb:
+        return iType(0x20, d.rs, d.rd, d.imm);
+    case DecodedOp::Lh:
+        return iType(0x21, d.rs, d.rd, d.imm);
+    case DecodedOp::Lw:
+        return iType(0x23, d.rs, d.rd, d.imm);
+    case DecodedOp::Lbu:
+        return iType(0x24, d.rs, d.rd, d.imm);
+    case DecodedOp::Lhu:
+        return iType(0x25, d.rs, d.rd, d.imm);
+    case DecodedOp::Sb:
+        return iType(0x28, d.rs, d.rt, d.imm);
+    case DecodedOp::Sh:
+        return iType(0x29, d.rs, d.rt, d.imm);
+    case DecodedOp::Sw:
+        return iType(0x2B, d.rs, d.rt, d.imm);
+    case DecodedOp::La:
+        if (d.imm > 0xFFFF)
+        {
+            std::ostringstream message;
+            message << "la address 0x" << std::hex << d.imm << " does not fit in 16 bits";
+            throw std::runtime_error(message.str());
+        }
+        return iType(0x0D, 0, d.rd, d.imm);  // ori rt, $zero, address
+
+    // Branches and jumps
+    case DecodedOp::Beq:
+        return iType(0x04, d.rs, d.rt, branchOffset(d.target, index));
+    case DecodedOp::Bne:
+        return iType(0x05, d.rs, d.rt, branchOffset(d.target, index));
+    case DecodedOp::Blez:
+        return iType(0x06, d.rs, 0, branchOffset(d.target, index));
+    case DecodedOp::Bgtz:
+        return iType(0x07, d.rs, 0, branchOffset(d.target, index));
+    case DecodedOp::J:
+        return jType(0x02, d.target);
+    case DecodedOp::Jal:
+        return jType(0x03, d.target);
+
+    case DecodedOp::Fallback:
+        break;
+    }
+
+    throw std::runtime_error("'" + instruction.getName() + "' has no machine encoding");
+}
+
+std::vector<uint32_t>
+InstructionEncoder::encodeProgram(const std::vector<std::unique_ptr<Instruction>>& instructions)
+{
+    std::vector<uint32_t> words;
+    words.reserve(instructions.size());
+    for (size_t i = 0; i < instructions.size(); ++i)
+    {
+        try
+        {
+            words.push_back(encode(*instructions[i], static_cast<uint32_t>(i)));
+        }
+        catch (const std::runtime_error& e)
+        {
+            throw std::runtime_error("instruction " + std::to_string(i) + ": " + e.what());
+        }
+    }
+    return words;
+}
+
+uint32_t InstructionEncoder::rType(uint32_t rs, uint32_t rt, uint32_t rd, uint32_t shamt,
+                                   uint32_t function)
+{
+    return ((rs & 0x1F) << 21) | ((rt & 0x1F) << 16) | ((rd & 0x1F) << 11) |
+           ((shamt & 0x1F) << 6) | (function & 0x3F);
+}
+
+uint32_t InstructionEncoder::iType(uint32_t opcode, uint32_t rs, uint32_t rt, uint32_t immediate)
+{
+    return (opcode << 26) | ((rs & 0x1F) << 21) | ((rt & 0x1F) << 16) | (immediate & 0xFFFF);
+}
+
+uint32_t InstructionEncoder::jType(uint32_t opcode, uint32_t target)
+{
+    if (target > 0x3FFFFFF)
+    {
+        throw std::runtime_error("jump target " + std::to_string(target) +
+                                 " does not fit in 26 bits");
+    }
+    return (opcode << 26) | target;
+}
+
+uint32_t InstructionEncoder::branchOffset(uint32_t target, uint32_t index)
+{
+    // Offsets count instructions from the one after the branch
+    const int64_t offset = static_cast<int64_t>(target) - (static_cast<int64_t>(index) + 1);
+    if (offset < INT16_MIN || offset > INT16_MAX)
+    {
+        throw std::runtime_error("branch offset " + std::to_string(offset) +
+                                 " does not fit in 16 bits");
+    }
+    return static_cast<uint32_t>(offset) & 0xFFFF;
+}
+
+}  // namespace mips
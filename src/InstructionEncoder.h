@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace mips
+{
+
+class Instruction;
+
+/**
+ * @brief 32-bit MIPS instruction encoder, the inverse of InstructionDecoder
+ *
+ * Works from the instruction's lowered form (Instruction::lower), so it needs
+ * linked instructions and emits exactly the opcode/funct layout the decoder
+ * reads. Text starts at address 0, so a jump field and a branch target are
+ * instruction indices. Three encodings are canonical rather than literal:
+ * an instruction whose only effect is a write to $zero becomes the nop word 0,
+ * and la becomes "ori rt, $zero, address", which requires a data address
+ * below 64KB.
+ */
+class InstructionEncoder
+{
+  public:
+    /**
+     * @brief Encode one linked instruction
+     * @param instruction Instruction after Assembler::link
+     * @param index Position of the instruction, for PC-relative branch offsets
+     * @return 32-bit machine word
+     * @throws std::runtime_error if the instruction has no single-word encoding
+     */
+    static uint32_t encode(const Instruction& instruction, uint32_t index);
+
+    /**
+     * @brief Encode a whole linked program, instruction i at index i
+     * @throws std::runtime_error naming the first instruction that cannot be encoded
+     */
+    static std::vector<uint32_t>
+    encodeProgram(const std::vector<std::unique_ptr<Instruction>>& instructions);
+
+  private:
+    static uint32_t rType(uint32_t rs, uint32_t rt, uint32_t rd, uint32_t shamt,
+                          uint32_t function);
+    static uint32_t iType(uint32_t opcode, uint32_t rs, uint32_t rt, uint32_t immediate);
+    static uint32_t jType(uint32_t opcode, uint32_t target);
+    static uint32_t branchOffset(uint32_t target, uint32_t index);
+};
+
+}  // namespace mips
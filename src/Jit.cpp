@@ -0,0 +1,843 @@
+#include "Jit.h"
+#include "Memory.h"
+#include <cstddef>
+#include <cstring>
+
+#if MIPSIM_JIT_AVAILABLE
+#include <sys/mman.h>
+#endif
+
+namespace mips
+{
+
+#if MIPSIM_JIT_AVAILABLE
+
+namespace
+{
+
+// Heat value of a block that could not be translated
+constexpr uint32_t NEVER_TRANSLATE = UINT32_MAX;
+
+// x86-64 register numbers (low three bits of the encoding)
+constexpr uint8_t EAX = 0;
+constexpr uint8_t ECX = 1;
+constexpr uint8_t EDX = 2;
+constexpr uint8_t EBX = 3;
+constexpr uint8_t EBP = 5;
+constexpr uint8_t ESI = 6;
+constexpr uint8_t EDI = 7;
+
+// Opcodes of "op reg32, r/m32"
+constexpr uint8_t OP_ADD = 0x03;
+constexpr uint8_t OP_OR  = 0x0B;
+constexpr uint8_t OP_AND = 0x23;
+constexpr uint8_t OP_SUB = 0x2B;
+constexpr uint8_t OP_XOR = 0x33;
+constexpr uint8_t OP_CMP = 0x3B;
+
+// ModRM reg-field extensions of the 0x81 "op r/m32, imm32" group
+constexpr uint8_t EXT_ADD = 0;
+constexpr uint8_t EXT_OR  = 1;
+constexpr uint8_t EXT_AND = 4;
+constexpr uint8_t EXT_XOR = 6;
+constexpr uint8_t EXT_CMP = 7;
+
+// Condition codes for setcc/cmovcc/jcc
+constexpr uint8_t CC_B  = 0x2;
+constexpr uint8_t CC_AE = 0x3;
+constexpr uint8_t CC_E  = 0x4;
+constexpr uint8_t CC_NE = 0x5;
+constexpr uint8_t CC_L  = 0xC;
+constexpr uint8_t CC_LE = 0xE;
+constexpr uint8_t CC_G  = 0xF;
+
+// ModRM reg-field extensions of the 0xC1/0xD3 shift group
+constexpr uint8_t SHIFT_SHL = 4;
+constexpr uint8_t SHIFT_SHR = 5;
+constexpr uint8_t SHIFT_SAR = 7;
+
+// ModRM reg-field extension of sub in the 0x81 group (used on the 64-bit budget)
+constexpr uint8_t EXT_SUB = 5;
+
+constexpr int32_t CONTEXT_HI          = offsetof(JitContext, hi);
+constexpr int32_t CONTEXT_LO          = offsetof(JitContext, lo);
+constexpr int32_t CONTEXT_MEMORY      = offsetof(JitContext, memory);
+constexpr int32_t CONTEXT_BUDGET      = offsetof(JitContext, budget);
+constexpr int32_t CONTEXT_ENTRIES     = offsetof(JitContext, entries);
+constexpr int32_t CONTEXT_ENTRY_COUNT = offsetof(JitContext, entryCount);
+
+// Memory and division helpers called from translated code (SysV calling convention)
+uint32_t loadWord(Memory* memory, uint32_t address)
+{
+    return memory->readWord(address);
+}
+
+uint32_t loadByte(Memory* memory, uint32_t address)
+{
+    return static_cast<uint32_t>(
+        static_cast<int32_t>(static_cast<int8_t>(memory->readByte(address))));
+}
+
+uint32_t loadByteUnsigned(Memory* memory, uint32_t address)
+{
+    return memory->readByte(address);
+}
+
+uint32_t loadHalfword(Memory* memory, uint32_t address)
+{
+    return static_cast<uint32_t>(
+        static_cast<int32_t>(static_cast<int16_t>(memory->readHalfword(address))));
+}
+
+uint32_t loadHalfwordUnsigned(Memory* memory, uint32_t address)
+{
+    return memory->readHalfword(address);
+}
+
+void storeWord(Memory* memory, uint32_t address, uint32_t value)
+{
+    memory->writeWord(address, value);
+}
+
+void storeByte(Memory* memory, uint32_t address, uint32_t value)
+{
+    memory->writeByte(address, static_cast<uint8_t>(value & 0xFF));
+}
+
+void storeHalfword(Memory* memory, uint32_t address, uint32_t value)
+{
+    memory->writeHalfword(address, static_cast<uint16_t>(value & 0xFFFF));
+}
+
+void divide(JitContext* context, uint32_t dividend, uint32_t divisor)
+{
+    int32_t a = static_cast<int32_t>(dividend);
+    int32_t b = static_cast<int32_t>(divisor);
+    if (b == 0)
+    {
+        // Divide by zero leaves HI and LO zeroed, as in the interpreter
+        context->lo = 0;
+        context->hi = 0;
+    }
+    else if (b == -1)
+    {
+        // Avoids the host trap on INT_MIN / -1; the quotient wraps
+        context->lo = 0u - dividend;
+        context->hi = 0;
+    }
+    else
+    {
+        context->lo = static_cast<uint32_t>(a / b);
+        context->hi = static_cast<uint32_t>(a % b);
+    }
+}
+
+void divideUnsigned(JitContext* context, uint32_t dividend, uint32_t divisor)
+{
+    context->lo = divisor == 0 ? 0 : dividend / divisor;
+    context->hi = divisor == 0 ? 0 : dividend % divisor;
+}
+
+/**
+ * @brief Byte-level x86-64 encoder for the handful of forms the translator needs
+ *
+ * Translated code keeps the guest register array in rbx and the JitContext in
+ * rbp; every memory operand is [rbx/rbp + disp32]. Code is emitted into a
+ * vector and copied to @p base afterwards, so jumps are encoded against base.
+ */
+class Emitter
+{
+  public:
+    Emitter(std::vector<uint8_t>& out, const uint8_t* base) : m_out(out), m_base(base) {}
+
+    const uint8_t* position() const
+    {
+        return m_base + m_out.size();
+    }
+
+    void byte(uint8_t value)
+    {
+        m_out.push_back(value);
+    }
+
+    void dword(uint32_t value)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            byte(static_cast<uint8_t>(value >> (8 * i)));
+        }
+    }
+
+    void qword(uint64_t value)
+    {
+        for (int i = 0; i < 8; ++i)
+        {
+            byte(static_cast<uint8_t>(value >> (8 * i)));
+        }
+    }
+
+    // ModRM + disp32 for [base + disp]
+    void memory(uint8_t reg, uint8_t base, int32_t disp)
+    {
+        byte(static_cast<uint8_t>(0x80 | (reg << 3) | base));
+        dword(static_cast<uint32_t>(disp));
+    }
+
+    void loadGuest(uint8_t reg, unsigned guest)
+    {
+        byte(0x8B);
+        memory(reg, EBX, guestOffset(guest));
+    }
+
+    void storeGuest(unsigned guest, uint8_t reg)
+    {
+        byte(0x89);
+        memory(reg, EBX, guestOffset(guest));
+    }
+
+    void storeGuestImmediate(unsigned guest, uint32_t value)
+    {
+        byte(0xC7);
+        memory(0, EBX, guestOffset(guest));
+        dword(value);
+    }
+
+    void aluGuest(uint8_t opcode, uint8_t reg, unsigned guest)
+    {
+        byte(opcode);
+        memory(reg, EBX, guestOffset(guest));
+    }
+
+    void aluImmediate(uint8_t extension, uint8_t reg, uint32_t value)
+    {
+        byte(0x81);
+        byte(static_cast<uint8_t>(0xC0 | (extension << 3) | reg));
+        dword(value);
+    }
+
+    void loadContext(uint8_t reg, int32_t offset)
+    {
+        byte(0x8B);
+        memory(reg, EBP, offset);
+    }
+
+    void storeContext(int32_t offset, uint8_t reg)
+    {
+        byte(0x89);
+        memory(reg, EBP, offset);
+    }
+
+    void moveImmediate(uint8_t reg, uint32_t value)
+    {
+        byte(static_cast<uint8_t>(0xB8 + reg));
+        dword(value);
+    }
+
+    // xor reg, reg
+    void zero(uint8_t reg)
+    {
+        byte(0x31);
+        byte(static_cast<uint8_t>(0xC0 | (reg << 3) | reg));
+    }
+
+    // setcc cl
+    void setConditionEcx(uint8_t condition)
+    {
+        byte(0x0F);
+        byte(static_cast<uint8_t>(0x90 | condition));
+        byte(0xC1);
+    }
+
+    // cmovcc eax, ecx
+    void conditionalMoveEcx(uint8_t condition)
+    {
+        byte(0x0F);
+        byte(static_cast<uint8_t>(0x40 | condition));
+        byte(0xC1);
+    }
+
+    // shl/shr/sar eax, imm8
+    void shiftImmediate(uint8_t extension, uint8_t amount)
+    {
+        byte(0xC1);
+        byte(static_cast<uint8_t>(0xC0 | (extension << 3) | EAX));
+        byte(amount);
+    }
+
+    // shl/shr/sar eax, cl
+    void shiftByEcx(uint8_t extension)
+    {
+        byte(0xD3);
+        byte(static_cast<uint8_t>(0xC0 | (extension << 3) | EAX));
+    }
+
+    // mov rax, fn; call rax
+    void call(const void* function)
+    {
+        byte(0x48);
+        byte(0xB8);
+        qword(reinterpret_cast<uint64_t>(function));
+        byte(0xFF);
+        byte(0xD0);
+    }
+
+    // jmp rel32
+    void jump(const uint8_t* target)
+    {
+        byte(0xE9);
+        relative(target);
+    }
+
+    // jcc rel32
+    void jumpIf(uint8_t condition, const uint8_t* target)
+    {
+        byte(0x0F);
+        byte(static_cast<uint8_t>(0x80 | condition));
+        relative(target);
+    }
+
+    // op qword [rbp + offset], imm32
+    void aluContext64(uint8_t extension, int32_t offset, uint32_t value)
+    {
+        byte(0x48);
+        byte(0x81);
+        memory(extension, EBP, offset);
+        dword(value);
+    }
+
+    // mov rdi, [rbp + JitContext::memory]
+    void loadMemoryArgument()
+    {
+        byte(0x48);
+        byte(0x8B);
+        memory(EDI, EBP, CONTEXT_MEMORY);
+    }
+
+    void prologue()
+    {
+        byte(0x53);  // push rbx
+        byte(0x55);  // push rbp
+        byte(0x48);  // sub rsp, 8 (keeps calls 16-byte aligned)
+        byte(0x83);
+        byte(0xEC);
+        byte(0x08);
+        byte(0x48);  // mov rbx, rdi
+        byte(0x89);
+        byte(0xFB);
+        byte(0x48);  // mov rbp, rsi
+        byte(0x89);
+        byte(0xF5);
+    }
+
+    void epilogue()
+    {
+        byte(0x48);  // add rsp, 8
+        byte(0x83);
+        byte(0xC4);
+        byte(0x08);
+        byte(0x5D);  // pop rbp
+        byte(0x5B);  // pop rbx
+        byte(0xC3);  // ret
+    }
+
+  private:
+    static int32_t guestOffset(unsigned guest)
+    {
+        return static_cast<int32_t>(guest * sizeof(uint32_t));
+    }
+
+    void relative(const uint8_t* target)
+    {
+        dword(static_cast<uint32_t>(target - (position() + 4)));
+    }
+
+    std::vector<uint8_t>& m_out;
+    const uint8_t*        m_base;
+};
+
+void emitLoad(Emitter& e, const DecodedInstr& d, const void* helper)
+{
+    e.loadMemoryArgument();
+    e.loadGuest(ESI, d.rs);
+    e.aluImmediate(EXT_ADD, ESI, d.imm);
+    e.call(helper);
+    e.storeGuest(d.rd, EAX);
+}
+
+void emitStore(Emitter& e, const DecodedInstr& d, const void* helper)
+{
+    e.loadMemoryArgument();
+    e.loadGuest(ESI, d.rs);
+    e.aluImmediate(EXT_ADD, ESI, d.imm);
+    e.loadGuest(EDX, d.rt);
+    e.call(helper);
+}
+
+void emitDivide(Emitter& e, const DecodedInstr& d, const void* helper)
+{
+    e.byte(0x48);  // mov rdi, rbp
+    e.byte(0x89);
+    e.byte(0xEF);
+    e.loadGuest(ESI, d.rs);
+    e.loadGuest(EDX, d.rt);
+    e.call(helper);
+}
+
+void emitRegisterOp(Emitter& e, const DecodedInstr& d, uint8_t opcode)
+{
+    e.loadGuest(EAX, d.rs);
+    e.aluGuest(opcode, EAX, d.rt);
+    e.storeGuest(d.rd, EAX);
+}
+
+void emitImmediateOp(Emitter& e, const DecodedInstr& d, uint8_t extension)
+{
+    e.loadGuest(EAX, d.rs);
+    e.aluImmediate(extension, EAX, d.imm);
+    e.storeGuest(d.rd, EAX);
+}
+
+void emitSetOnCompare(Emitter& e, const DecodedInstr& d, uint8_t condition, bool immediate)
+{
+    e.loadGuest(EAX, d.rs);
+    e.zero(ECX);
+    if (immediate)
+    {
+        e.aluImmediate(EXT_CMP, EAX, d.imm);
+    }
+    else
+    {
+        e.aluGuest(OP_CMP, EAX, d.rt);
+    }
+    e.setConditionEcx(condition);
+    e.storeGuest(d.rd, ECX);
+}
+
+void emitShift(Emitter& e, const DecodedInstr& d, uint8_t extension, bool variable)
+{
+    e.loadGuest(EAX, d.rt);
+    if (variable)
+    {
+        // x86 masks the count to five bits, matching the & 0x1F of the interpreter
+        e.loadGuest(ECX, d.rs);
+        e.shiftByEcx(extension);
+    }
+    else
+    {
+        e.shiftImmediate(extension, static_cast<uint8_t>(d.imm));
+    }
+    e.storeGuest(d.rd, EAX);
+}
+
+// eax = condition ? target : fallthrough, with flags already set
+void emitSelectTarget(Emitter& e, uint8_t condition, uint32_t target, uint32_t fallthrough)
+{
+    e.moveImmediate(EAX, fallthrough);
+    e.moveImmediate(ECX, target);
+    e.conditionalMoveEcx(condition);
+}
+
+/**
+ * @brief Emit one non-final instruction of a block
+ * @return false if the operation has no translation
+ */
+bool emitBody(Emitter& e, const DecodedInstr& d)
+{
+    switch (d.op)
+    {
+    case DecodedOp::Nop:
+        return true;
+    case DecodedOp::Add:
+    case DecodedOp::Addu:
+        emitRegisterOp(e, d, OP_ADD);
+        return true;
+    case DecodedOp::Sub:
+    case DecodedOp::Subu:
+        emitRegisterOp(e, d, OP_SUB);
+        return true;
+    case DecodedOp::And:
+        emitRegisterOp(e, d, OP_AND);
+        return true;
+    case DecodedOp::Or:
+        emitRegisterOp(e, d, OP_OR);
+        return true;
+    case DecodedOp::Xor:
+        emitRegisterOp(e, d, OP_XOR);
+        return true;
+    case DecodedOp::Nor:
+        e.loadGuest(EAX, d.rs);
+        e.aluGuest(OP_OR, EAX, d.rt);
+        e.byte(0xF7);  // not eax
+        e.byte(0xD0);
+        e.storeGuest(d.rd, EAX);
+        return true;
+    case DecodedOp::Slt:
+        emitSetOnCompare(e, d, CC_L, false);
+        return true;
+    case DecodedOp::Sltu:
+        emitSetOnCompare(e, d, CC_B, false);
+        return true;
+    case DecodedOp::Sllv:
+        emitShift(e, d, SHIFT_SHL, true);
+        return true;
+    case DecodedOp::Srlv:
+        emitShift(e, d, SHIFT_SHR, true);
+        return true;
+    case DecodedOp::Srav:
+        emitShift(e, d, SHIFT_SAR, true);
+        return true;
+    case DecodedOp::Sll:
+        emitShift(e, d, SHIFT_SHL, false);
+        return true;
+    case DecodedOp::Srl:
+        emitShift(e, d, SHIFT_SHR, false);
+        return true;
+    case DecodedOp::Sra:
+        emitShift(e, d, SHIFT_SAR, false);
+        return true;
+    case DecodedOp::Mult:
+    case DecodedOp::Multu:
+        // imul/mul dword [rt]: edx:eax = eax * [rt]
+        e.loadGuest(EAX, d.rs);
+        e.byte(0xF7);
+        e.memory(d.op == DecodedOp::Mult ? 5 : 4, EBX,
+                 static_cast<int32_t>(d.rt * sizeof(uint32_t)));
+        e.storeContext(CONTEXT_HI, EDX);
+        e.storeContext(CONTEXT_LO, EAX);
+        return true;
+    case DecodedOp::Div:
+        emitDivide(e, d, reinterpret_cast<const void*>(&divide));
+        return true;
+    case DecodedOp::Divu:
+        emitDivide(e, d, reinterpret_cast<const void*>(&divideUnsigned));
+        return true;
+    case DecodedOp::Mfhi:
+        e.loadContext(EAX, CONTEXT_HI);
+        e.storeGuest(d.rd, EAX);
+        return true;
+    case DecodedOp::Mthi:
+        e.loadGuest(EAX, d.rs);
+        e.storeContext(CONTEXT_HI, EAX);
+        return true;
+    case DecodedOp::Mflo:
+        e.loadContext(EAX, CONTEXT_LO);
+        e.storeGuest(d.rd, EAX);
+        return true;
+    case DecodedOp::Mtlo:
+        e.loadGuest(EAX, d.rs);
+        e.storeContext(CONTEXT_LO, EAX);
+        return true;
+    case DecodedOp::Addi:
+    case DecodedOp::Addiu:
+        emitImmediateOp(e, d, EXT_ADD);
+        return true;
+    case DecodedOp::Slti:
+        emitSetOnCompare(e, d, CC_L, true);
+        return true;
+    case DecodedOp::Sltiu:
+        emitSetOnCompare(e, d, CC_B, true);
+        return true;
+    case DecodedOp::Andi:
+        emitImmediateOp(e, d, EXT_AND);
+        return true;
+    case DecodedOp::Ori:
+        emitImmediateOp(e, d, EXT_OR);
+        return true;
+    case DecodedOp::Xori:
+        emitImmediateOp(e, d, EXT_XOR);
+        return true;
+    case DecodedOp::Llo:
+    case DecodedOp::Lhi:
+        e.loadGuest(EAX, d.rs);
+        e.aluImmediate(EXT_AND, EAX, d.op == DecodedOp::Llo ? 0xFFFF0000u : 0x0000FFFFu);
+        e.aluImmediate(EXT_OR, EAX, d.imm);
+        e.storeGuest(d.rd, EAX);
+        return true;
+    case DecodedOp::La:
+        e.storeGuestImmediate(d.rd, d.imm);
+        return true;
+    case DecodedOp::Lw:
+        emitLoad(e, d, reinterpret_cast<const void*>(&loadWord));
+        return true;
+    case DecodedOp::Lb:
+        emitLoad(e, d, reinterpret_cast<const void*>(&loadByte));
+        return true;
+    case DecodedOp::Lbu:
+        emitLoad(e, d, reinterpret_cast<const void*>(&loadByteUnsigned));
+        return true;
+    case DecodedOp::Lh:
+        emitLoad(e, d, reinterpret_cast<const void*>(&loadHalfword));
+        return true;
+    case DecodedOp::Lhu:
+        emitLoad(e, d, reinterpret_cast<const void*>(&loadHalfwordUnsigned));
+        return true;
+    case DecodedOp::Sw:
+        emitStore(e, d, reinterpret_cast<const void*>(&storeWord));
+        return true;
+    case DecodedOp::Sb:
+        emitStore(e, d, reinterpret_cast<const void*>(&storeByte));
+        return true;
+    case DecodedOp::Sh:
+        emitStore(e, d, reinterpret_cast<const void*>(&storeHalfword));
+        return true;
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief Emit the final instruction of a block, leaving the next PC in eax
+ * @return false if the operation has no translation
+ */
+bool emitTerminator(Emitter& e, const DecodedInstr& d, uint32_t pc)
+{
+    const uint32_t fallthrough   = pc + 1;
+    const uint32_t returnAddress = (pc + 1) * 4;  // Byte address, as in the interpreter
+
+    switch (d.op)
+    {
+    case DecodedOp::Beq:
+    case DecodedOp::Bne:
+        e.loadGuest(EAX, d.rs);
+        e.aluGuest(OP_CMP, EAX, d.rt);
+        emitSelectTarget(e, d.op == DecodedOp::Beq ? CC_E : CC_NE, d.target, fallthrough);
+        return true;
+    case DecodedOp::Blez:
+    case DecodedOp::Bgtz:
+        // cmp dword [rs], 0
+        e.byte(0x83);
+        e.memory(EXT_CMP, EBX, static_cast<int32_t>(d.rs * sizeof(uint32_t)));
+        e.byte(0x00);
+        emitSelectTarget(e, d.op == DecodedOp::Blez ? CC_LE : CC_G, d.target, fallthrough);
+        return true;
+    case DecodedOp::J:
+        e.moveImmediate(EAX, d.target);
+        return true;
+    case DecodedOp::Jal:
+        e.storeGuestImmediate(31, returnAddress);
+        e.moveImmediate(EAX, d.target);
+        return true;
+    case DecodedOp::Jr:
+    case DecodedOp::Jalr:
+        // Read the target before the link write, which may reuse the register
+        e.loadGuest(EAX, d.rs);
+        if (d.op == DecodedOp::Jalr && d.rd != 0)
+        {
+            e.storeGuestImmediate(d.rd, returnAddress);
+        }
+        e.shiftImmediate(SHIFT_SHR, 2);
+        return true;
+    case DecodedOp::Fallback:
+        return false;
+    default:
+        if (!emitBody(e, d))
+        {
+            return false;
+        }
+        e.moveImmediate(EAX, fallthrough);
+        return true;
+    }
+}
+
+}  // namespace
+
+JitCompiler::~JitCompiler()
+{
+    if (m_buffer != nullptr)
+    {
+        munmap(m_buffer, CODE_CAPACITY);
+    }
+}
+
+JitBlockFn JitCompiler::lookup(int32_t index, const BasicBlock& block,
+                               const std::vector<DecodedInstr>& program)
+{
+    const size_t slot = static_cast<size_t>(index);
+    if (slot >= m_code.size())
+    {
+        m_code.resize(slot + 1, nullptr);
+        m_heat.resize(slot + 1, 0);
+    }
+
+    if (m_code[slot] != nullptr)
+    {
+        return m_code[slot];
+    }
+    if (m_heat[slot] == NEVER_TRANSLATE || ++m_heat[slot] < HOT_THRESHOLD)
+    {
+        return nullptr;
+    }
+
+    m_code[slot] = translate(block, program);
+    if (m_code[slot] == nullptr)
+    {
+        m_heat[slot] = NEVER_TRANSLATE;
+    }
+    return m_code[slot];
+}
+
+bool JitCompiler::allocateBuffer()
+{
+    void* buffer = mmap(nullptr, CODE_CAPACITY, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (buffer == MAP_FAILED)
+    {
+        return false;
+    }
+    m_buffer = static_cast<uint8_t*>(buffer);
+
+    // Shared stubs at the start of the buffer:
+    //   return:   leave the translated code with the next PC in eax
+    //   dispatch: jump to the translation of the block at eax, or return
+    std::vector<uint8_t> code;
+    Emitter              e(code, m_buffer);
+    m_return = e.position();
+    e.epilogue();
+
+    m_dispatch = e.position();
+    e.byte(0x3B);  // cmp eax, [rbp + entryCount]
+    e.memory(EAX, EBP, CONTEXT_ENTRY_COUNT);
+    e.jumpIf(CC_AE, m_return);
+    e.byte(0x48);  // mov rcx, [rbp + entries]
+    e.byte(0x8B);
+    e.memory(ECX, EBP, CONTEXT_ENTRIES);
+    e.byte(0x48);  // mov rcx, [rcx + rax * 8]
+    e.byte(0x8B);
+    e.byte(0x0C);
+    e.byte(0xC1);
+    e.byte(0x48);  // test rcx, rcx
+    e.byte(0x85);
+    e.byte(0xC9);
+    e.jumpIf(CC_E, m_return);
+    e.byte(0xFF);  // jmp rcx
+    e.byte(0xE1);
+
+    std::memcpy(m_buffer, code.data(), code.size());
+    m_stubSize = (code.size() + 15) & ~size_t{15};
+    m_used     = m_stubSize;
+    return mprotect(m_buffer, CODE_CAPACITY, PROT_READ | PROT_EXEC) == 0;
+}
+
+JitBlockFn JitCompiler::translate(const BasicBlock& block, const std::vector<DecodedInstr>& program)
+{
+    if (block.endsInFallback)
+    {
+        // Syscalls and traps need the Cpu; the interpreter runs these blocks
+        return nullptr;
+    }
+    if (m_buffer == nullptr && !allocateBuffer())
+    {
+        return nullptr;
+    }
+
+    uint8_t* const       function = m_buffer + m_used;
+    std::vector<uint8_t> code;
+    Emitter              e(code, function);
+    e.prologue();
+
+    // Chained entry: run the block only if it fits in the budget
+    const uint8_t* entry = e.position();
+    e.aluContext64(EXT_CMP, CONTEXT_BUDGET, block.length);
+    e.byte(0x7D);  // jge +10 (over the two instructions below)
+    e.byte(0x0A);
+    e.moveImmediate(EAX, block.start);
+    e.jump(m_return);
+    e.aluContext64(EXT_SUB, CONTEXT_BUDGET, block.length);
+
+    const uint32_t last = block.start + block.length - 1;
+    for (uint32_t pc = block.start; pc < last; ++pc)
+    {
+        if (!emitBody(e, program[pc]))
+        {
+            return nullptr;
+        }
+    }
+    if (!emitTerminator(e, program[last], last))
+    {
+        return nullptr;
+    }
+    e.jump(m_dispatch);
+
+    if (code.size() > CODE_CAPACITY - m_used)
+    {
+        return nullptr;  // Buffer full: the rest of the program stays interpreted
+    }
+
+    // The buffer is never writable and executable at the same time
+    if (mprotect(m_buffer, CODE_CAPACITY, PROT_READ | PROT_WRITE) != 0)
+    {
+        return nullptr;
+    }
+    std::memcpy(function, code.data(), code.size());
+    if (mprotect(m_buffer, CODE_CAPACITY, PROT_READ | PROT_EXEC) != 0)
+    {
+        return nullptr;
+    }
+    m_used += (code.size() + 15) & ~size_t{15};
+
+    if (m_entries.size() < program.size())
+    {
+        m_entries.resize(program.size(), nullptr);
+    }
+    m_entries[block.start] = entry;
+    ++m_compiled;
+    return reinterpret_cast<JitBlockFn>(function);
+}
+
+void JitCompiler::reset(size_t programSize)
+{
+    m_code.clear();
+    m_heat.clear();
+    m_entries.assign(programSize, nullptr);
+    m_used     = m_stubSize;  // The shared stubs stay
+    m_compiled = 0;
+}
+
+const void* const* JitCompiler::entryTable() const
+{
+    return m_entries.data();
+}
+
+size_t JitCompiler::compiledBlockCount() const
+{
+    return m_compiled;
+}
+
+#else  // !MIPSIM_JIT_AVAILABLE
+
+JitCompiler::~JitCompiler() = default;
+
+JitBlockFn JitCompiler::lookup(int32_t index, const BasicBlock& block,
+                               const std::vector<DecodedInstr>& program)
+{
+    (void)index;
+    (void)block;
+    (void)program;
+    return nullptr;
+}
+
+JitBlockFn JitCompiler::translate(const BasicBlock& block, const std::vector<DecodedInstr>& program)
+{
+    (void)block;
+    (void)program;
+    return nullptr;
+}
+
+void JitCompiler::reset(size_t programSize)
+{
+    (void)programSize;
+}
+
+const void* const* JitCompiler::entryTable() const
+{
+    return nullptr;
+}
+
+size_t JitCompiler::compiledBlockCount() const
+{
+    return 0;
+}
+
+#endif  // MIPSIM_JIT_AVAILABLE
+
+}  // namespace mips
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "BlockCache.h"
+#include "DecodedInstruction.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Build with -DMIPSIM_ENABLE_JIT=0 to leave the native code generator out entirely
+#ifndef MIPSIM_ENABLE_JIT
+#define MIPSIM_ENABLE_JIT 1
+#endif
+
+#if MIPSIM_ENABLE_JIT && defined(__x86_64__) && (defined(__linux__) || defined(__APPLE__))
+#define MIPSIM_JIT_AVAILABLE 1
+#else
+#define MIPSIM_JIT_AVAILABLE 0
+#endif
+
+namespace mips
+{
+
+class Memory;
+
+/**
+ * @brief Host-memory state shared by translated blocks besides the general registers
+ *
+ * HI/LO are copied in from the RegisterFile before translated code is entered
+ * and copied back when it returns; memory accesses go through the Memory object
+ * so they keep its bounds and alignment rules. Translated blocks chain to each
+ * other through the entry table while the instruction budget lasts.
+ */
+struct JitContext
+{
+    uint32_t           hi         = 0;
+    uint32_t           lo         = 0;
+    Memory*            memory     = nullptr;
+    int64_t            budget     = 0;        // Instructions left; each block subtracts its length
+    const void* const* entries    = nullptr;  // Chaining entry per instruction index, or nullptr
+    uint32_t           entryCount = 0;
+};
+
+using JitBlockFn = uint32_t (*)(uint32_t* regs, JitContext* context);
+
+/**
+ * @brief x86-64 translator for hot basic blocks of the pre-decoded program
+ *
+ * Blocks are interpreted until they have been entered HOT_THRESHOLD times and
+ * are then translated into an mmap'd code buffer. A translated block that exits
+ * to another translated block jumps straight into it; control only returns to
+ * the caller at an untranslated block, past the end of the program, or when
+ * the next block does not fit in the remaining budget. Blocks ending in an
+ * out-of-line record (syscall, trap) are never translated, nor is anything once
+ * the code buffer is full. On hosts other than x86-64 Linux/macOS, or with
+ * MIPSIM_ENABLE_JIT off, lookup() always returns nullptr.
+ */
+class JitCompiler
+{
+  public:
+    static constexpr bool     available     = MIPSIM_JIT_AVAILABLE != 0;
+    static constexpr uint32_t HOT_THRESHOLD = 16;
+    static constexpr size_t   CODE_CAPACITY = 4u << 20;  // 4MB of host code
+
+    JitCompiler() = default;
+    ~JitCompiler();
+
+    JitCompiler(const JitCompiler&)            = delete;
+    JitCompiler& operator=(const JitCompiler&) = delete;
+
+    /**
+     * @brief Count an entry into a block and return its translation once it is hot
+     * @param index Block index in the BlockCache
+     * @param block The block itself
+     * @param program Pre-decoded program the block refers to
+     * @return Native code for the block, or nullptr to interpret it
+     */
+    JitBlockFn lookup(int32_t index, const BasicBlock& block,
+                      const std::vector<DecodedInstr>& program);
+
+    /**
+     * @brief Drop every translation and size the entry table for a new program
+     * @param programSize Number of pre-decoded instructions (0 when unloading)
+     *
+     * The code buffer is kept and reused.
+     */
+    void reset(size_t programSize);
+
+    /**
+     * @brief Chaining entry table to pass in JitContext::entries
+     */
+    const void* const* entryTable() const;
+
+    /**
+     * @brief Number of blocks translated since the last reset
+     */
+    size_t compiledBlockCount() const;
+
+  private:
+    JitBlockFn translate(const BasicBlock& block, const std::vector<DecodedInstr>& program);
+    bool       allocateBuffer();
+
+    std::vector<JitBlockFn>  m_code;     // Translation per block index, or nullptr
+    std::vector<uint32_t>    m_heat;     // Entries per block index while interpreted
+    std::vector<const void*> m_entries;  // Chaining entry per instruction index, or nullptr
+    uint8_t*                 m_buffer   = nullptr;
+    const uint8_t*           m_return   = nullptr;  // Shared epilogue in m_buffer
+    const uint8_t*           m_dispatch = nullptr;  // Shared chaining stub in m_buffer
+    size_t                   m_stubSize = 0;        // Bytes of m_buffer taken by the stubs
+    size_t                   m_used     = 0;        // Bytes of m_buffer in use
+    size_t                   m_compiled = 0;
+};
+
+}  // namespace mips
@@ -0,0 +1,203 @@
+#include "Log.h"
+#include <iostream>
+#include <mutex>
+
+namespace mips
+{
+
+namespace
+{
+
+constexpr size_t kCategoryCount = static_cast<size_t>(LogCategory::Count);
+
+using LevelTable = std::array<LogLevel, kCategoryCount>;
+
+std::mutex    g_sinkMutex;
+std::ostream* g_sink = nullptr;
+
+bool parseCategory(const std::string& name, LogCategory& category)
+{
+    for (size_t i = 0; i < kCategoryCount; ++i)
+    {
+        if (name == Log::categoryName(static_cast<LogCategory>(i)))
+        {
+            category = static_cast<LogCategory>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parseLevel(const std::string& name, LogLevel& level)
+{
+    for (uint8_t i = 0; i <= static_cast<uint8_t>(LogLevel::Trace); ++i)
+    {
+        if (name == Log::levelName(static_cast<LogLevel>(i)))
+        {
+            level = static_cast<LogLevel>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Applies a --log spec on top of the given levels; leaves them untouched on error
+bool parseSpec(const std::string& spec, LevelTable& levels, std::string& error)
+{
+    LevelTable parsed = levels;
+    size_t     start  = 0;
+    while (start <= spec.size())
+    {
+        size_t      end   = spec.find(',', start);
+        std::string entry = spec.substr(start, end == std::string::npos ? end : end - start);
+        start             = end == std::string::npos ? spec.size() + 1 : end + 1;
+
+        if (entry.empty())
+        {
+            error = "empty log category in '" + spec + "'";
+            return false;
+        }
+
+        size_t      equals       = entry.find('=');
+        std::string categoryName = entry.substr(0, equals);
+        LogLevel    level        = LogLevel::Trace;
+        if (equals != std::string::npos && !parseLevel(entry.substr(equals + 1), level))
+        {
+            error = "unknown log level '" + entry.substr(equals + 1) + "'";
+            return false;
+        }
+
+        if (categoryName == "all")
+        {
+            parsed.fill(level);
+            continue;
+        }
+
+        LogCategory category;
+        if (!parseCategory(categoryName, category))
+        {
+            error = "unknown log category '" + categoryName + "'";
+            return false;
+        }
+        parsed[static_cast<size_t>(category)] = level;
+    }
+
+    levels = parsed;
+    return true;
+}
+
+LevelTable currentLevels()
+{
+    LevelTable levels;
+    for (size_t i = 0; i < kCategoryCount; ++i)
+    {
+        levels[i] = Log::getLevel(static_cast<LogCategory>(i));
+    }
+    return levels;
+}
+
+}  // namespace
+
+void Log::setLevel(LogCategory category, LogLevel level)
+{
+    s_levels[static_cast<size_t>(category)].store(static_cast<uint8_t>(level),
+                                                  std::memory_order_relaxed);
+}
+
+void Log::setLevel(LogLevel level)
+{
+    for (size_t i = 0; i < kCategoryCount; ++i)
+    {
+        setLevel(static_cast<LogCategory>(i), level);
+    }
+}
+
+LogLevel Log::getLevel(LogCategory category)
+{
+    return static_cast<LogLevel>(
+        s_levels[static_cast<size_t>(category)].load(std::memory_order_relaxed));
+}
+
+bool Log::configure(const std::string& spec, std::string& error)
+{
+    LevelTable levels = currentLevels();
+    if (!parseSpec(spec, levels, error))
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < kCategoryCount; ++i)
+    {
+        setLevel(static_cast<LogCategory>(i), levels[i]);
+    }
+    return true;
+}
+
+bool Log::validate(const std::string& spec, std::string& error)
+{
+    LevelTable levels = currentLevels();
+    return parseSpec(spec, levels, error);
+}
+
+void Log::setSink(std::ostream* sink)
+{
+    std::lock_guard<std::mutex> lock(g_sinkMutex);
+    g_sink = sink;
+}
+
+void Log::reset()
+{
+    setLevel(static_cast<LogLevel>(kDefaultLevel));
+    setSink(nullptr);
+}
+
+void Log::write(LogCategory category, LogLevel level, const std::string& message)
+{
+    std::lock_guard<std::mutex> lock(g_sinkMutex);
+    std::ostream&               out = g_sink ? *g_sink : std::clog;
+    out << '[' << levelName(level) << "] " << categoryName(category) << ": " << message << '\n';
+}
+
+const char* Log::categoryName(LogCategory category)
+{
+    switch (category)
+    {
+    case LogCategory::Cpu:
+        return "cpu";
+    case LogCategory::Branch:
+        return "branch";
+    case LogCategory::Memory:
+        return "memory";
+    case LogCategory::Register:
+        return "register";
+    case LogCategory::Syscall:
+        return "syscall";
+    case LogCategory::Pipeline:
+        return "pipeline";
+    default:
+        return "unknown";
+    }
+}
+
+const char* Log::levelName(LogLevel level)
+{
+    switch (level)
+    {
+    case LogLevel::Off:
+        return "off";
+    case LogLevel::Error:
+        return "error";
+    case LogLevel::Warn:
+        return "warn";
+    case LogLevel::Info:
+        return "info";
+    case LogLevel::Debug:
+        return "debug";
+    case LogLevel::Trace:
+        return "trace";
+    default:
+        return "unknown";
+    }
+}
+
+}  // namespace mips
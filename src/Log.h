@@ -0,0 +1,131 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+#include <sstream>
+#include <string>
+
+// Build with -DMIPSIM_ENABLE_LOGGING=0 to compile every MIPS_LOG statement out
+#ifndef MIPSIM_ENABLE_LOGGING
+#define MIPSIM_ENABLE_LOGGING 1
+#endif
+
+namespace mips
+{
+
+/**
+ * @brief Subsystems that can be traced independently
+ */
+enum class LogCategory : uint8_t
+{
+    Cpu,       // Program counter updates and per-instruction execution
+    Branch,    // Branches, jumps and label lookups
+    Memory,    // Memory accesses
+    Register,  // Register file writes
+    Syscall,   // Console output produced by syscalls and traps
+    Pipeline,  // Pipeline stage activity
+    Count
+};
+
+/**
+ * @brief Message severity; a category prints messages at or below its configured level
+ */
+enum class LogLevel : uint8_t
+{
+    Off,
+    Error,
+    Warn,
+    Info,
+    Debug,
+    Trace
+};
+
+/**
+ * @brief Process-wide trace/log channel with per-category runtime levels
+ *
+ * Statements are written with the MIPS_LOG macro, which formats its message only
+ * when the category is enabled and expands to nothing when the build disables
+ * logging. Output is buffered (std::clog by default) and serialised across threads.
+ */
+class Log
+{
+  public:
+    static constexpr bool compiledIn = MIPSIM_ENABLE_LOGGING != 0;
+
+    /**
+     * @brief Check whether a message would be written (one relaxed load)
+     */
+    static bool isEnabled(LogCategory category, LogLevel level)
+    {
+        return static_cast<uint8_t>(level) <=
+               s_levels[static_cast<size_t>(category)].load(std::memory_order_relaxed);
+    }
+
+    static void     setLevel(LogCategory category, LogLevel level);
+    static void     setLevel(LogLevel level);  // All categories
+    static LogLevel getLevel(LogCategory category);
+
+    /**
+     * @brief Apply a comma separated spec such as "cpu,memory=debug" or "all=trace"
+     *
+     * A category without "=level" is enabled at Trace. Categories not named keep
+     * their current level.
+     *
+     * @param[out] error Description of the first invalid entry
+     * @return false if the spec is malformed (no levels are changed)
+     */
+    static bool configure(const std::string& spec, std::string& error);
+
+    /**
+     * @brief Check a spec for configure() without changing any level
+     */
+    static bool validate(const std::string& spec, std::string& error);
+
+    /**
+     * @brief Redirect output; nullptr restores std::clog
+     */
+    static void setSink(std::ostream* sink);
+
+    /**
+     * @brief Restore the default levels (Warn everywhere) and sink
+     */
+    static void reset();
+
+    static void write(LogCategory category, LogLevel level, const std::string& message);
+
+    static const char* categoryName(LogCategory category);
+    static const char* levelName(LogLevel level);
+
+  private:
+    static constexpr uint8_t kDefaultLevel = static_cast<uint8_t>(LogLevel::Warn);
+
+    inline static std::array<std::atomic<uint8_t>, static_cast<size_t>(LogCategory::Count)>
+        s_levels = {kDefaultLevel, kDefaultLevel, kDefaultLevel,
+                    kDefaultLevel, kDefaultLevel, kDefaultLevel};
+};
+
+static_assert(static_cast<size_t>(LogCategory::Count) == 6,
+              "Update the Log::s_levels initialiser when adding a category");
+
+}  // namespace mips
+
+#if MIPSIM_ENABLE_LOGGING
+#define MIPS_LOG(category, level, message)                                                         \
+    do                                                                                             \
+    {                                                                                              \
+        if (::mips::Log::isEnabled(::mips::LogCategory::category, ::mips::LogLevel::level))        \
+        {                                                                                          \
+            std::ostringstream mipsLogStream_;                                                     \
+            mipsLogStream_ << message;                                                             \
+            ::mips::Log::write(::mips::LogCategory::category, ::mips::LogLevel::level,             \
+                               mipsLogStream_.str());                                              \
+        }                                                                                          \
+    } while (0)
+#else
+#define MIPS_LOG(category, level, message)                                                         \
+    do                                                                                             \
+    {                                                                                              \
+    } while (0)
+#endif
@@ -0,0 +1,124 @@
+#include "MappedFile.h"
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#if MIPSIM_MMAP_AVAILABLE
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace mips
+{
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+bool MappedFile::open(const std::string& path, std::string& error)
+{
+    close();
+
+#if MIPSIM_MMAP_AVAILABLE
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        error = "cannot open " + path + ": " + std::strerror(errno);
+        return false;
+    }
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0)
+    {
+        error = "cannot stat " + path + ": " + std::strerror(errno);
+        ::close(fd);
+        return false;
+    }
+
+    if (S_ISREG(info.st_mode) && info.st_size > 0)
+    {
+        const size_t size    = static_cast<size_t>(info.st_size);
+        void*        mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping != MAP_FAILED)
+        {
+            ::close(fd);  // The mapping stays valid without the descriptor
+            m_data   = static_cast<const char*>(mapping);
+            m_size   = size;
+            m_mapped = true;
+            return true;
+        }
+        m_buffer.reserve(size);
+    }
+
+    // Pipes, FIFOs and /dev/stdin have no size to map, and files like those in /proc
+    // report none: read the descriptor to its end, as it is not rewound by reopening
+    char    chunk[64 * 1024];
+    ssize_t count;
+    while ((count = ::read(fd, chunk, sizeof(chunk))) != 0)
+    {
+        if (count < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (count < 0)
+        {
+            error = "cannot read " + path + ": " + std::strerror(errno);
+            ::close(fd);
+            m_buffer.clear();
+            return false;
+        }
+        m_buffer.insert(m_buffer.end(), chunk, chunk + count);
+    }
+    ::close(fd);
+    m_data = m_buffer.data();
+    m_size = m_buffer.size();
+    return true;
+#else
+    // No mmap on this platform: read it instead
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        error = "cannot open " + path;
+        return false;
+    }
+    m_buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    m_data = m_buffer.data();
+    m_size = m_buffer.size();
+    return true;
+#endif
+}
+
+const char* MappedFile::data() const
+{
+    return m_data;
+}
+
+size_t MappedFile::size() const
+{
+    return m_size;
+}
+
+std::string_view MappedFile::view() const
+{
+    return std::string_view(m_data, m_size);
+}
+
+void MappedFile::close()
+{
+#if MIPSIM_MMAP_AVAILABLE
+    if (m_mapped)
+    {
+        ::munmap(const_cast<char*>(m_data), m_size);
+    }
+#endif
+    m_data   = nullptr;
+    m_size   = 0;
+    m_mapped = false;
+    m_buffer.clear();
+}
+
+}  // namespace mips
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define MIPSIM_MMAP_AVAILABLE 1
+#else
+#define MIPSIM_MMAP_AVAILABLE 0
+#endif
+
+namespace mips
+{
+
+/**
+ * @brief Read-only view of a whole file
+ *
+ * A regular file is memory-mapped where the platform supports it, so opening
+ * costs no copy and pages are read on first touch. Anything else (a pipe, a
+ * FIFO, /dev/stdin, a /proc file that reports no size) and every file on other
+ * platforms is read into a buffer. The data pointer is page-aligned when mapped.
+ */
+class MappedFile
+{
+  public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&)            = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief Map a file, replacing any file mapped before
+     * @param error Set to a description of the problem on failure
+     * @return false if the file cannot be opened or read
+     */
+    bool open(const std::string& path, std::string& error);
+
+    const char*      data() const;
+    size_t           size() const;
+    std::string_view view() const;  // The contents, e.g. assembly source to lex in place
+
+  private:
+    void close();
+
+    const char*       m_data   = nullptr;
+    size_t            m_size   = 0;
+    bool              m_mapped = false;
+    std::vector<char> m_buffer;  // Contents when the file was not mapped
+};
+
+}  // namespace mips
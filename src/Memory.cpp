@@ -1,104 +1,268 @@
 #include "Memory.h"
+#include "Log.h"
+#include <algorithm>
 #include <cstring>
 #include <iomanip>
-#include <iostream>
+#include <utility>
 
 namespace mips
 {
 
-Memory::Memory() : m_data(MEMORY_SIZE, 0) {}
+namespace
+{
 
-uint32_t Memory::readWord(uint32_t address) const
+constexpr uint32_t TABLE_MASK  = (1u << Memory::TABLE_BITS) - 1;
+constexpr uint32_t OFFSET_MASK = Memory::PAGE_SIZE - 1;
+
+inline uint32_t directoryIndex(uint32_t address)
 {
-    if (!isValidAddress(address))
-    {
-        return 0;  // Invalid access returns 0
-    }
+    return address >> (Memory::PAGE_BITS + Memory::TABLE_BITS);
+}
 
-    uint32_t value;
-    std::memcpy(&value, &m_data[address], sizeof(uint32_t));
-    return value;
+inline uint32_t tableIndex(uint32_t address)
+{
+    return (address >> Memory::PAGE_BITS) & TABLE_MASK;
 }
 
-void Memory::writeWord(uint32_t address, uint32_t value)
+}  // namespace
+
+Memory::Memory() = default;
+
+Memory::~Memory() = default;
+
+Memory::Memory(const Memory& other) = default;
+
+Memory& Memory::operator=(const Memory& other) = default;
+
+Memory::Memory(Memory&& other) noexcept
+    : m_directory(std::move(other.m_directory)),
+      m_dirtyPages(std::move(other.m_dirtyPages)),
+      m_pageCount(std::exchange(other.m_pageCount, 0))
 {
-    if (!isValidAddress(address))
+    other.m_dirtyPages.clear();
+}
+
+Memory& Memory::operator=(Memory&& other) noexcept
+{
+    if (this != &other)
     {
-        return;  // Invalid access ignored
+        m_directory  = std::move(other.m_directory);
+        m_dirtyPages = std::move(other.m_dirtyPages);
+        m_pageCount  = std::exchange(other.m_pageCount, 0);
+        other.m_dirtyPages.clear();
     }
+    return *this;
+}
 
-    // Targeted debug: watch writes near the string/data area used in tests
-    if (address >= 760 && address <= 780)
+const uint8_t* Memory::findPage(uint32_t address) const
+{
+    const PageTable* table = m_directory[directoryIndex(address)].get();
+    if (table == nullptr)
     {
-        std::cerr << "DEBUG: writeWord addr=" << address << " value=0x" << std::hex << value
-                  << std::dec << std::endl;
+        return nullptr;
     }
+    const Page* page = table->pages[tableIndex(address)].get();
+    return page != nullptr ? page->data() : nullptr;
+}
 
-    std::memcpy(&m_data[address], &value, sizeof(uint32_t));
+uint8_t* Memory::touchPage(uint32_t address)
+{
+    const std::shared_ptr<PageTable>& table = m_directory[directoryIndex(address)];
+    if (table && table.use_count() == 1 && table->dirty[tableIndex(address)])
+    {
+        const std::shared_ptr<Page>& page = table->pages[tableIndex(address)];
+        if (page.use_count() == 1)
+        {
+            return page->data();  // Already written and owned outright
+        }
+    }
+    return ownPage(address);
 }
 
-uint8_t Memory::readByte(uint32_t address) const
+Memory::PageTable& Memory::ownTable(uint32_t address)
 {
-    if (address >= MEMORY_SIZE)
+    std::shared_ptr<PageTable>& table = m_directory[directoryIndex(address)];
+    if (!table)
     {
-        return 0;  // Invalid access returns 0
+        table = std::make_shared<PageTable>();
+    }
+    else if (table.use_count() > 1)
+    {
+        table = std::make_shared<PageTable>(*table);  // Copies page pointers, not pages
     }
+    return *table;
+}
 
-    return m_data[address];
+uint8_t* Memory::ownPage(uint32_t address)
+{
+    PageTable&             table = ownTable(address);
+    std::shared_ptr<Page>& page  = table.pages[tableIndex(address)];
+    if (!page)
+    {
+        page = std::make_shared<Page>();  // Value-initialised: zero-filled
+        ++m_pageCount;
+        MIPS_LOG(Memory, Debug, "page alloc addr=0x" << std::hex << (address & ~OFFSET_MASK));
+    }
+    else if (page.use_count() > 1)
+    {
+        page = std::make_shared<Page>(*page);
+        MIPS_LOG(Memory, Debug, "page copy addr=0x" << std::hex << (address & ~OFFSET_MASK));
+    }
+    if (!table.dirty[tableIndex(address)])
+    {
+        table.dirty[tableIndex(address)] = true;
+        m_dirtyPages.push_back(address >> PAGE_BITS);
+    }
+    return page->data();
 }
 
-void Memory::writeByte(uint32_t address, uint8_t value)
+uint32_t Memory::readWord(uint32_t address) const
 {
-    if (address >= MEMORY_SIZE)
+    if (!isValidAddress(address))
     {
-        return;  // Invalid access ignored
+        return 0;  // Invalid access returns 0
     }
 
-    if (address >= 760 && address <= 780)
+    const uint8_t* page = findPage(address);
+    if (page == nullptr)
     {
-        std::cerr << "DEBUG: writeByte addr=" << address << " byte=" << static_cast<uint32_t>(value)
-                  << std::endl;
+        return 0;
     }
 
-    m_data[address] = value;
+    uint32_t value;
+    std::memcpy(&value, page + (address & OFFSET_MASK), sizeof(uint32_t));
+    return value;
 }
 
-uint16_t Memory::readHalfword(uint32_t address) const
+void Memory::writeWord(uint32_t address, uint32_t value)
 {
-    // Allow unaligned halfword accesses (assemble from bytes, little-endian)
-    if (address + sizeof(uint16_t) > MEMORY_SIZE)
+    if (!isValidAddress(address))
     {
-        return 0;  // Invalid access returns 0
+        return;  // Invalid access ignored
     }
 
-    uint16_t low  = static_cast<uint16_t>(m_data[address]);
-    uint16_t high = static_cast<uint16_t>(m_data[address + 1]);
+    MIPS_LOG(Memory, Trace, "writeWord addr=" << address << " value=0x" << std::hex << value);
+
+    // Aligned words never straddle a page
+    std::memcpy(touchPage(address) + (address & OFFSET_MASK), &value, sizeof(uint32_t));
+}
+
+uint8_t Memory::readByte(uint32_t address) const
+{
+    const uint8_t* page = findPage(address);
+    return page != nullptr ? page[address & OFFSET_MASK] : 0;
+}
+
+void Memory::writeByte(uint32_t address, uint8_t value)
+{
+    MIPS_LOG(Memory, Trace,
+             "writeByte addr=" << address << " byte=" << static_cast<uint32_t>(value));
+
+    touchPage(address)[address & OFFSET_MASK] = value;
+}
+
+uint16_t Memory::readHalfword(uint32_t address) const
+{
+    // Allow unaligned halfword accesses (assemble from bytes, little-endian);
+    // the two bytes may sit on different pages
+    uint16_t low  = static_cast<uint16_t>(readByte(address));
+    uint16_t high = static_cast<uint16_t>(readByte(address + 1));
     return static_cast<uint16_t>((high << 8) | low);
 }
 
 void Memory::writeHalfword(uint32_t address, uint16_t value)
 {
     // Allow unaligned halfword writes by splitting into two bytes (little-endian)
-    if (address + sizeof(uint16_t) > MEMORY_SIZE)
+    touchPage(address)[address & OFFSET_MASK] = static_cast<uint8_t>(value & 0xFF);
+    touchPage(address + 1)[(address + 1) & OFFSET_MASK] =
+        static_cast<uint8_t>((value >> 8) & 0xFF);
+}
+
+void Memory::writePage(uint32_t address, const uint8_t* data)
+{
+    std::memcpy(touchPage(address), data, PAGE_SIZE);
+}
+
+void Memory::writeBlock(uint32_t address, const uint8_t* data, size_t size)
+{
+    while (size > 0)
     {
-        return;  // Invalid access ignored
+        const uint32_t offset = address & OFFSET_MASK;
+        const size_t   chunk  = std::min<size_t>(size, PAGE_SIZE - offset);
+        std::memcpy(touchPage(address) + offset, data, chunk);
+        address += static_cast<uint32_t>(chunk);
+        data += chunk;
+        size -= chunk;
     }
-
-    uint8_t low         = static_cast<uint8_t>(value & 0xFF);
-    uint8_t high        = static_cast<uint8_t>((value >> 8) & 0xFF);
-    m_data[address]     = low;
-    m_data[address + 1] = high;
 }
 
 void Memory::reset()
 {
-    std::fill(m_data.begin(), m_data.end(), static_cast<uint8_t>(0));
+    // Clean pages are all zeros already, so only the dirty ones need clearing
+    for (uint32_t pageNumber : m_dirtyPages)
+    {
+        uint32_t               address = pageNumber << PAGE_BITS;
+        PageTable&             table   = ownTable(address);
+        std::shared_ptr<Page>& page    = table.pages[tableIndex(address)];
+        if (page.use_count() == 1)
+        {
+            page->fill(0);  // Keep it mapped for reuse
+        }
+        else
+        {
+            page.reset();  // Still in use by a copy: just drop our reference
+            --m_pageCount;
+        }
+        table.dirty[tableIndex(address)] = false;
+    }
+    m_dirtyPages.clear();
+}
+
+void Memory::release()
+{
+    for (std::shared_ptr<PageTable>& table : m_directory)
+    {
+        table.reset();
+    }
+    m_dirtyPages.clear();
+    m_pageCount = 0;
 }
 
 bool Memory::isValidAddress(uint32_t address) const
 {
-    return (address + sizeof(uint32_t) <= MEMORY_SIZE) &&
-           (address % sizeof(uint32_t) == 0);  // Word-aligned
+    return address % sizeof(uint32_t) == 0;  // Word-aligned
+}
+
+size_t Memory::allocatedPageCount() const
+{
+    return m_pageCount;
+}
+
+Memory::DirtyPageRange Memory::dirtyPages() const
+{
+    return DirtyPageRange(this);
+}
+
+size_t Memory::dirtyPageCount() const
+{
+    return m_dirtyPages.size();
+}
+
+Memory::Segment Memory::segmentOf(uint32_t address)
+{
+    if (address >= KERNEL_BASE)
+    {
+        return Segment::Kernel;
+    }
+    if (address > STACK_TOP - STACK_LIMIT)
+    {
+        return Segment::Stack;
+    }
+    if (address >= HEAP_BASE)
+    {
+        return Segment::Heap;
+    }
+    return Segment::Text;
 }
 
 }  // namespace mips
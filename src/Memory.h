@@ -1,6 +1,11 @@
 #pragma once
 
+#include <array>
+#include <bitset>
+#include <cstddef>
 #include <cstdint>
+#include <iterator>
+#include <memory>
 #include <vector>
 
 namespace mips
@@ -8,13 +13,144 @@ namespace mips
 
 /**
  * @brief Memory subsystem for data and instruction storage
+ *
+ * Sparse 32-bit address space: 4KB pages are allocated on first write through a
+ * two-level page table (1024 directory entries of 1024 pages each). Reads of
+ * pages that were never written return 0 without allocating, so constructing
+ * and resetting a Memory cost nothing beyond the pages a program touches.
+ *
+ * Every page written since the last reset() is recorded as dirty. reset() zeroes
+ * only those pages and keeps them mapped for reuse, so its cost is proportional to
+ * what the previous program touched. dirtyPages() walks the same set, letting
+ * callers diff or serialise just the modified state.
+ *
+ * Copying a Memory is cheap: the copy shares every page table and page with the
+ * original, and whichever side writes first copies the affected table and page
+ * (copy-on-write at page granularity). Distinct Memory objects sharing pages may
+ * be used from different threads; a single Memory may not.
+ *
+ * Word accesses must be word-aligned (misaligned reads return 0, misaligned
+ * writes are ignored); byte and halfword accesses may use any address.
  */
 class Memory
 {
   public:
-    static constexpr uint32_t MEMORY_SIZE = 0x100000;  // 1MB
+    static constexpr uint32_t PAGE_BITS      = 12;
+    static constexpr uint32_t PAGE_SIZE      = 1u << PAGE_BITS;  // 4KB
+    static constexpr uint32_t TABLE_BITS     = 10;  // log2 of pages per second-level table
+    static constexpr uint32_t DIRECTORY_SIZE = 1u << (32 - PAGE_BITS - TABLE_BITS);
+
+    // Segment layout. Text and static data keep the assembler's placement:
+    // instruction i lives at byte i * 4 and data directives follow the code. The
+    // heap (grown by sbrk, syscall 9) and the stack use the standard MIPS addresses.
+    static constexpr uint32_t TEXT_BASE   = 0x00000000;
+    static constexpr uint32_t HEAP_BASE   = 0x10040000;
+    static constexpr uint32_t STACK_TOP   = 0x7FFFEFFC;  // Conventional initial $sp
+    static constexpr uint32_t STACK_LIMIT = 8u << 20;    // Stack segment size below STACK_TOP
+    static constexpr uint32_t KERNEL_BASE = 0x80000000;
+
+    enum class Segment
+    {
+        Text,   // Code and static data, below HEAP_BASE
+        Heap,   // HEAP_BASE up to the stack
+        Stack,  // The 8MB below STACK_TOP
+        Kernel  // KERNEL_BASE and above
+    };
+
+    /**
+     * @brief A page written since the last reset()
+     */
+    struct DirtyPage
+    {
+        uint32_t       address;  // Page-aligned guest address
+        const uint8_t* data;     // PAGE_SIZE bytes of page contents
+    };
+
+    /**
+     * @brief Forward iterator over the dirty pages, in the order they were first written
+     */
+    class DirtyPageIterator
+    {
+      public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = DirtyPage;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = const DirtyPage*;
+        using reference         = DirtyPage;
+
+        DirtyPageIterator(const Memory* memory, std::vector<uint32_t>::const_iterator it)
+            : m_memory(memory), m_it(it)
+        {
+        }
+
+        DirtyPage operator*() const
+        {
+            uint32_t address = *m_it << PAGE_BITS;
+            return DirtyPage{address, m_memory->findPage(address)};
+        }
+
+        DirtyPageIterator& operator++()
+        {
+            ++m_it;
+            return *this;
+        }
+
+        DirtyPageIterator operator++(int)
+        {
+            DirtyPageIterator previous = *this;
+            ++m_it;
+            return previous;
+        }
+
+        bool operator==(const DirtyPageIterator& other) const
+        {
+            return m_it == other.m_it;
+        }
+
+        bool operator!=(const DirtyPageIterator& other) const
+        {
+            return m_it != other.m_it;
+        }
+
+      private:
+        const Memory*                         m_memory;
+        std::vector<uint32_t>::const_iterator m_it;
+    };
+
+    /**
+     * @brief Range over the dirty pages, usable in a range-based for loop
+     */
+    class DirtyPageRange
+    {
+      public:
+        explicit DirtyPageRange(const Memory* memory) : m_memory(memory) {}
+
+        DirtyPageIterator begin() const
+        {
+            return DirtyPageIterator(m_memory, m_memory->m_dirtyPages.begin());
+        }
+
+        DirtyPageIterator end() const
+        {
+            return DirtyPageIterator(m_memory, m_memory->m_dirtyPages.end());
+        }
+
+        size_t size() const
+        {
+            return m_memory->m_dirtyPages.size();
+        }
+
+      private:
+        const Memory* m_memory;
+    };
 
     Memory();
+    ~Memory();
+
+    Memory(const Memory& other);                 // Shares pages copy-on-write
+    Memory& operator=(const Memory& other);      // Shares pages copy-on-write
+    Memory(Memory&& other) noexcept;             // Takes the pages, leaving other empty
+    Memory& operator=(Memory&& other) noexcept;  // Takes the pages, leaving other empty
 
     /**
      * @brief Read word from memory
@@ -46,30 +182,91 @@ class Memory
 
     /**
      * @brief Read halfword from memory
-     * @param address Memory address (must be halfword-aligned)
+     * @param address Memory address (may be unaligned)
      * @return Halfword value
      */
     uint16_t readHalfword(uint32_t address) const;
 
     /**
      * @brief Write halfword to memory
-     * @param address Memory address (must be halfword-aligned)
+     * @param address Memory address (may be unaligned)
      * @param value Halfword value to write
      */
     void writeHalfword(uint32_t address, uint16_t value);
 
+    /**
+     * @brief Overwrite a whole page, e.g. when loading a checkpoint
+     * @param address Page-aligned address
+     * @param data PAGE_SIZE bytes
+     */
+    void writePage(uint32_t address, const uint8_t* data);
+
+    /**
+     * @brief Copy a block of bytes into memory, a page at a time
+     * @param address Start address (any byte address)
+     * @param data Bytes to copy
+     * @param size Number of bytes
+     */
+    void writeBlock(uint32_t address, const uint8_t* data, size_t size);
+
     /**
      * @brief Reset memory to all zeros
+     *
+     * Only dirty pages are cleared; they stay mapped so the next program reuses them.
      */
     void reset();
 
     /**
-     * @brief Check if address is valid and aligned
+     * @brief Reset memory to all zeros and return every page to the host
+     */
+    void release();
+
+    /**
+     * @brief Check if address is valid and aligned for a word access
      */
     bool isValidAddress(uint32_t address) const;
 
+    /**
+     * @brief Number of 4KB pages currently backed by host memory
+     */
+    size_t allocatedPageCount() const;
+
+    /**
+     * @brief Pages written since the last reset()
+     */
+    DirtyPageRange dirtyPages() const;
+
+    /**
+     * @brief Number of pages written since the last reset()
+     */
+    size_t dirtyPageCount() const;
+
+    /**
+     * @brief Segment an address falls in
+     */
+    static Segment segmentOf(uint32_t address);
+
   private:
-    std::vector<uint8_t> m_data;
+    static constexpr uint32_t TABLE_SIZE = 1u << TABLE_BITS;
+
+    using Page = std::array<uint8_t, PAGE_SIZE>;
+
+    // Tables and pages are shared between copies; use_count() > 1 means a write
+    // has to copy first
+    struct PageTable
+    {
+        std::array<std::shared_ptr<Page>, TABLE_SIZE> pages;
+        std::bitset<TABLE_SIZE>                       dirty;  // Written since the last reset()
+    };
+
+    const uint8_t* findPage(uint32_t address) const;  // nullptr if never written
+    uint8_t*       touchPage(uint32_t address);       // Fast path, falls back to ownPage()
+    uint8_t*       ownPage(uint32_t address);         // Allocates or unshares, marks dirty
+    PageTable&     ownTable(uint32_t address);        // Allocates or unshares
+
+    std::array<std::shared_ptr<PageTable>, DIRECTORY_SIZE> m_directory;
+    std::vector<uint32_t> m_dirtyPages;  // Page numbers (address >> PAGE_BITS)
+    size_t                m_pageCount = 0;
 };
 
 }  // namespace mips
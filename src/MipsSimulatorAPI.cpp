@@ -1,26 +1,99 @@
 #include "MipsSimulatorAPI.h"
+#include "Checkpoint.h"
 #include "Cpu.h"
+#include "Instruction.h"
+#include "InstructionDecoder.h"
+#include "MappedFile.h"
 #include "Memory.h"
+#include "ObjectFile.h"
+#include "ProgramCache.h"
+#include "ProgramImage.h"
 #include "RegisterFile.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
 #include <fstream>
-#include <iostream>
+#include <random>
 #include <sstream>
+#include <unistd.h>
 
 namespace mips
 {
 
-MipsSimulatorAPI::MipsSimulatorAPI() : m_cpu(std::make_unique<Cpu>()), m_initialized(true)
+namespace
+{
+
+// Creates @p path (which must not exist) holding @p bytes, flushed to disk.
+// On failure the file, if it was created, is removed again.
+bool writeSynced(const std::string& path, std::string_view bytes, std::string& error)
+{
+    const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        error = "Could not create checkpoint " + path + ": " + std::strerror(errno);
+        return false;
+    }
+
+    const char* failed = nullptr;
+    int         code   = 0;
+    while (!bytes.empty() && failed == nullptr)
+    {
+        const ssize_t written = ::write(fd, bytes.data(), bytes.size());
+        if (written > 0)
+        {
+            bytes.remove_prefix(static_cast<size_t>(written));
+        }
+        else if (written == 0 || errno != EINTR)
+        {
+            failed = "write";
+            code   = written == 0 ? EIO : errno;
+        }
+    }
+    if (failed == nullptr && ::fsync(fd) != 0)
+    {
+        failed = "sync";
+        code   = errno;
+    }
+    if (::close(fd) != 0 && failed == nullptr)
+    {
+        failed = "close";
+        code   = errno;
+    }
+    if (failed != nullptr)
+    {
+        error = std::string("Failed to ") + failed + " checkpoint " + path + ": " +
+                std::strerror(code);
+        ::unlink(path.c_str());
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+MipsSimulatorAPI::MipsSimulatorAPI()
+    : m_cpu(std::make_unique<Cpu>()), m_initialized(true)
+{
+    clearError();
+}
+
+MipsSimulatorAPI::MipsSimulatorAPI(std::unique_ptr<Cpu> cpu)
+    : m_cpu(std::move(cpu)), m_initialized(true)
 {
     clearError();
 }
 
 MipsSimulatorAPI::~MipsSimulatorAPI() = default;
 
-bool MipsSimulatorAPI::loadProgram(const std::string& assembly)
+bool MipsSimulatorAPI::loadProgram(std::string_view assembly)
 {
     try
     {
-        m_cpu->loadProgramFromString(assembly);
+        std::vector<size_t> skippedLines;
+        m_cpu->loadProgramFromString(assembly, &skippedLines);
+        m_programFingerprint = Checkpoint::fingerprint(assembly);
+        m_lastWarning        = Assembler::describeSkippedLines(skippedLines);
         clearError();
         return true;
     }
@@ -36,22 +109,46 @@ bool MipsSimulatorAPI::loadProgram(const std::string& assembly)
     }
 }
 
-bool MipsSimulatorAPI::loadProgramFromFile(const std::string& filename)
+bool MipsSimulatorAPI::loadCachedProgram(std::string_view assembly)
 {
+    if (!m_programCache)
+    {
+        return loadProgram(assembly);
+    }
     try
     {
-        std::ifstream file(filename);
-        if (!file.is_open())
+        std::vector<size_t> skippedLines;
+        if (!loadProgramImage(m_programCache->load(assembly, &skippedLines)))
         {
-            setError("Could not open file: " + filename);
             return false;
         }
+        m_lastWarning = Assembler::describeSkippedLines(skippedLines);
+        return true;
+    }
+    catch (const std::exception& e)
+    {
+        setError("Failed to load program: " + std::string(e.what()));
+        return false;
+    }
+}
 
-        std::stringstream buffer;
-        buffer << file.rdbuf();
-        std::string assembly = buffer.str();
+void MipsSimulatorAPI::setProgramCache(std::shared_ptr<ProgramCache> cache)
+{
+    m_programCache = std::move(cache);
+}
 
-        return loadProgram(assembly);
+bool MipsSimulatorAPI::loadProgramFromFile(const std::string& filename)
+{
+    try
+    {
+        MappedFile  file;
+        std::string error;
+        if (!file.open(filename, error))
+        {
+            setError("Could not open file: " + error);
+            return false;
+        }
+        return loadCachedProgram(file.view());
     }
     catch (const std::exception& e)
     {
@@ -60,11 +157,63 @@ bool MipsSimulatorAPI::loadProgramFromFile(const std::string& filename)
     }
 }
 
+bool MipsSimulatorAPI::loadBinaryFile(const std::string& filename)
+{
+    try
+    {
+        MappedFile  file;
+        std::string error;
+        if (!file.open(filename, error))
+        {
+            setError("Could not open file: " + error);
+            return false;
+        }
+
+        ObjectFile::View image;
+        if (!ObjectFile::view(file.data(), file.size(), image, error))
+        {
+            setError("Failed to load binary: " + error);
+            return false;
+        }
+
+        Memory data;
+        data.writeBlock(image.dataBase, image.data, image.dataBytes);
+        m_cpu->loadProgramImage(ProgramImage::create(
+            std::make_shared<const ProgramImage::InstructionList>(
+                InstructionDecoder::decodeProgram(image.text, image.textWords)),
+            std::move(image.symbols), std::move(data)));
+        m_programFingerprint = Checkpoint::fingerprint(std::string_view(file.data(), file.size()));
+        m_lastWarning.clear();
+        clearError();
+        return true;
+    }
+    catch (const std::exception& e)
+    {
+        setError("Failed to load binary: " + std::string(e.what()));
+        return false;
+    }
+}
+
+bool MipsSimulatorAPI::loadProgramImage(std::shared_ptr<const ProgramImage> image)
+{
+    if (!image)
+    {
+        setError("Failed to load program: no program image");
+        return false;
+    }
+    m_programFingerprint = image->fingerprint();
+    m_cpu->loadProgramImage(std::move(image));
+    m_lastWarning.clear();
+    clearError();
+    return true;
+}
+
 void MipsSimulatorAPI::reset()
 {
     try
     {
         m_cpu->reset();
+        m_programFingerprint = 0;
         clearError();
     }
     catch (const std::exception& e)
@@ -73,6 +222,15 @@ void MipsSimulatorAPI::reset()
     }
 }
 
+std::unique_ptr<MipsSimulatorAPI> MipsSimulatorAPI::fork() const
+{
+    // Private constructor, so no make_unique
+    std::unique_ptr<MipsSimulatorAPI> clone(new MipsSimulatorAPI(m_cpu->fork()));
+    clone->m_programFingerprint = m_programFingerprint;
+    clone->m_programCache       = m_programCache;
+    return clone;
+}
+
 bool MipsSimulatorAPI::step()
 {
     try
@@ -92,27 +250,21 @@ bool MipsSimulatorAPI::step()
     }
 }
 
-int MipsSimulatorAPI::run(int maxCycles)
+uint64_t MipsSimulatorAPI::run(uint64_t maxCycles)
 {
     try
     {
-        int cyclesBefore = m_cpu->getCycleCount();
+        uint64_t cyclesBefore = m_cpu->getCycleCount();
 
-        if (maxCycles <= 0)
+        if (maxCycles == 0)
         {
-            // Run until termination
-            while (!m_cpu->shouldTerminate())
-            {
-                m_cpu->tick();
-            }
+            // Run until termination; a program that runs off its end stops there
+            m_cpu->runFor(UINT64_MAX);
         }
         else
         {
             // Run for specified cycles or until termination
-            for (int i = 0; i < maxCycles && !m_cpu->shouldTerminate(); ++i)
-            {
-                m_cpu->tick();
-            }
+            m_cpu->run(maxCycles);
         }
 
         return m_cpu->getCycleCount() - cyclesBefore;
@@ -124,6 +276,41 @@ int MipsSimulatorAPI::run(int maxCycles)
     }
 }
 
+bool MipsSimulatorAPI::setJitEnabled(bool enabled)
+{
+    m_cpu->setExecutionEngine(enabled ? ExecutionEngine::Jit : ExecutionEngine::Block);
+    return JitCompiler::available;
+}
+
+RunResult MipsSimulatorAPI::runFor(uint64_t budget, const std::atomic<bool>* stopFlag)
+{
+    return runUntil(Cpu::NO_STOP_PC, budget, stopFlag);
+}
+
+RunResult MipsSimulatorAPI::runUntil(uint32_t pc, uint64_t budget,
+                                     const std::atomic<bool>* stopFlag)
+{
+    const uint64_t cyclesBefore = m_cpu->getCycleCount();
+    try
+    {
+        RunResult result = m_cpu->runFor(budget, pc, stopFlag);
+        if (result.reason == StopReason::Fault)
+        {
+            setError("Program counter left the program at instruction " +
+                     std::to_string(m_cpu->getProgramCounter()));
+        }
+        return result;
+    }
+    catch (const std::exception& e)
+    {
+        setError("Error during program execution: " + std::string(e.what()));
+        RunResult result;
+        result.reason = StopReason::Fault;
+        result.cycles = m_cpu->getCycleCount() - cyclesBefore;
+        return result;
+    }
+}
+
 bool MipsSimulatorAPI::isTerminated() const
 {
     try
@@ -221,7 +408,7 @@ uint32_t MipsSimulatorAPI::getProgramCounter() const
     }
 }
 
-int MipsSimulatorAPI::getCycleCount() const
+uint64_t MipsSimulatorAPI::getCycleCount() const
 {
     try
     {
@@ -233,6 +420,84 @@ int MipsSimulatorAPI::getCycleCount() const
     }
 }
 
+uint64_t MipsSimulatorAPI::getRetiredInstructionCount() const
+{
+    try
+    {
+        return m_cpu->getRetiredInstructionCount();
+    }
+    catch (...)
+    {
+        return 0;
+    }
+}
+
+std::vector<uint32_t> MipsSimulatorAPI::getDirtyPages() const
+{
+    std::vector<uint32_t> pages;
+    for (const Memory::DirtyPage& page : m_cpu->getMemory().dirtyPages())
+    {
+        pages.push_back(page.address);
+    }
+    return pages;
+}
+
+bool MipsSimulatorAPI::saveCheckpoint(const std::string& path)
+{
+    std::ostringstream out;
+    Checkpoint::write(out, m_cpu->snapshot(), m_programFingerprint);
+
+    // A name no other saver uses, synced before the rename so a crash can only
+    // leave the old checkpoint or the whole new one, never a truncated file
+    static thread_local std::mt19937_64 random(std::random_device{}());
+    const std::string partial = path + "." + std::to_string(random()) + ".partial";
+    std::string       message;
+    if (!writeSynced(partial, out.view(), message))
+    {
+        setError(message);
+        return false;
+    }
+
+    std::error_code error;
+    std::filesystem::rename(partial, path, error);
+    if (error)
+    {
+        std::error_code ignored;
+        std::filesystem::remove(partial, ignored);
+        setError("Failed to replace checkpoint " + path + ": " + error.message());
+        return false;
+    }
+    return true;
+}
+
+bool MipsSimulatorAPI::loadCheckpoint(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        setError("Could not open checkpoint: " + path);
+        return false;
+    }
+
+    CpuSnapshot state;
+    uint64_t    fingerprint = 0;
+    std::string error;
+    if (!Checkpoint::read(file, state, fingerprint, error))
+    {
+        setError(path + ": " + error);
+        return false;
+    }
+    if (fingerprint != m_programFingerprint)
+    {
+        setError(path + ": checkpoint was saved for a different program");
+        return false;
+    }
+
+    m_cpu->restore(state);
+    clearError();
+    return true;
+}
+
 const std::string& MipsSimulatorAPI::getConsoleOutput() const
 {
     try
@@ -275,10 +540,14 @@ const std::string& MipsSimulatorAPI::getLastError() const
     return m_lastError;
 }
 
+const std::string& MipsSimulatorAPI::getLastWarning() const
+{
+    return m_lastWarning;
+}
+
 void MipsSimulatorAPI::setError(const std::string& error)
 {
-    m_lastError = error;
-    std::cerr << "MIPS Simulator Error: " << error << std::endl;
+    m_lastError = error;  // Reported by the caller through getLastError()
 }
 
 void MipsSimulatorAPI::clearError()
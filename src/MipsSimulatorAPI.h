@@ -1,8 +1,11 @@
 #pragma once
 
+#include "RunResult.h"
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace mips
@@ -10,6 +13,8 @@ namespace mips
 
 class Cpu;
 class Memory;
+class ProgramCache;
+class ProgramImage;
 class RegisterFile;
 
 /**
@@ -32,20 +37,76 @@ class MipsSimulatorAPI
      * @param assembly MIPS assembly code
      * @return true if successful, false if parse error
      */
-    bool loadProgram(const std::string& assembly);
+    bool loadProgram(std::string_view assembly);
+
+    /**
+     * @brief Load MIPS assembly program from string, through the program cache
+     *
+     * Like loadProgram(), but a source assembled before (by any process sharing the
+     * cache directory) is decoded from the cache without running the assembler.
+     * Without a cache (see setProgramCache()) this is loadProgram().
+     * @param assembly MIPS assembly code
+     * @return true if successful, false if parse error
+     */
+    bool loadCachedProgram(std::string_view assembly);
+
+    /**
+     * @brief Cache used by loadCachedProgram() and loadProgramFromFile()
+     *
+     * There is none by default, so the API never writes to disk on its own; the
+     * CLI's run and batch commands pass ProgramCache::standard().
+     * @param cache nullptr always assembles
+     */
+    void setProgramCache(std::shared_ptr<ProgramCache> cache);
 
     /**
      * @brief Load MIPS assembly program from file
+     *
+     * The file is memory-mapped and loaded with loadCachedProgram(), so it is
+     * assembled in place, without copying the source, unless a cache set with
+     * setProgramCache() has it.
      * @param filename Path to assembly file
      * @return true if successful, false if file not found or parse error
      */
     bool loadProgramFromFile(const std::string& filename);
 
+    /**
+     * @brief Load an assembled binary written by 'mipsim assemble' (.bin)
+     *
+     * The file is memory-mapped, its text section decoded in one pass and its data
+     * section copied straight into memory, so loading costs time proportional to
+     * the image rather than to re-assembling the source.
+     * @param filename Path to the binary
+     * @return true if successful, false if the file is unreadable or not a valid binary
+     */
+    bool loadBinaryFile(const std::string& filename);
+
+    /**
+     * @brief Load a program image shared with other simulators
+     *
+     * For running one program against many inputs: assemble it once with
+     * ProgramImage::assemble() and load the image into each simulator. Loading
+     * takes the same time whatever the program's size (see Cpu::loadProgramImage),
+     * and checkpoints match those of loadProgram() with the same source.
+     * @return true if successful, false if image is null
+     */
+    bool loadProgramImage(std::shared_ptr<const ProgramImage> image);
+
     /**
      * @brief Reset simulator to initial state
      */
     void reset();
 
+    /**
+     * @brief Clone this simulator in its current state
+     *
+     * The clone shares the assembled program and the memory pages (copy-on-write),
+     * so forking after a program's initialization and then giving each fork its own
+     * console input avoids re-assembling and re-running the prologue. Forks are
+     * independent and may run on different threads.
+     */
+    std::unique_ptr<MipsSimulatorAPI> fork() const;
+
     // ===== Execution Control =====
 
     /**
@@ -59,13 +120,37 @@ class MipsSimulatorAPI
      * @param maxCycles Maximum cycles to run (0 = unlimited)
      * @return Number of cycles executed
      */
-    int run(int maxCycles = 0);
+    uint64_t run(uint64_t maxCycles = 0);
+
+    /**
+     * @brief Run a batch of instructions and report why it stopped
+     * @param budget Maximum cycles to run (UINT64_MAX = unlimited)
+     * @param stopFlag Optional flag another thread sets to stop the run
+     * @return Stop reason and cycles spent; StopReason::Fault also sets the last error
+     */
+    RunResult runFor(uint64_t budget, const std::atomic<bool>* stopFlag = nullptr);
+
+    /**
+     * @brief Run until execution reaches an instruction, like runFor otherwise
+     * @param pc Instruction index to stop at (as returned by getProgramCounter)
+     * @param budget Maximum cycles to run (UINT64_MAX = unlimited)
+     * @param stopFlag Optional flag another thread sets to stop the run
+     */
+    RunResult runUntil(uint32_t pc, uint64_t budget = UINT64_MAX,
+                       const std::atomic<bool>* stopFlag = nullptr);
 
     /**
      * @brief Check if program has terminated
      */
     bool isTerminated() const;
 
+    /**
+     * @brief Run hot code through the x86-64 JIT instead of the block interpreter
+     * @param enabled true to select ExecutionEngine::Jit, false for the default engine
+     * @return true if a JIT is compiled into this build for this host
+     */
+    bool setJitEnabled(bool enabled);
+
     // ===== State Access =====
 
     /**
@@ -118,7 +203,39 @@ class MipsSimulatorAPI
     /**
      * @brief Get current cycle count
      */
-    int getCycleCount() const;
+    uint64_t getCycleCount() const;
+
+    /**
+     * @brief Get the number of retired instructions
+     */
+    uint64_t getRetiredInstructionCount() const;
+
+    /**
+     * @brief Page-aligned addresses of the 4KB pages written since the last reset
+     *
+     * Everything outside these pages is still zero, so they are all a caller needs to
+     * diff or serialise the memory state.
+     */
+    std::vector<uint32_t> getDirtyPages() const;
+
+    // ===== Checkpoints =====
+
+    /**
+     * @brief Write the machine state to a checkpoint file (format in Checkpoint.h)
+     *
+     * The file is written and synced under a unique name next to @p path, then
+     * renamed over it, so an interrupted save leaves the previous checkpoint
+     * intact; on failure the temporary file is removed.
+     * @return false on I/O error
+     */
+    bool saveCheckpoint(const std::string& path);
+
+    /**
+     * @brief Continue from a checkpoint file saved while running the loaded program
+     * @return false if the file cannot be read, is corrupt, or was saved for
+     *         different program source
+     */
+    bool loadCheckpoint(const std::string& path);
 
     // ===== Console I/O (for syscall support) =====
 
@@ -146,13 +263,28 @@ class MipsSimulatorAPI
 
     /**
      * @brief Get last error message
+     *
+     * Errors are only recorded here; the API never writes to stderr itself.
      */
     const std::string& getLastError() const;
 
+    /**
+     * @brief Warning about the program loaded last, empty if there is none
+     *
+     * Set when assembly skipped lines that did not parse (see
+     * Assembler::skippedLines()); like errors, only recorded here.
+     */
+    const std::string& getLastWarning() const;
+
   private:
-    std::unique_ptr<Cpu> m_cpu;
-    std::string          m_lastError;
-    bool                 m_initialized;
+    explicit MipsSimulatorAPI(std::unique_ptr<Cpu> cpu);
+
+    std::unique_ptr<Cpu>          m_cpu;
+    std::string                   m_lastError;
+    std::string                   m_lastWarning;
+    bool                          m_initialized;
+    uint64_t                      m_programFingerprint = 0;  // Of the source, for checkpoints
+    std::shared_ptr<ProgramCache> m_programCache;            // For loadCachedProgram()
 
     // Helper methods
     void setError(const std::string& error);
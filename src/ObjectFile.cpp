@@ -0,0 +1,224 @@
+#include "ObjectFile.h"
+#include "InstructionEncoder.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <iterator>
+#include <ostream>
+#include <stdexcept>
+
+namespace mips
+{
+
+namespace
+{
+
+constexpr char MAGIC[8] = {'M', 'I', 'P', 'S', 'B', 'I', 'N', '\0'};
+
+void put(std::string& out, uint32_t value, size_t bytes)
+{
+    for (size_t i = 0; i < bytes; ++i)
+    {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+uint32_t get(const char* in, size_t offset, size_t bytes)
+{
+    uint32_t value = 0;
+    for (size_t i = 0; i < bytes; ++i)
+    {
+        value |= static_cast<uint32_t>(static_cast<uint8_t>(in[offset + i])) << (8 * i);
+    }
+    return value;
+}
+
+bool isLittleEndian()
+{
+    const uint32_t probe = 1;
+    uint8_t        first;
+    std::memcpy(&first, &probe, 1);
+    return first == 1;
+}
+
+}  // namespace
+
+ObjectFile ObjectFile::fromProgram(const std::vector<std::unique_ptr<Instruction>>& instructions,
+                                   const std::vector<DataDirective>&                dataDirectives,
+                                   const std::map<std::string, uint32_t>&           labelMap)
+{
+    ObjectFile object;
+    object.text    = InstructionEncoder::encodeProgram(instructions);
+    object.symbols = labelMap;
+
+    // Flatten the directives into one image; gaps between them stay zero
+    if (!dataDirectives.empty())
+    {
+        uint32_t begin = UINT32_MAX;
+        uint32_t end   = 0;
+        for (const DataDirective& directive : dataDirectives)
+        {
+            const uint32_t size = directive.type == DataDirective::WORD
+                                      ? static_cast<uint32_t>(directive.words.size() * 4)
+                                      : static_cast<uint32_t>(directive.bytes.size());
+            begin = std::min(begin, directive.address);
+            end   = std::max(end, directive.address + size);
+        }
+
+        object.dataBase = begin;
+        object.data.assign(end > begin ? end - begin : 0, 0);
+        for (const DataDirective& directive : dataDirectives)
+        {
+            uint8_t* at = object.data.data() + (directive.address - begin);
+            if (directive.type == DataDirective::WORD)
+            {
+                for (uint32_t word : directive.words)
+                {
+                    for (int i = 0; i < 4; ++i)
+                    {
+                        *at++ = static_cast<uint8_t>(word >> (8 * i));  // Little-endian
+                    }
+                }
+            }
+            else
+            {
+                std::copy(directive.bytes.begin(), directive.bytes.end(), at);
+            }
+        }
+    }
+    return object;
+}
+
+void ObjectFile::write(std::ostream& out) const
+{
+    std::string bytes(MAGIC, sizeof(MAGIC));
+    put(bytes, VERSION, 4);
+    put(bytes, static_cast<uint32_t>(text.size()), 4);
+    put(bytes, dataBase, 4);
+    put(bytes, static_cast<uint32_t>(data.size()), 4);
+    put(bytes, static_cast<uint32_t>(symbols.size()), 4);
+    put(bytes, 0, 4);  // Reserved
+
+    for (uint32_t word : text)
+    {
+        put(bytes, word, 4);
+    }
+    bytes.append(data.begin(), data.end());
+    for (const auto& [name, address] : symbols)
+    {
+        put(bytes, address, 4);
+        put(bytes, static_cast<uint32_t>(std::min<size_t>(name.size(), UINT16_MAX)), 2);
+        bytes.append(name, 0, UINT16_MAX);
+    }
+
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+bool ObjectFile::read(std::istream& in, ObjectFile& object, std::string& error)
+{
+    const std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    View parsed;
+    if (!view(bytes.data(), bytes.size(), parsed, error))
+    {
+        return false;
+    }
+
+    ObjectFile result;
+    result.text.assign(parsed.text, parsed.text + parsed.textWords);
+    result.dataBase = parsed.dataBase;
+    result.data.assign(parsed.data, parsed.data + parsed.dataBytes);
+    result.symbols = std::move(parsed.symbols);
+
+    object = std::move(result);
+    return true;
+}
+
+bool ObjectFile::view(const char* bytes, size_t size, View& result, std::string& error)
+{
+    if (size < HEADER_BYTES || std::memcmp(bytes, MAGIC, sizeof(MAGIC)) != 0)
+    {
+        error = "not a mipsim binary";
+        return false;
+    }
+    const uint32_t version = get(bytes, 8, 4);
+    if (version != VERSION)
+    {
+        error = "unsupported binary version " + std::to_string(version);
+        return false;
+    }
+
+    const uint64_t textWords   = get(bytes, 12, 4);
+    const uint32_t dataBase    = get(bytes, 16, 4);
+    const uint64_t dataBytes   = get(bytes, 20, 4);
+    const uint32_t symbolCount = get(bytes, 24, 4);
+    if (size < HEADER_BYTES + textWords * 4 + dataBytes)
+    {
+        error = "binary is truncated";
+        return false;
+    }
+
+    View        parsed;
+    size_t      offset  = HEADER_BYTES;
+    const char* text    = bytes + offset;
+    const bool  inPlace = isLittleEndian() &&
+                         reinterpret_cast<uintptr_t>(text) % alignof(uint32_t) == 0;
+    if (inPlace)
+    {
+        parsed.text = reinterpret_cast<const uint32_t*>(text);
+    }
+    else
+    {
+        parsed.textStorage.resize(textWords);
+        for (size_t i = 0; i < textWords; ++i)
+        {
+            parsed.textStorage[i] = get(bytes, offset + i * 4, 4);
+        }
+        parsed.text = parsed.textStorage.data();
+    }
+    parsed.textWords = textWords;
+    offset += textWords * 4;
+
+    parsed.dataBase  = dataBase;
+    parsed.data      = reinterpret_cast<const uint8_t*>(bytes + offset);
+    parsed.dataBytes = dataBytes;
+    offset += dataBytes;
+
+    for (uint32_t i = 0; i < symbolCount; ++i)
+    {
+        if (size - offset < 6)
+        {
+            error = "binary symbol table is truncated";
+            return false;
+        }
+        const uint32_t address = get(bytes, offset, 4);
+        const uint32_t length  = get(bytes, offset + 4, 2);
+        offset += 6;
+        if (size - offset < length)
+        {
+            error = "binary symbol table is truncated";
+            return false;
+        }
+        // write() emits names in order, so inserting at the end takes constant time
+        parsed.symbols.insert_or_assign(parsed.symbols.end(), std::string(bytes + offset, length),
+                                        address);
+        offset += length;
+    }
+
+    result = std::move(parsed);
+    return true;
+}
+
+std::vector<DataDirective> ObjectFile::dataDirectives() const
+{
+    std::vector<DataDirective> directives;
+    if (!data.empty())
+    {
+        directives.emplace_back(DataDirective::BYTE, dataBase);
+        directives.back().bytes = data;
+    }
+    return directives;
+}
+
+}  // namespace mips
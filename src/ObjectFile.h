@@ -0,0 +1,92 @@
+#pragma once
+
+#include "Assembler.h"
+#include <cstdint>
+#include <iosfwd>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace mips
+{
+
+class Instruction;
+
+/**
+ * @brief Assembled program container written by 'mipsim assemble' (.bin)
+ *
+ * Layout (all integers little-endian):
+ *   header   "MIPSBIN\0", u32 version, u32 text words, u32 data base,
+ *            u32 data bytes, u32 symbol count, u32 reserved (0)
+ *   text     one u32 machine word per instruction (InstructionEncoder)
+ *   data     the initialised data image, loaded at the data base address
+ *   symbols  per symbol: u32 byte address, u16 name length, name bytes
+ *
+ * The header is 32 bytes, so the text section is word-aligned in the file.
+ */
+struct ObjectFile
+{
+    static constexpr uint32_t VERSION      = 1;
+    static constexpr size_t   HEADER_BYTES = 32;
+
+    std::vector<uint32_t>           text;
+    uint32_t                        dataBase = 0;
+    std::vector<uint8_t>            data;
+    std::map<std::string, uint32_t> symbols;
+
+    /**
+     * @brief Zero-copy view of a container held in memory, e.g. a MappedFile
+     *
+     * text and data point into the viewed bytes, which must outlive the view.
+     * The text is only copied (into textStorage) when it cannot be used in place:
+     * on big-endian hosts or when the bytes are not word-aligned.
+     */
+    struct View
+    {
+        const uint32_t*                 text      = nullptr;
+        size_t                          textWords = 0;
+        uint32_t                        dataBase  = 0;
+        const uint8_t*                  data      = nullptr;
+        size_t                          dataBytes = 0;
+        std::map<std::string, uint32_t> symbols;
+        std::vector<uint32_t>           textStorage;
+    };
+
+    /**
+     * @brief Build from the output of the assembler
+     * @param instructions Instructions after Assembler::link
+     * @param dataDirectives Data directives from Assembler::assembleWithLabels
+     * @param labelMap Label table from Assembler::assembleWithLabels
+     * @throws std::runtime_error if an instruction cannot be encoded
+     */
+    static ObjectFile fromProgram(const std::vector<std::unique_ptr<Instruction>>& instructions,
+                                  const std::vector<DataDirective>&                dataDirectives,
+                                  const std::map<std::string, uint32_t>&           labelMap);
+
+    /**
+     * @brief Serialise in the layout above
+     */
+    void write(std::ostream& out) const;
+
+    /**
+     * @brief Parse a container written by write()
+     * @param error Set to a description of the problem on failure
+     * @return false if the data is not a valid container of this version
+     */
+    static bool read(std::istream& in, ObjectFile& object, std::string& error);
+
+    /**
+     * @brief Parse a container in place without copying its sections
+     * @param error Set to a description of the problem on failure
+     * @return false if the bytes are not a valid container of this version
+     */
+    static bool view(const char* bytes, size_t size, View& result, std::string& error);
+
+    /**
+     * @brief The data image as a directive, ready to be written to memory
+     */
+    std::vector<DataDirective> dataDirectives() const;
+};
+
+}  // namespace mips
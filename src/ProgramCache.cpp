@@ -0,0 +1,393 @@
+#include "ProgramCache.h"
+#include "Assembler.h"
+#include "Checkpoint.h"
+#include "Instruction.h"
+#include "InstructionDecoder.h"
+#include "MappedFile.h"
+#include "Memory.h"
+#include "ObjectFile.h"
+#include "ProgramImage.h"
+#include "Sha256.h"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace mips
+{
+
+namespace
+{
+
+namespace fs = std::filesystem;
+
+// Temporary files left by a writer that died are removed after this long
+constexpr auto STALE_TEMPORARY = std::chrono::hours(1);
+
+const char* environment(const char* name)
+{
+    const char* value = std::getenv(name);
+    return value != nullptr && *value != '\0' ? value : nullptr;
+}
+
+// Whether two instructions run identically
+bool sameInstruction(const Instruction& a, const Instruction& b)
+{
+    DecodedInstr first;
+    DecodedInstr second;
+    const bool   lowered = a.lower(first);
+    if (lowered != b.lower(second))
+    {
+        return false;
+    }
+    if (lowered)
+    {
+        // la is encoded as ori from $zero, which computes the same value
+        for (DecodedInstr* d : {&first, &second})
+        {
+            if (d->op == DecodedOp::La)
+            {
+                d->op = DecodedOp::Ori;
+                d->rs = 0;
+            }
+        }
+        return first.op == second.op && first.rd == second.rd && first.rs == second.rs &&
+               first.rt == second.rt && first.imm == second.imm && first.target == second.target;
+    }
+
+    // Executed directly: syscalls, which have no operands, and traps
+    const auto* trapA = dynamic_cast<const TrapInstruction*>(&a);
+    const auto* trapB = dynamic_cast<const TrapInstruction*>(&b);
+    if (trapA != nullptr || trapB != nullptr)
+    {
+        return trapA != nullptr && trapB != nullptr && trapA->getTrapCode() == trapB->getTrapCode();
+    }
+    return a.getName() == b.getName();
+}
+
+// Whether decoding the container gives back exactly the assembled program
+bool roundTrips(const ObjectFile& object, const ProgramImage::InstructionList& instructions)
+{
+    std::vector<std::unique_ptr<Instruction>> decoded;
+    try
+    {
+        decoded = InstructionDecoder::decodeProgram(object.text.data(), object.text.size());
+    }
+    catch (const std::runtime_error&)
+    {
+        return false;
+    }
+    if (decoded.size() != instructions.size())
+    {
+        return false;
+    }
+    for (size_t i = 0; i < decoded.size(); ++i)
+    {
+        if (!sameInstruction(*instructions[i], *decoded[i]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+ProgramCache::ProgramCache(std::filesystem::path directory, uint64_t maxBytes)
+    : m_directory(std::move(directory)), m_maxBytes(maxBytes)
+{
+}
+
+std::shared_ptr<ProgramCache> ProgramCache::standard()
+{
+    static const std::shared_ptr<ProgramCache> cache = []() -> std::shared_ptr<ProgramCache>
+    {
+        fs::path directory = defaultDirectory();
+        if (directory.empty())
+        {
+            return nullptr;
+        }
+        uint64_t maxBytes = DEFAULT_MAX_BYTES;
+        if (const char* megabytes = environment("MIPSIM_CACHE_MAX_MB"))
+        {
+            if (!parseMaxBytes(megabytes, maxBytes))
+            {
+                std::cerr << "mipsim: warning: ignoring MIPSIM_CACHE_MAX_MB=" << megabytes
+                          << ", expected a number of MiB from 1 to " << (UINT64_MAX >> 20)
+                          << "; using " << (DEFAULT_MAX_BYTES >> 20) << std::endl;
+            }
+        }
+        return std::make_shared<ProgramCache>(std::move(directory), maxBytes);
+    }();
+    return cache;
+}
+
+bool ProgramCache::parseMaxBytes(std::string_view text, uint64_t& maxBytes)
+{
+    uint64_t   megabytes = 0;
+    const auto result    = std::from_chars(text.data(), text.data() + text.size(), megabytes);
+    if (result.ec != std::errc() || result.ptr != text.data() + text.size() || megabytes == 0 ||
+        megabytes > (UINT64_MAX >> 20))
+    {
+        return false;
+    }
+    maxBytes = megabytes << 20;
+    return true;
+}
+
+std::filesystem::path ProgramCache::defaultDirectory()
+{
+    if (environment("MIPSIM_NO_CACHE"))
+    {
+        return {};
+    }
+    if (const char* directory = environment("MIPSIM_CACHE_DIR"))
+    {
+        return directory;
+    }
+    if (const char* cacheHome = environment("XDG_CACHE_HOME"))
+    {
+        return fs::path(cacheHome) / "mipsim";
+    }
+    if (const char* home = environment("HOME"))
+    {
+        return fs::path(home) / ".cache" / "mipsim";
+    }
+    return {};
+}
+
+std::shared_ptr<const ProgramImage> ProgramCache::load(std::string_view     source,
+                                                       std::vector<size_t>* skippedLines)
+{
+    if (skippedLines != nullptr)
+    {
+        skippedLines->clear();
+    }
+
+    const uint64_t fingerprint = Checkpoint::fingerprint(source);
+    const fs::path path        = entryPath(source);
+
+    if (auto image = read(path, fingerprint))
+    {
+        std::error_code error;
+        fs::last_write_time(path, fs::file_time_type::clock::now(), error);  // Recently used
+        m_hits.fetch_add(1, std::memory_order_relaxed);
+        return image;
+    }
+    m_misses.fetch_add(1, std::memory_order_relaxed);
+
+    Assembler                  assembler;
+    LabelMap                   labelMap;
+    std::vector<DataDirective> dataDirectives;
+    auto instructions = assembler.assembleWithLabels(source, labelMap, dataDirectives);
+    Assembler::link(instructions, labelMap);  // Throws on undefined labels
+    if (skippedLines != nullptr)
+    {
+        *skippedLines = assembler.skippedLines();
+    }
+
+    // A hit could not repeat the warning for skipped lines
+    ObjectFile object;
+    bool       cacheable = assembler.skippedLines().empty();
+    try
+    {
+        if (cacheable)
+        {
+            object = ObjectFile::fromProgram(instructions, dataDirectives, labelMap);
+        }
+    }
+    catch (const std::runtime_error&)
+    {
+        cacheable = false;  // Not every instruction has a machine encoding
+    }
+    cacheable = cacheable && roundTrips(object, instructions);
+
+    if (cacheable)
+    {
+        store(path, object);
+        evict();
+    }
+
+    Memory data;
+    ProgramImage::writeData(dataDirectives, data);
+    return ProgramImage::create(
+        std::make_shared<const ProgramImage::InstructionList>(std::move(instructions)),
+        std::move(labelMap), std::move(data), fingerprint);
+}
+
+std::filesystem::path ProgramCache::entryPath(std::string_view source) const
+{
+    return m_directory / (Sha256::hex(Sha256::digest(source)) + "-v" +
+                          std::to_string(Assembler::VERSION) + ".bin");
+}
+
+const std::filesystem::path& ProgramCache::directory() const
+{
+    return m_directory;
+}
+
+uint64_t ProgramCache::maxBytes() const
+{
+    return m_maxBytes;
+}
+
+uint64_t ProgramCache::hits() const
+{
+    return m_hits.load(std::memory_order_relaxed);
+}
+
+uint64_t ProgramCache::misses() const
+{
+    return m_misses.load(std::memory_order_relaxed);
+}
+
+std::shared_ptr<const ProgramImage> ProgramCache::read(const std::filesystem::path& path,
+                                                       uint64_t fingerprint) const
+{
+    MappedFile  file;
+    std::string error;
+    if (!file.open(path.string(), error))
+    {
+        return nullptr;
+    }
+
+    // A container can parse and still hold other bits than were stored, so its
+    // checksum is checked first; a damaged entry is evicted along with the hit
+    const size_t    digestBytes = sizeof(Sha256::Digest);
+    Sha256::Digest  stored{};
+    std::error_code ignored;
+    if (file.size() < digestBytes)
+    {
+        fs::remove(path, ignored);
+        return nullptr;
+    }
+    const size_t payloadBytes = file.size() - digestBytes;
+    std::memcpy(stored.data(), file.data() + payloadBytes, digestBytes);
+    if (Sha256::digest(std::string_view(file.data(), payloadBytes)) != stored)
+    {
+        fs::remove(path, ignored);
+        return nullptr;
+    }
+
+    ObjectFile::View view;
+    if (!ObjectFile::view(file.data(), payloadBytes, view, error))
+    {
+        return nullptr;
+    }
+
+    std::vector<std::unique_ptr<Instruction>> instructions;
+    try
+    {
+        instructions = InstructionDecoder::decodeProgram(view.text, view.textWords);
+    }
+    catch (const std::runtime_error&)
+    {
+        return nullptr;
+    }
+
+    Memory data;
+    data.writeBlock(view.dataBase, view.data, view.dataBytes);
+    return ProgramImage::create(
+        std::make_shared<const ProgramImage::InstructionList>(std::move(instructions)),
+        std::move(view.symbols), std::move(data), fingerprint);
+}
+
+void ProgramCache::store(const std::filesystem::path& path, const ObjectFile& object) const
+{
+    std::error_code error;
+    fs::create_directories(m_directory, error);
+
+    // A name no other writer uses, renamed over the entry once complete
+    static thread_local std::mt19937_64 random(std::random_device{}());
+    fs::path                            temporary = path;
+    temporary += "." + std::to_string(random()) + ".tmp";
+    {
+        std::ostringstream payload;
+        object.write(payload);
+        const Sha256::Digest digest = Sha256::digest(payload.view());
+
+        std::ofstream out(temporary, std::ios::binary);
+        out.write(payload.view().data(), static_cast<std::streamsize>(payload.view().size()));
+        out.write(reinterpret_cast<const char*>(digest.data()), digest.size());
+        if (!out.flush())
+        {
+            out.close();
+            fs::remove(temporary, error);
+            return;
+        }
+    }
+    fs::rename(temporary, path, error);
+    if (error)
+    {
+        fs::remove(temporary, error);
+    }
+}
+
+void ProgramCache::evict() const
+{
+    struct Entry
+    {
+        fs::path           path;
+        fs::file_time_type used;
+        uintmax_t          size;
+    };
+
+    // Other processes add and remove entries meanwhile, so every error just skips a file
+    std::vector<Entry>       entries;
+    uintmax_t                total = 0;
+    const fs::file_time_type now   = fs::file_time_type::clock::now();
+    std::error_code          error;
+    for (fs::directory_iterator it(m_directory, error), end; !error && it != end;
+         it.increment(error))
+    {
+        const fs::path& path = it->path();
+        const auto      used = fs::last_write_time(path, error);
+        if (error)
+        {
+            error.clear();
+            continue;
+        }
+        if (path.extension() == ".tmp")
+        {
+            if (now - used > STALE_TEMPORARY)
+            {
+                fs::remove(path, error);
+                error.clear();
+            }
+            continue;
+        }
+        const uintmax_t size = fs::file_size(path, error);
+        if (error || path.extension() != ".bin")
+        {
+            error.clear();
+            continue;
+        }
+        entries.push_back({path, used, size});
+        total += size;
+    }
+
+    if (total <= m_maxBytes)
+    {
+        return;
+    }
+    std::sort(entries.begin(), entries.end(),
+              [](const Entry& a, const Entry& b) { return a.used < b.used; });
+    for (const Entry& entry : entries)
+    {
+        if (total <= m_maxBytes)
+        {
+            break;
+        }
+        fs::remove(entry.path, error);
+        total -= entry.size;
+    }
+}
+
+}  // namespace mips
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace mips
+{
+
+class ProgramImage;
+struct ObjectFile;
+
+/**
+ * @brief Content-addressed on-disk cache of assembled programs
+ *
+ * Each entry is a .bin container (ObjectFile) followed by the SHA-256 of the
+ * container, named after the source it was assembled from: its SHA-256 and
+ * Assembler::VERSION. An entry whose checksum does not match is evicted and
+ * counts as a miss. The name is the only key,
+ * so it must not be forgeable; with SHA-256 two sources share an entry only if
+ * they are the same text. A hit is decoded straight into a ProgramImage and the
+ * Assembler is not run at all; a miss is assembled and stored.
+ *
+ * Several processes may share a directory. Entries are written to a temporary
+ * file and renamed into place, so a reader sees a whole entry or none; readers
+ * map an entry, so one evicted under them stays readable. A program is only
+ * stored when decoding its container gives back exactly the lowered program, so
+ * a hit always runs like a fresh assembly.
+ *
+ * The directory is kept under a size limit by evicting the least recently used
+ * entries (by modification time, which a hit refreshes) after each store.
+ */
+class ProgramCache
+{
+  public:
+    static constexpr uint64_t DEFAULT_MAX_BYTES = 64ull << 20;
+
+    /**
+     * @param directory Created on the first store
+     * @param maxBytes Total size of entries kept after a store
+     */
+    explicit ProgramCache(std::filesystem::path directory, uint64_t maxBytes = DEFAULT_MAX_BYTES);
+
+    /**
+     * @brief The cache at defaultDirectory(), or nullptr when caching is off
+     *
+     * MIPSIM_CACHE_MAX_MB sets its size limit in MiB; a value parseMaxBytes()
+     * rejects is reported on stderr and the default is kept. Created on first use
+     * and shared by the whole process.
+     */
+    static std::shared_ptr<ProgramCache> standard();
+
+    /**
+     * @brief Convert a size limit in MiB, as MIPSIM_CACHE_MAX_MB gives it, to bytes
+     * @return false, leaving maxBytes unchanged, unless text is a whole number from 1
+     *         up to the largest limit that fits in 64 bits
+     */
+    static bool parseMaxBytes(std::string_view text, uint64_t& maxBytes);
+
+    /**
+     * @brief $MIPSIM_CACHE_DIR, else $XDG_CACHE_HOME/mipsim, else ~/.cache/mipsim
+     * @return Empty if MIPSIM_NO_CACHE is set or no directory can be found
+     */
+    static std::filesystem::path defaultDirectory();
+
+    /**
+     * @brief Image of a source, from the cache or by assembling and storing it
+     * @param[out] skippedLines If given, receives Assembler::skippedLines(). A source
+     *             with skipped lines is never stored, so a hit has none.
+     * @throws std::runtime_error if the program references an undefined label
+     *
+     * Problems with the cache itself (unwritable directory, damaged entry) only
+     * cost the cache hit; the program is assembled as usual and stored again.
+     */
+    std::shared_ptr<const ProgramImage> load(std::string_view     source,
+                                             std::vector<size_t>* skippedLines = nullptr);
+
+    /**
+     * @brief Path of the entry for a source, whether or not it exists
+     */
+    std::filesystem::path entryPath(std::string_view source) const;
+
+    const std::filesystem::path& directory() const;
+    uint64_t                     maxBytes() const;
+
+    uint64_t hits() const;    // load() calls answered from the directory
+    uint64_t misses() const;  // load() calls that assembled
+
+  private:
+    std::shared_ptr<const ProgramImage> read(const std::filesystem::path& path,
+                                             uint64_t                     fingerprint) const;
+    void store(const std::filesystem::path& path, const ObjectFile& object) const;
+    void evict() const;
+
+    std::filesystem::path m_directory;
+    uint64_t              m_maxBytes;
+    std::atomic<uint64_t> m_hits{0};
+    std::atomic<uint64_t> m_misses{0};
+};
+
+}  // namespace mips
@@ -0,0 +1,114 @@
+#include "ProgramImage.h"
+#include "AssemblySession.h"
+#include "BlockCache.h"
+#include "Checkpoint.h"
+
+namespace mips
+{
+
+std::shared_ptr<const ProgramImage> ProgramImage::assemble(std::string_view source, unsigned jobs)
+{
+    Assembler                  assembler(jobs);
+    LabelMap                   labelMap;
+    std::vector<DataDirective> dataDirectives;
+    auto instructions = assembler.assembleWithLabels(source, labelMap, dataDirectives);
+    Assembler::link(instructions, labelMap);  // Throws on undefined labels
+
+    Memory data;
+    writeData(dataDirectives, data);
+    return create(std::make_shared<const InstructionList>(std::move(instructions)),
+                  std::move(labelMap), std::move(data), Checkpoint::fingerprint(source));
+}
+
+std::shared_ptr<const ProgramImage> ProgramImage::create(const AssembledProgram& program)
+{
+    Memory data;
+    writeData(program.dataDirectives, data);
+    return create(program.instructions, program.labelMap, std::move(data));
+}
+
+std::shared_ptr<const ProgramImage>
+ProgramImage::create(std::shared_ptr<const InstructionList> instructions, LabelMap symbols,
+                     Memory data, uint64_t fingerprint)
+{
+    // Private constructor, so no make_shared
+    std::shared_ptr<ProgramImage> image(new ProgramImage);
+    image->m_instructions = std::move(instructions);
+    image->m_symbols      = std::move(symbols);
+    image->m_data         = std::move(data);
+    image->m_fingerprint  = fingerprint;
+
+    const InstructionList& list = *image->m_instructions;
+    image->m_decoded.reserve(list.size());
+    for (size_t i = 0; i < list.size(); ++i)
+    {
+        DecodedInstr decoded;
+        if (!list[i]->lower(decoded))
+        {
+            decoded        = DecodedInstr{};
+            decoded.op     = DecodedOp::Fallback;
+            decoded.target = static_cast<uint32_t>(i);
+        }
+        image->m_decoded.push_back(decoded);
+    }
+    image->m_leaders = BlockCache::findLeaders(image->m_decoded);
+    return image;
+}
+
+const std::shared_ptr<const ProgramImage>& ProgramImage::empty()
+{
+    static const std::shared_ptr<const ProgramImage> image =
+        create(std::make_shared<const InstructionList>(), LabelMap());
+    return image;
+}
+
+void ProgramImage::writeData(const std::vector<DataDirective>& dataDirectives, Memory& memory)
+{
+    for (const auto& directive : dataDirectives)
+    {
+        if (directive.type == DataDirective::WORD)
+        {
+            for (size_t i = 0; i < directive.words.size(); ++i)
+            {
+                uint32_t address = directive.address + (i * 4);
+                memory.writeWord(address, directive.words[i]);
+            }
+        }
+        else if (directive.type == DataDirective::BYTE || directive.type == DataDirective::ASCIIZ)
+        {
+            memory.writeBlock(directive.address, directive.bytes.data(), directive.bytes.size());
+        }
+    }
+}
+
+const ProgramImage::InstructionList& ProgramImage::instructions() const
+{
+    return *m_instructions;
+}
+
+const std::vector<DecodedInstr>& ProgramImage::decoded() const
+{
+    return m_decoded;
+}
+
+const std::vector<uint8_t>& ProgramImage::leaders() const
+{
+    return m_leaders;
+}
+
+const LabelMap& ProgramImage::symbols() const
+{
+    return m_symbols;
+}
+
+const Memory& ProgramImage::data() const
+{
+    return m_data;
+}
+
+uint64_t ProgramImage::fingerprint() const
+{
+    return m_fingerprint;
+}
+
+}  // namespace mips
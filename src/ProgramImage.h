@@ -0,0 +1,86 @@
+#pragma once
+
+#include "Assembler.h"
+#include "DecodedInstruction.h"
+#include "Instruction.h"
+#include "Memory.h"
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace mips
+{
+
+struct AssembledProgram;
+
+/**
+ * @brief An assembled program in the form a Cpu runs it, built once and shared
+ *
+ * Holds the linked instructions, their lowered records and basic-block leaders,
+ * the resolved symbols and the initial data image. An image never changes after
+ * it is built, so any number of Cpus (on any threads) can run it at once:
+ * Cpu::loadProgramImage attaches it without copying or lowering, and a fresh
+ * Cpu's memory starts out sharing the image's data pages copy-on-write.
+ */
+class ProgramImage
+{
+  public:
+    using InstructionList = std::vector<std::unique_ptr<Instruction>>;
+
+    /**
+     * @brief Assemble, link and lay out a source
+     * @param jobs Worker threads for assembly, as for Assembler
+     * @throws std::runtime_error if the program references an undefined label
+     */
+    static std::shared_ptr<const ProgramImage> assemble(std::string_view source,
+                                                        unsigned         jobs = 1);
+
+    /**
+     * @brief Image of an AssemblySession's program; its instructions are shared
+     */
+    static std::shared_ptr<const ProgramImage> create(const AssembledProgram& program);
+
+    /**
+     * @brief Image of an already linked program, e.g. one decoded from a .bin
+     * @param instructions Instructions whose targets are resolved to indices
+     * @param symbols Label table (byte addresses)
+     * @param data Initial memory contents
+     * @param fingerprint Checkpoint::fingerprint() of the source, if known
+     */
+    static std::shared_ptr<const ProgramImage>
+    create(std::shared_ptr<const InstructionList> instructions, LabelMap symbols,
+           Memory data = Memory(), uint64_t fingerprint = 0);
+
+    /**
+     * @brief The image of no program
+     */
+    static const std::shared_ptr<const ProgramImage>& empty();
+
+    /**
+     * @brief Write data directives into memory
+     */
+    static void writeData(const std::vector<DataDirective>& dataDirectives, Memory& memory);
+
+    const InstructionList&           instructions() const;
+    const std::vector<DecodedInstr>& decoded() const;
+    const std::vector<uint8_t>&      leaders() const;  // BlockCache::findLeaders of decoded()
+    const LabelMap&                  symbols() const;
+    const Memory&                    data() const;
+    uint64_t                         fingerprint() const;  // Of the source; 0 if unknown
+
+    ProgramImage(const ProgramImage&)            = delete;
+    ProgramImage& operator=(const ProgramImage&) = delete;
+
+  private:
+    ProgramImage() = default;
+
+    std::shared_ptr<const InstructionList> m_instructions;
+    std::vector<DecodedInstr>              m_decoded;  // Lowered m_instructions
+    std::vector<uint8_t>                   m_leaders;
+    LabelMap                               m_symbols;
+    Memory                                 m_data;
+    uint64_t                               m_fingerprint = 0;  // Checkpoint::fingerprint()
+};
+
+}  // namespace mips
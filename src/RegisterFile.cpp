@@ -1,5 +1,5 @@
 #include "RegisterFile.h"
-#include <iostream>
+#include "Log.h"
 
 namespace mips
 {
@@ -25,11 +25,7 @@ void RegisterFile::write(int regNum, uint32_t value)
         return;  // $zero (reg 0) is hardwired to 0, invalid regs ignored
     }
     m_registers[regNum] = value;
-    // Targeted tracing for debugging: log writes to $a0 (reg 4) and $ra (reg 31)
-    if (regNum == 4 || regNum == 31)
-    {
-        std::cerr << "TRACE: RegisterFile::write reg=" << regNum << " value=" << value << std::endl;
-    }
+    MIPS_LOG(Register, Trace, "write reg=" << regNum << " value=" << value);
 }
 
 void RegisterFile::reset()
@@ -59,4 +55,9 @@ void RegisterFile::writeLO(uint32_t value)
     m_lo = value;
 }
 
+std::array<uint32_t, RegisterFile::NUM_REGISTERS>& RegisterFile::data()
+{
+    return m_registers;
+}
+
 }  // namespace mips
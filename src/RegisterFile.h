@@ -59,6 +59,12 @@ class RegisterFile
      */
     void writeLO(uint32_t value);
 
+    /**
+     * @brief Direct access to the general-purpose registers for the pre-decoded engine
+     * @note Callers must never write to $zero (index 0)
+     */
+    std::array<uint32_t, NUM_REGISTERS>& data();
+
   private:
     std::array<uint32_t, NUM_REGISTERS> m_registers;
     uint32_t                            m_hi;  // HI register for multiply/divide
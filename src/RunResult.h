@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+
+namespace mips
+{
+
+/**
+ * @brief Why a batched run (Cpu::runFor, MipsSimulatorAPI::runFor/runUntil) returned
+ */
+enum class StopReason : uint8_t
+{
+    Exit,             // The program exited (exit syscall or trap)
+    BudgetExhausted,  // The cycle budget was used up
+    Breakpoint,       // The PC reached the requested stop PC
+    StopRequested,    // The caller's stop flag was raised
+    Fault             // The PC left the program, or execution threw
+};
+
+/**
+ * @brief Outcome of a batched run
+ */
+struct RunResult
+{
+    StopReason reason = StopReason::BudgetExhausted;
+    uint64_t   cycles = 0;  // Cycles spent by this run
+};
+
+/**
+ * @brief Short lower-case name of a stop reason, for messages
+ */
+inline const char* toString(StopReason reason)
+{
+    switch (reason)
+    {
+    case StopReason::Exit:
+        return "exit";
+    case StopReason::BudgetExhausted:
+        return "budget exhausted";
+    case StopReason::Breakpoint:
+        return "breakpoint";
+    case StopReason::StopRequested:
+        return "stop requested";
+    case StopReason::Fault:
+        return "fault";
+    }
+    return "unknown";
+}
+
+}  // namespace mips
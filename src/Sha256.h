@@ -0,0 +1,30 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace mips
+{
+
+/**
+ * @brief SHA-256 (FIPS 180-4) of a byte string
+ *
+ * Used where a fingerprint must not be forgeable, e.g. to name ProgramCache
+ * entries, so two sources can only share an entry if they are the same text.
+ */
+class Sha256
+{
+  public:
+    using Digest = std::array<uint8_t, 32>;
+
+    static Digest digest(std::string_view data);
+
+    /**
+     * @brief The digest as 64 lowercase hexadecimal digits
+     */
+    static std::string hex(const Digest& digest);
+};
+
+}  // namespace mips
@@ -1,9 +1,9 @@
 #include "WBStage.h"
 #include "Cpu.h"
 #include "Instruction.h"
+#include "Log.h"
 #include "RegisterFile.h"
 #include "Stage.h"
-#include <iostream>
 
 namespace mips
 {
@@ -42,6 +42,7 @@ void WBStage::execute()
 
         // Execute the instruction directly
         data.instruction->execute(*m_cpu);
+        m_cpu->retireInstruction();
 
         // For pipeline mode we only want to keep instruction-updated PC when
         // the instruction performed a control-flow change. Most instructions
@@ -50,13 +51,9 @@ void WBStage::execute()
         // to something else (e.g., jr/jal/jalr/branches), leave it.
         uint32_t afterPC = m_cpu->getProgramCounter();
 
-        // Targeted logging for the loop region to help debug unexpected jumps
-        if (savedPC >= 30 && savedPC <= 140)
-        {
-            std::cerr << "DEBUG: WBStage exec - instr='"
-                      << (data.instruction ? data.instruction->getName() : "<null>")
-                      << "' savedPC=" << savedPC << " afterPC=" << afterPC << std::endl;
-        }
+        MIPS_LOG(Pipeline, Trace,
+                 "WB exec instr='" << data.instruction->getName() << "' savedPC=" << savedPC
+                                   << " afterPC=" << afterPC);
 
         if (afterPC == savedPC + 1)
         {
@@ -65,10 +62,10 @@ void WBStage::execute()
         }
         else
         {
-            // Control-flow change detected - log for debugging
-            std::cerr << "DEBUG: WBStage control-flow - instr='"
-                      << (data.instruction ? data.instruction->getName() : "<null>")
-                      << "' savedPC=" << savedPC << " afterPC=" << afterPC << std::endl;
+            // Control-flow change: keep the PC written by the instruction
+            MIPS_LOG(Pipeline, Debug,
+                     "WB control-flow instr='" << data.instruction->getName() << "' savedPC="
+                                               << savedPC << " afterPC=" << afterPC);
         }
     }
 
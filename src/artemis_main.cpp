@@ -1,4 +1,5 @@
 #include "MipsSimulatorAPI.h"
+#include <cstdlib>
 #include <fstream>
 #include <iostream>
 #include <sstream>
@@ -57,7 +58,7 @@ bool runInteractiveMode(mips::MipsSimulatorAPI& api)
             }
 
             std::cout << "Running program...\n";
-            int cycles = api.run(1000);  // Max 1000 cycles
+            uint64_t cycles = api.run(1000);  // Max 1000 cycles
             std::cout << "Program completed in " << cycles << " cycles.\n";
 
             // Show console output if any
@@ -85,8 +86,8 @@ bool runInteractiveMode(mips::MipsSimulatorAPI& api)
     return true;
 }
 
-bool runFile(mips::MipsSimulatorAPI& api, const std::string& filename, bool stepMode, int maxCycles,
-             bool verbose)
+bool runFile(mips::MipsSimulatorAPI& api, const std::string& filename, bool stepMode,
+             uint64_t maxCycles, bool verbose)
 {
     if (verbose)
     {
@@ -139,7 +140,7 @@ bool runFile(mips::MipsSimulatorAPI& api, const std::string& filename, bool step
             std::cout << "Running program...\n";
         }
 
-        int cycles = api.run(maxCycles);
+        uint64_t cycles = api.run(maxCycles);
 
         if (verbose)
         {
@@ -175,7 +176,7 @@ int main(int argc, char* argv[])
     bool        interactive = false;
     bool        stepMode    = false;
     bool        verbose     = false;
-    int         maxCycles   = 10000;
+    uint64_t    maxCycles   = 10000;
     std::string filename;
 
     for (int i = 1; i < argc; ++i)
@@ -203,7 +204,7 @@ int main(int argc, char* argv[])
         {
             if (i + 1 < argc)
             {
-                maxCycles = std::atoi(argv[++i]);
+                maxCycles = std::strtoull(argv[++i], nullptr, 10);
             }
             else
             {
@@ -1,5 +1,5 @@
 #include "ImGuiMipsSimulatorGUI.h"
-#include "../Assembler.h"
+#include "../AssemblySession.h"
 #include "../Cpu.h"
 #include "../Memory.h"
 #include "../RegisterFile.h"
@@ -38,9 +38,9 @@ ImGuiMipsSimulatorGUI::ImGuiMipsSimulatorGUI(bool headless)
     memset(m_codeBuffer, 0, sizeof(m_codeBuffer));
 
     // Initialize components
-    m_cpu       = std::make_unique<Cpu>();
-    m_memory    = std::make_unique<Memory>();
-    m_assembler = std::make_unique<Assembler>();
+    m_cpu     = std::make_unique<Cpu>();
+    m_memory  = std::make_unique<Memory>();
+    m_session = std::make_unique<AssemblySession>();
 
     // Connect CPU and Memory
     if (m_cpu && m_memory)
@@ -471,7 +471,7 @@ void ImGuiMipsSimulatorGUI::renderConsoleOutput()
 
 void ImGuiMipsSimulatorGUI::executeCode()
 {
-    if (!m_assembler || !m_cpu)
+    if (!m_session || !m_cpu)
     {
         appendConsoleOutput("Error: Simulator not properly initialized\n");
         return;
@@ -492,8 +492,8 @@ void ImGuiMipsSimulatorGUI::executeCode()
         // Reset CPU state before execution
         m_cpu->reset();
 
-        // Load and execute the program
-        m_cpu->loadProgramFromString(code);
+        // Load and execute the program; only lines edited since the last run are parsed
+        m_cpu->loadAssembledProgram(m_session->update(code));
 
         // Run until program terminates or max cycles reached
         int maxCycles = 1000;  // Prevent infinite loops
@@ -544,7 +544,7 @@ void ImGuiMipsSimulatorGUI::stepExecution()
         {
             // First step - load the program
             m_cpu->reset();
-            m_cpu->loadProgramFromString(code);
+            m_cpu->loadAssembledProgram(m_session->update(code));
             appendConsoleOutput("Program loaded. Ready to execute.\n");
         }
 
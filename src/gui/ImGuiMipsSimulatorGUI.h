@@ -17,7 +17,7 @@ namespace mips
 // Forward declarations
 class Cpu;
 class Memory;
-class Assembler;
+class AssemblySession;
 
 /**
  * @brief Dear ImGui implementation of MIPS Simulator GUI
@@ -89,9 +89,9 @@ class ImGuiMipsSimulatorGUI : public MipsSimulatorGUI
     std::string m_consoleOutput;
 
     // Components
-    std::unique_ptr<Cpu>       m_cpu;
-    std::unique_ptr<Memory>    m_memory;
-    std::unique_ptr<Assembler> m_assembler;
+    std::unique_ptr<Cpu>             m_cpu;
+    std::unique_ptr<Memory>          m_memory;
+    std::unique_ptr<AssemblySession> m_session;  // Reassembles only the edited lines
 
     // Style and appearance
     void setupImGuiStyle();
@@ -1,4 +1,5 @@
 #include "MipsSimulatorGUI.h"
+#include "../AssemblySession.h"
 #include "../Cpu.h"
 #include "../Memory.h"
 #include "../RegisterFile.h"
@@ -75,6 +76,9 @@ class MipsSimulatorGUI::Impl
     // Breakpoints
     std::set<int> m_breakpoints;
 
+    // Keeps the loaded program assembled, so a reload parses only the edited lines
+    AssemblySession m_session;
+
     // Callbacks
     std::function<void(int, uint32_t)>      m_onRegisterChanged;
     std::function<void(uint32_t, uint32_t)> m_onMemoryChanged;
@@ -554,7 +558,7 @@ bool MipsSimulatorGUI::loadProgram(const std::string& program)
 {
     try
     {
-        m_cpu->loadProgramFromString(program);
+        m_cpu->loadAssembledProgram(m_impl->m_session.update(program));
         setCodeEditorText(program);
         clearErrorMessages();
         addConsoleText("Program loaded successfully", "green");
@@ -0,0 +1,36 @@
+#include "../src/DecodedInstruction.h"
+#include "../src/InstructionDecoder.h"
+#include <chrono>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+using namespace mips;
+
+TEST(InstructionDecoderBenchmark, DecodeRange)
+{
+    // A mix of every format, repeated to 4M words (16MB of text)
+    const uint32_t pattern[] = {0x012A4020, 0x20080005, 0xAFA8FFF8, 0x8FA8FFFC, 0x1500FFFE,
+                                0x08000002, 0x000840C0, 0x01200008, 0x0000000C, 0x6800000A,
+                                0x3508FFFF, 0x0109001A, 0x00004012, 0x0C000010, 0x60080123};
+    std::vector<uint32_t> words(4u << 20);
+    for (size_t i = 0; i < words.size(); ++i)
+    {
+        words[i] = pattern[i % std::size(pattern)];
+    }
+    std::vector<DecodedInstr> records(words.size());
+
+    constexpr int ROUNDS = 5;
+    const auto    start  = std::chrono::steady_clock::now();
+    for (int round = 0; round < ROUNDS; ++round)
+    {
+        ASSERT_EQ(InstructionDecoder::decodeRange(words, records), words.size());
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    const double wordsPerSecond = words.size() * ROUNDS / elapsed.count();
+    RecordProperty("decode_mwords_per_second", static_cast<int>(wordsPerSecond / 1e6));
+    std::cout << "decodeRange: " << static_cast<int>(wordsPerSecond / 1e6) << "M words/s"
+              << std::endl;
+}
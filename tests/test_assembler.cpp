@@ -0,0 +1,403 @@
+#include "Assembler.h"
+#include "DecodedInstruction.h"
+#include "Instruction.h"
+#include "MappedFile.h"
+#include "MipsSimulatorAPI.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#if MIPSIM_MMAP_AVAILABLE
+#include <sys/stat.h>
+#endif
+
+namespace
+{
+
+struct Assembled
+{
+    std::vector<std::unique_ptr<mips::Instruction>> instructions;
+    std::vector<mips::DataDirective>                dataDirectives;
+    std::map<std::string, uint32_t>                 labelMap;
+};
+
+Assembled assemble(const std::string& source)
+{
+    mips::Assembler assembler;
+    Assembled       result;
+    result.instructions =
+        assembler.assembleWithLabels(source, result.labelMap, result.dataDirectives);
+    return result;
+}
+
+// Ten instructions of mixed formats per loop, with a forward and a backward reference
+std::string generateSource(size_t lines)
+{
+    std::string source;
+    source.reserve(lines * 24);
+    for (size_t i = 0; source.size() < lines * 24 && i * 11 < lines; ++i)
+    {
+        const std::string label = "l" + std::to_string(i);
+        source += label + ":\n";
+        source += "addi $t0, $t0, " + std::to_string(i % 1000) + "\n";
+        source += "add $t1, $t0, $t2\n";
+        source += "lw $t2, 8($sp)\n";
+        source += "sw $t2, -4($sp)  # spill\n";
+        source += "sll $t3, $t1, 2\n";
+        source += "ori $t4, $t3, 0xFF\n";
+        source += "bne $t0, $t1, " + label + "\n";
+        source += "beq $t0, $zero, l" + std::to_string(i + 1) + "\n";
+        source += "mflo $t5\n";
+        source += "jal " + label + "\n";
+    }
+    return source;
+}
+
+// Every kind of statement the replay has to place: section switches, data mixed into
+// the text, labels alone on their line, lines and directives that do not parse, and
+// instructions that land in the data section and must be ignored
+std::string generateMixedSource(size_t blocks)
+{
+    std::string source = ".globl main\nmain:\n";
+    for (size_t i = 0; i < blocks; ++i)
+    {
+        const std::string n = std::to_string(i);
+        source += "f" + n + ": addi $a0, $zero, " + std::to_string(i % 500) + "\n";
+        source += "la $t0, d" + n + "\n";
+        source += "lw $t1, 4($t0)\n";
+        source += "bogus $t0, $t1\n";
+        source += "g" + n + ":\n";
+        source += "bne $t1, $zero, f" + std::to_string(i / 2) + "\n";
+        source += "jal f" + std::to_string((i * 7) % blocks) + "\n";
+        if (i % 3 == 0)
+        {
+            source += ".data\nd" + n + ": .word " + n + ", -1\n";
+            source += "lost" + n + ": .byte 999\n";
+            source += "add $t0, $t0, $t0\n";  // In the data section: ignored
+            source += "s" + n + ": .asciiz \"block " + n + "\"\n.text\n";
+        }
+        else
+        {
+            source += "d" + n + ": .byte 1, 2, 3\n";  // Switches to data until the next .text
+            source += "sll $t0, $t0, 2\n.text\n";
+        }
+    }
+    return source + "jr $ra\nend:\n";
+}
+
+double secondsToAssemble(const std::string& source, size_t& count)
+{
+    const auto start = std::chrono::steady_clock::now();
+    Assembled  program;
+    program.instructions =
+        mips::Assembler().assembleWithLabels(source, program.labelMap, program.dataDirectives);
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    count                                       = program.instructions.size();
+    return elapsed.count();
+}
+
+}  // namespace
+
+TEST(AssemblerTest, LexesCompactOperandsInlineLabelsAndComments)
+{
+    Assembled program = assemble("main: addi $t0,$zero,5   # count: five\n"
+                                 "loop :\n"
+                                 "lw $t1, 4 ($sp)\n"
+                                 "sw $t1,+8($sp)\n"
+                                 "lb $t2, ($sp)\n"
+                                 "bne $t0,$zero,loop\n"
+                                 "msg: .asciiz \"a: b # c\"\n"
+                                 "bytes: .byte 1,2,0x10\n");
+
+    ASSERT_EQ(program.instructions.size(), 5u);
+    EXPECT_EQ(program.labelMap.at("main"), 0u);
+    EXPECT_EQ(program.labelMap.at("loop"), 4u);
+    EXPECT_EQ(program.labelMap.at("msg"), 20u);
+    EXPECT_EQ(program.labelMap.at("bytes"), 32u);  // "a: b # c\0" padded to 12 bytes
+
+    mips::DecodedInstr decoded;
+    ASSERT_TRUE(program.instructions[0]->lower(decoded));
+    EXPECT_EQ(decoded.imm, 5u);
+    ASSERT_TRUE(program.instructions[1]->lower(decoded));
+    EXPECT_EQ(decoded.imm, 4u);
+    ASSERT_TRUE(program.instructions[2]->lower(decoded));
+    EXPECT_EQ(decoded.imm, 8u);
+
+    ASSERT_EQ(program.dataDirectives.size(), 2u);
+    const std::string text(program.dataDirectives[0].bytes.begin(),
+                           program.dataDirectives[0].bytes.end());
+    EXPECT_EQ(text, std::string("a: b # c\0", 9));
+    EXPECT_EQ(program.dataDirectives[1].bytes, (std::vector<uint8_t>{1, 2, 16}));
+}
+
+TEST(AssemblerTest, DataSectionStartsAfterTheText)
+{
+    Assembled program = assemble(".globl main\n"
+                                 ".text\n"
+                                 "main:\n"
+                                 "la $a0, table\n"
+                                 "bogus $t0\n"  // Dropped without taking an address
+                                 "lw $t0, 0($a0)\n"
+                                 ".data\n"
+                                 "table:\n"
+                                 ".word 1, -2, 010\n"
+                                 "skipped:\n"
+                                 ".byte 300\n"
+                                 "after:\n"
+                                 ".asciiz \"x\"\n"
+                                 ".text\n"
+                                 "tail:\n"
+                                 "jr $ra\n"
+                                 "end:\n");
+
+    ASSERT_EQ(program.instructions.size(), 3u);
+    EXPECT_EQ(program.labelMap.at("main"), 0u);
+    EXPECT_EQ(program.labelMap.at("tail"), 8u);
+    EXPECT_EQ(program.labelMap.at("end"), 12u);
+    EXPECT_EQ(program.labelMap.at("table"), 12u);
+    EXPECT_EQ(program.labelMap.at("after"), 24u);
+    EXPECT_EQ(program.labelMap.count("skipped"), 0u);  // Its directive is invalid
+
+    ASSERT_EQ(program.dataDirectives.size(), 2u);
+    EXPECT_EQ(program.dataDirectives[0].address, 12u);
+    EXPECT_EQ(program.dataDirectives[0].words, (std::vector<uint32_t>{1, 0xFFFFFFFE, 8}));
+    EXPECT_EQ(program.dataDirectives[1].address, 24u);
+}
+
+TEST(AssemblerTest, EveryMnemonicAndRegisterIsFound)
+{
+    const char* const lines[] = {
+        "add $t0, $t1, $t2", "addu $t0, $t1, $t2", "sub $t0, $t1, $t2", "subu $t0, $t1, $t2",
+        "and $t0, $t1, $t2", "or $t0, $t1, $t2",   "xor $t0, $t1, $t2", "nor $t0, $t1, $t2",
+        "slt $t0, $t1, $t2", "sltu $t0, $t1, $t2", "sllv $t0, $t1, $t2", "srlv $t0, $t1, $t2",
+        "srav $t0, $t1, $t2", "sll $t0, $t1, 3",   "srl $t0, $t1, 3",   "sra $t0, $t1, 3",
+        "mult $t0, $t1",     "multu $t0, $t1",     "div $t0, $t1",      "divu $t0, $t1",
+        "mfhi $t0",          "mthi $t0",           "mflo $t0",          "mtlo $t0",
+        "addi $t0, $t1, 1",  "addiu $t0, $t1, 1",  "andi $t0, $t1, 1",  "ori $t0, $t1, 1",
+        "xori $t0, $t1, 1",  "sltiu $t0, $t1, 1",  "llo $t0, 1",        "lhi $t0, 1",
+        "lw $t0, 4($sp)",    "sw $t0, 4($sp)",     "lb $t0, 4($sp)",    "lbu $t0, 4($sp)",
+        "lh $t0, 4($sp)",    "lhu $t0, 4($sp)",    "sb $t0, 4($sp)",    "sh $t0, 4($sp)",
+        "beq $t0, $t1, x",   "bne $t0, $t1, x",    "blez $t0, x",       "bgtz $t0, x",
+        "j x",               "jal x",              "jr $ra",            "jalr $t0",
+        "la $t0, x",         "syscall",            "trap 10",           "slti $t0, $t1, 1",
+    };
+    for (const char* line : lines)
+    {
+        EXPECT_EQ(mips::Assembler().assemble(line).size(), 1u) << line;
+    }
+
+    const char* const registers[] = {
+        "$zero", "$at", "$v0", "$v1", "$a0", "$a1", "$a2", "$a3", "$t0", "$t1", "$t2",
+        "$t3",   "$t4", "$t5", "$t6", "$t7", "$s0", "$s1", "$s2", "$s3", "$s4", "$s5",
+        "$s6",   "$s7", "$t8", "$t9", "$k0", "$k1", "$gp", "$sp", "$fp", "$ra",
+    };
+    for (const char* name : registers)
+    {
+        EXPECT_EQ(mips::Assembler().assemble(std::string("mfhi ") + name).size(), 1u) << name;
+    }
+
+    // Near misses of real names must not hash onto them
+    for (const char* line : {"addx $t0, $t1, $t2", "ad $t0, $t1, $t2", "Add $t0, $t1, $t2",
+                             "mfhi $t10", "mfhi $", "mfhi t0", "mfhi $ra2", "syscal", "lax $t0, x"})
+    {
+        EXPECT_TRUE(mips::Assembler().assemble(line).empty()) << line;
+    }
+}
+
+TEST(AssemblerTest, AssemblesAMappedFileInPlace)
+{
+    // No newline at the end: the last line ends at the end of the mapping
+    std::string source = generateMixedSource(300);
+    source.pop_back();
+    const std::filesystem::path path =
+        std::filesystem::temp_directory_path() / "mipsim_mapped_source.asm";
+    std::ofstream(path, std::ios::binary) << source;
+
+    Assembled mapped;
+    {
+        mips::MappedFile file;
+        std::string      error;
+        ASSERT_TRUE(file.open(path.string(), error)) << error;
+        ASSERT_EQ(file.view(), source);
+        mapped.instructions = mips::Assembler().assembleWithLabels(file.view(), mapped.labelMap,
+                                                                   mapped.dataDirectives);
+    }
+
+    // Nothing refers to the mapping once it is gone
+    const Assembled copied = assemble(source);
+    EXPECT_EQ(mapped.labelMap, copied.labelMap);
+    ASSERT_EQ(mapped.instructions.size(), copied.instructions.size());
+    EXPECT_EQ(mapped.dataDirectives.size(), copied.dataDirectives.size());
+    EXPECT_TRUE(mapped.labelMap.count("end"));
+
+    mips::MipsSimulatorAPI simulator;
+    EXPECT_TRUE(simulator.loadProgramFromFile(path.string())) << simulator.getLastError();
+    EXPECT_FALSE(simulator.loadProgramFromFile(path.string() + ".missing"));
+    std::filesystem::remove(path);
+}
+
+#if MIPSIM_MMAP_AVAILABLE
+TEST(AssemblerTest, ReadsSourcesThatCannotBeMapped)
+{
+    // A FIFO, as `mipsim run <(gen.sh)` passes: no size, and only readable once
+    const std::filesystem::path path =
+        std::filesystem::temp_directory_path() / "mipsim_fifo_source.asm";
+    std::filesystem::remove(path);
+    ASSERT_EQ(::mkfifo(path.c_str(), 0600), 0);
+    auto write = [&](const std::string& text)
+    { return std::thread([&path, text] { std::ofstream(path, std::ios::binary) << text; }); };
+
+    const std::string source = generateMixedSource(300);
+    std::thread       writer = write(source);
+    {
+        mips::MappedFile file;
+        std::string      error;
+        EXPECT_TRUE(file.open(path.string(), error)) << error;
+        EXPECT_EQ(file.view(), source);
+    }
+    writer.join();
+
+    writer = write("addi $a0, $zero, 70\n"
+                   "addi $v0, $zero, 11\n"
+                   "syscall\n"
+                   "addi $v0, $zero, 10\n"
+                   "syscall\n");
+    mips::MipsSimulatorAPI simulator;
+    EXPECT_TRUE(simulator.loadProgramFromFile(path.string())) << simulator.getLastError();
+    writer.join();
+    simulator.runFor(100);
+    EXPECT_EQ(simulator.getConsoleOutput(), "F");
+    std::filesystem::remove(path);
+
+    // A regular file that reports a size of 0
+    mips::MappedFile status;
+    std::string      error;
+    ASSERT_TRUE(status.open("/proc/self/status", error)) << error;
+    EXPECT_NE(status.view().find("Name:"), std::string_view::npos);
+}
+#endif
+
+TEST(AssemblerTest, ListsTheLinesItSkips)
+{
+    auto skipped = [](const std::string& source, unsigned jobs)
+    {
+        mips::Assembler                  assembler(jobs);
+        mips::LabelMap                   labelMap;
+        std::vector<mips::DataDirective> dataDirectives;
+        assembler.assembleWithLabels(source, labelMap, dataDirectives);
+        return assembler.skippedLines();
+    };
+
+    EXPECT_EQ(skipped("start: addi $t0, $t0, 1\n"
+                      "bogus $t0\n"
+                      "\n"
+                      "# comment\n"
+                      "addi $t0, $t0\n"
+                      ".data\n"
+                      "also bogus\n",  // In the data section: ignored
+                      1),
+              (std::vector<size_t>{2, 5}));
+    EXPECT_EQ(mips::Assembler::describeSkippedLines({2, 5}),
+              "skipped lines that did not parse: 2, 5");
+    EXPECT_EQ(mips::Assembler::describeSkippedLines({}), "");
+
+    // Line numbers carry across the chunks of a parallel assembly
+    std::string  source = generateSource(200000);
+    const size_t lines  = std::count(source.begin(), source.end(), '\n');
+    source += "addi $t0, $t0, 1\nbogus\n";
+    ASSERT_GT(source.size(), 2u << 20);
+    EXPECT_EQ(skipped(source, 1), (std::vector<size_t>{lines + 2}));
+    EXPECT_EQ(skipped(source, 4), (std::vector<size_t>{lines + 2}));
+}
+
+TEST(AssemblerTest, AcceptsSemicolonCommentsAndAByteOrderMark)
+{
+    Assembled program = assemble("\xEF\xBB\xBF"  // Byte order mark
+                                 "addi $t0, $zero, 1\n"
+                                 "label1:         ; comment, as some assemblers write them\n"
+                                 "slti $t1, $t0, 10 ; set if less\n"
+                                 ".data\n"
+                                 "text: .asciiz \"a;b#c\"  ; not part of the string\n");
+
+    ASSERT_EQ(program.instructions.size(), 2u);
+    EXPECT_EQ(program.instructions[1]->getName(), "slti");
+    EXPECT_EQ(program.labelMap.at("label1"), 4u);
+    ASSERT_EQ(program.dataDirectives.size(), 1u);
+    EXPECT_EQ(program.dataDirectives[0].bytes, (std::vector<uint8_t>{'a', ';', 'b', '#', 'c', 0}));
+}
+
+TEST(AssemblerThroughputTest, MillionLineAssemblyIsLinear)
+{
+    const std::string small = generateSource(100000);
+    const std::string large = generateSource(1000000);
+
+    size_t       smallCount = 0;
+    size_t       largeCount = 0;
+    const double smallTime  = secondsToAssemble(small, smallCount);
+    const double largeTime  = secondsToAssemble(large, largeCount);
+    EXPECT_GT(smallCount, 90000u);
+    EXPECT_GT(largeCount, 900000u);
+
+    const double linesPerSecond = 1000000 / largeTime;
+    RecordProperty("assemble_klines_per_second", static_cast<int>(linesPerSecond / 1e3));
+    std::cout << "assembleWithLabels: " << static_cast<int>(linesPerSecond / 1e3)
+              << "K lines/s, 1M lines in " << largeTime << "s" << std::endl;
+
+    // Ten times the source should take about ten times as long; a quadratic pass
+    // would take a hundred
+    EXPECT_LT(largeTime, smallTime * 30);
+}
+
+TEST(AssemblerThroughputTest, ParallelAssemblyMatchesSerial)
+{
+    const std::string source = generateMixedSource(20000);
+    ASSERT_GT(source.size(), 2u << 20);  // Well past the parallel threshold
+
+    auto build = [&](unsigned jobs, double& seconds)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        Assembled  program;
+        program.instructions = mips::Assembler(jobs).assembleWithLabels(source, program.labelMap,
+                                                                        program.dataDirectives);
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        mips::Assembler::link(program.instructions, program.labelMap);
+
+        // Everything the assembler produced, in a form that compares as a whole
+        std::ostringstream dump;
+        for (const auto& [name, address] : program.labelMap)
+        {
+            dump << name << '=' << address << '\n';
+        }
+        for (const mips::DataDirective& directive : program.dataDirectives)
+        {
+            dump << directive.type << '@' << directive.address << ':' << directive.words.size()
+                 << ':' << std::string(directive.bytes.begin(), directive.bytes.end()) << '\n';
+        }
+        for (const auto& instruction : program.instructions)
+        {
+            mips::DecodedInstr decoded;
+            EXPECT_TRUE(instruction->lower(decoded));
+            dump << static_cast<int>(decoded.op) << ' ' << int{decoded.rd} << ' '
+                 << int{decoded.rs} << ' ' << int{decoded.rt} << ' ' << decoded.imm << ' '
+                 << decoded.target << '\n';
+        }
+        return dump.str();
+    };
+
+    double            serialTime   = 0;
+    double            parallelTime = 0;
+    const std::string serial       = build(1, serialTime);
+    EXPECT_EQ(build(4, parallelTime), serial);
+    EXPECT_EQ(build(3, parallelTime), serial);
+    EXPECT_EQ(build(0, parallelTime), serial);
+
+    std::cout << "assembleWithLabels: " << source.size() / 1024 << " KiB in " << serialTime
+              << "s serial, " << parallelTime << "s on " << std::thread::hardware_concurrency()
+              << " threads" << std::endl;
+}
@@ -0,0 +1,249 @@
+#include "AssemblySession.h"
+#include "Cpu.h"
+#include "Instruction.h"
+#include "RegisterFile.h"
+#include <chrono>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+
+namespace
+{
+
+// Everything a program consists of, in a form that compares as a whole
+std::string dump(const std::vector<std::unique_ptr<mips::Instruction>>& instructions,
+                 const mips::LabelMap&                                  labelMap,
+                 const std::vector<mips::DataDirective>&                dataDirectives)
+{
+    std::ostringstream out;
+    for (const auto& [name, address] : labelMap)
+    {
+        out << name << '=' << address << '\n';
+    }
+    for (const mips::DataDirective& directive : dataDirectives)
+    {
+        out << directive.type << '@' << directive.address << ':' << directive.words.size() << ':'
+            << std::string(directive.bytes.begin(), directive.bytes.end()) << '\n';
+    }
+    for (const auto& instruction : instructions)
+    {
+        mips::DecodedInstr decoded;
+        const bool         lowered = instruction->lower(decoded);
+        out << instruction->getName() << ' ' << lowered << ' ' << static_cast<int>(decoded.op)
+            << ' ' << int{decoded.rd} << ' ' << int{decoded.rs} << ' ' << int{decoded.rt} << ' '
+            << decoded.imm << ' ' << decoded.target << '\n';
+    }
+    return out.str();
+}
+
+std::string dump(const mips::AssembledProgram& program)
+{
+    return dump(*program.instructions, program.labelMap, program.dataDirectives);
+}
+
+// Assemble from scratch; error receives link()'s message, if any
+std::string assembleFresh(const std::string& source, std::string& error)
+{
+    mips::Assembler                  assembler;
+    mips::LabelMap                   labelMap;
+    std::vector<mips::DataDirective> dataDirectives;
+    auto instructions = assembler.assembleWithLabels(source, labelMap, dataDirectives);
+    error.clear();
+    try
+    {
+        mips::Assembler::link(instructions, labelMap);
+    }
+    catch (const std::runtime_error& e)
+    {
+        error = e.what();
+    }
+    return dump(instructions, labelMap, dataDirectives);
+}
+
+// A random line: a few shared label names make labels move, repeat and vanish
+std::string randomLine(std::mt19937& rng)
+{
+    static const char* const LABELS[] = {"a", "b", "c", "d"};
+    const std::string        label    = LABELS[rng() % 4];
+    switch (rng() % 12)
+    {
+    case 0:
+        return label + ":";
+    case 1:
+        return label + ": addi $t0, $t0, 1";
+    case 2:
+        return "beq $t0, $t1, " + label;
+    case 3:
+        return "la $a0, " + label;
+    case 4:
+        return "jal " + label;
+    case 5:
+        return label + ": .word 1, 2";
+    case 6:
+        return ".byte 7";
+    case 7:
+        return rng() % 2 ? ".data" : ".text";
+    case 8:
+        return "bogus $t0";
+    case 9:
+        return "lw $t1, 4($sp)  # load";
+    case 10:
+        return "";
+    default:
+        return "add $t2, $t1, $t0";
+    }
+}
+
+std::string randomLines(std::mt19937& rng, size_t count)
+{
+    std::string text;
+    for (size_t i = 0; i < count; ++i)
+    {
+        text += randomLine(rng) + "\n";
+    }
+    return text;
+}
+
+std::string generateProgram(size_t blocks)
+{
+    std::string source;
+    for (size_t i = 0; i < blocks; ++i)
+    {
+        const std::string n = std::to_string(i);
+        source += "f" + n + ": addi $t0, $t0, 1\n";
+        source += "lw $t1, 0($sp)\n";
+        source += "bne $t0, $t1, f" + std::to_string(i / 2) + "\n";
+        source += "jal f" + n + "\n";
+    }
+    return source;
+}
+
+}  // namespace
+
+TEST(AssemblySessionTest, RandomEditsMatchAFreshAssembly)
+{
+    std::mt19937          rng(2024);
+    mips::AssemblySession session;
+
+    for (int round = 0; round < 400; ++round)
+    {
+        const size_t lines = session.lineCount();
+        const size_t first = rng() % (lines + 1);
+        const size_t count = std::min<size_t>(rng() % 4, lines - first);
+        std::string  text  = randomLines(rng, rng() % 5);
+        if (rng() % 8 == 0 && !text.empty())
+        {
+            text.pop_back();  // Runs into the next line
+        }
+
+        std::string sessionError;
+        try
+        {
+            session.edit(first, count, text);
+        }
+        catch (const std::runtime_error& e)
+        {
+            sessionError = e.what();
+        }
+
+        std::string       freshError;
+        const std::string fresh = assembleFresh(session.source(), freshError);
+        ASSERT_EQ(sessionError, freshError) << "round " << round << "\n" << session.source();
+        if (freshError.empty())
+        {
+            ASSERT_EQ(dump(session.program()), fresh) << "round " << round << "\n"
+                                                      << session.source();
+        }
+    }
+}
+
+TEST(AssemblySessionTest, UpdateParsesOnlyTheChangedLines)
+{
+    const std::string     source = generateProgram(2500);
+    mips::AssemblySession session;
+    session.update(source);
+    EXPECT_EQ(session.lineCount(), 10001u);
+    EXPECT_EQ(session.lastParsedLines(), 10001u);
+
+    // One character changed in the middle
+    std::string edited = source;
+    edited.replace(edited.find("f1200: addi $t0, $t0, 1"), 23, "f1200: addi $t0, $t0, 7");
+    const mips::AssembledProgram& program = session.update(edited);
+    EXPECT_EQ(session.lastParsedLines(), 1u);
+
+    std::string error;
+    EXPECT_EQ(dump(program), assembleFresh(edited, error));
+
+    // Inserting a line moves every label after it
+    session.edit(4, 0, "sll $t0, $t0, 1\n");
+    EXPECT_EQ(session.lastParsedLines(), 2u);
+    EXPECT_EQ(session.program().labelMap.at("f1"), 20u);
+    EXPECT_EQ(dump(session.program()), assembleFresh(session.source(), error));
+
+    EXPECT_THROW(session.edit(10003, 0, "nop\n"), std::out_of_range);
+}
+
+TEST(AssemblySessionTest, PublishedProgramsNeverChange)
+{
+    mips::AssemblySession session;
+    session.update("main: la $a0, msg\n"
+                   "j main\n"
+                   "msg: .asciiz \"hi\"\n");
+
+    // A held program (as a Cpu holds it) keeps its instructions and links
+    const mips::AssembledProgram held     = session.program();
+    const std::string            heldDump = dump(held);
+
+    session.edit(0, 0, "addi $t0, $zero, 1\naddi $t1, $zero, 2\n");
+    EXPECT_EQ(dump(held), heldDump);
+    EXPECT_EQ(session.program().labelMap.at("main"), 8u);
+    EXPECT_EQ(session.program().labelMap.at("msg"), 16u);
+
+    // An undefined label is reported like link() does, and fixed by the next edit
+    EXPECT_THROW(session.edit(3, 1, "j start\n"), std::runtime_error);
+    session.edit(0, 0, "start:\n");
+    EXPECT_EQ(session.program().instructions->size(), 4u);
+}
+
+TEST(AssemblySessionTest, CpuRunsTheSessionProgram)
+{
+    mips::AssemblySession session;
+    mips::Cpu             cpu;
+    cpu.loadAssembledProgram(session.update("addi $t0, $zero, 41\n"
+                                            "la $t1, value\n"
+                                            "lw $t2, 0($t1)\n"
+                                            "value: .word 7\n"));
+    cpu.run(3);
+    EXPECT_EQ(cpu.getRegisterFile().read(8), 41u);
+    EXPECT_EQ(cpu.getRegisterFile().read(10), 7u);
+
+    cpu.reset();
+    cpu.loadAssembledProgram(session.edit(0, 1, "addi $t0, $zero, 42\n"));
+    cpu.run(3);
+    EXPECT_EQ(cpu.getRegisterFile().read(8), 42u);
+    EXPECT_EQ(cpu.getRegisterFile().read(10), 7u);
+}
+
+TEST(AssemblySessionTest, OneLineEditIsCheaperThanReassembly)
+{
+    const std::string     source = generateProgram(50000);  // 200K lines
+    mips::AssemblySession session;
+    session.update(source);
+    const auto held = session.program().instructions;  // As a loaded Cpu would
+
+    auto start = std::chrono::steady_clock::now();
+    session.edit(100001, 1, "lw $t1, 8($sp)\n");
+    const std::chrono::duration<double> editTime = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    std::string error;
+    assembleFresh(session.source(), error);
+    const std::chrono::duration<double> fullTime = std::chrono::steady_clock::now() - start;
+
+    std::cout << "AssemblySession: one-line edit of 200K lines in " << editTime.count()
+              << "s (program shared), full reassembly and link in " << fullTime.count() << "s"
+              << std::endl;
+    EXPECT_LT(editTime.count(), fullTime.count());
+}
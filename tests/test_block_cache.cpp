@@ -0,0 +1,84 @@
+#include "BlockCache.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace
+{
+
+mips::DecodedInstr makeOp(mips::DecodedOp op, uint32_t target = 0)
+{
+    mips::DecodedInstr d;
+    d.op     = op;
+    d.target = target;
+    return d;
+}
+
+}  // namespace
+
+TEST(BlockCacheTest, SplitsAtTargetsAndAfterControlFlow)
+{
+    using mips::DecodedOp;
+    // 0: addi  1: addi  2: bne -> 1  3: addi  4: syscall  5: addi  6: jr
+    std::vector<mips::DecodedInstr> program = {
+        makeOp(DecodedOp::Addi),
+        makeOp(DecodedOp::Addi),
+        makeOp(DecodedOp::Bne, 1),
+        makeOp(DecodedOp::Addi),
+        makeOp(DecodedOp::Fallback, 4),
+        makeOp(DecodedOp::Addi),
+        makeOp(DecodedOp::Jr),
+    };
+
+    mips::BlockCache cache;
+    cache.build(program);
+
+    EXPECT_TRUE(cache.isLeader(0));
+    EXPECT_TRUE(cache.isLeader(1));
+    EXPECT_FALSE(cache.isLeader(2));
+    EXPECT_TRUE(cache.isLeader(3));
+    EXPECT_TRUE(cache.isLeader(5));
+    EXPECT_EQ(cache.blockCount(), 0u);
+
+    // Block 0 stops before the branch target at index 1
+    mips::BasicBlock entry = cache.block(cache.blockAt(0));
+    EXPECT_EQ(entry.start, 0u);
+    EXPECT_EQ(entry.length, 1u);
+    EXPECT_EQ(entry.takenTarget, mips::BasicBlock::NO_TARGET);
+
+    mips::BasicBlock loop = cache.block(cache.blockAt(1));
+    EXPECT_EQ(loop.length, 2u);
+    EXPECT_EQ(loop.takenTarget, 1u);
+    EXPECT_FALSE(loop.endsInFallback);
+
+    mips::BasicBlock syscall = cache.block(cache.blockAt(3));
+    EXPECT_EQ(syscall.length, 2u);
+    EXPECT_TRUE(syscall.endsInFallback);
+
+    mips::BasicBlock tail = cache.block(cache.blockAt(5));
+    EXPECT_EQ(tail.length, 2u);
+    EXPECT_EQ(tail.takenTarget, mips::BasicBlock::NO_TARGET);
+}
+
+TEST(BlockCacheTest, BlocksAreCachedAndFormedOnDemand)
+{
+    using mips::DecodedOp;
+    std::vector<mips::DecodedInstr> program = {
+        makeOp(DecodedOp::Addi),
+        makeOp(DecodedOp::Addi),
+        makeOp(DecodedOp::Addi),
+    };
+
+    mips::BlockCache cache;
+    cache.build(program);
+
+    int32_t first = cache.blockAt(0);
+    EXPECT_EQ(cache.blockAt(0), first);
+    EXPECT_EQ(cache.block(first).length, 3u);
+
+    // An indirect entry into the middle forms its own block
+    int32_t middle = cache.blockAt(1);
+    EXPECT_NE(middle, first);
+    EXPECT_EQ(cache.block(middle).start, 1u);
+    EXPECT_EQ(cache.block(middle).length, 2u);
+    EXPECT_EQ(cache.blockCount(), 2u);
+}
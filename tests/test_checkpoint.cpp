@@ -0,0 +1,216 @@
+#include "../cli/cli.hpp"
+#include "../cli/run_executor.hpp"
+#include "Checkpoint.h"
+#include "Cpu.h"
+#include "Memory.h"
+#include "MipsSimulatorAPI.h"
+#include "RegisterFile.h"
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <iterator>
+#include <sstream>
+#include <string>
+
+namespace
+{
+
+// Fills 64 heap words with a running sum, multiplies in HI/LO and prints the total
+const std::string SUM_PROGRAM = "addi $a0, $zero, 256\n"
+                                "addi $v0, $zero, 9\n"
+                                "syscall\n"
+                                "add $s0, $v0, $zero\n"
+                                "addi $t0, $zero, 0\n"
+                                "addi $t1, $zero, 0\n"
+                                "addi $t2, $zero, 64\n"
+                                "loop:\n"
+                                "add $t1, $t1, $t0\n"
+                                "sw $t1, 0($s0)\n"
+                                "addi $s0, $s0, 4\n"
+                                "addi $t0, $t0, 1\n"
+                                "bne $t0, $t2, loop\n"
+                                "mult $t1, $t2\n"
+                                "mflo $a0\n"
+                                "addi $v0, $zero, 1\n"
+                                "syscall\n"
+                                "addi $v0, $zero, 10\n"
+                                "syscall\n";
+
+std::string checkpointOf(const mips::Cpu& cpu, const std::string& source)
+{
+    std::ostringstream out;
+    mips::Checkpoint::write(out, cpu.snapshot(), mips::Checkpoint::fingerprint(source));
+    return out.str();
+}
+
+bool readCheckpoint(const std::string& bytes, mips::CpuSnapshot& state, std::string& error)
+{
+    std::istringstream in(bytes);
+    uint64_t           fingerprint = 0;
+    return mips::Checkpoint::read(in, state, fingerprint, error);
+}
+
+}  // namespace
+
+TEST(CheckpointTest, ResumedRunIsBitExact)
+{
+    mips::Cpu reference;
+    reference.loadProgramFromString(SUM_PROGRAM);
+    reference.runFor(UINT64_MAX);
+
+    mips::Cpu first;
+    first.loadProgramFromString(SUM_PROGRAM);
+    first.runFor(150);
+    const std::string bytes = checkpointOf(first, SUM_PROGRAM);
+
+    mips::CpuSnapshot state;
+    std::string       error;
+    ASSERT_TRUE(readCheckpoint(bytes, state, error)) << error;
+    EXPECT_EQ(state.cycleCount, 150u);
+
+    mips::Cpu resumed;
+    resumed.loadProgramFromString(SUM_PROGRAM);
+    resumed.restore(state);
+    EXPECT_EQ(resumed.runFor(UINT64_MAX).reason, mips::StopReason::Exit);
+
+    EXPECT_EQ(resumed.getConsoleOutput(), reference.getConsoleOutput());
+    EXPECT_EQ(resumed.getCycleCount(), reference.getCycleCount());
+    EXPECT_EQ(resumed.getRetiredInstructionCount(), reference.getRetiredInstructionCount());
+    EXPECT_EQ(resumed.getRegisterFile().data(), reference.getRegisterFile().data());
+    EXPECT_EQ(resumed.getRegisterFile().readLO(), reference.getRegisterFile().readLO());
+    for (uint32_t offset = 0; offset < 256; offset += 4)
+    {
+        EXPECT_EQ(resumed.getMemory().readWord(mips::Memory::HEAP_BASE + offset),
+                  reference.getMemory().readWord(mips::Memory::HEAP_BASE + offset));
+    }
+
+    // Writing the resumed state again reproduces the reference byte for byte
+    EXPECT_EQ(checkpointOf(resumed, SUM_PROGRAM), checkpointOf(reference, SUM_PROGRAM));
+}
+
+TEST(CheckpointTest, StoresOnlyNonZeroTouchedPages)
+{
+    mips::Cpu cpu;
+    cpu.getMemory().writeWord(0x00400000, 7);
+    cpu.getMemory().writeWord(0x7FFF0000, 0);  // Dirty but still all zeros
+    const size_t size = checkpointOf(cpu, "").size();
+    EXPECT_LT(size, 2 * mips::Memory::PAGE_SIZE);
+
+    mips::CpuSnapshot state;
+    std::string       error;
+    ASSERT_TRUE(readCheckpoint(checkpointOf(cpu, ""), state, error)) << error;
+    EXPECT_EQ(state.memory->dirtyPageCount(), 1u);
+    EXPECT_EQ(state.memory->readWord(0x00400000), 7u);
+}
+
+TEST(CheckpointTest, RejectsDamagedData)
+{
+    mips::Cpu cpu;
+    cpu.loadProgramFromString(SUM_PROGRAM);
+    cpu.runFor(40);
+    const std::string bytes = checkpointOf(cpu, SUM_PROGRAM);
+
+    mips::CpuSnapshot state;
+    std::string       error;
+
+    EXPECT_FALSE(readCheckpoint("hello", state, error));
+    EXPECT_EQ(error, "not a checkpoint file");
+
+    std::string corrupt = bytes;
+    corrupt[bytes.size() / 2] ^= 0x01;
+    EXPECT_FALSE(readCheckpoint(corrupt, state, error));
+    EXPECT_NE(error.find("checksum"), std::string::npos);
+
+    std::string future = bytes;
+    future[8]          = 2;  // Version field
+    EXPECT_FALSE(readCheckpoint(future, state, error));
+    EXPECT_NE(error.find("version 2"), std::string::npos);
+}
+
+TEST(CheckpointTest, ApiRejectsCheckpointOfAnotherProgram)
+{
+    auto path = std::filesystem::temp_directory_path() / "mipsim_checkpoint_api_test.ckpt";
+
+    mips::MipsSimulatorAPI api;
+    ASSERT_TRUE(api.loadProgram(SUM_PROGRAM));
+    api.runFor(100);
+    ASSERT_TRUE(api.saveCheckpoint(path.string())) << api.getLastError();
+
+    mips::MipsSimulatorAPI other;
+    ASSERT_TRUE(other.loadProgram("addi $t0, $zero, 1\n"));
+    EXPECT_FALSE(other.loadCheckpoint(path.string()));
+    EXPECT_NE(other.getLastError().find("different program"), std::string::npos);
+
+    mips::MipsSimulatorAPI same;
+    ASSERT_TRUE(same.loadProgram(SUM_PROGRAM));
+    ASSERT_TRUE(same.loadCheckpoint(path.string())) << same.getLastError();
+    EXPECT_EQ(same.getCycleCount(), 100u);
+
+    std::filesystem::remove(path);
+}
+
+TEST(CheckpointTest, RunCommandResumesFromCheckpointDirectory)
+{
+    auto dir = std::filesystem::temp_directory_path() / "mipsim_checkpoint_cli_test";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    {
+        std::ofstream file(dir / "sum.asm");
+        file << SUM_PROGRAM;
+    }
+
+    // A run cut short by --limit leaves its last checkpoint behind
+    cli::RunConfig config;
+    config.program          = (dir / "sum.asm").string();
+    config.limit            = 250;
+    config.checkpoint_every = 100;
+    config.checkpoint_dir   = (dir / "ckpt").string();
+    EXPECT_EQ(cli::execute_run_command(config), cli::EXIT_RUNTIME_ERROR);
+    ASSERT_TRUE(std::filesystem::exists(dir / "ckpt" / "sum.ckpt"));
+
+    mips::MipsSimulatorAPI probe;
+    ASSERT_TRUE(probe.loadProgram(SUM_PROGRAM));
+    ASSERT_TRUE(probe.loadCheckpoint((dir / "ckpt" / "sum.ckpt").string()));
+    EXPECT_EQ(probe.getCycleCount(), 200u);
+
+    // Resuming without a limit runs to completion
+    cli::RunConfig resume;
+    resume.program = config.program;
+    resume.resume  = (dir / "ckpt" / "sum.ckpt").string();
+    EXPECT_EQ(cli::execute_run_command(resume), cli::EXIT_OK);
+
+    resume.resume = (dir / "missing.ckpt").string();
+    EXPECT_EQ(cli::execute_run_command(resume), cli::EXIT_IO_ERROR);
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST(CheckpointTest, ApiSaveLeavesNoTemporaryFiles)
+{
+    const auto directory = std::filesystem::temp_directory_path() / "mipsim_checkpoint_save_test";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    const auto countFiles = [&]
+    {
+        return std::distance(std::filesystem::directory_iterator(directory),
+                             std::filesystem::directory_iterator());
+    };
+
+    mips::MipsSimulatorAPI api;
+    ASSERT_TRUE(api.loadProgram(SUM_PROGRAM));
+    api.runFor(100);
+    ASSERT_TRUE(api.saveCheckpoint((directory / "run.ckpt").string())) << api.getLastError();
+    ASSERT_TRUE(api.saveCheckpoint((directory / "run.ckpt").string())) << api.getLastError();
+    EXPECT_EQ(countFiles(), 1);
+
+    // The rename fails onto a directory that is not empty; the temporary file goes again
+    std::filesystem::create_directories(directory / "busy.ckpt" / "inside");
+    EXPECT_FALSE(api.saveCheckpoint((directory / "busy.ckpt").string()));
+    EXPECT_NE(api.getLastError().find("Failed to replace checkpoint"), std::string::npos);
+    EXPECT_EQ(countFiles(), 2);
+
+    EXPECT_FALSE(api.saveCheckpoint((directory / "missing" / "run.ckpt").string()));
+    EXPECT_NE(api.getLastError().find("Could not create checkpoint"), std::string::npos);
+
+    std::filesystem::remove_all(directory);
+}
@@ -225,6 +225,164 @@ TEST_F(CLIArgumentParsingBDD, RejectsMissingProgramFile)
     then_error_message_should_contain("missing program file");
 }
 
+// Test 10: Run command with log spec
+TEST_F(CLIArgumentParsingBDD, ParsesRunCommandWithLogSpec)
+{
+    // When I parse "mipsim run program.asm --log cpu,memory=debug"
+    when_parsing_args({"mipsim", "run", "program.asm", "--log", "cpu,memory=debug"});
+
+    // Then the error code should be 0
+    then_error_code_should_be(cli::EXIT_OK);
+    // And the run config should carry the log spec
+    then_run_config_should_have("program.asm");
+    EXPECT_EQ(std::get<cli::RunConfig>(result.config).log, "cpu,memory=debug");
+}
+
+// Test 11: Invalid log spec is an argument error
+TEST_F(CLIArgumentParsingBDD, RejectsUnknownLogCategory)
+{
+    // When I parse "mipsim run program.asm --log cache"
+    when_parsing_args({"mipsim", "run", "program.asm", "--log", "cache"});
+
+    // Then the error code should be 2
+    then_error_code_should_be(cli::EXIT_ARG_PARSE);
+    // And the error message should name the category
+    then_error_message_should_contain("unknown log category 'cache'");
+}
+
+// Test 12: Run command with JIT enabled
+TEST_F(CLIArgumentParsingBDD, ParsesRunCommandWithJit)
+{
+    // When I parse "mipsim run program.asm --jit"
+    when_parsing_args({"mipsim", "run", "program.asm", "--jit"});
+
+    // Then the error code should be 0
+    then_error_code_should_be(cli::EXIT_OK);
+    // And the run config should request the JIT
+    then_run_config_should_have("program.asm");
+    EXPECT_TRUE(std::get<cli::RunConfig>(result.config).jit);
+}
+
+// Test 13: Translate command with output file
+TEST_F(CLIArgumentParsingBDD, ParsesTranslateCommandWithOutput)
+{
+    // When I parse "mipsim translate prog.asm -o prog.cpp"
+    when_parsing_args({"mipsim", "translate", "prog.asm", "-o", "prog.cpp"});
+
+    // Then the error code should be 0
+    then_error_code_should_be(cli::EXIT_OK);
+    // And the translate config should name both files
+    ASSERT_EQ(result.cmd, cli::Command::Translate);
+    const auto& config = std::get<cli::TranslateConfig>(result.config);
+    EXPECT_EQ(config.input, "prog.asm");
+    EXPECT_EQ(config.output, "prog.cpp");
+}
+
+// Test 14: Run command with checkpointing and resume
+TEST_F(CLIArgumentParsingBDD, ParsesRunCommandWithCheckpointOptions)
+{
+    // When I parse "mipsim run program.asm --checkpoint-every 5000 --checkpoint-dir ckpt
+    // --resume ckpt/program.ckpt"
+    when_parsing_args({"mipsim", "run", "program.asm", "--checkpoint-every", "5000",
+                       "--checkpoint-dir", "ckpt", "--resume", "ckpt/program.ckpt"});
+
+    // Then the error code should be 0
+    then_error_code_should_be(cli::EXIT_OK);
+    // And the run config should carry all three options
+    then_run_config_should_have("program.asm");
+    const auto& run_cfg = std::get<cli::RunConfig>(result.config);
+    EXPECT_EQ(run_cfg.checkpoint_every, 5000);
+    EXPECT_EQ(run_cfg.checkpoint_dir, "ckpt");
+    EXPECT_EQ(run_cfg.resume, "ckpt/program.ckpt");
+}
+
+// Test 15: Checkpoint interval without a directory
+TEST_F(CLIArgumentParsingBDD, RejectsCheckpointIntervalWithoutDirectory)
+{
+    // When I parse "mipsim run program.asm --checkpoint-every 5000"
+    when_parsing_args({"mipsim", "run", "program.asm", "--checkpoint-every", "5000"});
+
+    // Then parsing should fail and name both options
+    then_error_code_should_be(cli::EXIT_ARG_PARSE);
+    then_error_message_should_contain("--checkpoint-dir");
+
+    // And a non-positive interval is rejected outright
+    when_parsing_args({"mipsim", "run", "program.asm", "--checkpoint-every", "0",
+                       "--checkpoint-dir", "ckpt"});
+    then_error_code_should_be(cli::EXIT_ARG_PARSE);
+    then_error_message_should_contain("invalid value for --checkpoint-every");
+}
+
+// Test 16: Disasm command with range, symbol map and jobs
+TEST_F(CLIArgumentParsingBDD, ParsesDisasmCommand)
+{
+    // When I parse "mipsim disasm out.bin --start 0x40 --count 10 --map out.map --jobs 2"
+    when_parsing_args({"mipsim", "disasm", "out.bin", "--start", "0x40", "--count", "10", "--map",
+                       "out.map", "--jobs", "2"});
+
+    // Then the error code should be 0
+    then_error_code_should_be(cli::EXIT_OK);
+    // And the disasm config should carry every option
+    ASSERT_EQ(result.cmd, cli::Command::Disasm);
+    const auto& config = std::get<cli::DisasmConfig>(result.config);
+    EXPECT_EQ(config.input, "out.bin");
+    EXPECT_EQ(config.start, 0x40u);
+    EXPECT_EQ(config.count, 10);
+    EXPECT_EQ(config.map, "out.map");
+    EXPECT_EQ(config.jobs, 2);
+
+    // And a start address that is not word-aligned is rejected
+    when_parsing_args({"mipsim", "disasm", "out.bin", "--start", "0x41"});
+    then_error_code_should_be(cli::EXIT_ARG_PARSE);
+    then_error_message_should_contain("invalid value for --start");
+}
+
+// Test 17: Assemble command with worker threads
+TEST_F(CLIArgumentParsingBDD, ParsesAssembleJobs)
+{
+    // When I parse "mipsim assemble src.asm -o out.bin --jobs 8"
+    when_parsing_args({"mipsim", "assemble", "src.asm", "-o", "out.bin", "--jobs", "8"});
+
+    // Then the assemble config should carry the thread count
+    then_error_code_should_be(cli::EXIT_OK);
+    ASSERT_EQ(result.cmd, cli::Command::Assemble);
+    EXPECT_EQ(std::get<cli::AssembleConfig>(result.config).jobs, 8);
+
+    // And zero threads is rejected
+    when_parsing_args({"mipsim", "assemble", "src.asm", "--jobs", "0"});
+    then_error_code_should_be(cli::EXIT_ARG_PARSE);
+    then_error_message_should_contain("invalid value for --jobs");
+}
+
+// Test 18: Batch command with several inputs and per-program limits
+TEST_F(CLIArgumentParsingBDD, ParsesBatchCommand)
+{
+    // When I parse "mipsim batch tests/ extra.asm --jobs 4 --limit 1000 --timeout 5 --jit -o out"
+    when_parsing_args({"mipsim", "batch", "tests/", "extra.asm", "--jobs", "4", "--limit", "1000",
+                       "--timeout", "5", "--jit", "-o", "out"});
+
+    // Then the batch config should carry every input and option
+    then_error_code_should_be(cli::EXIT_OK);
+    ASSERT_EQ(result.cmd, cli::Command::Batch);
+    const auto& config = std::get<cli::BatchConfig>(result.config);
+    EXPECT_EQ(config.inputs, (std::vector<std::string>{"tests/", "extra.asm"}));
+    EXPECT_EQ(config.jobs, 4);
+    EXPECT_EQ(config.limit, 1000);
+    EXPECT_EQ(config.timeout, 5);
+    EXPECT_TRUE(config.jit);
+    EXPECT_EQ(config.output, "out");
+
+    // And a batch needs something to run
+    when_parsing_args({"mipsim", "batch", "--jobs", "2"});
+    then_error_code_should_be(cli::EXIT_ARG_PARSE);
+    then_error_message_should_contain("missing program directory or list");
+
+    // And limits must be positive
+    when_parsing_args({"mipsim", "batch", "tests/", "--limit", "0"});
+    then_error_code_should_be(cli::EXIT_ARG_PARSE);
+    then_error_message_should_contain("invalid value for --limit");
+}
+
 
 /**
  * @brief BDD-style tests for CLI execution and dispatch
@@ -173,6 +173,36 @@ TEST_F(CLIAssembleCommandBDD, GeneratesSymbolMapWhenRequested)
     then_output_file_should_not_be_empty(config.map);
 }
 
+// Scenario: Windows line endings and no final newline assemble like a plain file
+TEST_F(CLIAssembleCommandBDD, AssemblesCrlfSourceWithoutFinalNewline)
+{
+    // Given the same program with CRLF line endings and with plain newlines
+    given_assembly_file("crlf.asm", "main:\r\n"
+                                    "    addi $t0, $zero, 42\r\n"
+                                    "    beq $t0, $zero, main\r\n"
+                                    "    jr $ra");
+    const std::string crlf_file = m_test_file;
+    given_assembly_file("plain.asm", "main:\n"
+                                     "    addi $t0, $zero, 42\n"
+                                     "    beq $t0, $zero, main\n"
+                                     "    jr $ra\n");
+
+    // When I assemble both
+    when_executing_assemble_command(crlf_file);
+    then_exit_code_should_be(cli::EXIT_OK);
+    when_executing_assemble_command(m_test_file);
+    then_exit_code_should_be(cli::EXIT_OK);
+
+    // Then the binaries are identical
+    auto read = [](const std::string& filename)
+    {
+        std::ifstream file(filename, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(file), {});
+    };
+    EXPECT_EQ(read(crlf_file + ".bin"), read(m_test_file + ".bin"));
+    EXPECT_FALSE(read(crlf_file + ".bin").empty());
+}
+
 // Scenario: Default output filename when not specified
 TEST_F(CLIAssembleCommandBDD, UsesDefaultOutputFilename)
 {
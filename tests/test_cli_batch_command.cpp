@@ -0,0 +1,182 @@
+#include "../cli/batch_executor.hpp"
+#include "../cli/cli.hpp"
+#include "../src/Assembler.h"
+#include "../src/Instruction.h"
+#include "../src/ObjectFile.h"
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <map>
+#include <sstream>
+
+namespace
+{
+
+// Reads an integer, prints it plus one and exits
+const char* const INCREMENT_PROGRAM = "addi $v0, $zero, 5\n"
+                                      "syscall\n"
+                                      "addi $a0, $v0, 1\n"
+                                      "addi $v0, $zero, 1\n"
+                                      "syscall\n"
+                                      "addi $v0, $zero, 10\n"
+                                      "syscall\n";
+
+const char* const SPIN_PROGRAM = "spin: j spin\n";
+
+}  // namespace
+
+/**
+ * @brief BDD-style tests for the batch command
+ */
+class CLIBatchCommandBDD : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        dir = std::filesystem::temp_directory_path() / "mipsim_batch_test";
+        std::filesystem::remove_all(dir);
+        std::filesystem::create_directories(dir / "sub");
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove_all(dir);
+    }
+
+    void given_file(const std::string& name, const std::string& content)
+    {
+        std::ofstream file(dir / name, std::ios::binary);
+        file << content;
+    }
+
+    // Runs the batch and indexes the JSON lines by program file name
+    void when_running_batch(cli::BatchConfig config)
+    {
+        std::ostringstream out;
+        m_result = cli::execute_batch_command(config, out);
+
+        m_lines.clear();
+        std::istringstream lines(out.str());
+        std::string        line;
+        while (std::getline(lines, line))
+        {
+            const size_t                start = line.find("\"program\":\"") + 11;
+            const std::filesystem::path path  = line.substr(start, line.find('"', start) - start);
+            m_lines[path.filename().string()] = line;
+        }
+    }
+
+    void then_result_should_contain(const std::string& program, const std::string& field)
+    {
+        ASSERT_TRUE(m_lines.count(program)) << program << " has no result";
+        EXPECT_NE(m_lines[program].find(field), std::string::npos) << m_lines[program];
+    }
+
+    std::filesystem::path              dir;
+    int                                m_result = 0;
+    std::map<std::string, std::string> m_lines;
+};
+
+TEST_F(CLIBatchCommandBDD, RunsEveryProgramAndChecksItsExpectedOutput)
+{
+    // Given a directory of programs, some with expected output and console input
+    given_file("pass.asm", INCREMENT_PROGRAM);
+    given_file("pass.in", "41\n");
+    given_file("pass.out", "42\r\n");  // Saved with CRLF, trailing newlines ignored
+    given_file("fail.asm", INCREMENT_PROGRAM);
+    given_file("fail.in", "1\n");
+    given_file("fail.out", "3\n");
+    given_file("sub/unchecked.asm", INCREMENT_PROGRAM);
+    given_file("sub/broken.asm", "j nowhere\n");
+    given_file("notes.txt.bak", "not a program");
+
+    // When I run the batch on three workers
+    cli::BatchConfig config;
+    config.inputs = {dir.string()};
+    config.jobs   = 3;
+    when_running_batch(config);
+
+    // Then there is one line per program, with its own outcome
+    EXPECT_EQ(m_lines.size(), 4u);
+    then_result_should_contain("pass.asm", "\"status\":\"pass\",\"reason\":\"exit\"");
+    then_result_should_contain("pass.asm", "\"cycles\":7,\"instructions\":7,\"wall_ms\":");
+    then_result_should_contain("fail.asm", "\"status\":\"fail\"");
+    then_result_should_contain("fail.asm", "\"diff_line\":1");
+    then_result_should_contain("unchecked.asm", "\"status\":\"unchecked\"");
+    then_result_should_contain("broken.asm", "\"status\":\"error\",\"reason\":\"load\"");
+    then_result_should_contain("broken.asm", "\"error\":\"Failed to load program: Undefined label");
+
+    // And the batch fails because one program did
+    EXPECT_EQ(m_result, cli::EXIT_TEST_FAILURE);
+}
+
+TEST_F(CLIBatchCommandBDD, StopsEachProgramAtItsOwnLimits)
+{
+    // Given a program that never exits next to one that does
+    given_file("spin.asm", SPIN_PROGRAM);
+    given_file("quick.asm", INCREMENT_PROGRAM);
+    given_file("quick.out", "1");
+
+    // When I run them with a cycle limit
+    cli::BatchConfig config;
+    config.inputs = {dir.string()};
+    config.jobs   = 2;
+    config.limit  = 1000;
+    when_running_batch(config);
+
+    // Then only the spinning program stops at it
+    then_result_should_contain("spin.asm", "\"reason\":\"limit\",\"cycles\":1000,");
+    then_result_should_contain("quick.asm", "\"status\":\"pass\"");
+    EXPECT_EQ(m_result, cli::EXIT_TEST_FAILURE);
+
+    // And with a timeout instead, the watchdog stops it while the other still passes
+    config.limit   = -1;
+    config.timeout = 1;
+    when_running_batch(config);
+    then_result_should_contain("spin.asm", "\"status\":\"error\",\"reason\":\"timeout\"");
+    then_result_should_contain("quick.asm", "\"status\":\"pass\"");
+}
+
+TEST_F(CLIBatchCommandBDD, CollectsProgramsFromListsAndBinaries)
+{
+    // Given a source, its assembled binary and a list naming both
+    given_file("sub/one.asm", INCREMENT_PROGRAM);
+    given_file("sub/one.out", "1");
+    {
+        mips::Assembler                  assembler;
+        mips::LabelMap                   labelMap;
+        std::vector<mips::DataDirective> dataDirectives;
+        auto instructions =
+            assembler.assembleWithLabels(INCREMENT_PROGRAM, labelMap, dataDirectives);
+        std::ofstream file(dir / "sub/two.bin", std::ios::binary);
+        mips::ObjectFile::fromProgram(instructions, dataDirectives, labelMap).write(file);
+    }
+    given_file("sub/two.out", "1");
+    given_file("programs.list", "# Relative to the list\n\n  sub/one.asm\r\nsub/two.bin\n");
+
+    // When I collect the list
+    std::vector<std::string> programs;
+    std::string              error;
+    ASSERT_TRUE(cli::collect_batch_programs({(dir / "programs.list").string()}, programs, error));
+
+    // Then both programs are found next to the list
+    ASSERT_EQ(programs.size(), 2u);
+    EXPECT_EQ(programs[0], (dir / "sub/one.asm").string());
+    EXPECT_EQ(programs[1], (dir / "sub/two.bin").string());
+
+    // And both pass when run
+    cli::BatchConfig config;
+    config.inputs = {(dir / "programs.list").string()};
+    when_running_batch(config);
+    then_result_should_contain("one.asm", "\"status\":\"pass\"");
+    then_result_should_contain("two.bin", "\"status\":\"pass\"");
+    EXPECT_EQ(m_result, cli::EXIT_OK);
+
+    // And a missing input is reported before anything runs
+    EXPECT_FALSE(cli::collect_batch_programs({(dir / "missing").string()}, programs, error));
+    EXPECT_NE(error.find("file not found"), std::string::npos);
+    config.inputs = {(dir / "missing").string()};
+    when_running_batch(config);
+    EXPECT_EQ(m_result, cli::EXIT_IO_ERROR);
+    EXPECT_TRUE(m_lines.empty());
+}
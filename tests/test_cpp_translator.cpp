@@ -0,0 +1,163 @@
+#include "../cli/cli.hpp"
+#include "../cli/translate_executor.hpp"
+#include "Assembler.h"
+#include "CppTranslator.h"
+#include "Instruction.h"
+#include "MipsSimulatorAPI.h"
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+
+namespace
+{
+
+std::string translateSource(const std::string& source)
+{
+    mips::Assembler                  assembler;
+    std::map<std::string, uint32_t>  labelMap;
+    std::vector<mips::DataDirective> dataDirectives;
+    auto instructions = assembler.assembleWithLabels(source, labelMap, dataDirectives);
+    mips::Assembler::link(instructions, labelMap);
+    return mips::CppTranslator::translate(instructions, dataDirectives, labelMap, "test.asm");
+}
+
+// Loops, calls through jal/jr and jalr, memory, data directives and every console syscall
+const std::string SAMPLE_PROGRAM = "main:\n"
+                                   "la $a0, greeting\n"
+                                   "addi $v0, $zero, 4\n"
+                                   "syscall\n"
+                                   "addi $v0, $zero, 5\n"
+                                   "syscall\n"
+                                   "add $s0, $v0, $zero\n"
+                                   "addi $v0, $zero, 12\n"
+                                   "syscall\n"
+                                   "add $s1, $v0, $zero\n"
+                                   "addi $t0, $zero, 0\n"
+                                   "addi $t1, $zero, 0\n"
+                                   "addi $t6, $zero, 3\n"
+                                   "la $t2, table\n"
+                                   "loop:\n"
+                                   "lw $t3, 0($t2)\n"
+                                   "add $t1, $t1, $t3\n"
+                                   "addi $t2, $t2, 4\n"
+                                   "addi $t0, $t0, 1\n"
+                                   "slt $t4, $t0, $t6\n"
+                                   "bne $t4, $zero, loop\n"
+                                   "mult $t1, $s0\n"
+                                   "mflo $a0\n"
+                                   "jal print_int\n"
+                                   "la $t5, print_char\n"
+                                   "add $a0, $s1, $zero\n"
+                                   "jalr $t5\n"
+                                   "sb $s1, 64($zero)\n"
+                                   "lbu $a0, 64($zero)\n"
+                                   "trap 11\n"
+                                   "trap 10\n"
+                                   "print_int:\n"
+                                   "addi $v0, $zero, 1\n"
+                                   "syscall\n"
+                                   "jr $ra\n"
+                                   "print_char:\n"
+                                   "addi $v0, $zero, 11\n"
+                                   "syscall\n"
+                                   "jr $ra\n"
+                                   "greeting:\n"
+                                   ".asciiz \"n=\"\n"
+                                   "table:\n"
+                                   ".word 3, -7, 11\n";
+
+}  // namespace
+
+TEST(CppTranslatorTest, EmitsLabelledBlocksAndRegisterLocals)
+{
+    const std::string output = translateSource("addi $t0, $zero, 3\n"
+                                               "loop:\n"
+                                               "addi $t0, $t0, -1\n"
+                                               "bne $t0, $zero, loop\n"
+                                               "trap 10\n");
+
+    EXPECT_NE(output.find("int main()"), std::string::npos);
+    EXPECT_NE(output.find("uint8_t*    g_pages[1u << (32 - PAGE_BITS)];"), std::string::npos);
+    EXPECT_NE(output.find("L1:"), std::string::npos);
+    EXPECT_NE(output.find("r8 = r8 + 0xFFFFFFFFu;"), std::string::npos);
+    EXPECT_NE(output.find("if (r8 != 0u) goto L1;"), std::string::npos);
+    // No indirect jumps, so no dispatch switch
+    EXPECT_EQ(output.find("dispatch:"), std::string::npos);
+}
+
+TEST(CppTranslatorTest, IndirectJumpsGoThroughDispatch)
+{
+    const std::string output = translateSource("jal f\n"
+                                               "trap 10\n"
+                                               "f:\n"
+                                               "jr $ra\n");
+
+    EXPECT_NE(output.find("r31 = 0x4u; goto L2;"), std::string::npos);
+    EXPECT_NE(output.find("pc = r31 / 4; goto dispatch;"), std::string::npos);
+    EXPECT_NE(output.find("case 1: goto L1;"), std::string::npos);
+}
+
+TEST(CppTranslatorTest, TranslateCommandWritesOutputFile)
+{
+    auto dir = std::filesystem::temp_directory_path() / "mipsim_translate_test";
+    std::filesystem::create_directories(dir);
+    {
+        std::ofstream file(dir / "prog.asm");
+        file << "addi $a0, $zero, 7\ntrap 1\ntrap 10\n";
+    }
+
+    cli::TranslateConfig config;
+    config.input = (dir / "prog.asm").string();
+    EXPECT_EQ(cli::execute_translate_command(config), cli::EXIT_OK);
+    EXPECT_TRUE(std::filesystem::exists(dir / "prog.asm.cpp"));
+
+    config.input = (dir / "missing.asm").string();
+    EXPECT_EQ(cli::execute_translate_command(config), cli::EXIT_IO_ERROR);
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST(CppTranslatorTest, NativeBuildMatchesSimulatorOutput)
+{
+#ifndef MIPSIM_HOST_CXX
+    GTEST_SKIP() << "No host compiler recorded for this build";
+#else
+    auto dir = std::filesystem::temp_directory_path() / "mipsim_translate_native_test";
+    std::filesystem::create_directories(dir);
+    {
+        std::ofstream source(dir / "prog.cpp");
+        source << translateSource(SAMPLE_PROGRAM);
+        std::ofstream input(dir / "input.txt");
+        input << "  -4Z";
+    }
+
+    const std::string binary  = (dir / "prog").string();
+    const std::string compile = std::string("\"") + MIPSIM_HOST_CXX + "\" -std=c++17 -O1 -o \"" +
+                                binary + "\" \"" + (dir / "prog.cpp").string() + "\"";
+    if (std::system(compile.c_str()) != 0)
+    {
+        std::filesystem::remove_all(dir);
+        GTEST_SKIP() << "Host compiler could not build the translation";
+    }
+
+    const std::string run = "\"" + binary + "\" < \"" + (dir / "input.txt").string() + "\" > \"" +
+                            (dir / "output.txt").string() + "\"";
+    ASSERT_EQ(std::system(run.c_str()), 0);
+    std::ifstream     outputFile(dir / "output.txt", std::ios::binary);
+    std::stringstream native;
+    native << outputFile.rdbuf();
+
+    mips::MipsSimulatorAPI api;
+    ASSERT_TRUE(api.loadProgram(SAMPLE_PROGRAM));
+    api.setConsoleInput("  -4Z");
+    api.run(10000);
+    ASSERT_TRUE(api.isTerminated());
+
+    EXPECT_EQ(native.str(), api.getConsoleOutput());
+    EXPECT_EQ(native.str(), "n=" + std::to_string(static_cast<uint32_t>(-28)) + "\nZZ");
+    std::filesystem::remove_all(dir);
+#endif
+}
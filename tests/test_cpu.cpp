@@ -1,8 +1,10 @@
 #include "Assembler.h"
 #include "Cpu.h"
 #include "Memory.h"
+#include "MipsSimulatorAPI.h"
 #include "RegisterFile.h"
 #include <gtest/gtest.h>
+#include <vector>
 
 class CpuTest : public ::testing::Test
 {
@@ -37,6 +39,33 @@ TEST_F(CpuTest, RunMultipleCycles)
     EXPECT_EQ(cpu->getCycleCount(), 5);
 }
 
+TEST_F(CpuTest, CountersDoNotOverflowPast32Bits)
+{
+    // Idle cycles past the end of the program are counted without executing anything
+    cpu->loadProgramFromString("addi $t0, $zero, 1\naddi $t1, $zero, 2");
+    const uint64_t cycles = 5000000000ull;
+    cpu->run(cycles);
+    EXPECT_EQ(cpu->getCycleCount(), cycles);
+    EXPECT_EQ(cpu->getRetiredInstructionCount(), 2u);
+}
+
+TEST_F(CpuTest, CountsRetiredInstructionsSeparatelyFromCycles)
+{
+    cpu->loadProgramFromString("addi $t0, $zero, 3\n"
+                               "loop:\n"
+                               "addi $t0, $t0, -1\n"
+                               "bne $t0, $zero, loop\n"
+                               "addi $v0, $zero, 10\n"
+                               "syscall");
+    cpu->run(100);
+    EXPECT_TRUE(cpu->shouldTerminate());
+    EXPECT_EQ(cpu->getRetiredInstructionCount(), 9u);
+    EXPECT_EQ(cpu->getCycleCount(), 9u);
+
+    cpu->reset();
+    EXPECT_EQ(cpu->getRetiredInstructionCount(), 0u);
+}
+
 // Register file tests
 TEST(RegisterFileTest, InitialZeroState)
 {
@@ -91,6 +120,131 @@ TEST(MemoryTest, WordAlignment)
     EXPECT_FALSE(memory.isValidAddress(0x1002));  // Not word-aligned
 }
 
+TEST(MemoryTest, PagesAreAllocatedOnFirstWrite)
+{
+    mips::Memory memory;
+    EXPECT_EQ(memory.allocatedPageCount(), 0u);
+
+    // Reads of untouched memory do not allocate
+    EXPECT_EQ(memory.readWord(0x7FFFEFF8), 0u);
+    EXPECT_EQ(memory.readByte(0xFFFFFFFF), 0u);
+    EXPECT_EQ(memory.allocatedPageCount(), 0u);
+
+    memory.writeWord(0x1000, 1);
+    memory.writeWord(0x1FFC, 2);
+    EXPECT_EQ(memory.allocatedPageCount(), 1u);
+
+    memory.release();
+    EXPECT_EQ(memory.allocatedPageCount(), 0u);
+    EXPECT_EQ(memory.readWord(0x1000), 0u);
+}
+
+TEST(MemoryTest, ResetClearsOnlyDirtyPagesAndKeepsThemMapped)
+{
+    mips::Memory memory;
+    memory.writeWord(0x00000040, 0xAAAAAAAA);
+    memory.writeByte(0x10040123, 0xBB);
+    memory.writeWord(0x00000044, 0xCCCCCCCC);  // Same page as the first write
+    EXPECT_EQ(memory.dirtyPageCount(), 2u);
+
+    std::vector<uint32_t> addresses;
+    for (const mips::Memory::DirtyPage& page : memory.dirtyPages())
+    {
+        addresses.push_back(page.address);
+        if (page.address == 0x10040000)
+        {
+            EXPECT_EQ(page.data[0x123], 0xBBu);
+        }
+    }
+    EXPECT_EQ(addresses, (std::vector<uint32_t>{0x00000000, 0x10040000}));
+
+    memory.reset();
+    EXPECT_EQ(memory.dirtyPageCount(), 0u);
+    EXPECT_EQ(memory.allocatedPageCount(), 2u);  // Kept for reuse
+    EXPECT_EQ(memory.readWord(0x00000040), 0u);
+    EXPECT_EQ(memory.readByte(0x10040123), 0u);
+
+    // A reused page becomes dirty again on its next write
+    memory.writeHalfword(0x10040FFE, 0x1234);
+    EXPECT_EQ(memory.dirtyPageCount(), 1u);
+    EXPECT_EQ(memory.allocatedPageCount(), 2u);
+    EXPECT_EQ(memory.readHalfword(0x10040FFE), 0x1234u);
+}
+
+TEST(MemoryTest, ApiReportsDirtyPagesUntilReset)
+{
+    mips::MipsSimulatorAPI api;
+    ASSERT_TRUE(api.loadProgram("addi $t0, $zero, 5\n"
+                                "sw $t0, 8192($zero)\n"
+                                "trap 10\n"));
+    api.run();
+
+    std::vector<uint32_t> pages = api.getDirtyPages();
+    EXPECT_EQ(pages, (std::vector<uint32_t>{0x2000}));
+
+    api.reset();
+    EXPECT_TRUE(api.getDirtyPages().empty());
+    EXPECT_EQ(api.loadWord(0x2000), 0u);
+}
+
+TEST(MemoryTest, CoversFullAddressSpace)
+{
+    mips::Memory memory;
+
+    memory.writeWord(0x10040000, 0x11111111);
+    memory.writeWord(0x7FFFEFFC, 0x22222222);
+    memory.writeWord(0xFFFFFFFC, 0x33333333);
+    memory.writeByte(0xFFFFFFFF, 0x44);
+
+    EXPECT_EQ(memory.readWord(0x10040000), 0x11111111u);
+    EXPECT_EQ(memory.readWord(0x7FFFEFFC), 0x22222222u);
+    EXPECT_EQ(memory.readWord(0xFFFFFFFC), 0x44333333u);
+    EXPECT_EQ(memory.readWord(0x00100000), 0u);
+    EXPECT_EQ(memory.allocatedPageCount(), 3u);
+
+    EXPECT_EQ(mips::Memory::segmentOf(0x00000040), mips::Memory::Segment::Text);
+    EXPECT_EQ(mips::Memory::segmentOf(0x10040000), mips::Memory::Segment::Heap);
+    EXPECT_EQ(mips::Memory::segmentOf(0x7FFFEFFC), mips::Memory::Segment::Stack);
+    EXPECT_EQ(mips::Memory::segmentOf(0x80000000), mips::Memory::Segment::Kernel);
+}
+
+TEST(MemoryTest, HalfwordMayStraddlePages)
+{
+    mips::Memory memory;
+
+    memory.writeHalfword(0x1FFF, 0xBEEF);
+    EXPECT_EQ(memory.readByte(0x1FFF), 0xEFu);
+    EXPECT_EQ(memory.readByte(0x2000), 0xBEu);
+    EXPECT_EQ(memory.readHalfword(0x1FFF), 0xBEEFu);
+    EXPECT_EQ(memory.allocatedPageCount(), 2u);
+
+    // Misaligned word accesses are still rejected
+    memory.writeWord(0x1FFE, 0x12345678);
+    EXPECT_EQ(memory.readWord(0x1FFE), 0u);
+}
+
+TEST(MemoryTest, SbrkGrowsHeapFromHeapBase)
+{
+    mips::Cpu cpu;
+    cpu.loadProgramFromString("addi $a0, $zero, 10\n"
+                              "addi $v0, $zero, 9\n"
+                              "syscall\n"
+                              "add $s0, $v0, $zero\n"
+                              "addi $t0, $zero, 77\n"
+                              "sw $t0, 8($s0)\n"
+                              "addi $a0, $zero, 4\n"
+                              "addi $v0, $zero, 9\n"
+                              "syscall\n"
+                              "add $s1, $v0, $zero\n"
+                              "addi $v0, $zero, 10\n"
+                              "syscall\n");
+    cpu.run(100);
+
+    EXPECT_EQ(cpu.getRegisterFile().read(16), mips::Memory::HEAP_BASE);
+    EXPECT_EQ(cpu.getRegisterFile().read(17), mips::Memory::HEAP_BASE + 12);  // Word-rounded
+    EXPECT_EQ(cpu.getMemory().readWord(mips::Memory::HEAP_BASE + 8), 77u);
+}
+
 // Instruction execution tests
 TEST(InstructionTest, AddInstructionBasic)
 {
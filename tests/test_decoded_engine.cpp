@@ -0,0 +1,265 @@
+#include "Cpu.h"
+#include "Memory.h"
+#include "RegisterFile.h"
+#include <gtest/gtest.h>
+#include <string>
+
+namespace
+{
+
+void expectSameState(mips::Cpu& actual, mips::Cpu& reference)
+{
+    for (int reg = 0; reg < mips::RegisterFile::NUM_REGISTERS; ++reg)
+    {
+        EXPECT_EQ(actual.getRegisterFile().read(reg), reference.getRegisterFile().read(reg))
+            << "Register $" << reg << " differs";
+    }
+    EXPECT_EQ(actual.getRegisterFile().readHI(), reference.getRegisterFile().readHI());
+    EXPECT_EQ(actual.getRegisterFile().readLO(), reference.getRegisterFile().readLO());
+    EXPECT_EQ(actual.getProgramCounter(), reference.getProgramCounter());
+    EXPECT_EQ(actual.getCycleCount(), reference.getCycleCount());
+    EXPECT_EQ(actual.shouldTerminate(), reference.shouldTerminate());
+    EXPECT_EQ(actual.getConsoleOutput(), reference.getConsoleOutput());
+
+    for (uint32_t address = 0; address < 0x400; address += 4)
+    {
+        EXPECT_EQ(actual.getMemory().readWord(address), reference.getMemory().readWord(address))
+            << "Memory word at " << address << " differs";
+    }
+}
+
+// Runs the same program on every single-cycle engine and compares the visible state
+void expectEnginesAgree(const std::string& program, int maxCycles = 10000)
+{
+    mips::Cpu reference;
+    reference.setExecutionEngine(mips::ExecutionEngine::Reference);
+    reference.loadProgramFromString(program);
+    reference.run(maxCycles);
+
+    for (auto engine : {mips::ExecutionEngine::Decoded, mips::ExecutionEngine::Block,
+                        mips::ExecutionEngine::Jit})
+    {
+        SCOPED_TRACE(engine == mips::ExecutionEngine::Block ? "Block engine"
+                     : engine == mips::ExecutionEngine::Jit ? "Jit engine"
+                                                            : "Decoded engine");
+
+        mips::Cpu cpu;
+        cpu.setExecutionEngine(engine);
+        cpu.loadProgramFromString(program);
+        cpu.run(maxCycles);
+        expectSameState(cpu, reference);
+    }
+}
+
+}  // namespace
+
+TEST(DecodedEngineTest, ArithmeticAndLogical)
+{
+    expectEnginesAgree("addi $t0, $zero, 7\n"
+                       "addi $t1, $zero, -3\n"
+                       "add $t2, $t0, $t1\n"
+                       "sub $t3, $t1, $t0\n"
+                       "addu $t4, $t2, $t3\n"
+                       "subu $t5, $t1, $t0\n"
+                       "and $t6, $t0, $t1\n"
+                       "or $t7, $t0, $t1\n"
+                       "xor $s0, $t0, $t1\n"
+                       "nor $s1, $t0, $t1\n"
+                       "slt $s2, $t1, $t0\n"
+                       "sltu $s3, $t1, $t0\n"
+                       "andi $s4, $t1, 0xFF\n"
+                       "ori $s5, $t0, 0x8000\n"
+                       "xori $s6, $t1, 0x1234\n"
+                       "sltiu $s7, $t0, -1\n"
+                       "addiu $t8, $t1, 100\n"
+                       "add $zero, $t0, $t0\n"
+                       "syscall\n");
+}
+
+TEST(DecodedEngineTest, ShiftsAndHiLo)
+{
+    expectEnginesAgree("addi $t0, $zero, -16\n"
+                       "addi $t1, $zero, 3\n"
+                       "sll $t2, $t0, 4\n"
+                       "srl $t3, $t0, 4\n"
+                       "sra $t4, $t0, 2\n"
+                       "sllv $t5, $t0, $t1\n"
+                       "srlv $t6, $t0, $t1\n"
+                       "srav $t7, $t0, $t1\n"
+                       "mult $t0, $t1\n"
+                       "mfhi $s0\n"
+                       "mflo $s1\n"
+                       "multu $t0, $t1\n"
+                       "mfhi $s2\n"
+                       "mflo $s3\n"
+                       "div $t0, $t1\n"
+                       "mfhi $s4\n"
+                       "mflo $s5\n"
+                       "divu $t0, $t1\n"
+                       "mfhi $s6\n"
+                       "mflo $s7\n"
+                       "div $t0, $zero\n"
+                       "mthi $t1\n"
+                       "mtlo $t0\n"
+                       "lhi $a1, 0x1234\n"
+                       "llo $a1, 0x5678\n");
+}
+
+TEST(DecodedEngineTest, SignedDivisionByMinusOne)
+{
+    // INT_MIN / -1 overflows: the quotient wraps to INT_MIN instead of trapping the host
+    expectEnginesAgree("lhi $t0, 0x8000\n"
+                       "llo $t0, 0x0000\n"
+                       "addi $t1, $zero, -1\n"
+                       "div $t0, $t1\n"
+                       "mfhi $s0\n"
+                       "mflo $s1\n"
+                       "addi $t2, $zero, 7\n"
+                       "div $t2, $t1\n"
+                       "mfhi $s2\n"
+                       "mflo $s3\n");
+
+    mips::Cpu cpu;
+    cpu.setExecutionEngine(mips::ExecutionEngine::Decoded);
+    cpu.loadProgramFromString("lhi $t0, 0x8000\n"
+                              "llo $t0, 0x0000\n"
+                              "addi $t1, $zero, -1\n"
+                              "div $t0, $t1\n");
+    cpu.run(10);
+    EXPECT_EQ(cpu.getRegisterFile().readLO(), 0x80000000u);
+    EXPECT_EQ(cpu.getRegisterFile().readHI(), 0u);
+}
+
+TEST(DecodedEngineTest, LoopWithBranchesAndSyscalls)
+{
+    expectEnginesAgree("addi $a0, $zero, 0\n"
+                       "addi $a1, $zero, 25\n"
+                       "addi $v0, $zero, 1\n"
+                       "loop:\n"
+                       "syscall\n"
+                       "addi $a0, $a0, 1\n"
+                       "bne $a0, $a1, loop\n"
+                       "beq $a0, $a1, done\n"
+                       "addi $t9, $zero, 99\n"
+                       "done:\n"
+                       "blez $zero, tail\n"
+                       "addi $t9, $zero, 98\n"
+                       "tail:\n"
+                       "bgtz $a0, finish\n"
+                       "addi $t9, $zero, 97\n"
+                       "finish:\n"
+                       "addi $v0, $zero, 10\n"
+                       "syscall\n"
+                       "addi $t9, $zero, 96\n");
+}
+
+TEST(DecodedEngineTest, CallsAndMemory)
+{
+    expectEnginesAgree("la $a0, msg\n"
+                       "addi $v0, $zero, 4\n"
+                       "syscall\n"
+                       "jal store_values\n"
+                       "la $t0, store_values\n"
+                       "jalr $t0\n"
+                       "lw $s0, 0($sp)\n"
+                       "lb $s1, 4($sp)\n"
+                       "lbu $s2, 4($sp)\n"
+                       "lh $s3, 6($sp)\n"
+                       "lhu $s4, 6($sp)\n"
+                       "addi $a0, $zero, 65\n"
+                       "trap print_character\n"
+                       "trap exit\n"
+                       "store_values:\n"
+                       "addi $sp, $zero, 512\n"
+                       "addi $t1, $zero, -2\n"
+                       "sw $t1, 0($sp)\n"
+                       "sb $t1, 4($sp)\n"
+                       "sh $t1, 6($sp)\n"
+                       "jr $ra\n"
+                       "msg:\n"
+                       ".asciiz \"hello\"\n");
+}
+
+TEST(DecodedEngineTest, RunningPastEndCountsIdleCycles)
+{
+    expectEnginesAgree("addi $t0, $zero, 1\n"
+                       "addi $t1, $zero, 2\n",
+                       50);
+}
+
+TEST(DecodedEngineTest, TickMatchesRun)
+{
+    const std::string program = "addi $t0, $zero, 3\n"
+                                "loop:\n"
+                                "addi $t0, $t0, -1\n"
+                                "bgtz $t0, loop\n"
+                                "trap exit\n";
+
+    mips::Cpu stepped;
+    stepped.loadProgramFromString(program);
+    while (!stepped.shouldTerminate())
+    {
+        stepped.tick();
+    }
+
+    mips::Cpu batched;
+    batched.loadProgramFromString(program);
+    batched.run(1000);
+
+    EXPECT_EQ(stepped.getCycleCount(), batched.getCycleCount());
+    EXPECT_EQ(stepped.getProgramCounter(), batched.getProgramCounter());
+    EXPECT_EQ(stepped.getRegisterFile().read(8), 0u);
+}
+
+TEST(DecodedEngineTest, BlockEngineIsDefault)
+{
+    mips::Cpu cpu;
+    EXPECT_EQ(cpu.getExecutionEngine(), mips::ExecutionEngine::Block);
+}
+
+TEST(DecodedEngineTest, BudgetEndingInsideBlockIsExact)
+{
+    const std::string program = "addi $t0, $zero, 50\n"
+                                "loop:\n"
+                                "addi $t1, $t1, 1\n"
+                                "addi $t2, $t2, 2\n"
+                                "addi $t3, $t3, 3\n"
+                                "addi $t0, $t0, -1\n"
+                                "bgtz $t0, loop\n"
+                                "trap exit\n";
+
+    for (int budget : {1, 2, 3, 7, 13, 64, 127, 250, 252, 1000})
+    {
+        SCOPED_TRACE("budget " + std::to_string(budget));
+        expectEnginesAgree(program, budget);
+    }
+}
+
+TEST(DecodedEngineTest, ChunkedBlockRunMatchesSingleRun)
+{
+    const std::string program = "addi $t0, $zero, 20\n"
+                                "loop:\n"
+                                "jal body\n"
+                                "addi $t0, $t0, -1\n"
+                                "bne $t0, $zero, loop\n"
+                                "trap exit\n"
+                                "body:\n"
+                                "addi $s0, $s0, 3\n"
+                                "jr $ra\n";
+
+    mips::Cpu reference;
+    reference.setExecutionEngine(mips::ExecutionEngine::Reference);
+    reference.loadProgramFromString(program);
+    reference.run(10000);
+
+    mips::Cpu chunked;
+    chunked.loadProgramFromString(program);
+    while (!chunked.shouldTerminate())
+    {
+        chunked.run(5);
+    }
+
+    EXPECT_EQ(chunked.getRegisterFile().read(16), 60u);
+    EXPECT_EQ(chunked.getProgramCounter(), reference.getProgramCounter());
+    EXPECT_EQ(chunked.getCycleCount(), reference.getCycleCount());
+}
@@ -0,0 +1,222 @@
+#include "../cli/cli.hpp"
+#include "../cli/disasm_executor.hpp"
+#include "Assembler.h"
+#include "Disassembler.h"
+#include "Instruction.h"
+#include "ObjectFile.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+
+namespace
+{
+
+const std::string SAMPLE_PROGRAM = "start:\n"
+                                   "addi $t0, $zero, 3\n"
+                                   "loop:\n"
+                                   "addi $t0, $t0, -1\n"
+                                   "bne $t0, $zero, loop\n"
+                                   "jal done\n"
+                                   "sw $t0, -4($sp)\n"
+                                   "ori $t1, $t0, 0x8000\n"
+                                   "sllv $t2, $t1, $t0\n"
+                                   "jalr $t9\n"
+                                   "done:\n"
+                                   "trap 10\n";
+
+mips::ObjectFile assembleObject(const std::string& source)
+{
+    mips::Assembler                  assembler;
+    std::map<std::string, uint32_t>  labelMap;
+    std::vector<mips::DataDirective> dataDirectives;
+    auto instructions = assembler.assembleWithLabels(source, labelMap, dataDirectives);
+    mips::Assembler::link(instructions, labelMap);
+    return mips::ObjectFile::fromProgram(instructions, dataDirectives, labelMap);
+}
+
+std::string disassemble(const mips::ObjectFile& object)
+{
+    mips::Disassembler disassembler(object.symbols);
+    std::string        listing;
+    disassembler.disassemble(object.text.data(), object.text.size(), 0, listing);
+    return listing;
+}
+
+class DisasmCommandTest : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        dir = std::filesystem::temp_directory_path() / "mipsim_disasm_test";
+        std::filesystem::create_directories(dir);
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove_all(dir);
+    }
+
+    std::string writeObject(const mips::ObjectFile& object)
+    {
+        const std::string path = (dir / "prog.bin").string();
+        std::ofstream     file(path, std::ios::binary);
+        object.write(file);
+        return path;
+    }
+
+    int run(const cli::DisasmConfig& config)
+    {
+        output.str("");
+        return cli::execute_disasm_command(config, output);
+    }
+
+    std::filesystem::path dir;
+    std::ostringstream    output;
+};
+
+}  // namespace
+
+TEST(DisassemblerTest, FormatsInstructionsWithLabelsAndTargets)
+{
+    const std::string listing = disassemble(assembleObject(SAMPLE_PROGRAM));
+
+    EXPECT_EQ(listing.find("start:\n00000000  "), 0u);
+    EXPECT_NE(listing.find("  addi $t0, $zero, 3\nloop:\n00000004  "), std::string::npos);
+    EXPECT_NE(listing.find("  addi $t0, $t0, -1\n"), std::string::npos);
+    EXPECT_NE(listing.find("  bne $t0, $zero, 0x00000004 <loop>\n"), std::string::npos);
+    EXPECT_NE(listing.find("  jal 0x00000020 <done>\n"), std::string::npos);
+    EXPECT_NE(listing.find("  sw $t0, -4($sp)\n"), std::string::npos);
+    EXPECT_NE(listing.find("  ori $t1, $t0, 0x8000\n"), std::string::npos);
+    EXPECT_NE(listing.find("  sllv $t2, $t1, $t0\n"), std::string::npos);
+    EXPECT_NE(listing.find("  jalr $ra, $t9\n"), std::string::npos);
+    EXPECT_NE(listing.find("done:\n00000020  "), std::string::npos);
+    EXPECT_EQ(listing.substr(listing.size() - 8), "trap 10\n");
+}
+
+TEST(DisassemblerTest, FormatsZeroAndInvalidWords)
+{
+    mips::Disassembler disassembler;
+    std::string        text;
+    disassembler.formatInstruction(0, 0, text);
+    EXPECT_EQ(text, "nop");
+
+    text.clear();
+    disassembler.formatInstruction(0xFC000000, 0, text);  // Opcode 0x3F
+    EXPECT_EQ(text, ".word 0xfc000000");
+
+    // A branch to an address with no symbol prints the bare address
+    text.clear();
+    disassembler.formatInstruction(0x1000FFFF, 4, text);  // beq $zero, $zero, -1
+    EXPECT_EQ(text, "beq $zero, $zero, 0x00000010");
+}
+
+TEST(DisassemblerTest, ReadsSymbolMaps)
+{
+    std::istringstream              good("# Symbol Map File for prog.asm\n"
+                                         "# Format: <label> <address>\n"
+                                         "\n"
+                                         "main 0x0\n"
+                                         "loop 0x1c\n"
+                                         "count 32\n");
+    std::map<std::string, uint32_t> symbols;
+    std::string                     error;
+    ASSERT_TRUE(mips::Disassembler::readSymbolMap(good, symbols, error)) << error;
+    EXPECT_EQ(symbols,
+              (std::map<std::string, uint32_t>{{"main", 0}, {"loop", 0x1C}, {"count", 32}}));
+
+    std::istringstream missing("main 0x0\nloop\n");
+    EXPECT_FALSE(mips::Disassembler::readSymbolMap(missing, symbols, error));
+    EXPECT_NE(error.find("line 2"), std::string::npos);
+
+    std::istringstream invalid("main zero\n");
+    EXPECT_FALSE(mips::Disassembler::readSymbolMap(invalid, symbols, error));
+    EXPECT_NE(error.find("invalid address 'zero'"), std::string::npos);
+}
+
+TEST_F(DisasmCommandTest, HonoursRangeAndSymbolMap)
+{
+    cli::DisasmConfig config;
+    config.input = writeObject(assembleObject(SAMPLE_PROGRAM));
+    config.start = 0x08;
+    config.count = 2;
+    {
+        std::ofstream map(dir / "prog.map");
+        map << "# Format: <label> <address>\nretry 0x4\nfinish 0x20\n";
+    }
+    config.map = (dir / "prog.map").string();
+
+    ASSERT_EQ(run(config), cli::EXIT_OK);
+    const std::string listing = output.str();
+    EXPECT_EQ(listing.find("00000008  "), 0u);
+    EXPECT_NE(listing.find("bne $t0, $zero, 0x00000004 <loop>"), std::string::npos);
+    EXPECT_NE(listing.find("jal 0x00000020 <done>"), std::string::npos);
+    EXPECT_EQ(listing.find("0000000c  "), listing.find('\n') + 1);
+    EXPECT_EQ(std::count(listing.begin(), listing.end(), '\n'), 2);
+
+    // Map symbols are added alongside the binary's own
+    config.start = 0x04;
+    config.count = 1;
+    ASSERT_EQ(run(config), cli::EXIT_OK);
+    EXPECT_EQ(output.str().find("loop:\nretry:\n00000004  "), 0u);
+}
+
+TEST_F(DisasmCommandTest, ReportsBadInputs)
+{
+    cli::DisasmConfig config;
+    config.input = (dir / "missing.bin").string();
+    EXPECT_EQ(run(config), cli::EXIT_IO_ERROR);
+
+    {
+        std::ofstream file(dir / "garbage.bin");
+        file << "not a binary";
+    }
+    config.input = (dir / "garbage.bin").string();
+    EXPECT_EQ(run(config), cli::EXIT_IO_ERROR);
+
+    config.input = writeObject(assembleObject(SAMPLE_PROGRAM));
+    config.map   = (dir / "missing.map").string();
+    EXPECT_EQ(run(config), cli::EXIT_IO_ERROR);
+
+    config.map   = "";
+    config.start = 0x400;
+    EXPECT_EQ(run(config), cli::EXIT_RUNTIME_ERROR);
+}
+
+TEST_F(DisasmCommandTest, ParallelOutputMatchesSerial)
+{
+    // Large enough to take the threaded path, with labels in every block
+    std::string source;
+    for (int i = 0; i < 8000; ++i)
+    {
+        source += "l" + std::to_string(i) + ":\n";
+        source += "addi $t0, $t0, " + std::to_string(i % 100 - 50) + "\n";
+        source += "beq $t0, $t1, l" + std::to_string(i - i % 16) + "\n";
+        source += "lw $t2, " + std::to_string(i % 64 * 4) + "($sp)\n";
+        source += "sltu $t3, $t2, $t0\n";
+        source += "srl $t4, $t3, 3\n";
+        source += "mflo $t5\n";
+        source += "xori $t6, $t5, 0xBEEF\n";
+        source += "sb $t6, 1($gp)\n";
+        source += "bgtz $t6, l" + std::to_string(i) + "\n";
+        source += "j l" + std::to_string((i * 7) % 8000) + "\n";
+    }
+    const mips::ObjectFile object = assembleObject(source);
+    ASSERT_EQ(object.text.size(), 80000u);
+
+    cli::DisasmConfig config;
+    config.input = writeObject(object);
+    config.jobs  = 1;
+    ASSERT_EQ(run(config), cli::EXIT_OK);
+    const std::string serial = output.str();
+    EXPECT_EQ(serial, disassemble(object));
+
+    for (int jobs : {2, 4, 7})
+    {
+        config.jobs = jobs;
+        ASSERT_EQ(run(config), cli::EXIT_OK);
+        EXPECT_EQ(output.str(), serial) << jobs << " jobs";
+    }
+}
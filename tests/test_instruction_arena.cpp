@@ -0,0 +1,120 @@
+#include "Assembler.h"
+#include "Instruction.h"
+#include "InstructionArena.h"
+#include <gtest/gtest.h>
+#include <string>
+
+using namespace mips;
+
+TEST(InstructionArenaTest, ScopedInstructionsAreContiguousAndFreedTogether)
+{
+    const size_t before = InstructionArena::liveArenas();
+
+    std::vector<std::unique_ptr<Instruction>> instructions;
+    {
+        InstructionArena::Scope arena;
+        EXPECT_EQ(InstructionArena::liveArenas(), before + 1);
+        for (int i = 0; i < 1000; ++i)
+        {
+            instructions.push_back(std::make_unique<AddInstruction>(8, 9, 10));
+        }
+    }
+
+    // Laid out in creation order, one header apart, apart from block boundaries
+    size_t adjacent = 0;
+    for (size_t i = 1; i < instructions.size(); ++i)
+    {
+        const auto* previous = reinterpret_cast<const char*>(instructions[i - 1].get());
+        const auto* current  = reinterpret_cast<const char*>(instructions[i].get());
+        adjacent += current - previous == sizeof(AddInstruction) + sizeof(void*);
+    }
+    EXPECT_GT(adjacent, instructions.size() - 16);
+
+    // The arena outlives its Scope until the last instruction goes
+    EXPECT_EQ(InstructionArena::liveArenas(), before + 1);
+    instructions.erase(instructions.begin(), instructions.begin() + 999);
+    EXPECT_EQ(InstructionArena::liveArenas(), before + 1);
+    instructions.clear();
+    EXPECT_EQ(InstructionArena::liveArenas(), before);
+
+    // Outside a Scope instructions come from the heap
+    auto standalone = std::make_unique<AddInstruction>(8, 9, 10);
+    EXPECT_EQ(InstructionArena::liveArenas(), before);
+}
+
+TEST(InstructionArenaTest, LabelNamesOutliveTheSourceAndClonesOutliveTheArena)
+{
+    const size_t before = InstructionArena::liveArenas();
+
+    std::unique_ptr<Instruction> copy;
+    {
+        auto source = std::make_unique<std::string>("top: add $t0, $t0, $t1\n"
+                                                    "bne $t0, $zero, a_rather_long_label_name\n"
+                                                    "a_rather_long_label_name: j top\n");
+        LabelMap labelMap;
+        auto     instructions = Assembler().assembleWithLabels(*source, labelMap);
+        source.reset();
+
+        Assembler::link(instructions, labelMap);
+        copy = instructions[1]->clone();  // Outside any Scope: a heap copy
+    }
+    EXPECT_EQ(InstructionArena::liveArenas(), before);
+
+    // The copy kept its own name and link
+    DecodedInstr decoded;
+    ASSERT_TRUE(copy->lower(decoded));
+    EXPECT_EQ(decoded.target, 2u);  // Instruction index of the label
+
+    std::string unresolved;
+    EXPECT_FALSE(copy->link(LabelMap{{"top", 0}}, unresolved));
+    EXPECT_EQ(unresolved, "a_rather_long_label_name");
+}
+
+TEST(InstructionArenaTest, ParallelAssemblyFreesEveryChunkArena)
+{
+    const size_t before = InstructionArena::liveArenas();
+
+    std::string source;
+    for (int i = 0; source.size() < (2u << 20); ++i)
+    {
+        const std::string label = "l" + std::to_string(i);
+        source += label + ": addi $t0, $t0, 1\nbeq $t0, $t1, " + label + "\nj " + label + "\n";
+    }
+
+    LabelMap labelMap;
+    auto     instructions = Assembler(4).assembleWithLabels(source, labelMap);
+    EXPECT_GT(InstructionArena::liveArenas(), before + 1);  // One per chunk
+    Assembler::link(instructions, labelMap);
+
+    instructions.clear();
+    EXPECT_EQ(InstructionArena::liveArenas(), before);
+}
+
+TEST(InstructionArenaTest, NamesOutsideAnArenaAreOwnedByTheirLabel)
+{
+    auto name = std::make_unique<std::string>("a_label_built_outside_any_scope");
+
+    // On the stack, from the heap and copied: each holds its own copy
+    LabelRef                     onStack(*name);
+    auto                         onHeap = std::make_unique<JInstruction>(*name);
+    std::unique_ptr<Instruction> clone  = onHeap->clone();
+    LabelRef                     assigned("other");
+    assigned        = onStack;
+    LabelRef& alias = assigned;
+    assigned        = alias;
+    name.reset();
+
+    EXPECT_EQ(onStack.name(), "a_label_built_outside_any_scope");
+    EXPECT_EQ(assigned.name(), onStack.name());
+    EXPECT_NE(assigned.name().data(), onStack.name().data());
+    onHeap.reset();
+
+    std::string unresolved;
+    EXPECT_FALSE(clone->link(LabelMap{}, unresolved));
+    EXPECT_EQ(unresolved, "a_label_built_outside_any_scope");
+
+    // Inside a Scope, a name only goes to the arena for the instruction being built
+    InstructionArena::Scope arena;
+    LabelRef                local("in_scope_but_on_the_stack");
+    EXPECT_EQ(local.name(), "in_scope_but_on_the_stack");
+}
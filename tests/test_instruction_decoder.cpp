@@ -4,6 +4,7 @@
 #include "../src/Memory.h"
 #include "../src/RegisterFile.h"
 #include <gtest/gtest.h>
+#include <vector>
 
 using namespace mips;
 
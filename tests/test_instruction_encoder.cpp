@@ -0,0 +1,342 @@
+#include "../cli/assemble_executor.hpp"
+#include "Assembler.h"
+#include "DecodedInstruction.h"
+#include "Instruction.h"
+#include "InstructionDecoder.h"
+#include "InstructionEncoder.h"
+#include "MipsSimulatorAPI.h"
+#include "ObjectFile.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+
+namespace
+{
+
+// One of every mnemonic the assembler accepts, with forward and backward branches
+const std::string EVERY_INSTRUCTION = "start:\n"
+                                      "add $t0, $t1, $t2\n"
+                                      "addu $t0, $t1, $t2\n"
+                                      "sub $t0, $t1, $t2\n"
+                                      "subu $t0, $t1, $t2\n"
+                                      "and $t0, $t1, $t2\n"
+                                      "or $t0, $t1, $t2\n"
+                                      "xor $t0, $t1, $t2\n"
+                                      "nor $t0, $t1, $t2\n"
+                                      "slt $t0, $t1, $t2\n"
+                                      "sltu $t0, $t1, $t2\n"
+                                      "sllv $t0, $t1, $t2\n"
+                                      "srlv $t0, $t1, $t2\n"
+                                      "srav $t0, $t1, $t2\n"
+                                      "sll $t0, $t1, 3\n"
+                                      "srl $t0, $t1, 31\n"
+                                      "sra $t0, $t1, 7\n"
+                                      "mult $t1, $t2\n"
+                                      "multu $t1, $t2\n"
+                                      "div $t1, $t2\n"
+                                      "divu $t1, $t2\n"
+                                      "mfhi $t3\n"
+                                      "mthi $t3\n"
+                                      "mflo $t4\n"
+                                      "mtlo $t4\n"
+                                      "addi $t0, $t1, -5\n"
+                                      "addiu $t0, $t1, 32767\n"
+                                      "sltiu $t0, $t1, -1\n"
+                                      "andi $t0, $t1, 0xFFFF\n"
+                                      "ori $t0, $t1, 0x8000\n"
+                                      "xori $t0, $t1, 255\n"
+                                      "llo $t0, 0x1234\n"
+                                      "lhi $t0, 0xABCD\n"
+                                      "la $a0, value\n"
+                                      "lw $t0, -4($sp)\n"
+                                      "lb $t0, 1($t1)\n"
+                                      "lbu $t0, 2($t1)\n"
+                                      "lh $t0, 6($t1)\n"
+                                      "lhu $t0, 8($t1)\n"
+                                      "sw $t0, 12($t1)\n"
+                                      "sb $t0, 13($t1)\n"
+                                      "sh $t0, 14($t1)\n"
+                                      "beq $t0, $t1, later\n"
+                                      "bne $t0, $t1, start\n"
+                                      "blez $t0, start\n"
+                                      "bgtz $t0, later\n"
+                                      "j later\n"
+                                      "jal start\n"
+                                      "jr $ra\n"
+                                      "jalr $t9\n"
+                                      "later:\n"
+                                      "syscall\n"
+                                      "trap 10\n"
+                                      "value:\n"
+                                      ".word 42\n";
+
+struct Assembled
+{
+    std::vector<std::unique_ptr<mips::Instruction>> instructions;
+    std::vector<mips::DataDirective>                dataDirectives;
+    std::map<std::string, uint32_t>                 labelMap;
+};
+
+Assembled assemble(const std::string& source)
+{
+    mips::Assembler assembler;
+    Assembled       result;
+    result.instructions =
+        assembler.assembleWithLabels(source, result.labelMap, result.dataDirectives);
+    mips::Assembler::link(result.instructions, result.labelMap);
+    return result;
+}
+
+bool sameLowering(const mips::Instruction& a, const mips::Instruction& b)
+{
+    mips::DecodedInstr x;
+    mips::DecodedInstr y;
+    if (!a.lower(x) || !b.lower(y))
+    {
+        return a.getName() == b.getName();  // syscall and trap have no lowered form
+    }
+    if (x.op == mips::DecodedOp::La)
+    {
+        // la is encoded as "ori rt, $zero, address"
+        return y.op == mips::DecodedOp::Ori && y.rd == x.rd && y.rs == 0 && y.imm == x.imm;
+    }
+    return x.op == y.op && x.rd == y.rd && x.rs == y.rs && x.rt == y.rt && x.imm == y.imm &&
+           x.target == y.target;
+}
+
+}  // namespace
+
+TEST(InstructionEncoderTest, EncodesStandardLayouts)
+{
+    Assembled program = assemble("add $t0, $t1, $t2\n"
+                                 "addi $t0, $zero, 5\n"
+                                 "loop:\n"
+                                 "sw $t0, -8($sp)\n"
+                                 "bne $t0, $zero, loop\n"
+                                 "j loop\n"
+                                 "syscall\n"
+                                 "trap 10\n");
+    std::vector<uint32_t> words = mips::InstructionEncoder::encodeProgram(program.instructions);
+
+    ASSERT_EQ(words.size(), 7u);
+    EXPECT_EQ(words[0], 0x012A4020u);  // add: rs=9 rt=10 rd=8 funct=0x20
+    EXPECT_EQ(words[1], 0x20080005u);  // addi: opcode 8, rt=8, imm 5
+    EXPECT_EQ(words[2], 0xAFA8FFF8u);  // sw: opcode 0x2B, rs=29, rt=8, imm -8
+    EXPECT_EQ(words[3], 0x1500FFFEu);  // bne: offset -2 from the next instruction
+    EXPECT_EQ(words[4], 0x08000002u);  // j: instruction index 2
+    EXPECT_EQ(words[5], 0x0000000Cu);
+    EXPECT_EQ(words[6], 0x6800000Au);  // trap: opcode 0x1A, code 10
+}
+
+TEST(InstructionEncoderTest, EveryInstructionRoundTripsThroughDecoder)
+{
+    Assembled             program = assemble(EVERY_INSTRUCTION);
+    std::vector<uint32_t> words   = mips::InstructionEncoder::encodeProgram(program.instructions);
+    ASSERT_EQ(words.size(), program.instructions.size());
+
+    auto decoded = mips::InstructionDecoder::decodeProgram(words.data(), words.size());
+    ASSERT_EQ(decoded.size(), program.instructions.size());
+    for (size_t i = 0; i < words.size(); ++i)
+    {
+        EXPECT_TRUE(sameLowering(*program.instructions[i], *decoded[i]))
+            << "instruction " << i << " '" << program.instructions[i]->getName() << "'";
+        // Re-encoding the decoded instruction is stable
+        EXPECT_EQ(mips::InstructionEncoder::encode(*decoded[i], static_cast<uint32_t>(i)),
+                  words[i]);
+    }
+}
+
+TEST(InstructionEncoderTest, RejectsOperandsWithoutEncoding)
+{
+    mips::LAInstruction unlinked(4, "nowhere");
+    EXPECT_THROW(mips::InstructionEncoder::encode(unlinked, 0), std::runtime_error);
+
+    Assembled far = assemble("la $a0, far\nfar:\n");
+    far.labelMap["far"] = 0x10010000;
+    mips::Assembler::link(far.instructions, far.labelMap);
+    EXPECT_THROW(mips::InstructionEncoder::encodeProgram(far.instructions), std::runtime_error);
+
+    const uint32_t invalid = 0xFC000000;  // Opcode 0x3F
+    EXPECT_THROW(mips::InstructionDecoder::decodeProgram(&invalid, 1), std::runtime_error);
+}
+
+TEST(ObjectFileTest, WriteAndReadRoundTrip)
+{
+    Assembled        program = assemble(EVERY_INSTRUCTION);
+    mips::ObjectFile object  = mips::ObjectFile::fromProgram(
+        program.instructions, program.dataDirectives, program.labelMap);
+    EXPECT_EQ(object.dataBase, program.labelMap.at("value"));
+    EXPECT_EQ(object.data, (std::vector<uint8_t>{42, 0, 0, 0}));
+
+    std::stringstream stream;
+    object.write(stream);
+    EXPECT_EQ(stream.str().size(), mips::ObjectFile::HEADER_BYTES + object.text.size() * 4 + 4 +
+                                       (4 + 2 + 5) + (4 + 2 + 5) + (4 + 2 + 5));
+
+    mips::ObjectFile loaded;
+    std::string      error;
+    ASSERT_TRUE(mips::ObjectFile::read(stream, loaded, error)) << error;
+    EXPECT_EQ(loaded.text, object.text);
+    EXPECT_EQ(loaded.dataBase, object.dataBase);
+    EXPECT_EQ(loaded.data, object.data);
+    EXPECT_EQ(loaded.symbols, program.labelMap);
+
+    std::stringstream truncated(stream.str().substr(0, 40));
+    EXPECT_FALSE(mips::ObjectFile::read(truncated, loaded, error));
+    EXPECT_EQ(error, "binary is truncated");
+
+    std::stringstream text("add $t0, $t1, $t2\n");
+    EXPECT_FALSE(mips::ObjectFile::read(text, loaded, error));
+    EXPECT_EQ(error, "not a mipsim binary");
+}
+
+TEST(ObjectFileTest, AssembleCommandWritesContainer)
+{
+    auto dir = std::filesystem::temp_directory_path() / "mipsim_object_file_test";
+    std::filesystem::create_directories(dir);
+    {
+        std::ofstream file(dir / "prog.asm");
+        file << "addi $a0, $zero, 7\ntrap 1\ntrap 10\n";
+    }
+
+    cli::AssembleConfig config;
+    config.input  = (dir / "prog.asm").string();
+    config.output = (dir / "prog.bin").string();
+    ASSERT_EQ(cli::execute_assemble_command(config), cli::EXIT_OK);
+
+    std::ifstream    file(dir / "prog.bin", std::ios::binary);
+    mips::ObjectFile object;
+    std::string      error;
+    ASSERT_TRUE(mips::ObjectFile::read(file, object, error)) << error;
+    EXPECT_EQ(object.text, (std::vector<uint32_t>{0x20040007, 0x68000001, 0x6800000A}));
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST(ObjectFileTest, ViewParsesMisalignedBytes)
+{
+    Assembled        program = assemble("la $a0, value\ntrap 1\ntrap 10\nvalue:\n.word 7\n");
+    mips::ObjectFile object  = mips::ObjectFile::fromProgram(
+        program.instructions, program.dataDirectives, program.labelMap);
+    std::stringstream stream;
+    object.write(stream);
+
+    // Shift the image by one byte so the text section cannot be used in place
+    const std::string bytes = " " + stream.str();
+    mips::ObjectFile::View view;
+    std::string            error;
+    ASSERT_TRUE(mips::ObjectFile::view(bytes.data() + 1, bytes.size() - 1, view, error)) << error;
+    EXPECT_EQ(std::vector<uint32_t>(view.text, view.text + view.textWords), object.text);
+    EXPECT_EQ(std::vector<uint8_t>(view.data, view.data + view.dataBytes), object.data);
+    EXPECT_EQ(view.symbols, program.labelMap);
+}
+
+TEST(ObjectFileTest, BinaryRunsLikeItsSource)
+{
+    const std::string source = "la $a0, greeting\n"
+                               "addi $v0, $zero, 4\n"
+                               "syscall\n"
+                               "la $t0, table\n"
+                               "lw $a0, 4($t0)\n"
+                               "jal print\n"
+                               "trap 10\n"
+                               "print:\n"
+                               "addi $v0, $zero, 1\n"
+                               "syscall\n"
+                               "jr $ra\n"
+                               "greeting:\n"
+                               ".asciiz \"sum=\"\n"
+                               "table:\n"
+                               ".word 5, 12\n";
+
+    auto dir = std::filesystem::temp_directory_path() / "mipsim_binary_load_test";
+    std::filesystem::create_directories(dir);
+    {
+        std::ofstream file(dir / "prog.asm");
+        file << source;
+    }
+    cli::AssembleConfig config;
+    config.input  = (dir / "prog.asm").string();
+    config.output = (dir / "prog.bin").string();
+    ASSERT_EQ(cli::execute_assemble_command(config), cli::EXIT_OK);
+
+    mips::MipsSimulatorAPI fromSource;
+    ASSERT_TRUE(fromSource.loadProgram(source));
+    fromSource.run(1000);
+
+    mips::MipsSimulatorAPI fromBinary;
+    ASSERT_TRUE(fromBinary.loadBinaryFile((dir / "prog.bin").string()))
+        << fromBinary.getLastError();
+    fromBinary.run(1000);
+
+    ASSERT_TRUE(fromBinary.isTerminated());
+    EXPECT_EQ(fromBinary.getConsoleOutput(), "sum=12\n");
+    EXPECT_EQ(fromBinary.getConsoleOutput(), fromSource.getConsoleOutput());
+
+    {
+        std::ofstream file(dir / "bad.bin", std::ios::binary);
+        file << "not a binary";
+    }
+    EXPECT_FALSE(fromBinary.loadBinaryFile((dir / "bad.bin").string()));
+    EXPECT_NE(fromBinary.getLastError().find("not a mipsim binary"), std::string::npos);
+    EXPECT_FALSE(fromBinary.loadBinaryFile((dir / "missing.bin").string()));
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST(InstructionEncoderTest, DecodeRangeMatchesLoweredInstructions)
+{
+    // Writes to $zero lower to Nop but keep their fields
+    const std::string     zeroWrites = "add $zero, $t1, $t2\naddi $zero, $t1, 4\nllo $zero, 7\n";
+    Assembled             program    = assemble(EVERY_INSTRUCTION + zeroWrites);
+    std::vector<uint32_t> words = mips::InstructionEncoder::encodeProgram(program.instructions);
+    auto decoded = mips::InstructionDecoder::decodeProgram(words.data(), words.size());
+
+    // Table-driven records, placed as if the text started at instruction 100
+    const uint32_t                  first = 100;
+    std::vector<mips::DecodedInstr> records(words.size());
+    ASSERT_EQ(mips::InstructionDecoder::decodeRange(words, records, 0), words.size());
+    std::vector<mips::DecodedInstr> shifted(words.size());
+    ASSERT_EQ(mips::InstructionDecoder::decodeRange(words, shifted, first), words.size());
+
+    for (size_t i = 0; i < words.size(); ++i)
+    {
+        // What Cpu::lowerProgram builds from the decoded Instruction objects
+        mips::DecodedInstr expected;
+        if (!decoded[i]->lower(expected))
+        {
+            expected        = mips::DecodedInstr{};
+            expected.op     = mips::DecodedOp::Fallback;
+            expected.target = static_cast<uint32_t>(i);
+        }
+
+        const mips::DecodedInstr& actual = records[i];
+        EXPECT_EQ(actual.op, expected.op) << "instruction " << i;
+        EXPECT_EQ(actual.rd, expected.rd) << "instruction " << i;
+        EXPECT_EQ(actual.rs, expected.rs) << "instruction " << i;
+        EXPECT_EQ(actual.rt, expected.rt) << "instruction " << i;
+        EXPECT_EQ(actual.imm, expected.imm) << "instruction " << i;
+        EXPECT_EQ(actual.target, expected.target) << "instruction " << i;
+
+        mips::DecodedInstr single;
+        ASSERT_TRUE(
+            mips::InstructionDecoder::decodeInto(words[i], single, static_cast<uint32_t>(i)));
+        EXPECT_EQ(std::memcmp(&single, &actual, sizeof(single)), 0) << "instruction " << i;
+
+        // Branch and self targets move with the base index; jump fields are absolute
+        const bool relative = actual.op == mips::DecodedOp::Beq ||
+                              actual.op == mips::DecodedOp::Bne ||
+                              actual.op == mips::DecodedOp::Blez ||
+                              actual.op == mips::DecodedOp::Bgtz ||
+                              actual.op == mips::DecodedOp::Fallback;
+        EXPECT_EQ(shifted[i].target, actual.target + (relative ? first : 0)) << "instruction " << i;
+    }
+
+    // Decoding stops at the first invalid word
+    words[3] = 0xFC000000;
+    EXPECT_EQ(mips::InstructionDecoder::decodeRange(words, records), 3u);
+    EXPECT_FALSE(mips::InstructionDecoder::decodeInto(words[3], records[0]));
+}
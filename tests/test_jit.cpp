@@ -0,0 +1,210 @@
+#include "BlockCache.h"
+#include "Cpu.h"
+#include "Jit.h"
+#include "Memory.h"
+#include "RegisterFile.h"
+#include <gtest/gtest.h>
+#include <array>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+mips::DecodedInstr makeOp(mips::DecodedOp op, uint8_t rd, uint8_t rs, uint8_t rt,
+                          uint32_t imm = 0, uint32_t target = 0)
+{
+    mips::DecodedInstr d;
+    d.op     = op;
+    d.rd     = rd;
+    d.rs     = rs;
+    d.rt     = rt;
+    d.imm    = imm;
+    d.target = target;
+    return d;
+}
+
+}  // namespace
+
+TEST(JitTest, TranslatesBlockOnceHot)
+{
+    if (!mips::JitCompiler::available)
+    {
+        GTEST_SKIP() << "No JIT in this build";
+    }
+
+    using mips::DecodedOp;
+    // 0: $t0 = $t0 + 5   1: $t1 = $t0 * $t0 (LO)   2: mflo $t2   3: sw $t2, 16($zero)
+    // 4: bne $t0, $zero -> 0
+    std::vector<mips::DecodedInstr> program = {
+        makeOp(DecodedOp::Addi, 8, 8, 0, 5),
+        makeOp(DecodedOp::Mult, 0, 8, 8),
+        makeOp(DecodedOp::Mflo, 10, 0, 0),
+        makeOp(DecodedOp::Sw, 0, 0, 10, 16),
+        makeOp(DecodedOp::Bne, 0, 8, 0, 0, 0),
+    };
+
+    mips::BlockCache cache;
+    cache.build(program);
+    int32_t index = cache.blockAt(0);
+
+    mips::JitCompiler jit;
+    jit.reset(program.size());
+    for (uint32_t i = 1; i < mips::JitCompiler::HOT_THRESHOLD; ++i)
+    {
+        EXPECT_EQ(jit.lookup(index, cache.block(index), program), nullptr);
+    }
+    mips::JitBlockFn native = jit.lookup(index, cache.block(index), program);
+    ASSERT_NE(native, nullptr);
+    EXPECT_EQ(jit.compiledBlockCount(), 1u);
+    EXPECT_EQ(jit.lookup(index, cache.block(index), program), native);
+
+    std::array<uint32_t, 32> regs{};
+    mips::Memory             memory;
+    mips::JitContext         context;
+    context.memory     = &memory;
+    context.entries    = jit.entryTable();
+    context.entryCount = static_cast<uint32_t>(program.size());
+
+    // The taken branch chains back into the block until the budget is spent
+    context.budget = 12;
+    EXPECT_EQ(native(regs.data(), &context), 0u);
+    EXPECT_EQ(context.budget, 2);
+    EXPECT_EQ(regs[8], 10u);
+    EXPECT_EQ(regs[10], 100u);
+    EXPECT_EQ(context.lo, 100u);
+    EXPECT_EQ(memory.readWord(16), 100u);
+
+    // The not-taken exit leaves at the end of the program
+    regs[8]        = static_cast<uint32_t>(-5);
+    context.budget = 100;
+    EXPECT_EQ(native(regs.data(), &context), 5u);
+    EXPECT_EQ(context.budget, 95);
+    EXPECT_EQ(regs[8], 0u);
+
+    jit.reset(program.size());
+    EXPECT_EQ(jit.compiledBlockCount(), 0u);
+    EXPECT_EQ(jit.lookup(index, cache.block(index), program), nullptr);
+}
+
+TEST(JitTest, BlocksEndingInFallbackStayInterpreted)
+{
+    using mips::DecodedOp;
+    std::vector<mips::DecodedInstr> program = {
+        makeOp(DecodedOp::Addi, 8, 8, 0, 1),
+        makeOp(DecodedOp::Fallback, 0, 0, 0, 0, 1),
+    };
+
+    mips::BlockCache cache;
+    cache.build(program);
+    int32_t index = cache.blockAt(0);
+
+    mips::JitCompiler jit;
+    jit.reset(program.size());
+    for (uint32_t i = 0; i < 4 * mips::JitCompiler::HOT_THRESHOLD; ++i)
+    {
+        EXPECT_EQ(jit.lookup(index, cache.block(index), program), nullptr);
+    }
+    EXPECT_EQ(jit.compiledBlockCount(), 0u);
+}
+
+TEST(JitTest, HotLoopMatchesReference)
+{
+    // Every translated operation runs well past the hot threshold
+    const std::string program = "addi $s7, $zero, 40\n"
+                                "addi $sp, $zero, 768\n"
+                                "la $s6, square\n"
+                                "loop:\n"
+                                "addi $t0, $s7, -20\n"
+                                "addu $t1, $t0, $s7\n"
+                                "sub $t2, $t0, $s7\n"
+                                "subu $t3, $s7, $t0\n"
+                                "and $t4, $t1, $t2\n"
+                                "or $t5, $t1, $t2\n"
+                                "xor $t6, $t1, $t2\n"
+                                "nor $t7, $t1, $t2\n"
+                                "slt $s0, $t0, $zero\n"
+                                "sltu $s1, $t0, $s7\n"
+                                "slti $s2, $t0, -3\n"
+                                "sltiu $s3, $t0, 5\n"
+                                "andi $s4, $t2, 0xF0F0\n"
+                                "ori $s5, $t0, 0x8001\n"
+                                "xori $t8, $t2, 0x00FF\n"
+                                "sll $t9, $t2, 7\n"
+                                "srl $a2, $t2, 3\n"
+                                "sra $a3, $t2, 3\n"
+                                "sllv $v1, $t2, $s7\n"
+                                "srlv $k0, $t2, $s7\n"
+                                "srav $k1, $t2, $s7\n"
+                                "mult $t2, $t1\n"
+                                "mfhi $gp\n"
+                                "mflo $fp\n"
+                                "multu $t2, $t1\n"
+                                "mfhi $t1\n"
+                                "div $t2, $t0\n"
+                                "mflo $t3\n"
+                                "divu $t2, $s7\n"
+                                "mfhi $t4\n"
+                                "mthi $t0\n"
+                                "mtlo $s7\n"
+                                "lhi $t5, 0x1234\n"
+                                "llo $t5, 0x5678\n"
+                                "sw $t2, 0($sp)\n"
+                                "sb $t0, 4($sp)\n"
+                                "sh $t2, 6($sp)\n"
+                                "lw $t6, 0($sp)\n"
+                                "lb $t7, 4($sp)\n"
+                                "lbu $s0, 4($sp)\n"
+                                "lh $s1, 6($sp)\n"
+                                "lhu $s2, 6($sp)\n"
+                                "sw $t2, 2($sp)\n"
+                                "addi $sp, $sp, 8\n"
+                                "jal square\n"
+                                "jalr $s6\n"
+                                "blez $t0, skip\n"
+                                "addi $a1, $a1, 1\n"
+                                "skip:\n"
+                                "bgtz $t0, next\n"
+                                "addi $a0, $a0, 1\n"
+                                "next:\n"
+                                "beq $t0, $zero, zero_case\n"
+                                "addi $s7, $s7, -1\n"
+                                "bne $s7, $zero, loop\n"
+                                "j done\n"
+                                "zero_case:\n"
+                                "addi $s7, $s7, -1\n"
+                                "j loop\n"
+                                "square:\n"
+                                "mult $t0, $t0\n"
+                                "mflo $v0\n"
+                                "jr $ra\n"
+                                "done:\n"
+                                "trap exit\n";
+
+    mips::Cpu reference;
+    reference.setExecutionEngine(mips::ExecutionEngine::Reference);
+    reference.loadProgramFromString(program);
+    reference.run(100000);
+    ASSERT_TRUE(reference.shouldTerminate());
+
+    mips::Cpu cpu;
+    cpu.setExecutionEngine(mips::ExecutionEngine::Jit);
+    cpu.loadProgramFromString(program);
+    cpu.run(100000);
+
+    for (int reg = 0; reg < mips::RegisterFile::NUM_REGISTERS; ++reg)
+    {
+        EXPECT_EQ(cpu.getRegisterFile().read(reg), reference.getRegisterFile().read(reg))
+            << "Register $" << reg << " differs";
+    }
+    EXPECT_EQ(cpu.getRegisterFile().readHI(), reference.getRegisterFile().readHI());
+    EXPECT_EQ(cpu.getRegisterFile().readLO(), reference.getRegisterFile().readLO());
+    EXPECT_EQ(cpu.getProgramCounter(), reference.getProgramCounter());
+    EXPECT_EQ(cpu.getCycleCount(), reference.getCycleCount());
+    EXPECT_TRUE(cpu.shouldTerminate());
+    for (uint32_t address = 0; address < 0x800; address += 4)
+    {
+        EXPECT_EQ(cpu.getMemory().readWord(address), reference.getMemory().readWord(address))
+            << "Memory word at " << address << " differs";
+    }
+}
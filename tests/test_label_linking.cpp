@@ -0,0 +1,105 @@
+#include "Assembler.h"
+#include "Cpu.h"
+#include "Instruction.h"
+#include "MipsSimulatorAPI.h"
+#include "RegisterFile.h"
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+
+TEST(LabelLinkingTest, LinkResolvesBranchJumpAndLaTargets)
+{
+    mips::Assembler                 assembler;
+    std::map<std::string, uint32_t> labelMap;
+    auto instructions = assembler.assembleWithLabels("start:\n"
+                                                     "beq $t0, $t1, done\n"
+                                                     "j start\n"
+                                                     "la $a0, value\n"
+                                                     "done:\n"
+                                                     "jal start\n"
+                                                     "value:\n"
+                                                     ".word 7\n",
+                                                     labelMap);
+    ASSERT_EQ(instructions.size(), 4u);
+
+    EXPECT_NO_THROW(mips::Assembler::link(instructions, labelMap));
+
+    mips::DecodedInstr decoded;
+    ASSERT_TRUE(instructions[0]->lower(decoded));
+    EXPECT_EQ(decoded.target, 3u);
+    ASSERT_TRUE(instructions[1]->lower(decoded));
+    EXPECT_EQ(decoded.target, 0u);
+    ASSERT_TRUE(instructions[2]->lower(decoded));
+    EXPECT_EQ(decoded.imm, labelMap.at("value"));
+    ASSERT_TRUE(instructions[3]->lower(decoded));
+    EXPECT_EQ(decoded.target, 0u);
+}
+
+TEST(LabelLinkingTest, UndefinedLabelsAreReportedAtLinkTime)
+{
+    mips::Assembler                 assembler;
+    std::map<std::string, uint32_t> labelMap;
+    auto instructions = assembler.assembleWithLabels("bne $t0, $t1, nowhere\n"
+                                                     "la $a0, missing_data\n",
+                                                     labelMap);
+
+    try
+    {
+        mips::Assembler::link(instructions, labelMap);
+        FAIL() << "Expected link to fail";
+    }
+    catch (const std::runtime_error& e)
+    {
+        const std::string message = e.what();
+        EXPECT_NE(message.find("'nowhere' (instruction 0)"), std::string::npos) << message;
+        EXPECT_NE(message.find("'missing_data' (instruction 1)"), std::string::npos) << message;
+    }
+}
+
+TEST(LabelLinkingTest, LoadProgramRejectsUndefinedLabel)
+{
+    mips::Cpu cpu;
+    EXPECT_THROW(cpu.loadProgramFromString("j nowhere\n"), std::runtime_error);
+
+    mips::MipsSimulatorAPI api;
+    EXPECT_FALSE(api.loadProgram("addi $t0, $zero, 1\n"
+                                 "beq $t0, $zero, nowhere\n"));
+    EXPECT_NE(api.getLastError().find("nowhere"), std::string::npos);
+}
+
+TEST(LabelLinkingTest, LinkedProgramRunsOnReferenceEngine)
+{
+    mips::Cpu cpu;
+    cpu.setExecutionEngine(mips::ExecutionEngine::Reference);
+    cpu.loadProgramFromString("addi $t0, $zero, 4\n"
+                              "loop:\n"
+                              "addi $t0, $t0, -1\n"
+                              "bne $t0, $zero, loop\n"
+                              "la $t1, value\n"
+                              "lw $t2, 0($t1)\n"
+                              "trap exit\n"
+                              "value:\n"
+                              ".word 99\n");
+    cpu.run(100);
+
+    EXPECT_TRUE(cpu.shouldTerminate());
+    EXPECT_EQ(cpu.getRegisterFile().read(8), 0u);
+    EXPECT_EQ(cpu.getRegisterFile().read(10), 99u);
+}
+
+TEST(LabelLinkingTest, UnlinkedInstructionFallsBackToCpuLabelTable)
+{
+    mips::Cpu cpu;
+    cpu.loadProgramFromString("nop_target:\n"
+                              "addi $t0, $zero, 1\n"
+                              "addi $t0, $zero, 2\n"
+                              "target:\n"
+                              "addi $t0, $zero, 3\n");
+
+    mips::JInstruction jump("target");
+    mips::DecodedInstr decoded;
+    EXPECT_FALSE(jump.lower(decoded));
+
+    jump.execute(cpu);
+    EXPECT_EQ(cpu.getProgramCounter(), 2u);
+}
@@ -0,0 +1,100 @@
+#include "Cpu.h"
+#include "Log.h"
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+
+namespace
+{
+
+class LogTest : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        mips::Log::reset();
+        mips::Log::setSink(&m_output);
+    }
+
+    void TearDown() override
+    {
+        mips::Log::reset();
+    }
+
+    std::ostringstream m_output;
+};
+
+}  // namespace
+
+TEST_F(LogTest, DefaultsToWarnForEveryCategory)
+{
+    EXPECT_TRUE(mips::Log::isEnabled(mips::LogCategory::Cpu, mips::LogLevel::Error));
+    EXPECT_TRUE(mips::Log::isEnabled(mips::LogCategory::Cpu, mips::LogLevel::Warn));
+    EXPECT_FALSE(mips::Log::isEnabled(mips::LogCategory::Cpu, mips::LogLevel::Info));
+    EXPECT_FALSE(mips::Log::isEnabled(mips::LogCategory::Memory, mips::LogLevel::Trace));
+}
+
+TEST_F(LogTest, ConfigureSetsPerCategoryLevels)
+{
+    std::string error;
+    ASSERT_TRUE(mips::Log::configure("cpu,memory=debug", error)) << error;
+
+    EXPECT_EQ(mips::Log::getLevel(mips::LogCategory::Cpu), mips::LogLevel::Trace);
+    EXPECT_EQ(mips::Log::getLevel(mips::LogCategory::Memory), mips::LogLevel::Debug);
+    EXPECT_EQ(mips::Log::getLevel(mips::LogCategory::Branch), mips::LogLevel::Warn);
+
+    ASSERT_TRUE(mips::Log::configure("all=off,syscall=info", error)) << error;
+    EXPECT_EQ(mips::Log::getLevel(mips::LogCategory::Cpu), mips::LogLevel::Off);
+    EXPECT_EQ(mips::Log::getLevel(mips::LogCategory::Syscall), mips::LogLevel::Info);
+}
+
+TEST_F(LogTest, InvalidSpecLeavesLevelsUnchanged)
+{
+    std::string error;
+    EXPECT_FALSE(mips::Log::configure("cpu,bogus", error));
+    EXPECT_EQ(error, "unknown log category 'bogus'");
+    EXPECT_FALSE(mips::Log::configure("cpu=loud", error));
+    EXPECT_EQ(error, "unknown log level 'loud'");
+    EXPECT_FALSE(mips::Log::configure("cpu,,memory", error));
+
+    EXPECT_EQ(mips::Log::getLevel(mips::LogCategory::Cpu), mips::LogLevel::Warn);
+}
+
+TEST_F(LogTest, ExecutionIsSilentByDefault)
+{
+    mips::Cpu cpu;
+    cpu.setExecutionEngine(mips::ExecutionEngine::Reference);
+    cpu.loadProgramFromString("addi $a0, $zero, 5\n"
+                              "loop:\n"
+                              "addi $a0, $a0, -1\n"
+                              "bne $a0, $zero, loop\n"
+                              "sw $a0, 0($sp)\n");
+    cpu.run(50);
+
+    EXPECT_TRUE(m_output.str().empty()) << m_output.str();
+}
+
+TEST_F(LogTest, EnabledCategoryTracesExecution)
+{
+    if (!mips::Log::compiledIn)
+    {
+        GTEST_SKIP() << "Logging compiled out";
+    }
+
+    std::string error;
+    ASSERT_TRUE(mips::Log::configure("cpu,branch=debug", error)) << error;
+
+    mips::Cpu cpu;
+    cpu.setExecutionEngine(mips::ExecutionEngine::Reference);
+    cpu.loadProgramFromString("addi $t0, $zero, 1\n"
+                              "bne $t0, $zero, done\n"
+                              "addi $t1, $zero, 2\n"
+                              "done:\n"
+                              "addi $t2, $zero, 3\n");
+    cpu.run(3);
+
+    const std::string output = m_output.str();
+    EXPECT_NE(output.find("[trace] cpu: exec pc=0 instr='addi'"), std::string::npos) << output;
+    EXPECT_NE(output.find("[debug] branch: BNE taken label='done'"), std::string::npos) << output;
+    EXPECT_EQ(output.find("register:"), std::string::npos) << output;
+}
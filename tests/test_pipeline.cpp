@@ -52,3 +52,17 @@ TEST_F(PipelineTest, SingleCycleModeStillWorks)
     EXPECT_EQ(cpu->getRegisterFile().read(8), 8);  // $t0 should be 3 + 5 = 8
     EXPECT_EQ(cpu->getCycleCount(), 1);
 }
+
+TEST_F(PipelineTest, RetiredInstructionsGiveCpi)
+{
+    cpu->setPipelineMode(true);
+    cpu->loadProgramFromString("addi $t0, $zero, 1\n"
+                               "addi $t1, $zero, 2\n"
+                               "addi $t2, $zero, 3");
+
+    cpu->run(20);
+
+    // Filling the five-stage pipeline costs cycles that retire nothing
+    EXPECT_EQ(cpu->getRetiredInstructionCount(), 3u);
+    EXPECT_GT(cpu->getCycleCount(), cpu->getRetiredInstructionCount());
+}
@@ -0,0 +1,383 @@
+#include "Assembler.h"
+#include "Checkpoint.h"
+#include "Cpu.h"
+#include "Memory.h"
+#include "MipsSimulatorAPI.h"
+#include "ObjectFile.h"
+#include "ProgramCache.h"
+#include "ProgramImage.h"
+#include "Sha256.h"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+// Prints the character in its data word plus $a0, then exits
+std::string printProgram(char base)
+{
+    return "la $t1, value\n"
+           "lw $t2, 0($t1)\n"
+           "add $a0, $t2, $a0\n"
+           "addi $v0, $zero, 11\n"
+           "syscall\n"
+           "addi $v0, $zero, 10\n"
+           "syscall\n"
+           "value: .word " +
+           std::to_string(static_cast<int>(base)) + "\n";
+}
+
+// Writes a cache entry as ProgramCache stores one: the container, then its SHA-256
+void writeEntry(const std::filesystem::path& path, const mips::ObjectFile& object)
+{
+    std::ostringstream payload;
+    object.write(payload);
+    const auto digest = mips::Sha256::digest(payload.view());
+
+    std::ofstream out(path, std::ios::binary);
+    out << payload.view();
+    out.write(reinterpret_cast<const char*>(digest.data()), digest.size());
+}
+
+std::string run(const std::shared_ptr<const mips::ProgramImage>& image)
+{
+    mips::Cpu cpu;
+    cpu.loadProgramImage(image);
+    cpu.runFor(1000);
+    return cpu.getConsoleOutput();
+}
+
+}  // namespace
+
+class ProgramCacheTest : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        m_directory = std::filesystem::temp_directory_path() / "mipsim_program_cache_test";
+        std::filesystem::remove_all(m_directory);
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove_all(m_directory);
+    }
+
+    size_t countFiles(const std::string& extension) const
+    {
+        size_t count = 0;
+        for (const auto& entry : std::filesystem::directory_iterator(m_directory))
+        {
+            count += entry.path().extension() == extension;
+        }
+        return count;
+    }
+
+    std::filesystem::path m_directory;
+};
+
+TEST_F(ProgramCacheTest, HitIsDecodedFromTheEntryWithoutAssembling)
+{
+    const std::string source = printProgram('A');
+
+    mips::ProgramCache cache(m_directory);
+    const auto         assembled = cache.load(source);
+    EXPECT_EQ(cache.misses(), 1u);
+    EXPECT_TRUE(std::filesystem::exists(cache.entryPath(source)));
+
+    // Another process sharing the directory
+    mips::ProgramCache other(m_directory);
+    const auto         cached = other.load(source);
+    EXPECT_EQ(other.hits(), 1u);
+    EXPECT_EQ(other.misses(), 0u);
+    EXPECT_EQ(run(assembled), "A");
+    EXPECT_EQ(run(cached), "A");
+    EXPECT_EQ(cached->symbols(), assembled->symbols());
+    EXPECT_EQ(cached->fingerprint(), mips::Checkpoint::fingerprint(source));
+
+    // The entry is all a hit reads: replace it with another program's
+    mips::Assembler                  assembler;
+    mips::LabelMap                   labelMap;
+    std::vector<mips::DataDirective> dataDirectives;
+    auto instructions = assembler.assembleWithLabels(printProgram('Z'), labelMap, dataDirectives);
+    mips::Assembler::link(instructions, labelMap);
+    writeEntry(cache.entryPath(source),
+               mips::ObjectFile::fromProgram(instructions, dataDirectives, labelMap));
+    EXPECT_EQ(run(other.load(source)), "Z");
+}
+
+TEST_F(ProgramCacheTest, EntriesThatFailTheirChecksumAreEvicted)
+{
+    const std::string  source = printProgram('C');
+    mips::ProgramCache cache(m_directory);
+    cache.load(source);
+
+    // Change the data word in place: the container still parses, but would print 'D'
+    std::string bytes;
+    {
+        std::ifstream in(cache.entryPath(source), std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    mips::ObjectFile::View view;
+    std::string            error;
+    ASSERT_TRUE(mips::ObjectFile::view(bytes.data(), bytes.size() - sizeof(mips::Sha256::Digest),
+                                       view, error))
+        << error;
+    bytes[reinterpret_cast<const char*>(view.data) - bytes.data()] = 'D';
+    std::ofstream(cache.entryPath(source), std::ios::binary) << bytes;
+
+    mips::ProgramCache other(m_directory);
+    EXPECT_EQ(run(other.load(source)), "C");
+    EXPECT_EQ(other.hits(), 0u);
+    EXPECT_EQ(other.misses(), 1u);
+
+    // Evicted and stored again, so the next load hits
+    EXPECT_EQ(run(other.load(source)), "C");
+    EXPECT_EQ(other.hits(), 1u);
+
+    // Too short to hold a checksum
+    std::ofstream(cache.entryPath(source), std::ios::binary) << "short";
+    EXPECT_EQ(run(other.load(source)), "C");
+    EXPECT_EQ(other.misses(), 2u);
+}
+
+TEST_F(ProgramCacheTest, EntriesAreNamedAfterTheSourceSha256)
+{
+    const std::string  source = printProgram('K');
+    mips::ProgramCache cache(m_directory);
+    EXPECT_EQ(cache.entryPath(source).filename().string(),
+              mips::Sha256::hex(mips::Sha256::digest(source)) + "-v" +
+                  std::to_string(mips::Assembler::VERSION) + ".bin");
+
+    // Sources that differ only slightly never share an entry
+    EXPECT_NE(cache.entryPath(source), cache.entryPath(printProgram('L')));
+    EXPECT_EQ(run(cache.load(source)), "K");
+    EXPECT_EQ(run(cache.load(printProgram('L'))), "L");
+    EXPECT_EQ(cache.misses(), 2u);
+}
+
+TEST_F(ProgramCacheTest, ProblemsWithTheCacheOnlyCostTheHit)
+{
+    const std::string  source = printProgram('B');
+    mips::ProgramCache cache(m_directory);
+
+    // A damaged entry is assembled again and replaced
+    std::filesystem::create_directories(m_directory);
+    std::ofstream(cache.entryPath(source)) << "not a binary";
+    EXPECT_EQ(run(cache.load(source)), "B");
+    EXPECT_EQ(cache.misses(), 1u);
+    EXPECT_EQ(run(cache.load(source)), "B");
+    EXPECT_EQ(cache.hits(), 1u);
+
+    // Branches too far to encode: runs, but is never stored
+    std::string far = "beq $zero, $zero, end\n";
+    for (int i = 0; i < 40000; ++i)
+    {
+        far += "addi $t0, $t0, 1\n";
+    }
+    far += "end: addi $v0, $zero, 10\nsyscall\n";
+    EXPECT_EQ(cache.load(far)->instructions().size(), 40003u);
+    EXPECT_FALSE(std::filesystem::exists(cache.entryPath(far)));
+
+    EXPECT_THROW(cache.load("j nowhere\n"), std::runtime_error);
+    EXPECT_FALSE(std::filesystem::exists(cache.entryPath("j nowhere\n")));
+
+    // An unusable directory
+    mips::ProgramCache unwritable(m_directory / "entry-is-a-file");
+    std::ofstream(m_directory / "entry-is-a-file") << "";
+    EXPECT_EQ(run(unwritable.load(source)), "B");
+}
+
+TEST_F(ProgramCacheTest, EvictsLeastRecentlyUsedEntries)
+{
+    std::vector<std::string> sources;
+    for (char c : {'C', 'D', 'E', 'F'})
+    {
+        sources.push_back(printProgram(c));
+    }
+
+    mips::ProgramCache probe(m_directory / "probe");
+    probe.load(sources[0]);
+    const uint64_t entrySize = std::filesystem::file_size(probe.entryPath(sources[0]));
+
+    mips::ProgramCache cache(m_directory, entrySize * 3);
+    const auto         now = std::filesystem::file_time_type::clock::now();
+    for (int i = 0; i < 3; ++i)
+    {
+        cache.load(sources[i]);
+        std::filesystem::last_write_time(cache.entryPath(sources[i]),
+                                         now - std::chrono::seconds(30 - 10 * i));
+    }
+
+    // A hit makes the oldest entry the most recently used
+    cache.load(sources[0]);
+    EXPECT_EQ(cache.hits(), 1u);
+
+    cache.load(sources[3]);
+    EXPECT_TRUE(std::filesystem::exists(cache.entryPath(sources[0])));
+    EXPECT_FALSE(std::filesystem::exists(cache.entryPath(sources[1])));
+    EXPECT_TRUE(std::filesystem::exists(cache.entryPath(sources[2])));
+    EXPECT_TRUE(std::filesystem::exists(cache.entryPath(sources[3])));
+}
+
+TEST_F(ProgramCacheTest, ConcurrentWritersLeaveOneWholeEntry)
+{
+    std::string source = printProgram('G');
+    for (int i = 0; i < 5000; ++i)
+    {
+        source += "addi $t0, $t0, " + std::to_string(i) + "\n";
+    }
+
+    std::vector<std::string> outputs(8);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < outputs.size(); ++t)
+    {
+        threads.emplace_back(
+            [&, t]
+            {
+                // One cache per thread, as separate processes would have
+                mips::ProgramCache cache(m_directory);
+                for (int round = 0; round < 4; ++round)
+                {
+                    outputs[t] += run(cache.load(source));
+                }
+            });
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    for (const std::string& output : outputs)
+    {
+        EXPECT_EQ(output, "GGGG");
+    }
+    EXPECT_EQ(countFiles(".bin"), 1u);
+    EXPECT_EQ(countFiles(".tmp"), 0u);
+}
+
+TEST_F(ProgramCacheTest, ApiLoadsFilesThroughTheCache)
+{
+    std::filesystem::create_directories(m_directory);
+    const auto path = m_directory / "program.asm";
+    std::ofstream(path) << printProgram('H');
+
+    auto cache = std::make_shared<mips::ProgramCache>(m_directory / "cache");
+    for (int i = 0; i < 2; ++i)
+    {
+        mips::MipsSimulatorAPI api;
+        api.setProgramCache(cache);
+        ASSERT_TRUE(api.loadProgramFromFile(path.string())) << api.getLastError();
+        api.runFor(1000);
+        EXPECT_EQ(api.getConsoleOutput(), "H");
+    }
+    EXPECT_EQ(cache->misses(), 1u);
+    EXPECT_EQ(cache->hits(), 1u);
+
+    mips::MipsSimulatorAPI uncached;
+    uncached.setProgramCache(nullptr);
+    ASSERT_TRUE(uncached.loadCachedProgram(printProgram('I')));
+    uncached.runFor(1000);
+    EXPECT_EQ(uncached.getConsoleOutput(), "I");
+    EXPECT_FALSE(uncached.loadCachedProgram("j nowhere\n"));
+}
+
+TEST_F(ProgramCacheTest, SourcesWithSkippedLinesWarnEveryTime)
+{
+    const std::string source = "bogus $t0\n" + printProgram('W');
+    auto cache = std::make_shared<mips::ProgramCache>(m_directory);
+
+    std::vector<size_t> skipped;
+    EXPECT_EQ(run(cache->load(source, &skipped)), "W");
+    EXPECT_EQ(skipped, std::vector<size_t>{1});
+    EXPECT_FALSE(std::filesystem::exists(cache->entryPath(source)));
+
+    // With and without the cache
+    for (const auto& programCache : {cache, std::shared_ptr<mips::ProgramCache>()})
+    {
+        mips::MipsSimulatorAPI api;
+        api.setProgramCache(programCache);
+        ASSERT_TRUE(api.loadCachedProgram(source)) << api.getLastError();
+        EXPECT_EQ(api.getLastWarning(), "skipped line that did not parse: 1");
+        ASSERT_TRUE(api.loadCachedProgram(printProgram('W')));
+        EXPECT_EQ(api.getLastWarning(), "");
+    }
+}
+
+TEST_F(ProgramCacheTest, HitsLoadIntoADirtySimulatorLikeAssembling)
+{
+    // Grows the heap, so the next program's sbrk shows whether the break was kept
+    const std::string grow    = "addi $a0, $zero, 64\n"
+                                "addi $v0, $zero, 9\n"
+                                "syscall\n"
+                                "addi $v0, $zero, 10\n"
+                                "syscall\n";
+    const std::string program = "addi $a0, $zero, 16\n"
+                                "addi $v0, $zero, 9\n"
+                                "syscall\n"
+                                "add $s0, $v0, $zero\n"
+                                "la $t0, value\n"
+                                "lw $t1, 0($t0)\n"
+                                "addi $v0, $zero, 10\n"
+                                "syscall\n"
+                                "value: .word 1234\n";
+    const uint32_t    written = mips::Memory::HEAP_BASE + 0x10000;
+
+    struct Outcome
+    {
+        uint32_t heapStart;
+        uint32_t value;
+        uint32_t kept;
+    };
+    const auto loadIntoDirty = [&](const std::shared_ptr<mips::ProgramCache>& cache)
+    {
+        mips::MipsSimulatorAPI api;
+        api.setProgramCache(cache);
+        EXPECT_TRUE(api.loadCachedProgram(grow));
+        api.runFor(1000);
+        api.storeWord(written, 0xCAFEF00D);
+        EXPECT_TRUE(api.loadCachedProgram(program)) << api.getLastError();
+        api.runFor(1000);
+        return Outcome{api.readRegister(16), api.readRegister(9), api.loadWord(written)};
+    };
+
+    auto       cache    = std::make_shared<mips::ProgramCache>(m_directory);
+    const auto uncached = loadIntoDirty(nullptr);
+    const auto miss     = loadIntoDirty(cache);
+    const auto hit      = loadIntoDirty(cache);
+    EXPECT_EQ(cache->hits(), 2u);
+
+    EXPECT_EQ(uncached.heapStart, mips::Memory::HEAP_BASE + 64);
+    EXPECT_EQ(uncached.value, 1234u);
+    EXPECT_EQ(uncached.kept, 0xCAFEF00Du);
+    for (const Outcome& cached : {miss, hit})
+    {
+        EXPECT_EQ(cached.heapStart, uncached.heapStart);
+        EXPECT_EQ(cached.value, uncached.value);
+        EXPECT_EQ(cached.kept, uncached.kept);
+    }
+}
+
+TEST(ProgramCacheLimitTest, OnlyWholePositiveMegabytesThatFitAreAccepted)
+{
+    uint64_t maxBytes = mips::ProgramCache::DEFAULT_MAX_BYTES;
+    EXPECT_TRUE(mips::ProgramCache::parseMaxBytes("16", maxBytes));
+    EXPECT_EQ(maxBytes, 16u << 20);
+    EXPECT_TRUE(mips::ProgramCache::parseMaxBytes("17592186044415", maxBytes));
+    EXPECT_EQ(maxBytes, UINT64_MAX >> 20 << 20);
+
+    for (const char* bad : {"0", "abc", "", "12abc", " 12", "-1", "+5", "1.5", "17592186044416",
+                            "99999999999999999999999"})
+    {
+        maxBytes = 1;
+        EXPECT_FALSE(mips::ProgramCache::parseMaxBytes(bad, maxBytes)) << bad;
+        EXPECT_EQ(maxBytes, 1u) << bad;
+    }
+}
@@ -0,0 +1,167 @@
+#include "Cpu.h"
+#include "Memory.h"
+#include "MipsSimulatorAPI.h"
+#include "ProgramImage.h"
+#include "RegisterFile.h"
+#include <chrono>
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+// Adds $a0 to a data word, prints the sum as a character and exits
+const char* const ADD_PROGRAM = "la $t1, counter\n"
+                                "lw $t2, 0($t1)\n"
+                                "add $t2, $t2, $a0\n"
+                                "sw $t2, 0($t1)\n"
+                                "addi $a0, $t2, 0\n"
+                                "addi $v0, $zero, 11\n"
+                                "syscall\n"
+                                "addi $v0, $zero, 10\n"
+                                "syscall\n"
+                                "counter: .word 64\n";
+
+// Counts $t0 up to $t1 and exits, followed by blocks that never run
+std::string generateLoop(size_t blocks)
+{
+    std::string source = "loop: addi $t0, $t0, 1\n"
+                         "bne $t0, $t1, loop\n"
+                         "addi $v0, $zero, 10\n"
+                         "syscall\n";
+    for (size_t i = 0; i < blocks; ++i)
+    {
+        const std::string n = std::to_string(i);
+        source += "f" + n + ": addi $t0, $t0, 1\n";
+        source += "bne $t0, $t1, f" + std::to_string(i / 2) + "\n";
+    }
+    return source + "table: .word 1, 2, 3\n";
+}
+
+}  // namespace
+
+TEST(ProgramImageTest, CpusShareOneImageAndKeepTheirOwnData)
+{
+    const auto     image   = mips::ProgramImage::assemble(ADD_PROGRAM);
+    const uint32_t counter = image->symbols().at("counter");
+
+    std::vector<std::unique_ptr<mips::Cpu>> cpus;
+    for (int i = 0; i < 4; ++i)
+    {
+        auto cpu = std::make_unique<mips::Cpu>();
+        cpu->loadProgramImage(image);
+        cpu->getRegisterFile().write(4, i + 1);  // $a0
+        cpus.push_back(std::move(cpu));
+    }
+    EXPECT_EQ(image.use_count(), 5);
+
+    for (int i = 0; i < 4; ++i)
+    {
+        mips::Cpu& cpu = *cpus[i];
+        cpu.runFor(1000);
+        EXPECT_TRUE(cpu.shouldTerminate());
+        EXPECT_EQ(cpu.getConsoleOutput(), std::string(1, static_cast<char>('A' + i)));
+        EXPECT_EQ(cpu.getMemory().readWord(counter), 65u + i);
+        EXPECT_EQ(&cpu.getProgramImage()->instructions(), &image->instructions());
+    }
+
+    // Writes went to each Cpu's own copy of the page
+    EXPECT_EQ(image->data().readWord(counter), 64u);
+
+    // Loading the image again starts over from its data
+    cpus[0]->getRegisterFile().write(4, 2);
+    cpus[0]->loadProgramImage(image);
+    EXPECT_EQ(cpus[0]->getMemory().readWord(counter), 64u);
+    cpus[0]->runFor(1000);
+    EXPECT_EQ(cpus[0]->getMemory().readWord(counter), 66u);
+
+    cpus[0]->reset();
+    EXPECT_EQ(cpus[0]->getProgramImage()->instructions().size(), 0u);
+    EXPECT_EQ(image.use_count(), 4);
+}
+
+TEST(ProgramImageTest, CpusOnSeveralThreadsRunOneImage)
+{
+    const auto image = mips::ProgramImage::assemble(generateLoop(2000));
+
+    std::vector<uint32_t>    counts(8);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < counts.size(); ++t)
+    {
+        threads.emplace_back(
+            [&, t]
+            {
+                mips::Cpu cpu;
+                cpu.setExecutionEngine(t % 2 ? mips::ExecutionEngine::Jit
+                                             : mips::ExecutionEngine::Block);
+                cpu.loadProgramImage(image);
+                cpu.getRegisterFile().write(9, 1000 + static_cast<uint32_t>(t));  // $t1
+                cpu.getMemory().writeWord(image->symbols().at("table"), static_cast<uint32_t>(t));
+                cpu.runFor(1000000);
+                EXPECT_TRUE(cpu.shouldTerminate());
+                counts[t] = cpu.getRegisterFile().read(8);
+            });
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    for (size_t t = 0; t < counts.size(); ++t)
+    {
+        EXPECT_EQ(counts[t], 1000 + t);
+    }
+    EXPECT_EQ(image->data().readWord(image->symbols().at("table")), 1u);
+}
+
+TEST(ProgramImageTest, LoadingAnImageDoesNotDependOnItsSize)
+{
+    const std::string source = generateLoop(100000);  // 200K instructions
+
+    auto       start = std::chrono::steady_clock::now();
+    const auto image = mips::ProgramImage::assemble(source);
+    const std::chrono::duration<double> assembleTime = std::chrono::steady_clock::now() - start;
+
+    mips::Cpu cpu;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 100; ++i)
+    {
+        cpu.loadProgramImage(image);
+    }
+    const std::chrono::duration<double> loadTime = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    mips::Cpu fresh;
+    fresh.loadProgramFromString(source);
+    const std::chrono::duration<double> stringTime = std::chrono::steady_clock::now() - start;
+
+    std::cout << "ProgramImage: 200K instructions assembled in " << assembleTime.count()
+              << "s, 100 loads of the image in " << loadTime.count()
+              << "s, one loadProgramFromString in " << stringTime.count() << "s" << std::endl;
+    EXPECT_LT(loadTime.count(), stringTime.count());
+    EXPECT_EQ(cpu.getLabelAddress("f99999"), fresh.getLabelAddress("f99999"));
+}
+
+TEST(ProgramImageTest, ApiLoadsImagesAndSharesCheckpointsWithLoadProgram)
+{
+    auto path = std::filesystem::temp_directory_path() / "mipsim_program_image_test.ckpt";
+
+    mips::MipsSimulatorAPI api;
+    ASSERT_TRUE(api.loadProgram(ADD_PROGRAM));
+    api.writeRegister(4, 3);
+    api.runFor(3);
+    ASSERT_TRUE(api.saveCheckpoint(path.string())) << api.getLastError();
+
+    mips::MipsSimulatorAPI shared;
+    EXPECT_FALSE(shared.loadProgramImage(nullptr));
+    ASSERT_TRUE(shared.loadProgramImage(mips::ProgramImage::assemble(ADD_PROGRAM)));
+    ASSERT_TRUE(shared.loadCheckpoint(path.string())) << shared.getLastError();
+    shared.runFor(100);
+    EXPECT_EQ(shared.getConsoleOutput(), "C");
+
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,154 @@
+#include "Cpu.h"
+#include "MipsSimulatorAPI.h"
+#include "RegisterFile.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <string>
+
+namespace
+{
+
+// 0: li $t0, 0   1: loop: addi $t0, $t0, 1   2: addi $t1, $t1, 2
+// 3: bne $t0, $t2, loop   4: exit
+const std::string COUNT_LOOP = "addi $t0, $zero, 0\n"
+                               "loop:\n"
+                               "addi $t0, $t0, 1\n"
+                               "addi $t1, $t1, 2\n"
+                               "bne $t0, $t2, loop\n"
+                               "trap 10\n";
+
+const mips::ExecutionEngine ALL_ENGINES[] = {
+    mips::ExecutionEngine::Block, mips::ExecutionEngine::Jit, mips::ExecutionEngine::Decoded,
+    mips::ExecutionEngine::Reference};
+
+void loadCountLoop(mips::Cpu& cpu, mips::ExecutionEngine engine, uint32_t iterations)
+{
+    cpu.setExecutionEngine(engine);
+    cpu.loadProgramFromString(COUNT_LOOP);
+    cpu.getRegisterFile().write(10, iterations);  // $t2
+}
+
+}  // namespace
+
+TEST(RunForTest, StopsAtExit)
+{
+    for (mips::ExecutionEngine engine : ALL_ENGINES)
+    {
+        mips::Cpu cpu;
+        loadCountLoop(cpu, engine, 100);
+
+        mips::RunResult result = cpu.runFor(UINT64_MAX);
+        EXPECT_EQ(result.reason, mips::StopReason::Exit);
+        EXPECT_EQ(result.cycles, 1u + 3u * 100u + 1u);
+        EXPECT_EQ(cpu.getRegisterFile().read(9), 200u);
+    }
+}
+
+TEST(RunForTest, StopsWhenBudgetIsExhausted)
+{
+    for (mips::ExecutionEngine engine : ALL_ENGINES)
+    {
+        mips::Cpu cpu;
+        loadCountLoop(cpu, engine, 1000);
+
+        mips::RunResult result = cpu.runFor(200);
+        EXPECT_EQ(result.reason, mips::StopReason::BudgetExhausted);
+        EXPECT_EQ(result.cycles, 200u);
+        EXPECT_EQ(cpu.getCycleCount(), 200u);
+
+        // The next run carries on from where the budget ran out
+        result = cpu.runFor(UINT64_MAX);
+        EXPECT_EQ(result.reason, mips::StopReason::Exit);
+        EXPECT_EQ(cpu.getCycleCount(), 1u + 3u * 1000u + 1u);
+    }
+}
+
+TEST(RunForTest, StopsAtBreakpointInsideBlock)
+{
+    for (mips::ExecutionEngine engine : ALL_ENGINES)
+    {
+        mips::Cpu cpu;
+        loadCountLoop(cpu, engine, 100);
+
+        // Instruction 2 sits in the middle of the loop block
+        mips::RunResult result = cpu.runFor(UINT64_MAX, 2);
+        EXPECT_EQ(result.reason, mips::StopReason::Breakpoint);
+        EXPECT_EQ(result.cycles, 2u);
+        EXPECT_EQ(cpu.getProgramCounter(), 2u);
+
+        // Starting on the stop PC runs one full iteration back to it
+        result = cpu.runFor(UINT64_MAX, 2);
+        EXPECT_EQ(result.reason, mips::StopReason::Breakpoint);
+        EXPECT_EQ(result.cycles, 3u);
+        EXPECT_EQ(cpu.getRegisterFile().read(8), 2u);
+    }
+}
+
+TEST(RunForTest, BreakpointOnHotLoopWithJit)
+{
+    mips::Cpu cpu;
+    loadCountLoop(cpu, mips::ExecutionEngine::Jit, 1000);
+
+    // Let the loop get hot enough to be translated first
+    cpu.runFor(600);
+    mips::RunResult result = cpu.runFor(UINT64_MAX, 4);
+    EXPECT_EQ(result.reason, mips::StopReason::Breakpoint);
+    EXPECT_EQ(cpu.getProgramCounter(), 4u);
+    EXPECT_EQ(cpu.getRegisterFile().read(8), 1000u);
+    EXPECT_FALSE(cpu.shouldTerminate());
+}
+
+TEST(RunForTest, StopFlagEndsRun)
+{
+    for (mips::ExecutionEngine engine : ALL_ENGINES)
+    {
+        mips::Cpu cpu;
+        cpu.setExecutionEngine(engine);
+        cpu.loadProgramFromString("loop:\naddi $t0, $t0, 1\nj loop\n");
+
+        std::atomic<bool> stop{true};
+        mips::RunResult   result = cpu.runFor(UINT64_MAX, mips::Cpu::NO_STOP_PC, &stop);
+        EXPECT_EQ(result.reason, mips::StopReason::StopRequested);
+        EXPECT_EQ(result.cycles, 0u);
+    }
+}
+
+TEST(RunForTest, LeavingTheProgramIsAFault)
+{
+    for (mips::ExecutionEngine engine : ALL_ENGINES)
+    {
+        mips::Cpu cpu;
+        cpu.setExecutionEngine(engine);
+        cpu.loadProgramFromString("addi $t0, $zero, 1\naddi $t1, $zero, 2\n");
+
+        mips::RunResult result = cpu.runFor(UINT64_MAX);
+        EXPECT_EQ(result.reason, mips::StopReason::Fault);
+        EXPECT_EQ(result.cycles, 2u);
+        EXPECT_EQ(cpu.getProgramCounter(), 2u);
+    }
+}
+
+TEST(RunForTest, RunStillIdlesPastTheEnd)
+{
+    mips::Cpu cpu;
+    cpu.loadProgramFromString("addi $t0, $zero, 1\n");
+    cpu.run(10);
+    EXPECT_EQ(cpu.getCycleCount(), 10u);
+    EXPECT_EQ(cpu.getRetiredInstructionCount(), 1u);
+}
+
+TEST(RunForTest, ApiRunUntilAndFaultMessage)
+{
+    mips::MipsSimulatorAPI api;
+    ASSERT_TRUE(api.loadProgram("addi $t0, $zero, 1\n"
+                                "addi $t1, $zero, 2\n"
+                                "addi $t2, $zero, 3\n"));
+
+    mips::RunResult result = api.runUntil(2);
+    EXPECT_EQ(result.reason, mips::StopReason::Breakpoint);
+    EXPECT_EQ(api.getProgramCounter(), 2u);
+
+    result = api.runFor(UINT64_MAX);
+    EXPECT_EQ(result.reason, mips::StopReason::Fault);
+    EXPECT_NE(api.getLastError().find("left the program"), std::string::npos);
+}
@@ -0,0 +1,196 @@
+#include "Cpu.h"
+#include "Memory.h"
+#include "MipsSimulatorAPI.h"
+#include "RegisterFile.h"
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+// Instructions 0-5 are the prologue: allocate a heap word and store 100 in it.
+// Instruction 6 onwards reads an integer, adds it to the stored word and prints it.
+const std::string PROLOGUE_THEN_READ = "addi $a0, $zero, 16\n"
+                                       "addi $v0, $zero, 9\n"
+                                       "syscall\n"
+                                       "add $s0, $v0, $zero\n"
+                                       "addi $t0, $zero, 100\n"
+                                       "sw $t0, 0($s0)\n"
+                                       "addi $v0, $zero, 5\n"
+                                       "syscall\n"
+                                       "lw $t1, 0($s0)\n"
+                                       "add $t1, $t1, $v0\n"
+                                       "sw $t1, 0($s0)\n"
+                                       "add $a0, $t1, $zero\n"
+                                       "addi $v0, $zero, 1\n"
+                                       "syscall\n"
+                                       "addi $v0, $zero, 10\n"
+                                       "syscall\n";
+
+const uint32_t READ_PC = 6;
+
+}  // namespace
+
+TEST(MemorySnapshotTest, CopySharesPagesUntilWritten)
+{
+    mips::Memory original;
+    original.writeWord(0x1000, 11);
+    original.writeWord(0x5000, 22);
+
+    mips::Memory copy(original);
+    EXPECT_EQ(copy.readWord(0x1000), 11u);
+    EXPECT_EQ(copy.allocatedPageCount(), 2u);
+    EXPECT_EQ(copy.dirtyPageCount(), 2u);
+
+    copy.writeWord(0x1000, 33);
+    original.writeWord(0x5000, 44);
+    EXPECT_EQ(original.readWord(0x1000), 11u);
+    EXPECT_EQ(copy.readWord(0x1000), 33u);
+    EXPECT_EQ(original.readWord(0x5000), 44u);
+    EXPECT_EQ(copy.readWord(0x5000), 22u);
+
+    // Resetting one side must not clear pages the other still uses
+    copy.reset();
+    EXPECT_EQ(copy.readWord(0x5000), 0u);
+    EXPECT_EQ(original.readWord(0x1000), 11u);
+    EXPECT_EQ(original.readWord(0x5000), 44u);
+}
+
+TEST(MemorySnapshotTest, MoveTakesThePagesAndLeavesTheSourceEmpty)
+{
+    mips::Memory original;
+    original.writeWord(0x1000, 11);
+    const uint8_t* page = (*original.dirtyPages().begin()).data;
+
+    mips::Memory moved(std::move(original));
+    EXPECT_EQ(moved.readWord(0x1000), 11u);
+    EXPECT_EQ(moved.allocatedPageCount(), 1u);
+    EXPECT_EQ((*moved.dirtyPages().begin()).data, page);  // Not copied
+    EXPECT_EQ(original.allocatedPageCount(), 0u);
+    EXPECT_EQ(original.dirtyPageCount(), 0u);
+
+    original = std::move(moved);
+    EXPECT_EQ(original.readWord(0x1000), 11u);
+    EXPECT_EQ(moved.readWord(0x1000), 0u);
+}
+
+TEST(CpuSnapshotTest, RestoreReplaysFromSavedState)
+{
+    mips::Cpu cpu;
+    cpu.loadProgramFromString(PROLOGUE_THEN_READ);
+    ASSERT_EQ(cpu.runFor(UINT64_MAX, READ_PC).reason, mips::StopReason::Breakpoint);
+
+    const mips::CpuSnapshot saved = cpu.snapshot();
+
+    cpu.setConsoleInput("5");
+    EXPECT_EQ(cpu.runFor(UINT64_MAX).reason, mips::StopReason::Exit);
+    EXPECT_EQ(cpu.getConsoleOutput(), "105\n");
+
+    cpu.restore(saved);
+    EXPECT_FALSE(cpu.shouldTerminate());
+    EXPECT_EQ(cpu.getProgramCounter(), READ_PC);
+    EXPECT_EQ(cpu.getCycleCount(), saved.cycleCount);
+    EXPECT_EQ(cpu.getMemory().readWord(cpu.getRegisterFile().read(16)), 100u);
+
+    cpu.setConsoleInput("-30");
+    EXPECT_EQ(cpu.runFor(UINT64_MAX).reason, mips::StopReason::Exit);
+    EXPECT_EQ(cpu.getConsoleOutput(), "70\n");
+
+    // The snapshot itself was never modified
+    EXPECT_EQ(saved.memory->readWord(mips::Memory::HEAP_BASE), 100u);
+}
+
+TEST(CpuSnapshotTest, ConsoleTextIsSharedUntilWritten)
+{
+    mips::Cpu cpu;
+    cpu.loadProgramFromString(PROLOGUE_THEN_READ);
+    cpu.setConsoleInput(std::string(1 << 20, ' ') + "7");
+    for (int i = 0; i < 1000; ++i)
+    {
+        cpu.printString("line of earlier output\n");
+    }
+    cpu.runFor(UINT64_MAX, READ_PC);
+
+    // Snapshots and forks take a reference to the text, not a copy of it
+    const mips::CpuSnapshot    saved = cpu.snapshot();
+    std::unique_ptr<mips::Cpu> child = cpu.fork();
+    const mips::CpuSnapshot    fromChild = child->snapshot();
+    EXPECT_TRUE(saved.consoleOutput.sharesWith(fromChild.consoleOutput));
+    EXPECT_TRUE(saved.consoleInput.sharesWith(fromChild.consoleInput));
+    EXPECT_EQ(&child->getConsoleOutput(), &cpu.getConsoleOutput());
+
+    // The first print copies, on the side that printed only
+    const std::string before = cpu.getConsoleOutput();
+    EXPECT_EQ(child->runFor(UINT64_MAX).reason, mips::StopReason::Exit);
+    EXPECT_EQ(child->getConsoleOutput(), before + "107\n");
+    EXPECT_EQ(cpu.getConsoleOutput(), before);
+    EXPECT_EQ(saved.consoleOutput.str(), before);
+    EXPECT_TRUE(saved.consoleOutput.sharesWith(cpu.snapshot().consoleOutput));
+    EXPECT_TRUE(saved.consoleInput.sharesWith(child->snapshot().consoleInput));
+}
+
+TEST(CpuSnapshotTest, ForkRunsIndependentlyOnEveryEngine)
+{
+    const mips::ExecutionEngine engines[] = {
+        mips::ExecutionEngine::Block, mips::ExecutionEngine::Jit,
+        mips::ExecutionEngine::Decoded, mips::ExecutionEngine::Reference};
+
+    for (mips::ExecutionEngine engine : engines)
+    {
+        mips::Cpu parent;
+        parent.setExecutionEngine(engine);
+        parent.loadProgramFromString(PROLOGUE_THEN_READ);
+        parent.runFor(UINT64_MAX, READ_PC);
+
+        std::unique_ptr<mips::Cpu> child = parent.fork();
+        EXPECT_EQ(child->getExecutionEngine(), engine);
+        EXPECT_EQ(child->getInstructionCount(), parent.getInstructionCount());
+
+        child->setConsoleInput("1");
+        EXPECT_EQ(child->runFor(UINT64_MAX).reason, mips::StopReason::Exit);
+        EXPECT_EQ(child->getConsoleOutput(), "101\n");
+
+        // The parent is still parked before the read with its memory untouched
+        EXPECT_EQ(parent.getProgramCounter(), READ_PC);
+        EXPECT_EQ(parent.getMemory().readWord(mips::Memory::HEAP_BASE), 100u);
+        parent.setConsoleInput("2");
+        parent.runFor(UINT64_MAX);
+        EXPECT_EQ(parent.getConsoleOutput(), "102\n");
+    }
+}
+
+TEST(CpuSnapshotTest, ApiForksFanOutAcrossThreads)
+{
+    mips::MipsSimulatorAPI api;
+    ASSERT_TRUE(api.loadProgram(PROLOGUE_THEN_READ));
+    ASSERT_EQ(api.runUntil(READ_PC).reason, mips::StopReason::Breakpoint);
+
+    constexpr int                                        FORKS = 8;
+    std::vector<std::unique_ptr<mips::MipsSimulatorAPI>> forks;
+    for (int i = 0; i < FORKS; ++i)
+    {
+        forks.push_back(api.fork());
+        forks.back()->setConsoleInput(std::to_string(i));
+    }
+
+    std::vector<std::thread> threads;
+    for (auto& fork : forks)
+    {
+        threads.emplace_back([&fork]() { fork->run(); });
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    for (int i = 0; i < FORKS; ++i)
+    {
+        EXPECT_TRUE(forks[i]->isTerminated());
+        EXPECT_EQ(forks[i]->getConsoleOutput(), std::to_string(100 + i) + "\n");
+        EXPECT_EQ(forks[i]->loadWord(mips::Memory::HEAP_BASE), static_cast<uint32_t>(100 + i));
+    }
+    EXPECT_EQ(api.loadWord(mips::Memory::HEAP_BASE), 100u);
+}